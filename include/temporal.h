@@ -100,6 +100,18 @@ typedef enum
   DIV,
 } TArithmetic;
 
+/** Enumeration for the comparison functions */
+
+typedef enum
+{
+  EQ,
+  NE,
+  LT,
+  LE,
+  GT,
+  GE,
+} TComparison;
+
 /*****************************************************************************
  * Compatibility with older versions of PostgreSQL
  *****************************************************************************/
@@ -148,7 +160,7 @@ struct tduration_struct
 
 /*****************************************************************************
  * Macros for manipulating the 'flags' element
- * GTZXBL
+ * PGTZXBL
  *****************************************************************************/
 
 #define MOBDB_FLAGS_GET_LINEAR(flags)     ((bool) ((flags) & 0x01))
@@ -158,6 +170,13 @@ struct tduration_struct
 #define MOBDB_FLAGS_GET_Z(flags)       ((bool) (((flags) & 0x08)>>3))
 #define MOBDB_FLAGS_GET_T(flags)       ((bool) (((flags) & 0x10)>>4))
 #define MOBDB_FLAGS_GET_GEODETIC(flags)   ((bool) (((flags) & 0x20)>>5))
+/* The following flag is only used for TInstantSet, TSequence, and
+ * TSequenceSet. It is set when the bounding box follows the header and unset
+ * for the values written by previous versions, which keep the bounding box
+ * after the instants or the sequences */
+#define MOBDB_FLAGS_GET_PREFIXBOX(flags)   ((bool) (((flags) & 0x40)>>6))
+/* Flags without the layout flag, used for comparing temporal values */
+#define MOBDB_FLAGS_NO_PREFIXBOX(flags)    ((flags) & 0xBF)
 
 #define MOBDB_FLAGS_SET_LINEAR(flags, value) \
   ((flags) = (value) ? ((flags) | 0x01) : ((flags) & 0xFE))
@@ -172,6 +191,10 @@ struct tduration_struct
   ((flags) = (value) ? ((flags) | 0x10) : ((flags) & 0xEF))
 #define MOBDB_FLAGS_SET_GEODETIC(flags, value) \
   ((flags) = (value) ? ((flags) | 0x20) : ((flags) & 0xDF))
+/* The following flag is only used for TInstantSet, TSequence, and
+ * TSequenceSet */
+#define MOBDB_FLAGS_SET_PREFIXBOX(flags, value) \
+  ((flags) = (value) ? ((flags) | 0x40) : ((flags) & 0xBF))
 
 /*****************************************************************************
  * Macros for GiST indexes
@@ -235,43 +258,56 @@ typedef struct
 
 /**
  * Structure to represent temporal values of instant set duration
+ *
+ * The bboxsize field occupies padding bytes of the layout of previous
+ * versions and is only valid when the flag PREFIXBOX is set
  */
 typedef struct
 {
   int32    vl_len_;        /**< varlena header (do not touch directly!) */
   TDuration   duration;    /**< duration */
   int16    flags;          /**< flags */
+  int16    bboxsize;       /**< size of the bounding box, without padding */
   Oid     valuetypid;      /**< base type's OID (4 bytes) */
   int32     count;         /**< number of TInstant elements */
-  size_t    offsets[1];    /**< beginning of variable-length data */
+  /* variable-length data follows */
 } TInstantSet;
 
 /**
  * Structure to represent temporal values of sequence duration
+ *
+ * The bboxsize and maxcount fields occupy padding bytes of the layout of
+ * previous versions and are only valid when the flag PREFIXBOX is set
  */
 typedef struct
 {
   int32    vl_len_;        /**< varlena header (do not touch directly!) */
   TDuration   duration;    /**< duration */
   int16    flags;          /**< flags */
+  int16    bboxsize;       /**< size of the bounding box, without padding */
   Oid     valuetypid;      /**< base type's OID (4 bytes) */
   int32     count;         /**< number of TInstant elements */
+  int32     maxcount;      /**< maximum number of TInstant elements */
   Period     period;       /**< time span (24 bytes) */
-  size_t    offsets[1];    /**< beginning of variable-length data */
+  /* variable-length data follows */
 } TSequence;
 
 /**
  * Structure to represent temporal values of sequence set duration
+ *
+ * The bboxsize field occupies padding bytes of the layout of previous
+ * versions and is only valid when the flag PREFIXBOX is set
  */
 typedef struct
 {
   int32       vl_len_;        /**< varlena header (do not touch directly!) */
   TDuration   duration;       /**< duration */
   int16       flags;          /**< flags */
+  int16       bboxsize;       /**< size of the bounding box, without padding */
   Oid         valuetypid;     /**< base type's OID (4 bytes) */
   int32       count;          /**< number of TSequence elements */
   int32       totalcount;     /**< total number of TInstant elements in all TSequence elements */
-  size_t      offsets[1];     /**< beginning of variable-length data */
+  /* variable-length data follows */
 } TSequenceSet;
 
 /**
@@ -457,6 +493,7 @@ extern void ensure_sequences_duration(TDuration duration);
 extern void ensure_non_empty_array(ArrayType *array);
 extern void ensure_linear_interpolation(Oid type);
 extern void ensure_linear_interpolation_all(Oid type);
+extern void ensure_positive_interval(const Interval *duration);
 
 extern void ensure_same_duration(const Temporal *temp1,
   const Temporal *temp2);
@@ -477,8 +514,9 @@ extern Datum temporal_in(PG_FUNCTION_ARGS);
 extern Datum temporal_out(PG_FUNCTION_ARGS);
 extern Datum temporal_send(PG_FUNCTION_ARGS);
 extern Datum temporal_recv(PG_FUNCTION_ARGS);
-extern Temporal* temporal_read(StringInfo buf, Oid valuetypid);
-extern void temporal_write(Temporal* temp, StringInfo buf);
+extern Temporal* temporal_read(StringInfo buf, Oid valuetypid,
+  FmgrInfo *flinfo);
+extern void temporal_write(Temporal* temp, StringInfo buf, FmgrInfo *flinfo);
 
 /* Constructor functions */
 
@@ -579,6 +617,8 @@ extern Datum temporal_intersects_periodset(PG_FUNCTION_ARGS);
 
 extern bool temporal_value_at_timestamp_inc(const Temporal *temp,
   TimestampTz t, Datum *value);
+extern bool temporal_intersects_period_internal(const Temporal *temp,
+  const Period *p);
 
 extern bool temporal_bbox_restrict_value(const Temporal *temp, Datum value);
 extern Datum *temporal_bbox_restrict_values(const Temporal *temp,
@@ -606,6 +646,8 @@ extern char *temporal_to_string(const Temporal *temp,
   char *(*value_out)(Oid, Datum));
 extern void *temporal_bbox_ptr(const Temporal *temp);
 extern void temporal_bbox(void *box, const Temporal *temp);
+extern void temporal_bbox_slice(Datum tempdatum, void *box);
+extern void temporal_period_slice(Datum tempdatum, Period *p);
 
 /* Comparison functions */
 
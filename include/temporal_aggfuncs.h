@@ -15,6 +15,7 @@
 
 #include <postgres.h>
 #include <catalog/pg_type.h>
+#include <utils/timestamp.h>
 #include "temporal.h"
 
 /*****************************************************************************/
@@ -23,17 +24,18 @@
 
 #define SKIPLIST_MAXLEVEL 32   // maximum possible is 47 with current RNG
 #define SKIPLIST_INITIAL_CAPACITY 1024
-#define SKIPLIST_GROW 2
-#define SKIPLIST_INITIAL_FREELIST 32
+#define SKIPLIST_GROW 1
 
 /**
- * Structure to represent elements in the skiplists
+ * Structure to represent elements in the skiplists. The forward pointers of
+ * an element are kept in the level pool of the skiplist and only take as 
+ * many entries as the height of the element.
  */
 typedef struct
 {
   Temporal *value;
   int height;
-  int next[SKIPLIST_MAXLEVEL];
+  int levels;      /**< Offset of the forward pointers in the level pool */
 } Elem;
 
 /**
@@ -44,15 +46,183 @@ typedef struct
   int capacity;
   int next;
   int length;
-  int *freed;
-  int freecount;
-  int freecap;
+  int levelcap;    /**< Capacity of the level pool */
+  int levelnext;   /**< Next unused entry of the level pool */
+  int freed[SKIPLIST_MAXLEVEL]; /**< Free lists of elements by height */
+  bool fingered;   /**< True when the finger is valid */
+  int finger[SKIPLIST_MAXLEVEL]; /**< Last element of each level */
   int tail;
   void *extra;
   size_t extrasize;
   Elem *elems;
+  int *levels;     /**< Level pool */
 } SkipList;
 
+/* Sequence-building aggregates - Internal type for the aggregation state */
+
+#define SEQAGG_INITIAL_CAPACITY 64
+
+/**
+ * Structure to represent the state of the aggregates that build temporal
+ * sequences from the values and timestamps of the rows. The instants of the
+ * current sequence are kept contiguously in a growable buffer, the sequences
+ * already closed by a gap are kept in an array.
+ */
+typedef struct
+{
+  Oid valuetypid;       /**< Oid of the base type */
+  bool linear;          /**< True when the sequences have linear interpolation */
+  bool hasgap;          /**< True when the sequences are split by gaps */
+  Interval maxgap;      /**< Maximum time interval between two instants */
+  char *data;           /**< Instants of the current sequence */
+  size_t datasize;      /**< Size in bytes of the instants in the buffer */
+  size_t datacap;       /**< Capacity in bytes of the buffer */
+  size_t *offsets;      /**< Offsets of the instants in the buffer */
+  int count;            /**< Number of instants in the current sequence */
+  int capacity;         /**< Capacity of the offsets array */
+  TSequence **sequences; /**< Sequences closed by a gap */
+  int seqcount;         /**< Number of closed sequences */
+  int seqcap;           /**< Capacity of the sequences array */
+} SeqAggState;
+
+/* Temporal count - Internal type for the aggregation state */
+
+#define TCOUNT_INITIAL_CAPACITY 64
+
+/**
+ * Structure to represent the state of the temporal count aggregation. The
+ * state keeps the timestamps of the instants or the periods of the sequences
+ * of the aggregated values in a buffer.
+ */
+typedef struct
+{
+  int16 duration;       /**< INSTANT for timestamps, SEQUENCE for periods */
+  int count;            /**< Number of elements in the buffer */
+  int capacity;         /**< Capacity of the buffer */
+  void *data;           /**< Buffer of timestamps or periods */
+} TCountState;
+
+#define TCOUNT_ELEMSIZE(duration) \
+  ((duration) == INSTANT ? sizeof(TimestampTz) : sizeof(Period))
+
+/* Temporal average - Internal type for the aggregation state */
+
+#define TAVG_INITIAL_CAPACITY 64
+#define TAVG_MAXDIM 3
+
+/**
+ * Structure to represent the state of the temporal average aggregation,
+ * which is also used for the temporal centroid. The state keeps in parallel
+ * arrays the timestamps, the kinds, and the values of the events of the
+ * aggregated values, which are their instants. The instants of a sequence
+ * are consecutive in the arrays. The values have dim components per event.
+ */
+typedef struct
+{
+  int16 duration;       /**< INSTANT for instants, SEQUENCE for sequences */
+  bool linear;          /**< True when the sequences are linear */
+  int16 dim;            /**< Number of components of the values */
+  int32 srid;           /**< SRID of the values of the temporal centroid */
+  int count;            /**< Number of events in the arrays */
+  int capacity;         /**< Capacity of the arrays */
+  TimestampTz *times;   /**< Timestamps of the events */
+  uint8 *kinds;         /**< Kinds of the events, NULL for instants */
+  double *values;       /**< Values of the events */
+} TAvgState;
+
+/* Bucket aggregates - Internal type for the aggregation state */
+
+#define TBUCKET_INITIAL_CAPACITY 64
+
+/**
+ * Structure to represent the aggregated values of a time bucket
+ */
+typedef struct
+{
+  int count;            /**< Number of values intersecting the bucket */
+  int ninsts;           /**< Number of instantaneous values in the bucket */
+  double sum;           /**< Sum of the instantaneous values */
+  double integral;      /**< Integral of the values over the bucket */
+  double duration;      /**< Duration of the values in the bucket */
+} TBucket;
+
+/**
+ * Structure to represent the state of the bucket aggregations. The state
+ * keeps a dense array of the buckets between the first and the last one
+ * intersected by the aggregated values. The array may have free slots on
+ * both sides so that it can grow in both directions.
+ */
+typedef struct
+{
+  TimestampTz origin;   /**< Origin of the buckets */
+  int64 width;          /**< Width of the buckets in microseconds */
+  int64 first;          /**< Number of the first bucket of the state */
+  int start;            /**< Position of the first bucket in the array */
+  int count;            /**< Number of buckets of the state */
+  int capacity;         /**< Capacity of the array */
+  TBucket *buckets;     /**< Array of buckets */
+} TBucketState;
+
+/* Merge aggregate - Internal type for the aggregation state */
+
+#define MERGEAGG_INITIAL_CAPACITY 64
+#define MERGEAGG_BUFFER_SIZE 64
+
+/**
+ * Structure to represent the state of the merge aggregation. The incoming
+ * sequences are kept in a bounded buffer that is merged with the sequences
+ * merged so far when it is full.
+ */
+typedef struct
+{
+  bool linear;          /**< True when the sequences are linear */
+  int count;            /**< Number of merged sequences */
+  int capacity;         /**< Capacity of the array of merged sequences */
+  TSequence **sequences; /**< Merged sequences in time order */
+  int npending;         /**< Number of sequences in the buffer */
+  TSequence *pending[MERGEAGG_BUFFER_SIZE]; /**< Buffer of sequences */
+} MergeAggState;
+
+/* Append aggregate - Internal type for the aggregation state */
+
+#define APPENDAGG_INITIAL_CAPACITY 64
+
+/**
+ * Structure to represent the state of the aggregation appending instants.
+ * The instants are appended in place to the last sequence, which has spare
+ * capacity, the sequences closed by a discontinuity are kept compact in an
+ * array.
+ */
+typedef struct
+{
+  TSequence *seq;       /**< Last sequence, which has spare capacity */
+  int count;            /**< Number of closed sequences */
+  int capacity;         /**< Capacity of the array of closed sequences */
+  TSequence **sequences; /**< Sequences closed by a discontinuity */
+} AppendAggState;
+
+/* Moving extent - Internal type for the aggregation state */
+
+#define EXTENTAGG_INITIAL_CAPACITY 64
+
+/**
+ * Structure to represent the state of the moving extent aggregation. The
+ * bounding boxes of the rows of the frame are kept in a circular buffer in
+ * the order in which they were added, since the rows leave the frame in
+ * this order. When a removed box reaches a bound of the extent, the extent
+ * is recomputed from the remaining boxes.
+ */
+typedef struct
+{
+  Oid valuetypid;       /**< Oid of the base type */
+  size_t boxsize;       /**< Size of the bounding boxes */
+  int start;            /**< Position of the first box in the buffer */
+  int count;            /**< Number of boxes in the buffer */
+  int capacity;         /**< Capacity of the buffer */
+  char *boxes;          /**< Circular buffer of bounding boxes */
+  bboxunion extent;     /**< Extent of the boxes in the buffer */
+} ExtentAggState;
+
 /*****************************************************************************/
 
 extern Datum datum_min_int32(Datum l, Datum r);
@@ -81,12 +251,25 @@ extern SkipList *tsequence_tagg_transfn(FunctionCallInfo fcinfo, SkipList *state
 extern SkipList *temporal_tagg_combinefn1(FunctionCallInfo fcinfo, SkipList *state1,
   SkipList *state2, Datum (*func)(Datum, Datum), bool crossings);
 
+extern TAvgState *tavg_state_make(FunctionCallInfo fcinfo, const Temporal *temp,
+  int16 dim);
+extern void tavg_state_add(FunctionCallInfo fcinfo, TAvgState *state,
+  const Temporal *temp, void (*func)(const TInstant *, double *));
+extern bool tavg_state_remove(TAvgState *state, const Temporal *temp);
+extern TAvgState *tavg_state_combine(FunctionCallInfo fcinfo,
+  TAvgState *state1, const TAvgState *state2);
+extern Temporal *tavg_state_final(const TAvgState *state, bool avg,
+  Datum (*func)(const double *, const TAvgState *), Oid valuetypid);
+
 /*****************************************************************************/
 
 extern Datum temporal_extent_transfn(PG_FUNCTION_ARGS);
 extern Datum temporal_extent_combinefn(PG_FUNCTION_ARGS);
 extern Datum tnumber_extent_transfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_extent_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_extent_mtransfn(PG_FUNCTION_ARGS);
+extern Datum temporal_extent_minvfn(PG_FUNCTION_ARGS);
+extern Datum temporal_extent_mfinalfn(PG_FUNCTION_ARGS);
 
 extern Datum tbool_tand_transfn(PG_FUNCTION_ARGS);
 extern Datum tbool_tand_combinefn(PG_FUNCTION_ARGS);
@@ -105,16 +288,44 @@ extern Datum tint_tsum_combinefn(PG_FUNCTION_ARGS);
 extern Datum tfloat_tsum_transfn(PG_FUNCTION_ARGS);
 extern Datum tfloat_tsum_combinefn(PG_FUNCTION_ARGS);
 extern Datum temporal_tcount_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_invfn(PG_FUNCTION_ARGS);
 extern Datum temporal_tcount_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_deserialize(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_transfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_combinefn(PG_FUNCTION_ARGS);
+extern Datum tnumber_tavg_invfn(PG_FUNCTION_ARGS);
 extern Datum temporal_tagg_finalfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_finalfn(PG_FUNCTION_ARGS);
+extern Datum tint_tsum_mfinalfn(PG_FUNCTION_ARGS);
+extern Datum tfloat_tsum_mfinalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tavg_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_tavg_deserialize(PG_FUNCTION_ARGS);
 extern Datum ttext_tmin_transfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmin_combinefn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmax_transfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmax_combinefn(PG_FUNCTION_ARGS);
 
+extern Datum temporal_seq_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_seq_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_append_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_append_finalfn(PG_FUNCTION_ARGS);
+
+extern Datum temporal_tcount_bucket_transfn(PG_FUNCTION_ARGS);
+extern Datum tnumber_tavg_bucket_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_bucket_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_bucket_finalfn(PG_FUNCTION_ARGS);
+extern Datum tnumber_tavg_bucket_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_bucket_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_bucket_deserialize(PG_FUNCTION_ARGS);
+
+extern Datum temporal_merge_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_merge_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_merge_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_merge_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_merge_deserialize(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
@@ -0,0 +1,47 @@
+/*****************************************************************************
+ *
+ * temporal_compress.h
+ *    Compressed binary encoding of temporal types.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *    Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_COMPRESS_H__
+#define __TEMPORAL_COMPRESS_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <catalog/pg_type.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/* Version of the compressed format */
+
+#define COMPRESS_VERSION    1
+
+/* Tags for the base types of the compressed values */
+
+#define COMPRESS_BOOL       1
+#define COMPRESS_INT4       2
+#define COMPRESS_FLOAT8     3
+#define COMPRESS_GEOMETRY   4
+#define COMPRESS_GEOGRAPHY  5
+
+/*****************************************************************************/
+
+extern Datum temporal_compress(PG_FUNCTION_ARGS);
+extern Datum temporal_decompress(PG_FUNCTION_ARGS);
+
+extern bytea *temporal_compress_internal(const Temporal *temp);
+extern Temporal *temporal_decompress_internal(const bytea *bytes,
+  Oid valuetypid);
+
+/*****************************************************************************/
+
+#endif
@@ -20,6 +20,12 @@
 
 /*****************************************************************************/
 
+/* Initial capacity of the arrays of elements collected by the parser */
+
+#define PARSER_INITIAL_CAPACITY 64
+
+/*****************************************************************************/
+
 extern void ensure_end_input(char **str, bool end);
 
 extern void p_whitespace(char **str);
@@ -38,7 +44,11 @@ extern TimestampTz timestamp_parse(char **str);
 extern TimestampSet *timestampset_parse(char **str);
 extern Period *period_parse(char **str, bool make);
 extern PeriodSet *periodset_parse(char **str);
-extern TInstant *tinstant_parse(char **str, Oid basetype, bool end, bool make);
+extern TInstant *tinstant_parse(char **str, Oid basetype, bool end);
+extern void tinstantarr_parse_append(TInstant ***instants, int *count,
+  int *capacity, TInstant *inst);
+extern void tsequencearr_parse_append(TSequence ***sequences, int *count,
+  int *capacity, TSequence *seq);
 extern Temporal *temporal_parse(char **str, Oid basetype);
 
 /*****************************************************************************/
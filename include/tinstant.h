@@ -33,8 +33,10 @@ extern void tinstant_set(TInstant *inst, Datum value, TimestampTz t);
 /* Input/output functions */
 
 extern char *tinstant_to_string(const TInstant *inst, char *(*value_out)(Oid, Datum));
-extern void tinstant_write(const TInstant *inst, StringInfo buf);
-extern TInstant *tinstant_read(StringInfo buf, Oid valuetypid);
+extern void tinstant_write(const TInstant *inst, StringInfo buf,
+  FmgrInfo *flinfo);
+extern TInstant *tinstant_read(StringInfo buf, Oid valuetypid,
+  FmgrInfo *flinfo);
 
 /* Intersection function */
 
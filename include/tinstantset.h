@@ -40,8 +40,10 @@ extern bool intersection_tinstantset_tinstantset(const TInstantSet *ti1, const T
 /* Input/output functions */
 
 extern char *tinstantset_to_string(const TInstantSet *ti, char *(*value_out)(Oid, Datum));
-extern void tinstantset_write(const TInstantSet *ti, StringInfo buf);
-extern TInstantSet *tinstantset_read(StringInfo buf, Oid valuetypid);
+extern void tinstantset_write(const TInstantSet *ti, StringInfo buf,
+  FmgrInfo *flinfo);
+extern TInstantSet *tinstantset_read(StringInfo buf, Oid valuetypid,
+  FmgrInfo *flinfo);
 
 /* Constructor functions */
 
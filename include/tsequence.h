@@ -22,12 +22,61 @@
 
 /*****************************************************************************/
 
+/**
+ * Structure to iterate over the synchronized segments of two temporal
+ * sequences without constructing the synchronized sequences
+ */
+typedef struct
+{
+  const TSequence *seq1;   /**< First sequence */
+  const TSequence *seq2;   /**< Second sequence */
+  bool linear1;            /**< Interpolation of the first sequence */
+  bool linear2;            /**< Interpolation of the second sequence */
+  int i;                   /**< Next instant to read in the first sequence */
+  int j;                   /**< Next instant to read in the second sequence */
+  TInstant *start1;        /**< Start of the current segment of the first sequence */
+  TInstant *end1;          /**< End of the current segment of the first sequence */
+  TInstant *start2;        /**< Start of the current segment of the second sequence */
+  TInstant *end2;          /**< End of the current segment of the second sequence */
+  TInstant *buffers1[2];   /**< Instants added for synchronizing the first sequence */
+  TInstant *buffers2[2];   /**< Instants added for synchronizing the second sequence */
+} TSequenceSyncIter;
+
+/**
+ * Cursor over the segments of a temporal sequence (set), optionally
+ * restricted to a period
+ */
+typedef struct
+{
+  const Temporal *temp;    /**< Temporal value of sequence (set) duration */
+  Period period;           /**< Period to which the temporal value is restricted */
+  bool hasperiod;          /**< True when the temporal value is restricted */
+  int seqno;               /**< Index of the next sequence to open */
+  int count;               /**< Number of sequences of the temporal value */
+  const TSequence *seq;    /**< Current sequence, NULL when none is open */
+  Period seqperiod;        /**< Period of the current (restricted) sequence */
+  int instno;              /**< Index of the next instant of the current sequence */
+  bool linear;             /**< True when the interpolation is linear */
+  bool newseq;             /**< True when the segment starts a sequence */
+  TInstant *start;         /**< Start of the current segment */
+  TInstant *end;           /**< End of the current segment */
+  TInstant *buffers[2];    /**< Instants added at the bounds of the period */
+} TSegmentCursor;
+
+/*****************************************************************************/
+
+extern size_t *tsequence_offsets_ptr(const TSequence *seq);
+extern char *tsequence_data_ptr(const TSequence *seq);
 extern TInstant *tsequence_inst_n(const TSequence *seq, int index);
 extern TSequence *tsequence_make(TInstant **instants, 
   int count, bool lower_inc, bool upper_inc, bool linear, bool normalize);
 extern TSequence *tsequence_make_free(TInstant **instants, 
   int count, bool lower_inc, bool upper_inc, bool linear, bool normalize);
+extern TSequence *tsequence_make1(TInstant **instants, int count,
+  bool lower_inc, bool upper_inc, bool linear, bool normalize);
 extern TSequence *tsequence_copy(const TSequence *seq);
+extern bool tinstant_redundant(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3, bool linear);
 extern int tsequence_find_timestamp(const TSequence *seq, TimestampTz t);
 extern Datum tsequence_value_at_timestamp1(const TInstant *inst1,
   const TInstant *inst2, bool linear, TimestampTz t);
@@ -52,6 +101,16 @@ extern bool intersection_tsequence_tsequence(const TSequence *seq1, const TSeque
 extern bool synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
   TSequence **sync1, TSequence **sync2, bool interpoint);
 
+extern void tsequence_sync_init(TSequenceSyncIter *iter, const TSequence *seq1,
+  const TSequence *seq2, const Period *inter);
+extern bool tsequence_sync_next(TSequenceSyncIter *iter);
+extern void tsequence_sync_free(TSequenceSyncIter *iter);
+
+extern void tsegment_cursor_init(TSegmentCursor *cur, const Temporal *temp,
+  const Period *p);
+extern bool tsegment_cursor_next(TSegmentCursor *cur);
+extern void tsegment_cursor_free(TSegmentCursor *cur);
+
 extern bool tlinearseq_intersection_value(const TInstant *inst1, const TInstant *inst2,
   Datum value, Oid valuetypid, Datum *inter, TimestampTz *t);
 extern bool tgeompointseq_intersection(const TInstant *start1, const TInstant *end1,
@@ -63,8 +122,10 @@ extern bool tsequence_intersection(const TInstant *start1, const TInstant *end1,
 /* Input/output functions */
 
 extern char *tsequence_to_string(const TSequence *seq, bool component, char *(*value_out)(Oid, Datum));
-extern void tsequence_write(const TSequence *seq, StringInfo buf);
-extern TSequence *tsequence_read(StringInfo buf, Oid valuetypid);
+extern void tsequence_write(const TSequence *seq, StringInfo buf,
+  FmgrInfo *flinfo);
+extern TSequence *tsequence_read(StringInfo buf, Oid valuetypid,
+  FmgrInfo *flinfo);
 
 /* Constructor functions */
 
@@ -74,8 +135,8 @@ extern Datum tsequence_from_base(PG_FUNCTION_ARGS);
 
 /* Append and merge functions */
 
-extern TSequence *tsequence_join(const TSequence *seq1, const TSequence *seq2, bool last, bool first);
-extern Temporal *tsequence_append_tinstant(const TSequence *seq, const TInstant *inst);
+extern Temporal *tsequence_append_tinstant(TSequence *seq, const TInstant *inst, bool expand);
+extern TSequence *tsequence_compact(const TSequence *seq);
 extern Temporal *tsequence_merge(const TSequence *seq1, const TSequence *seq2);
 extern TSequence **tsequence_merge_array1(TSequence **sequences, int count, int *totalcount);
 extern Temporal *tsequence_merge_array(TSequence **sequences, int count);
@@ -191,6 +252,8 @@ extern bool tsequence_intersects_periodset(const TSequence *seq,
 
 extern double tnumberseq_integral(const TSequence *seq);
 extern double tnumberseq_twavg(const TSequence *seq);
+extern double tnumberarr_integral(const TimestampTz *times,
+  const double *values, int count, bool linear);
 
 /* Comparison functions */
 
@@ -58,8 +58,10 @@ extern bool intersection_tsequenceset_tsequenceset(const TSequenceSet *ts1,
 
 extern char *tsequenceset_to_string(const TSequenceSet *ts,
   char *(*value_out)(Oid, Datum));
-extern void tsequenceset_write(const TSequenceSet *ts, StringInfo buf);
-extern TSequenceSet *tsequenceset_read(StringInfo buf, Oid valuetypid);
+extern void tsequenceset_write(const TSequenceSet *ts, StringInfo buf,
+  FmgrInfo *flinfo);
+extern TSequenceSet *tsequenceset_read(StringInfo buf, Oid valuetypid,
+  FmgrInfo *flinfo);
 
 /* Constructor functions */
 
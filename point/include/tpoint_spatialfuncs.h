@@ -25,6 +25,41 @@
 
 /*****************************************************************************/
 
+/**
+ * Maximum number of children of a node of a box R-tree
+ */
+#define BOX_RTREE_FANOUT             16
+
+/**
+ * Node of a box R-tree. The first `leafcount` nodes of the tree are
+ * the leaves, whose children are entries of the `entries` array. The
+ * children of the other nodes are nodes of the tree.
+ */
+typedef struct
+{
+  double xmin;      /**< minimum x value */
+  double xmax;      /**< maximum x value */
+  double ymin;      /**< minimum y value */
+  double ymax;      /**< maximum y value */
+  int first;        /**< first child, or element number for the entries */
+  int count;        /**< number of children */
+} BoxRTreeNode;
+
+/**
+ * Sort-Tile-Recursive packed R-tree over 2D bounding boxes, such as those
+ * of the edges of a geometry. The root is the last node.
+ */
+typedef struct
+{
+  BoxRTreeNode *entries;        /**< indexed boxes in tree order */
+  int entrycount;               /**< number of indexed boxes */
+  BoxRTreeNode *nodes;          /**< nodes of the tree, leaves first */
+  int nodecount;                /**< number of nodes */
+  int leafcount;                /**< number of leaves */
+} BoxRTree;
+
+/*****************************************************************************/
+
 /* Fetch from and store in the cache the fcinfo of the external function */
 
 extern FunctionCallInfo fetch_fcinfo();
@@ -83,6 +118,8 @@ extern bool datum_point_eq(Datum geopoint1, Datum geopoint2);
 extern Datum datum2_point_eq(Datum geopoint1, Datum geopoint2);
 extern Datum datum2_point_ne(Datum geopoint1, Datum geopoint2);
 extern GSERIALIZED *geo_serialize(LWGEOM *geom);
+extern bool point_write(Datum value, StringInfo buf);
+extern bool point_read(StringInfo buf, int size, Datum *result);
 extern Datum datum_transform(Datum value, Datum srid);
 
 extern Datum geom_distance2d(Datum geom1, Datum geom2);
@@ -98,6 +135,17 @@ extern void spheroid_init(SPHEROID *s, double a, double b);
 extern void geography_interpolate_point4d(const POINT3D *p1, const POINT3D *p2,
   const POINT4D *v1, const POINT4D *v2, double f, POINT4D *p);
 
+/* Box R-tree */
+
+extern void segment_box_set(BoxRTreeNode *box, const POINT2D *p1,
+  const POINT2D *p2);
+extern BoxRTree *box_rtree_make(BoxRTreeNode *entries, int entrycount);
+extern void box_rtree_free(BoxRTree *tree);
+extern double box_rtree_box_distance(const BoxRTreeNode *node,
+  const GBOX *box);
+extern int *box_rtree_search(const BoxRTree *tree, const GBOX *box,
+  int *count);
+
 /* Functions for spatial reference systems */
 
 extern Datum tpoint_srid(PG_FUNCTION_ARGS);
@@ -133,6 +181,8 @@ extern LWLINE *geopoint_lwline(Datum value1, Datum value2);
 
 extern Datum tpointseq_trajectory(const TSequence *seq);
 extern Datum tpointseq_trajectory_copy(const TSequence *seq);
+extern Datum tpointseq_trajectory_append(const TSequence *seq,
+  const TInstant *inst, bool replace);
 extern Datum tpointseqset_trajectory(const TSequenceSet *ts);
 
 /* Length, speed, time-weighted centroid, and temporal azimuth functions */
@@ -140,8 +190,12 @@ extern Datum tpointseqset_trajectory(const TSequenceSet *ts);
 extern Datum tpoint_length(PG_FUNCTION_ARGS);
 extern Datum tpoint_cumulative_length(PG_FUNCTION_ARGS);
 extern Datum tpoint_speed(PG_FUNCTION_ARGS);
+extern Datum tpoint_length_period(PG_FUNCTION_ARGS);
+extern Datum tpoint_speed_period(PG_FUNCTION_ARGS);
+extern Datum tpoint_speed_above(PG_FUNCTION_ARGS);
 extern Datum tgeompoint_twcentroid(PG_FUNCTION_ARGS);
 extern Datum tpoint_azimuth(PG_FUNCTION_ARGS);
+extern Datum tpoint_azimuth_period(PG_FUNCTION_ARGS);
 
 extern Datum tgeompointi_twcentroid(const TInstantSet *ti);
 extern Datum tgeompointseq_twcentroid(const TSequence *seq);
@@ -154,6 +208,7 @@ extern Datum tpoint_at_stbox(PG_FUNCTION_ARGS);
 
 extern Datum tpoint_minus_geometry(PG_FUNCTION_ARGS);
 extern Datum tpoint_minus_stbox(PG_FUNCTION_ARGS);
+extern Datum tpoint_length_geometry(PG_FUNCTION_ARGS);
 
 extern TSequence **tpointseq_at_geometry2(const TSequence *seq, Datum geo, int *count);
 
@@ -63,4 +63,13 @@ CREATE FUNCTION fromEWKB(bytea)
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 */
 
+CREATE FUNCTION tgeompointFromCompressed(bytea)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tgeogpointFromCompressed(bytea)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
@@ -124,4 +124,13 @@ CREATE FUNCTION asHexEWKB(tgeogpoint, endianenconding text)
   AS 'MODULE_PATHNAME', 'tpoint_as_hexewkb'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION compress(tgeompoint)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tgeogpoint)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
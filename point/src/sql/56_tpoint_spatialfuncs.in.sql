@@ -138,6 +138,33 @@ CREATE FUNCTION speed(tgeogpoint)
   AS 'MODULE_PATHNAME', 'tpoint_speed'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION length(tgeompoint, period)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_length_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION length(tgeogpoint, period)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_length_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION speed(tgeompoint, period)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tpoint_speed_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION speed(tgeogpoint, period)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tpoint_speed_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION speedAbove(tgeompoint, period, float)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'tpoint_speed_above'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION speedAbove(tgeogpoint, period, float)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'tpoint_speed_above'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION twcentroid(tgeompoint)
   RETURNS geometry
   AS 'MODULE_PATHNAME', 'tgeompoint_twcentroid'
@@ -152,6 +179,15 @@ CREATE FUNCTION azimuth(tgeogpoint)
   AS 'MODULE_PATHNAME', 'tpoint_azimuth'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION azimuth(tgeompoint, period)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tpoint_azimuth_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION azimuth(tgeogpoint, period)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tpoint_azimuth_period'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
 
 CREATE FUNCTION atGeometry(tgeompoint, geometry)
@@ -164,6 +200,11 @@ CREATE FUNCTION minusGeometry(tgeompoint, geometry)
   AS 'MODULE_PATHNAME', 'tpoint_minus_geometry'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION length(tgeompoint, geometry)
+  RETURNS float
+  AS 'MODULE_PATHNAME', 'tpoint_length_geometry'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION atStbox(tgeompoint, stbox)
   RETURNS tgeompoint
   AS 'MODULE_PATHNAME', 'tpoint_at_stbox'
@@ -22,17 +22,45 @@ CREATE OR REPLACE FUNCTION tpoint_extent_combinefn(stbox, stbox)
   RETURNS stbox
   AS 'MODULE_PATHNAME'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mtransfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mtransfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_minvfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_minvfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION tpoint_extent_mfinalfn(internal)
+  RETURNS stbox
+  AS 'MODULE_PATHNAME', 'temporal_extent_mfinalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE extent(tgeompoint) (
   SFUNC = tpoint_extent_transfn,
   STYPE = stbox,
   COMBINEFUNC = tpoint_extent_combinefn,
+  MSFUNC = temporal_extent_mtransfn,
+  MINVFUNC = temporal_extent_minvfn,
+  MSTYPE = internal,
+  MFINALFUNC = tpoint_extent_mfinalfn,
   PARALLEL = safe
 );
 CREATE AGGREGATE extent(tgeogpoint) (
   SFUNC = tpoint_extent_transfn,
   STYPE = stbox,
   COMBINEFUNC = tpoint_extent_combinefn,
+  MSFUNC = temporal_extent_mtransfn,
+  MINVFUNC = temporal_extent_minvfn,
+  MSTYPE = internal,
+  MFINALFUNC = tpoint_extent_mfinalfn,
   PARALLEL = safe
 );
 
@@ -46,23 +74,69 @@ CREATE FUNCTION tcount_transfn(internal, tgeogpoint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 
 CREATE AGGREGATE tcount(tgeompoint) (
   SFUNC = tcount_transfn,
   STYPE = internal,
   COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  FINALFUNC = tcount_finalfn,
+  SERIALFUNC = tcount_serialize,
+  DESERIALFUNC = tcount_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcount_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tgeogpoint) (
   SFUNC = tcount_transfn,
   STYPE = internal,
   COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  FINALFUNC = tcount_finalfn,
+  SERIALFUNC = tcount_serialize,
+  DESERIALFUNC = tcount_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcount_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tcount_bucket_transfn(internal, tgeompoint, interval,
+    timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_bucket_transfn(internal, tgeogpoint, interval,
+    timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE tcountBucket(tgeompoint, interval, timestamptz) (
+  SFUNC = tcount_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tcount_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountBucket(tgeogpoint, interval, timestamptz) (
+  SFUNC = tcount_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tcount_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
   PARALLEL = SAFE
 );
 
@@ -102,6 +176,10 @@ CREATE FUNCTION tcentroid_combinefn(internal, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tpoint_tcentroid_combinefn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcentroid_invfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tpoint_tcentroid_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tcentroid_finalfn(internal)
   RETURNS tgeompoint
   AS 'MODULE_PATHNAME', 'tpoint_tcentroid_finalfn'
@@ -112,8 +190,152 @@ CREATE AGGREGATE tcentroid(tgeompoint) (
   STYPE = internal,
   COMBINEFUNC = tcentroid_combinefn,
   FINALFUNC = tcentroid_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  SERIALFUNC = tavg_serialize,
+  DESERIALFUNC = tavg_deserialize,
+  MSFUNC = tcentroid_transfn,
+  MINVFUNC = tcentroid_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcentroid_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregates building a temporal sequence (set) from the values and the
+ * timestamps of the rows, which must be given in increasing order of time,
+ * e.g., tgeompointSeq(geom, t ORDER BY t). With an interval argument, a new
+ * sequence is started when two consecutive rows are separated by more than
+ * the interval and the result is a sequence set.
+ *****************************************************************************/
+
+CREATE FUNCTION tgeompoint_seq_transfn(internal, geometry, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_seq_transfn(internal, geometry, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_seq_finalfn(internal)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_seq_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tgeompointSeq(geometry, timestamptz) (
+  SFUNC = tgeompoint_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tgeompoint_seq_finalfn,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tgeompointSeq(geometry, timestamptz, interval) (
+  SFUNC = tgeompoint_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tgeompoint_seq_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tgeogpoint_seq_transfn(internal, geography, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_seq_transfn(internal, geography, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_seq_finalfn(internal)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_seq_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tgeogpointSeq(geography, timestamptz) (
+  SFUNC = tgeogpoint_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tgeogpoint_seq_finalfn,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tgeogpointSeq(geography, timestamptz, interval) (
+  SFUNC = tgeogpoint_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tgeogpoint_seq_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregates building a temporal sequence by appending the instants of the
+ * rows, which must be given in increasing order of time, e.g.,
+ * appendInstant(inst ORDER BY getTimestamp(inst)).
+ *****************************************************************************/
+
+CREATE FUNCTION tgeompoint_append_transfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_append_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_append_finalfn(internal)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_append_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE appendInstant(tgeompoint) (
+  SFUNC = tgeompoint_append_transfn,
+  STYPE = internal,
+  FINALFUNC = tgeompoint_append_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tgeogpoint_append_transfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_append_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_append_finalfn(internal)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_append_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE appendInstant(tgeogpoint) (
+  SFUNC = tgeogpoint_append_transfn,
+  STYPE = internal,
+  FINALFUNC = tgeogpoint_append_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+CREATE FUNCTION merge_transfn(internal, tgeompoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_merge_finalfn(internal)
+  RETURNS tgeompoint
+  AS 'MODULE_PATHNAME', 'temporal_merge_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge_transfn(internal, tgeogpoint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_merge_finalfn(internal)
+  RETURNS tgeogpoint
+  AS 'MODULE_PATHNAME', 'temporal_merge_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE merge(tgeompoint) (
+  SFUNC = merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = merge_combinefn,
+  FINALFUNC = tgeompoint_merge_finalfn,
+  SERIALFUNC = merge_serialize,
+  DESERIALFUNC = merge_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE merge(tgeogpoint) (
+  SFUNC = merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = merge_combinefn,
+  FINALFUNC = tgeogpoint_merge_finalfn,
+  SERIALFUNC = merge_serialize,
+  DESERIALFUNC = merge_deserialize,
   PARALLEL = SAFE
 );
 
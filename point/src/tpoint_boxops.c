@@ -212,15 +212,13 @@ boxop_geo_tpoint(FunctionCallInfo fcinfo,
 	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(0);
 	if (gserialized_is_empty(gs))
 		PG_RETURN_NULL();
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	STBOX box1, box2;
 	memset(&box1, 0, sizeof(STBOX));
 	memset(&box2, 0, sizeof(STBOX));
 	geo_to_stbox_internal(&box1, gs);
-	temporal_bbox(&box2, temp);
+	temporal_bbox_slice(PG_GETARG_DATUM(1), &box2);
 	bool result = func(&box1, &box2);
 	PG_FREE_IF_COPY(gs, 0);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -237,14 +235,12 @@ boxop_tpoint_geo(FunctionCallInfo fcinfo,
 	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
 	if (gserialized_is_empty(gs))
 		PG_RETURN_NULL();
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	STBOX box1, box2;
 	memset(&box1, 0, sizeof(STBOX));
 	memset(&box2, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp);
+	temporal_bbox_slice(PG_GETARG_DATUM(0), &box1);
 	geo_to_stbox_internal(&box2, gs);
 	bool result = func(&box1, &box2);
-	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
 	PG_RETURN_BOOL(result);
 }
@@ -260,12 +256,10 @@ boxop_stbox_tpoint(FunctionCallInfo fcinfo,
 	bool (*func)(const STBOX *, const STBOX *))
 {
 	STBOX *box = PG_GETARG_STBOX_P(0);
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	STBOX box1;
 	memset(&box1, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp);
+	temporal_bbox_slice(PG_GETARG_DATUM(1), &box1);
 	bool result = func(box, &box1);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -279,13 +273,11 @@ Datum
 boxop_tpoint_stbox(FunctionCallInfo fcinfo,
 	bool (*func)(const STBOX *, const STBOX *))
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	STBOX *box = PG_GETARG_STBOX_P(1);
 	STBOX box1;
 	memset(&box1, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp);
+	temporal_bbox_slice(PG_GETARG_DATUM(0), &box1);
 	bool result = func(&box1, box);
-	PG_FREE_IF_COPY(temp, 0);
 	PG_RETURN_BOOL(result);
 }
 
@@ -299,16 +291,12 @@ Datum
 boxop_tpoint_tpoint(FunctionCallInfo fcinfo,
 	bool (*func)(const STBOX *, const STBOX *))
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	STBOX box1, box2;
 	memset(&box1, 0, sizeof(STBOX));
 	memset(&box2, 0, sizeof(STBOX));
-	temporal_bbox(&box1, temp1);
-	temporal_bbox(&box2, temp2);
+	temporal_bbox_slice(PG_GETARG_DATUM(0), &box1);
+	temporal_bbox_slice(PG_GETARG_DATUM(1), &box2);
 	bool result = func(&box1, &box2);
-	PG_FREE_IF_COPY(temp1, 0);
-	PG_FREE_IF_COPY(temp2, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -642,14 +642,17 @@ NAI_tpointseqset_step_geo(const TSequenceSet *ts, Datum geo,
  * sequence point with linear interpolation and the geometry
  *
  * @param[in] inst1,inst2 Temporal segment
+ * @param[in] geo Geometry
  * @param[in] lwgeom Geometry
+ * @param[in] func Distance function
  * @param[out] closest Closest point
  * @param[out] t Timestamp
  * @param[out] tofree True when the resulting instant should be freed
  */
 static double
 NAI_tpointseq_linear_geo1(const TInstant *inst1, const TInstant *inst2,
-  LWGEOM *lwgeom, Datum *closest, TimestampTz *t, bool *tofree)
+  Datum geo, LWGEOM *lwgeom, Datum (*func)(Datum, Datum), Datum *closest,
+  TimestampTz *t, bool *tofree)
 {
   Datum value1 = tinstant_value(inst1);
   Datum value2 = tinstant_value(inst2);
@@ -661,7 +664,7 @@ NAI_tpointseq_linear_geo1(const TInstant *inst1, const TInstant *inst2,
   {
     *closest = value1;
     *t = inst1->t;
-    return 0.0;
+    return DatumGetFloat8(func(value1, geo));
   }
 
   /* The trajectory is a line */
@@ -678,13 +681,13 @@ NAI_tpointseq_linear_geo1(const TInstant *inst1, const TInstant *inst2,
   {
     *closest = value1;
     *t = inst1->t;
-    return 0.0;
+    return dist;
   }
   if (fabs(fraction - 1.0) < EPSILON)
   {
     *closest = value2;
     *t = inst2->t;
-    return 0.0;
+    return dist;
   }
 
   double duration = (inst2->t - inst1->t);
@@ -695,6 +698,23 @@ NAI_tpointseq_linear_geo1(const TInstant *inst1, const TInstant *inst2,
   return dist;
 }
 
+/**
+ * Returns the 2D distance between the bounding box of the segment of the
+ * temporal sequence point starting at the given instant and the box, which
+ * is a lower bound of the distance between the segment and any geometry
+ * inside the box
+ */
+static double
+NAI_tpointseq_segment_box_distance(const TSequence *seq, int segno,
+  const GBOX *box)
+{
+  BoxRTreeNode segbox;
+  segment_box_set(&segbox,
+    datum_get_point2d_p(tinstant_value(tsequence_inst_n(seq, segno))),
+    datum_get_point2d_p(tinstant_value(tsequence_inst_n(seq, segno + 1))));
+  return box_rtree_box_distance(&segbox, box);
+}
+
 /**
  * Returns the nearest approach instant between the temporal sequence
  * point with linear interpolation and the geometry
@@ -735,25 +755,61 @@ NAI_tpointseq_linear_geo2(const TSequence *seq, Datum geo, double mindist,
 
   GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(geo);
   LWGEOM *lwgeom = lwgeom_from_gserialized(gs);
-  inst1 = tsequence_inst_n(seq, 0);
   *tofree = false;
-  for (int i = 0; i < seq->count - 1; i++)
+  /* For geometric points the segments whose bounding box is farther from
+   * the one of the geometry than the minimum distance found so far are
+   * skipped. The scan starts with the segment whose box is the closest to
+   * obtain early a tight minimum distance. */
+  bool prune = ! MOBDB_FLAGS_GET_GEODETIC(seq->flags);
+  GBOX box;
+  int first = 0;
+  if (prune)
   {
-    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
-    dist = NAI_tpointseq_linear_geo1(inst1, inst2, lwgeom, &point, &t1, &tofree1);
-    if (dist < mindist)
+    lwgeom_calculate_gbox(lwgeom, &box);
+    double minboxdist = DBL_MAX;
+    for (int i = 0; i < seq->count - 1; i++)
+    {
+      double boxdist = NAI_tpointseq_segment_box_distance(seq, i, &box);
+      if (boxdist < minboxdist)
+      {
+        minboxdist = boxdist;
+        first = i;
+      }
+    }
+  }
+
+  /* Segment at the minimum distance, or -1 when it is not in the sequence.
+   * Ties are broken towards the earliest segment. */
+  int segno = -1;
+  for (int j = -1; j < seq->count - 1; j++)
+  {
+    /* The first iteration visits the segment with the closest box */
+    int i = (j < 0) ? first : j;
+    if (j == first)
+      continue;
+    if (prune && NAI_tpointseq_segment_box_distance(seq, i, &box) > mindist)
+      continue;
+    dist = NAI_tpointseq_linear_geo1(tsequence_inst_n(seq, i),
+      tsequence_inst_n(seq, i + 1), geo, lwgeom, func, &point, &t1,
+      &tofree1);
+    if (dist < mindist || (dist == mindist && i < segno))
     {
       if (*tofree)
         pfree(DatumGetPointer(*closest));
       mindist = dist;
+      segno = i;
       *closest = point;
       *t = t1;
       *tofree = tofree1;
     }
-    if (mindist == 0.0)
+    else if (tofree1)
+      pfree(DatumGetPointer(point));
+    /* No later segment can be closer */
+    if (mindist == 0.0 && j >= 0 && segno <= j)
       break;
-    inst1 = inst2;
   }
+  lwgeom_free(lwgeom);
+  POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(geo));
   return mindist;
 }
 
@@ -882,6 +938,309 @@ NAI_tpoint_geo(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Nearest approach between two temporal points
+ *****************************************************************************/
+
+/**
+ * Number of synchronized segments of two temporal points that are grouped
+ * in a chunk sharing a lower bound of their distance
+ */
+#define NA_CHUNK_SEGMENTS  32
+
+/**
+ * Spatial box of the values of a temporal point in a chunk
+ */
+typedef struct
+{
+  double xmin, xmax, ymin, ymax, zmin, zmax;
+} NABox;
+
+/**
+ * Chunk of synchronized segments of two temporal points
+ */
+typedef struct
+{
+  TimestampTz t;    /**< Start of the chunk */
+  int count;        /**< Number of synchronized segments */
+  double lowerdist; /**< Lower bound of the distance in the chunk */
+} NAChunk;
+
+/**
+ * Sets the box to the temporal point value
+ */
+static void
+nabox_set(NABox *box, Datum value, bool hasz)
+{
+  if (hasz)
+  {
+    const POINT3DZ *p = datum_get_point3dz_p(value);
+    box->xmin = box->xmax = p->x;
+    box->ymin = box->ymax = p->y;
+    box->zmin = box->zmax = p->z;
+  }
+  else
+  {
+    const POINT2D *p = datum_get_point2d_p(value);
+    box->xmin = box->xmax = p->x;
+    box->ymin = box->ymax = p->y;
+    box->zmin = box->zmax = 0;
+  }
+  return;
+}
+
+/**
+ * Expands the box with the temporal point value
+ */
+static void
+nabox_expand(NABox *box, Datum value, bool hasz)
+{
+  NABox box1;
+  nabox_set(&box1, value, hasz);
+  box->xmin = Min(box->xmin, box1.xmin);
+  box->xmax = Max(box->xmax, box1.xmax);
+  box->ymin = Min(box->ymin, box1.ymin);
+  box->ymax = Max(box->ymax, box1.ymax);
+  box->zmin = Min(box->zmin, box1.zmin);
+  box->zmax = Max(box->zmax, box1.zmax);
+  return;
+}
+
+/**
+ * Returns the distance between the two boxes, which is a lower bound of
+ * the distance between any two points in the boxes
+ */
+static double
+nabox_distance(const NABox *box1, const NABox *box2)
+{
+  double dx = Max(0, Max(box1->xmin - box2->xmax, box2->xmin - box1->xmax));
+  double dy = Max(0, Max(box1->ymin - box2->ymax, box2->ymin - box1->ymax));
+  double dz = Max(0, Max(box1->zmin - box2->zmax, box2->zmin - box1->zmax));
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * Comparator of chunks by increasing lower bound of their distance
+ */
+static int
+nachunk_cmp(const void *a, const void *b)
+{
+  const NAChunk *chunk1 = (const NAChunk *) a;
+  const NAChunk *chunk2 = (const NAChunk *) b;
+  if (chunk1->lowerdist < chunk2->lowerdist)
+    return -1;
+  if (chunk1->lowerdist > chunk2->lowerdist)
+    return 1;
+  return timestamp_cmp_internal(chunk1->t, chunk2->t);
+}
+
+/**
+ * Updates the nearest approach with the distance at the timestamp. Ties are
+ * resolved in favour of the earliest timestamp, as does the minimum of the
+ * temporal distance.
+ */
+static void
+na_update(double dist, TimestampTz t, double *mindist, TimestampTz *mint)
+{
+  if (dist < *mindist || (dist == *mindist && t < *mint))
+  {
+    *mindist = dist;
+    *mint = t;
+  }
+  return;
+}
+
+/**
+ * Updates the nearest approach with the synchronized segments of the
+ * temporal points, whose end instant is only considered when `withend`
+ * is true
+ */
+static void
+na_tpointseq_segment(const TInstant *start1, const TInstant *end1,
+  const TInstant *start2, const TInstant *end2, bool linear, bool withend,
+  Datum (*func)(Datum, Datum), double *mindist, TimestampTz *mint)
+{
+  Datum sv1 = tinstant_value(start1), ev1 = tinstant_value(end1);
+  Datum sv2 = tinstant_value(start2), ev2 = tinstant_value(end2);
+  na_update(DatumGetFloat8(func(sv1, sv2)), start1->t, mindist, mint);
+  if (withend)
+    na_update(DatumGetFloat8(func(ev1, ev2)), end1->t, mindist, mint);
+  /* Turning point of the distance */
+  TimestampTz t;
+  if (linear && (! datum_point_eq(sv1, ev1) || ! datum_point_eq(sv2, ev2)) &&
+    tgeompointseq_min_dist_at_timestamp(start1, end1, start2, end2, &t))
+  {
+    Datum value1 = tsequence_value_at_timestamp1(start1, end1, true, t);
+    Datum value2 = tsequence_value_at_timestamp1(start2, end2, true, t);
+    na_update(DatumGetFloat8(func(value1, value2)), t, mindist, mint);
+    pfree(DatumGetPointer(value1)); pfree(DatumGetPointer(value2));
+  }
+  return;
+}
+
+/**
+ * Updates the nearest approach with the two temporal sequence points
+ *
+ * The synchronized segments of the sequences are grouped into chunks of
+ * NA_CHUNK_SEGMENTS segments. A first pass computes for each chunk the
+ * distance between the spatial boxes of the two sequences during the chunk,
+ * which is a lower bound of their distance in the chunk. The chunks are
+ * then visited by increasing lower bound, resuming the synchronization at
+ * their start, and the traversal stops at the first chunk whose lower
+ * bound is greater than the minimum distance found so far.
+ *
+ * @pre The sequences are geometric and have the same interpolation
+ */
+static void
+NA_tpointseq_tpointseq(const TSequence *seq1, const TSequence *seq2,
+  const Period *inter, Datum (*func)(Datum, Datum), double *mindist,
+  TimestampTz *mint)
+{
+  /* Instantaneous intersection */
+  if (inter->lower == inter->upper)
+  {
+    Datum value1, value2;
+    tsequence_value_at_timestamp_inc(seq1, inter->lower, &value1);
+    tsequence_value_at_timestamp_inc(seq2, inter->lower, &value2);
+    na_update(DatumGetFloat8(func(value1, value2)), inter->lower, mindist,
+      mint);
+    pfree(DatumGetPointer(value1)); pfree(DatumGetPointer(value2));
+    return;
+  }
+
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
+  bool hasz = MOBDB_FLAGS_GET_Z(seq1->flags);
+  /* Compute the lower bound of the distance in each chunk */
+  NAChunk *chunks = palloc(sizeof(NAChunk) *
+    ((seq1->count + seq2->count) / NA_CHUNK_SEGMENTS + 1));
+  int count = 0;
+  NABox box1, box2;
+  TSequenceSyncIter iter;
+  tsequence_sync_init(&iter, seq1, seq2, inter);
+  while (tsequence_sync_next(&iter))
+  {
+    if (count == 0 || chunks[count - 1].count == NA_CHUNK_SEGMENTS)
+    {
+      if (count > 0)
+        chunks[count - 1].lowerdist = nabox_distance(&box1, &box2);
+      chunks[count].t = iter.start1->t;
+      chunks[count++].count = 0;
+      nabox_set(&box1, tinstant_value(iter.start1), hasz);
+      nabox_set(&box2, tinstant_value(iter.start2), hasz);
+    }
+    nabox_expand(&box1, tinstant_value(iter.end1), hasz);
+    nabox_expand(&box2, tinstant_value(iter.end2), hasz);
+    chunks[count - 1].count++;
+  }
+  tsequence_sync_free(&iter);
+  if (count == 0)
+  {
+    pfree(chunks);
+    return;
+  }
+  chunks[count - 1].lowerdist = nabox_distance(&box1, &box2);
+
+  /* Visit the chunks by increasing lower bound */
+  if (count > 1)
+    qsort(chunks, (size_t) count, sizeof(NAChunk), &nachunk_cmp);
+  for (int i = 0; i < count; i++)
+  {
+    /* The remaining chunks cannot be closer */
+    if (chunks[i].lowerdist > *mindist)
+      break;
+    Period p = *inter;
+    p.lower = chunks[i].t;
+    tsequence_sync_init(&iter, seq1, seq2, &p);
+    for (int j = 0; j < chunks[i].count; j++)
+    {
+      tsequence_sync_next(&iter);
+      na_tpointseq_segment(iter.start1, iter.end1, iter.start2, iter.end2,
+        linear, j == chunks[i].count - 1, func, mindist, mint);
+    }
+    tsequence_sync_free(&iter);
+  }
+  pfree(chunks);
+  return;
+}
+
+/**
+ * Returns the nearest approach distance and instant between the two temporal
+ * points (dispatch function)
+ *
+ * For geometric points of sequence (set) duration with the same
+ * interpolation the nearest approach is computed by branch and bound over
+ * the synchronized segments without constructing the temporal distance.
+ * Otherwise, it is the minimum of the temporal distance.
+ *
+ * @param[in] temp1,temp2 Temporal points
+ * @param[out] mindist Nearest approach distance
+ * @param[out] t Timestamp of the nearest approach instant
+ * @result Returns false when the temporal points do not intersect in time
+ */
+static bool
+NA_tpoint_tpoint(const Temporal *temp1, const Temporal *temp2,
+  double *mindist, TimestampTz *t)
+{
+  if (MOBDB_FLAGS_GET_GEODETIC(temp1->flags) ||
+    temp1->duration == INSTANT || temp1->duration == INSTANTSET ||
+    temp2->duration == INSTANT || temp2->duration == INSTANTSET ||
+    MOBDB_FLAGS_GET_LINEAR(temp1->flags) != MOBDB_FLAGS_GET_LINEAR(temp2->flags))
+  {
+    Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
+    if (dist == NULL)
+      return false;
+    TInstant *min = temporal_min_instant(dist);
+    *mindist = DatumGetFloat8(tinstant_value(min));
+    *t = min->t;
+    pfree(dist);
+    return true;
+  }
+
+  Datum (*func)(Datum, Datum) = MOBDB_FLAGS_GET_Z(temp1->flags) ?
+    &pt_distance3d : &pt_distance2d;
+  int count1 = (temp1->duration == SEQUENCE) ? 1 :
+    ((TSequenceSet *) temp1)->count;
+  int count2 = (temp2->duration == SEQUENCE) ? 1 :
+    ((TSequenceSet *) temp2)->count;
+  *mindist = DBL_MAX;
+  bool found = false;
+  int i = 0, j = 0;
+  while (i < count1 && j < count2)
+  {
+    const TSequence *seq1 = (temp1->duration == SEQUENCE) ?
+      (const TSequence *) temp1 : tsequenceset_seq_n((TSequenceSet *) temp1, i);
+    const TSequence *seq2 = (temp2->duration == SEQUENCE) ?
+      (const TSequence *) temp2 : tsequenceset_seq_n((TSequenceSet *) temp2, j);
+    Period *inter = intersection_period_period_internal(&seq1->period,
+      &seq2->period);
+    if (inter != NULL)
+    {
+      NA_tpointseq_tpointseq(seq1, seq2, inter, func, mindist, t);
+      found = true;
+      pfree(inter);
+    }
+    /* A sequence with an exclusive upper bound may be followed by one that
+     * starts at the inclusive upper bound of the other sequence */
+    int cmp = timestamp_cmp_internal(seq1->period.upper, seq2->period.upper);
+    if (cmp == 0)
+    {
+      if (!seq1->period.upper_inc && seq2->period.upper_inc)
+        cmp = -1;
+      else if (seq1->period.upper_inc && !seq2->period.upper_inc)
+        cmp = 1;
+    }
+    if (cmp == 0)
+    {
+      i++; j++;
+    }
+    else if (cmp < 0)
+      i++;
+    else
+      j++;
+  }
+  return found;
+}
+
 PG_FUNCTION_INFO_V1(NAI_tpoint_tpoint);
 /**
  * Returns the nearest approach instant between the temporal points
@@ -896,21 +1255,18 @@ NAI_tpoint_tpoint(PG_FUNCTION_ARGS)
   TInstant *result = NULL;
   /* Store fcinfo into a global variable */
   store_fcinfo(fcinfo);
-  Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
-  if (dist != NULL)
+  double mindist;
+  TimestampTz t;
+  if (NA_tpoint_tpoint(temp1, temp2, &mindist, &t))
   {
-    TInstant *min = temporal_min_instant(dist);
     result = (TInstant *) temporal_restrict_timestamp_internal(temp1,
-      min->t, REST_AT);
-    pfree(dist);
+      t, REST_AT);
     if (result == NULL)
     {
       if (temp1->duration == SEQUENCE)
-        result = tsequence_find_timestamp_excl((TSequence *)temp1,
-          min->t);
+        result = tsequence_find_timestamp_excl((TSequence *)temp1, t);
       else /* temp->duration == SEQUENCESET */
-        result = tsequenceset_find_timestamp_excl((TSequenceSet *)temp1,
-          min->t);
+        result = tsequenceset_find_timestamp_excl((TSequenceSet *)temp1, t);
     }
   }
   PG_FREE_IF_COPY(temp1, 0);
@@ -1232,19 +1588,14 @@ NAD_tpoint_tpoint(PG_FUNCTION_ARGS)
   ensure_same_dimensionality_tpoint(temp1, temp2);
   /* Store fcinfo into a global variable */
   store_fcinfo(fcinfo);
-  Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
-  if (dist == NULL)
-  {
-    PG_FREE_IF_COPY(temp1, 0);
-    PG_FREE_IF_COPY(temp2, 1);
-    PG_RETURN_NULL();
-  }
-
-  Datum result = temporal_min_value_internal(dist);
-  pfree(dist);
+  double mindist;
+  TimestampTz t;
+  bool found = NA_tpoint_tpoint(temp1, temp2, &mindist, &t);
   PG_FREE_IF_COPY(temp1, 0);
   PG_FREE_IF_COPY(temp2, 1);
-  PG_RETURN_DATUM(result);
+  if (! found)
+    PG_RETURN_NULL();
+  PG_RETURN_FLOAT8(mindist);
 }
 
 /*****************************************************************************
@@ -1319,14 +1670,14 @@ bool
 shortestline_tpoint_tpoint_internal(const Temporal *temp1,
   const Temporal *temp2, Datum *line)
 {
-  Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
-  if (dist == NULL)
+  double mindist;
+  TimestampTz t;
+  if (! NA_tpoint_tpoint(temp1, temp2, &mindist, &t))
     return false;
-  TInstant *inst = temporal_min_instant(dist);
   /* Timestamp t may be at an exclusive bound */
   Datum value1, value2;
-  bool found1 = temporal_value_at_timestamp_inc(temp1, inst->t, &value1);
-  bool found2 = temporal_value_at_timestamp_inc(temp2, inst->t, &value2);
+  bool found1 = temporal_value_at_timestamp_inc(temp1, t, &value1);
+  bool found2 = temporal_value_at_timestamp_inc(temp2, t, &value2);
   assert (found1 && found2);
   *line = geopoint_line(value1, value2);
   return true;
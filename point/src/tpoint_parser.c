@@ -12,6 +12,11 @@
 
 #include "tpoint_parser.h"
 
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <liblwgeom.h>
+
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "tpoint.h"
@@ -189,6 +194,83 @@ stbox_parse(char **str)
 
 /*****************************************************************************/
 
+/**
+ * Parse a coordinate of a point in WKT format
+ *
+ * @return False when the coordinate must be parsed by PostGIS
+ */
+static bool
+point_coord_parse_fast(char **str, double *result)
+{
+  char *ptr = *str;
+  /* Do not accept the hexadecimal and special values of strtod */
+  if (! isdigit((unsigned char) *ptr) && *ptr != '-' && *ptr != '+' &&
+      *ptr != '.')
+    return false;
+  char *end;
+  errno = 0;
+  *result = strtod(ptr, &end);
+  if (end == ptr || errno != 0 || ! isfinite(*result))
+    return false;
+  *str = end;
+  return true;
+}
+
+/**
+ * Parse a geometric point in WKT format such as "Point(1 1)" or
+ * "Point Z(1 1 1)" followed by the at sign of the instant without calling
+ * the input function of PostGIS.
+ *
+ * @return False, without consuming the buffer, when the point must be parsed
+ * by PostGIS, e.g., when it has an SRID or an M dimension, or when it is 
+ * given in WKB format. PostGIS also reports the errors in the input.
+ */
+static bool
+geompoint_parse_fast(char **str, Datum *result)
+{
+  char *ptr = *str;
+  if (strncasecmp(ptr, "POINT", 5) != 0)
+    return false;
+  ptr += 5;
+  p_whitespace(&ptr);
+  bool hasz = false;
+  if (*ptr == 'Z' || *ptr == 'z')
+  {
+    hasz = true;
+    ptr++;
+    p_whitespace(&ptr);
+  }
+  if (*ptr != '(')
+    return false;
+  ptr++;
+  double coords[3];
+  int ndims = 0;
+  while (ndims < 3)
+  {
+    p_whitespace(&ptr);
+    if (! point_coord_parse_fast(&ptr, &coords[ndims]))
+      return false;
+    ndims++;
+    p_whitespace(&ptr);
+    if (*ptr == ')')
+      break;
+  }
+  if (*ptr != ')' || ndims < 2 || (hasz && ndims != 3))
+    return false;
+  ptr++;
+  p_whitespace(&ptr);
+  if (*ptr != '@')
+    return false;
+  LWPOINT *point = (ndims == 3) ?
+    lwpoint_make3dz(SRID_UNKNOWN, coords[0], coords[1], coords[2]) :
+    lwpoint_make2d(SRID_UNKNOWN, coords[0], coords[1]);
+  *result = PointerGetDatum(geo_serialize((LWGEOM *) point));
+  lwpoint_free(point);
+  /* Consume the at */
+  *str = ptr + 1;
+  return true;
+}
+
 /**
  * Parse a temporal point value of instant duration from the buffer
  *
@@ -196,15 +278,16 @@ stbox_parse(char **str)
  * @param[in] basetype Oid of the base type
  * @param[in] end Set to true when reading a single instant to ensure there is
  * no moreinput after the sequence
- * @param[in] make Set to false for the first pass to do not create the instant 
  * @param[in] tpoint_srid SRID of the temporal point
  */
 static TInstant *
-tpointinst_parse(char **str, Oid basetype, bool end, bool make, int *tpoint_srid) 
+tpointinst_parse(char **str, Oid basetype, bool end, int *tpoint_srid) 
 {
   p_whitespace(str);
+  Datum geo;
   /* The next instruction will throw an exception if it fails */
-  Datum geo = basetype_parse(str, basetype); 
+  if (basetype != type_oid(T_GEOMETRY) || ! geompoint_parse_fast(str, &geo))
+    geo = basetype_parse(str, basetype); 
   GSERIALIZED *gs = (GSERIALIZED *)PG_DETOAST_DATUM(geo);
   int geo_srid = gserialized_get_srid(gs);
   ensure_point_type(gs);
@@ -231,12 +314,58 @@ tpointinst_parse(char **str, Oid basetype, bool end, bool make, int *tpoint_srid
   /* The next instruction will throw an exception if it fails */
   TimestampTz t = timestamp_parse(str);
   ensure_end_input(str, end);
-  TInstant *result = make ? 
-    tinstant_make(PointerGetDatum(gs), t, basetype) : NULL;
+  TInstant *result = tinstant_make(PointerGetDatum(gs), t, basetype);
   pfree(gs);
   return result;
 }
 
+/**
+ * Set the SRID of the instants whose point was given without SRID before 
+ * the SRID of the temporal point was found in the input, e.g., as in 
+ * "{Point(1 1)@2000-01-01, SRID=5676;Point(2 2)@2000-01-02}". 
+ * The instants are modified in place since the SRID does not change their
+ * size.
+ */
+static void
+tpointinstarr_parse_set_srid(TInstant **instants, int count, Oid basetype,
+  int tpoint_srid)
+{
+  if (tpoint_srid == SRID_UNKNOWN)
+    return;
+  int nosrid = (basetype == type_oid(T_GEOMETRY)) ?
+    SRID_UNKNOWN : SRID_DEFAULT;
+  for (int i = 0; i < count; i++)
+  {
+    GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(
+      tinstant_value(instants[i]));
+    if (gserialized_get_srid(gs) == nosrid)
+      gserialized_set_srid(gs, tpoint_srid);
+  }
+}
+
+/**
+ * Parse the comma-separated instants of a temporal point value from the
+ * buffer
+ *
+ * @param[in] str Input string
+ * @param[in] basetype Oid of the base type
+ * @param[in] tpoint_srid SRID of the temporal point
+ * @param[out] count Number of instants
+ */
+static TInstant **
+tpointinstarr_parse(char **str, Oid basetype, int *tpoint_srid, int *count) 
+{
+  int capacity = PARSER_INITIAL_CAPACITY;
+  TInstant **instants = palloc(sizeof(TInstant *) * capacity);
+  *count = 0;
+  do
+  {
+    tinstantarr_parse_append(&instants, count, &capacity,
+      tpointinst_parse(str, basetype, false, tpoint_srid));
+  } while (p_comma(str));
+  return instants;
+}
+
 /**
  * Parse a temporal point value of instant set duration from the buffer
  *
@@ -252,85 +381,71 @@ tpointinstset_parse(char **str, Oid basetype, int *tpoint_srid)
    * to call this function in the dispatch function tpoint_parse */
   p_obrace(str);
 
-  /* First parsing */
-  char *bak = *str;
-  tpointinst_parse(str, basetype, false, false, tpoint_srid);
-  int count = 1;
-  while (p_comma(str)) 
-  {
-    count++;
-    tpointinst_parse(str, basetype, false, false, tpoint_srid);
-  }
+  int count;
+  TInstant **instants = tpointinstarr_parse(str, basetype, tpoint_srid,
+    &count);
   if (!p_cbrace(str))
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse temporal value")));
   ensure_end_input(str, true);
-
-  /* Second parsing */
-  *str = bak;
-  TInstant **instants = palloc(sizeof(TInstant *) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    instants[i] = tpointinst_parse(str, basetype, false, true, tpoint_srid);
-  }
-  p_cbrace(str);
+  tpointinstarr_parse_set_srid(instants, count, basetype, *tpoint_srid);
   return tinstantset_make_free(instants, count);
 }
 
 /**
- * Parse a temporal point value of sequence duration from the buffer
+ * Parse the instants and the bounds of a temporal point value of sequence
+ * duration from the buffer. The sequence is not constructed since the SRID
+ * of the temporal point may be found later in the input.
  *
  * @param[in] str Input string
  * @param[in] basetype Oid of the base type
- * @param[in] linear Set to true when the sequence set has linear interpolation
  * @param[in] end Set to true when reading a single instant to ensure there is
  * no moreinput after the sequence
- * @param[in] make Set to false for the first pass to do not create the instant 
  * @param[in] tpoint_srid SRID of the temporal point
-*/
-static TSequence *
-tpointseq_parse(char **str, Oid basetype, bool linear, bool end, bool make, int *tpoint_srid) 
+ * @param[out] count Number of instants
+ * @param[out] lower_inc,upper_inc Bounds of the sequence
+ */
+static TInstant **
+tpointseq_parse_instants(char **str, Oid basetype, bool end, int *tpoint_srid,
+  int *count, bool *lower_inc, bool *upper_inc) 
 {
   p_whitespace(str);
-  bool lower_inc = false, upper_inc = false;
+  *lower_inc = *upper_inc = false;
   /* We are sure to find an opening bracket or parenthesis because that was the
    * condition to call this function in the dispatch function tpoint_parse */
   if (p_obracket(str))
-    lower_inc = true;
+    *lower_inc = true;
   else if (p_oparen(str))
-    lower_inc = false;
+    *lower_inc = false;
 
-  /* First parsing */
-  char *bak = *str;
-  tpointinst_parse(str, basetype, false, false, tpoint_srid);
-  int count = 1;
-  while (p_comma(str)) 
-  {
-    count++;
-    tpointinst_parse(str, basetype, false, false, tpoint_srid);
-  }
+  TInstant **instants = tpointinstarr_parse(str, basetype, tpoint_srid, count);
   if (p_cbracket(str))
-    upper_inc = true;
+    *upper_inc = true;
   else if (p_cparen(str))
-    upper_inc = false;
+    *upper_inc = false;
   else
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse temporal value")));
   ensure_end_input(str, end);
-  if (! make)
-    return NULL;
+  return instants;
+}
 
-  /* Second parsing */
-  *str = bak; 
-  TInstant **instants = palloc(sizeof(TInstant *) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    instants[i] = tpointinst_parse(str, basetype, false, true, tpoint_srid);
-  }
-  p_cbracket(str);
-  p_cparen(str);
+/**
+ * Parse a temporal point value of sequence duration from the buffer
+ *
+ * @param[in] str Input string
+ * @param[in] basetype Oid of the base type
+ * @param[in] linear Set to true when the sequence set has linear interpolation
+ * @param[in] tpoint_srid SRID of the temporal point
+*/
+static TSequence *
+tpointseq_parse(char **str, Oid basetype, bool linear, int *tpoint_srid) 
+{
+  int count;
+  bool lower_inc, upper_inc;
+  TInstant **instants = tpointseq_parse_instants(str, basetype, true,
+    tpoint_srid, &count, &lower_inc, &upper_inc);
+  tpointinstarr_parse_set_srid(instants, count, basetype, *tpoint_srid);
   return tsequence_make_free(instants, count, lower_inc, upper_inc,
     linear, NORMALIZE);
 }
@@ -351,30 +466,40 @@ tpointseqset_parse(char **str, Oid basetype, bool linear, int *tpoint_srid)
    * to call this function in the dispatch function tpoint_parse */
   p_obrace(str);
 
-  /* First parsing */
-  char *bak = *str;
-  tpointseq_parse(str, basetype, linear, false, false, tpoint_srid);
-  int count = 1;
-  while (p_comma(str)) 
+  /* The sequences are constructed after the whole input has been read */
+  int count = 0, capacity = PARSER_INITIAL_CAPACITY;
+  TInstant ***instants = palloc(sizeof(TInstant **) * capacity);
+  int *counts = palloc(sizeof(int) * capacity);
+  bool *lower_inc = palloc(sizeof(bool) * capacity);
+  bool *upper_inc = palloc(sizeof(bool) * capacity);
+  do
   {
+    if (count == capacity)
+    {
+      capacity *= 2;
+      instants = repalloc(instants, sizeof(TInstant **) * capacity);
+      counts = repalloc(counts, sizeof(int) * capacity);
+      lower_inc = repalloc(lower_inc, sizeof(bool) * capacity);
+      upper_inc = repalloc(upper_inc, sizeof(bool) * capacity);
+    }
+    instants[count] = tpointseq_parse_instants(str, basetype, false,
+      tpoint_srid, &counts[count], &lower_inc[count], &upper_inc[count]);
     count++;
-    tpointseq_parse(str, basetype, linear, false, false, tpoint_srid);
-  }
+  } while (p_comma(str));
   if (!p_cbrace(str))
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse temporal value")));
   ensure_end_input(str, true);
 
-  /* Second parsing */
-  *str = bak;
   TSequence **sequences = palloc(sizeof(TSequence *) * count);
   for (int i = 0; i < count; i++) 
   {
-    p_comma(str);
-    sequences[i] = tpointseq_parse(str, basetype, linear, false, true,
-      tpoint_srid);
+    tpointinstarr_parse_set_srid(instants[i], counts[i], basetype,
+      *tpoint_srid);
+    sequences[i] = tsequence_make_free(instants[i], counts[i], lower_inc[i],
+      upper_inc[i], linear, NORMALIZE);
   }
-  p_cbrace(str);
+  pfree(instants); pfree(counts); pfree(lower_inc); pfree(upper_inc);
   return tsequenceset_make_free(sequences, count, NORMALIZE);
 }
 
@@ -432,10 +557,10 @@ tpoint_parse(char **str, Oid basetype)
   {
     /* Pass the SRID specification */
     *str = bak;
-    result = (Temporal *)tpointinst_parse(str, basetype, true, true, &tpoint_srid);
+    result = (Temporal *)tpointinst_parse(str, basetype, true, &tpoint_srid);
   }
   else if (**str == '[' || **str == '(')
-    result = (Temporal *)tpointseq_parse(str, basetype, linear, true, true, &tpoint_srid);
+    result = (Temporal *)tpointseq_parse(str, basetype, linear, &tpoint_srid);
   else if (**str == '{')
   {
     bak = *str;
@@ -15,6 +15,7 @@
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <libpq/pqformat.h>
 #include <utils/builtins.h>
 #include <utils/timestamp.h>
 
@@ -787,6 +788,135 @@ datum2_point_ne(Datum geopoint1, Datum geopoint2)
   return BoolGetDatum(! datum_point_eq(geopoint1, geopoint2));
 }
 
+/*****************************************************************************
+ * Binary representation of points
+ *****************************************************************************/
+
+/* Flags of the extended WKB type of PostGIS */
+#define EWKB_ZFLAG          0x80000000
+#define EWKB_MFLAG          0x40000000
+#define EWKB_SRIDFLAG       0x20000000
+#define EWKB_TYPEMASK       0x0FFFFFFF
+
+/**
+ * Reverse the order of the bytes of a value read from a WKB in the other
+ * endianness than the one of the machine
+ */
+static void
+wkb_swap(void *value, size_t size)
+{
+  uint8_t *bytes = (uint8_t *) value;
+  for (size_t i = 0; i < size / 2; i++)
+  {
+    uint8_t tmp = bytes[i];
+    bytes[i] = bytes[size - i - 1];
+    bytes[size - i - 1] = tmp;
+  }
+}
+
+/**
+ * Write into the buffer the binary representation of the point preceded by
+ * its length. The output is the extended WKB produced by the send function
+ * of PostGIS, but it is written directly from the serialized point.
+ *
+ * @return False when the value is not a point that can be written natively
+ */
+bool
+point_write(Datum value, StringInfo buf)
+{
+  GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(value);
+  if (gserialized_get_type(gs) != POINTTYPE || FLAGS_GET_M(gs->flags) ||
+    gserialized_is_empty(gs))
+    return false;
+  bool hasz = FLAGS_GET_Z(gs->flags);
+  int32 srid = gserialized_get_srid(gs);
+  uint32 type = POINTTYPE;
+  if (hasz)
+    type |= EWKB_ZFLAG;
+  if (srid != SRID_UNKNOWN)
+    type |= EWKB_SRIDFLAG;
+  size_t coordsize = (hasz ? 3 : 2) * sizeof(double);
+  int size = WKB_BYTE_SIZE + WKB_INT_SIZE +
+    (srid != SRID_UNKNOWN ? WKB_INT_SIZE : 0) + coordsize;
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(buf, size, 4);
+#else
+  pq_sendint32(buf, size);
+#endif
+  enlargeStringInfo(buf, size);
+  char *ptr = buf->data + buf->len;
+  *ptr++ = getMachineEndian();
+  memcpy(ptr, &type, WKB_INT_SIZE);
+  ptr += WKB_INT_SIZE;
+  if (srid != SRID_UNKNOWN)
+  {
+    memcpy(ptr, &srid, WKB_INT_SIZE);
+    ptr += WKB_INT_SIZE;
+  }
+  memcpy(ptr, datum_get_point2d_p(value), coordsize);
+  buf->len += size;
+  buf->data[buf->len] = '\0';
+  return true;
+}
+
+/**
+ * Returns a geometry point from its extended WKB representation of the
+ * given size read from the buffer
+ *
+ * @return False, without consuming the buffer, when the representation
+ * is not a point that can be read natively
+ */
+bool
+point_read(StringInfo buf, int size, Datum *result)
+{
+  if (size < WKB_BYTE_SIZE + WKB_INT_SIZE ||
+    buf->cursor + size > buf->len)
+    return false;
+  const char *ptr = buf->data + buf->cursor;
+  bool swap = (ptr[0] != getMachineEndian());
+  uint32 type;
+  memcpy(&type, ptr + WKB_BYTE_SIZE, WKB_INT_SIZE);
+  if (swap)
+    wkb_swap(&type, WKB_INT_SIZE);
+  if ((type & EWKB_TYPEMASK) != POINTTYPE || (type & EWKB_MFLAG))
+    return false;
+  bool hasz = (type & EWKB_ZFLAG) != 0;
+  bool hassrid = (type & EWKB_SRIDFLAG) != 0;
+  int ndims = hasz ? 3 : 2;
+  if (size != WKB_BYTE_SIZE + WKB_INT_SIZE + (hassrid ? WKB_INT_SIZE : 0) +
+    ndims * WKB_DOUBLE_SIZE)
+    return false;
+  ptr += WKB_BYTE_SIZE + WKB_INT_SIZE;
+
+  int32 srid = SRID_UNKNOWN;
+  if (hassrid)
+  {
+    memcpy(&srid, ptr, WKB_INT_SIZE);
+    if (swap)
+      wkb_swap(&srid, WKB_INT_SIZE);
+    srid = clamp_srid(srid);
+    ptr += WKB_INT_SIZE;
+  }
+  double coords[3];
+  memcpy(coords, ptr, ndims * WKB_DOUBLE_SIZE);
+  for (int i = 0; i < ndims; i++)
+  {
+    if (swap)
+      wkb_swap(&coords[i], WKB_DOUBLE_SIZE);
+    /* Empty points are left to the receive function of PostGIS */
+    if (isnan(coords[i]))
+      return false;
+  }
+
+  LWPOINT *point = hasz ?
+    lwpoint_make3dz(srid, coords[0], coords[1], coords[2]) :
+    lwpoint_make2d(srid, coords[0], coords[1]);
+  *result = PointerGetDatum(geo_serialize((LWGEOM *) point));
+  lwpoint_free(point);
+  buf->cursor += size;
+  return true;
+}
+
 /**
  * Serialize a geometry/geography
  *
@@ -886,6 +1016,224 @@ pt_distance3d(Datum geom1, Datum geom2)
 }
 
 
+/*****************************************************************************
+ * Box R-tree
+ *****************************************************************************/
+
+/**
+ * Comparator of R-tree nodes on the x coordinate of their center
+ */
+static int
+box_rtree_cmp_x(const void *a, const void *b)
+{
+  const BoxRTreeNode *node1 = (const BoxRTreeNode *) a;
+  const BoxRTreeNode *node2 = (const BoxRTreeNode *) b;
+  double c1 = node1->xmin + node1->xmax;
+  double c2 = node2->xmin + node2->xmax;
+  return (c1 < c2) ? -1 : ((c1 > c2) ? 1 : 0);
+}
+
+/**
+ * Comparator of R-tree nodes on the y coordinate of their center
+ */
+static int
+box_rtree_cmp_y(const void *a, const void *b)
+{
+  const BoxRTreeNode *node1 = (const BoxRTreeNode *) a;
+  const BoxRTreeNode *node2 = (const BoxRTreeNode *) b;
+  double c1 = node1->ymin + node1->ymax;
+  double c2 = node2->ymin + node2->ymax;
+  return (c1 < c2) ? -1 : ((c1 > c2) ? 1 : 0);
+}
+
+/**
+ * Comparator of element numbers
+ */
+static int
+box_rtree_cmp_elemno(const void *a, const void *b)
+{
+  int s1 = *(const int *) a;
+  int s2 = *(const int *) b;
+  return (s1 < s2) ? -1 : ((s1 > s2) ? 1 : 0);
+}
+
+/**
+ * Sort the nodes of a level of the R-tree in Sort-Tile-Recursive order,
+ * that is, sort them on x, cut them into vertical slices of about
+ * sqrt(n / fanout) parents, and sort each slice on y. Consecutive runs
+ * of BOX_RTREE_FANOUT nodes are then spatially compact.
+ */
+static void
+box_rtree_str_sort(BoxRTreeNode *nodes, int count)
+{
+  int parents = (count + BOX_RTREE_FANOUT - 1) / BOX_RTREE_FANOUT;
+  int slices = (int) ceil(sqrt((double) parents));
+  int slicesize = ((parents + slices - 1) / slices) * BOX_RTREE_FANOUT;
+  qsort(nodes, (size_t) count, sizeof(BoxRTreeNode), &box_rtree_cmp_x);
+  for (int i = 0; i < count; i += slicesize)
+    qsort(&nodes[i], (size_t) Min(slicesize, count - i),
+      sizeof(BoxRTreeNode), &box_rtree_cmp_y);
+  return;
+}
+
+/**
+ * Sets the 2D bounding box of the segment defined by the two points
+ */
+void
+segment_box_set(BoxRTreeNode *box, const POINT2D *p1, const POINT2D *p2)
+{
+  box->xmin = Min(p1->x, p2->x);
+  box->xmax = Max(p1->x, p2->x);
+  box->ymin = Min(p1->y, p2->y);
+  box->ymax = Max(p1->y, p2->y);
+  return;
+}
+
+/**
+ * Returns the R-tree over the 2D bounding boxes, e.g., of the edges of a
+ * geometry
+ *
+ * @param[in] entries Boxes to index, whose `first` member is the number
+ * of the indexed element and whose `count` member is 1. The array is
+ * reordered and becomes owned by the tree.
+ * @param[in] entrycount Number of boxes
+ * @pre There is at least one box
+ */
+BoxRTree *
+box_rtree_make(BoxRTreeNode *entries, int entrycount)
+{
+  assert(entrycount > 0);
+  /* Compute the number of nodes of the tree */
+  int nodecount = 0, levelcount = entrycount;
+  do
+  {
+    levelcount = (levelcount + BOX_RTREE_FANOUT - 1) / BOX_RTREE_FANOUT;
+    nodecount += levelcount;
+  } while (levelcount > 1);
+
+  BoxRTree *result = palloc(sizeof(BoxRTree));
+  result->entries = entries;
+  result->entrycount = entrycount;
+  result->nodes = palloc(sizeof(BoxRTreeNode) * nodecount);
+  result->nodecount = nodecount;
+
+  /* Pack bottom-up each level of the tree into the nodes of the next one */
+  BoxRTreeNode *level = result->entries;
+  levelcount = entrycount;
+  int levelstart = 0, k = 0;
+  while (true)
+  {
+    box_rtree_str_sort(level, levelcount);
+    int first = k;
+    for (int i = 0; i < levelcount; i += BOX_RTREE_FANOUT)
+    {
+      BoxRTreeNode *node = &result->nodes[k++];
+      node->first = levelstart + i;
+      node->count = Min(BOX_RTREE_FANOUT, levelcount - i);
+      node->xmin = level[i].xmin; node->xmax = level[i].xmax;
+      node->ymin = level[i].ymin; node->ymax = level[i].ymax;
+      for (int j = 1; j < node->count; j++)
+      {
+        node->xmin = Min(node->xmin, level[i + j].xmin);
+        node->xmax = Max(node->xmax, level[i + j].xmax);
+        node->ymin = Min(node->ymin, level[i + j].ymin);
+        node->ymax = Max(node->ymax, level[i + j].ymax);
+      }
+    }
+    if (level == result->entries)
+      result->leafcount = k;
+    if (k - first == 1)
+      break;
+    level = &result->nodes[first];
+    levelcount = k - first;
+    levelstart = first;
+  }
+  assert(k == nodecount);
+  return result;
+}
+
+/**
+ * Free the R-tree
+ */
+void
+box_rtree_free(BoxRTree *tree)
+{
+  pfree(tree->entries); pfree(tree->nodes);
+  pfree(tree);
+  return;
+}
+
+/**
+ * Returns the 2D distance between the box of the R-tree node or entry and
+ * the box. The result is a lower bound of the distance between any
+ * element under the node and any geometry inside the box.
+ */
+double
+box_rtree_box_distance(const BoxRTreeNode *node, const GBOX *box)
+{
+  double dx = 0.0, dy = 0.0;
+  if (node->xmax < box->xmin)
+    dx = box->xmin - node->xmax;
+  else if (box->xmax < node->xmin)
+    dx = node->xmin - box->xmax;
+  if (node->ymax < box->ymin)
+    dy = box->ymin - node->ymax;
+  else if (box->ymax < node->ymin)
+    dy = node->ymin - box->ymax;
+  return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * Returns true if the box of the R-tree node or entry overlaps the box
+ */
+static bool
+box_rtree_box_overlaps(const BoxRTreeNode *node, const GBOX *box)
+{
+  return node->xmin <= box->xmax && box->xmin <= node->xmax &&
+    node->ymin <= box->ymax && box->ymin <= node->ymax;
+}
+
+/**
+ * Returns the numbers of the elements whose 2D bounding box overlaps the
+ * box, in increasing order
+ *
+ * @param[in] tree R-tree
+ * @param[in] box Box
+ * @param[out] count Number of elements in the resulting array
+ */
+int *
+box_rtree_search(const BoxRTree *tree, const GBOX *box, int *count)
+{
+  int *result = palloc(sizeof(int) * tree->entrycount);
+  /* Each node is pushed at most once */
+  int *stack = palloc(sizeof(int) * tree->nodecount);
+  int k = 0, top = 0;
+  stack[top++] = tree->nodecount - 1;
+  while (top > 0)
+  {
+    int nodeno = stack[--top];
+    const BoxRTreeNode *node = &tree->nodes[nodeno];
+    if (! box_rtree_box_overlaps(node, box))
+      continue;
+    for (int i = 0; i < node->count; i++)
+    {
+      if (nodeno >= tree->leafcount)
+        stack[top++] = node->first + i;
+      else
+      {
+        const BoxRTreeNode *entry = &tree->entries[node->first + i];
+        if (box_rtree_box_overlaps(entry, box))
+          result[k++] = entry->first;
+      }
+    }
+  }
+  pfree(stack);
+  if (k > 1)
+    qsort(result, (size_t) k, sizeof(int), &box_rtree_cmp_elemno);
+  *count = k;
+  return result;
+}
+
 /*****************************************************************************
  * Trajectory functions.
  *****************************************************************************/
@@ -1104,19 +1452,139 @@ tpointseq_make_trajectory(TInstant **instants, int count, bool linear)
 Datum
 tpointseq_trajectory(const TSequence *seq)
 {
-  void *traj = (char *)(&seq->offsets[seq->count + 2]) +   /* start of data */
-    seq->offsets[seq->count + 1];            /* offset */
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  /* The values written by previous versions have the offset of the
+   * bounding box before the one of the trajectory */
+  int n = MOBDB_FLAGS_GET_PREFIXBOX(seq->flags) ? seq->maxcount :
+    seq->count + 1;
+  void *traj = tsequence_data_ptr(seq) + offsets[n];
   return PointerGetDatum(traj);
 }
 
+/**
+ * Returns true if the two points are equal, the comparison is exact as for
+ * the function lwpoint_same used when computing the trajectory
+ */
+static bool
+point4d_eq(const POINT4D *p1, const POINT4D *p2, bool hasz)
+{
+  return p1->x == p2->x && p1->y == p2->y && (! hasz || p1->z == p2->z);
+}
+
+/**
+ * Returns the trajectory of the temporal sequence point obtained by
+ * appending an instant, computed from the precomputed trajectory of the
+ * sequence instead of from all its instants
+ *
+ * @param[in] seq Temporal point
+ * @param[in] inst Temporal instant point appended
+ * @param[in] replace True when the appended instant replaces the last
+ * instant of the sequence due to normalization
+ * @note The result is the same as the one of the function
+ * tpointseq_make_trajectory applied to the instants of the resulting sequence
+ */
+Datum
+tpointseq_trajectory_append(const TSequence *seq, const TInstant *inst,
+  bool replace)
+{
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  bool geodetic = MOBDB_FLAGS_GET_GEODETIC(seq->flags);
+  GSERIALIZED *gstraj = (GSERIALIZED *) DatumGetPointer(tpointseq_trajectory(seq));
+  int srid = gserialized_get_srid(gstraj);
+  LWGEOM *traj = lwgeom_from_gserialized(gstraj);
+  POINTARRAY *pa;
+  POINT4D p;
+
+  /* Collect the points of the trajectory */
+  if (traj->type == LINETYPE)
+    pa = ptarray_clone_deep(((LWLINE *) traj)->points);
+  else if (traj->type == POINTTYPE)
+  {
+    pa = ptarray_construct_empty(hasz, false, 2);
+    getPoint4d_p(((LWPOINT *) traj)->point, 0, &p);
+    ptarray_append_point(pa, &p, LW_TRUE);
+  }
+  else /* traj->type == MULTIPOINTTYPE */
+  {
+    LWMPOINT *mpoint = (LWMPOINT *) traj;
+    pa = ptarray_construct_empty(hasz, false, mpoint->ngeoms + 1);
+    for (uint32_t i = 0; i < mpoint->ngeoms; i++)
+    {
+      getPoint4d_p(mpoint->geoms[i]->point, 0, &p);
+      ptarray_append_point(pa, &p, LW_TRUE);
+    }
+  }
+  lwgeom_free(traj);
+
+  POINT4D newp = datum_get_point4d(tinstant_value(inst));
+  POINT4D last;
+  if (linear)
+  {
+    /* The point of the replaced instant is the last one of the trajectory
+     * unless it is equal to the point of the previous instant */
+    if (replace && seq->count > 1 && pa->npoints > 1)
+    {
+      POINT4D prev = datum_get_point4d(tinstant_value(
+        tsequence_inst_n(seq, seq->count - 2)));
+      getPoint4d_p(pa, pa->npoints - 1, &last);
+      if (! point4d_eq(&prev, &last, hasz))
+        pa->npoints--;
+    }
+    /* Remove two consecutive points if they are equal */
+    getPoint4d_p(pa, pa->npoints - 1, &last);
+    if (! point4d_eq(&newp, &last, hasz))
+      ptarray_append_point(pa, &newp, LW_TRUE);
+  }
+  else
+  {
+    /* Remove all duplicate points, the point of a replaced instant
+     * is equal to the point of the previous instant */
+    bool found = false;
+    for (uint32_t i = 0; i < pa->npoints; i++)
+    {
+      getPoint4d_p(pa, i, &p);
+      if (point4d_eq(&newp, &p, hasz))
+      {
+        found = true;
+        break;
+      }
+    }
+    if (! found)
+      ptarray_append_point(pa, &newp, LW_TRUE);
+  }
+
+  /* Construct the trajectory */
+  LWGEOM *lwresult;
+  if (pa->npoints == 1)
+    lwresult = (LWGEOM *) lwpoint_construct(srid, NULL, pa);
+  else if (linear)
+    lwresult = (LWGEOM *) lwline_construct(srid, NULL, pa);
+  else
+  {
+    lwresult = (LWGEOM *) lwmpoint_construct_empty(srid, hasz, false);
+    for (uint32_t i = 0; i < pa->npoints; i++)
+    {
+      getPoint4d_p(pa, i, &p);
+      lwmpoint_add_lwpoint((LWMPOINT *) lwresult, lwpoint_make(srid, hasz,
+        false, &p));
+    }
+    ptarray_free(pa);
+  }
+  FLAGS_SET_Z(lwresult->flags, hasz);
+  FLAGS_SET_GEODETIC(lwresult->flags, geodetic);
+  Datum result = PointerGetDatum(geo_serialize(lwresult));
+  lwgeom_free(lwresult);
+  return result;
+}
+
 /**
  * Copy the precomputed trajectory of a temporal sequence point
  */
 Datum
 tpointseq_trajectory_copy(const TSequence *seq)
 {
-  void *traj = (char *)(&seq->offsets[seq->count + 2]) +   /* start of data */
-      seq->offsets[seq->count + 1];          /* offset */
+  void *traj = DatumGetPointer(tpointseq_trajectory(seq));
   return PointerGetDatum(gserialized_copy(traj));
 }
 
@@ -2336,185 +2804,355 @@ tpoint_speed(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************
- * Time-weighed centroid for temporal geometry points
+ * Length and speed restricted to a period
+ *
+ * The functions below are equivalent to applying the length and speed
+ * functions to the restriction of the temporal point to a period, and
+ * comparing the resulting speed with a threshold, but consume the segments
+ * of the temporal point with a cursor without building the intermediate
+ * temporal values.
  *****************************************************************************/
 
 /**
- * Returns the time-weighed centroid of the temporal geometry point of
- * instant set duration
+ * Returns the length traversed by the temporal sequence (set) point
+ * restricted to the period
  */
-Datum
-tgeompointi_twcentroid(const TInstantSet *ti)
+static double
+tpoint_length_period1(const Temporal *temp, const Period *p)
 {
-  int srid = tpointinstset_srid(ti);
-  TInstant **instantsx = palloc(sizeof(TInstant *) * ti->count);
-  TInstant **instantsy = palloc(sizeof(TInstant *) * ti->count);
-  TInstant **instantsz = NULL; /* keep compiler quiet */
-  bool hasz = MOBDB_FLAGS_GET_Z(ti->flags);
-  if (hasz)
-    instantsz = palloc(sizeof(TInstant *) * ti->count);
-
-  for (int i = 0; i < ti->count; i++)
+  Datum (*func)(Datum, Datum);
+  if (MOBDB_FLAGS_GET_GEODETIC(temp->flags))
+    func = &geog_distance;
+  else
+    func = MOBDB_FLAGS_GET_Z(temp->flags) ? &pt_distance3d : &pt_distance2d;
+  double result = 0;
+  TSegmentCursor cur;
+  tsegment_cursor_init(&cur, temp, p);
+  while (tsegment_cursor_next(&cur))
   {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    POINT4D point = datum_get_point4d(tinstant_value(inst));
-    instantsx[i] = tinstant_make(Float8GetDatum(point.x), inst->t,
-      FLOAT8OID);
-    instantsy[i] = tinstant_make(Float8GetDatum(point.y), inst->t,
-      FLOAT8OID);
-    if (hasz)
-      instantsz[i] = tinstant_make(Float8GetDatum(point.z), inst->t,
-        FLOAT8OID);
+    if (cur.start == cur.end)
+      continue;
+    Datum value1 = tinstant_value(cur.start);
+    Datum value2 = tinstant_value(cur.end);
+    if (! datum_point_eq(value1, value2))
+      result += DatumGetFloat8(func(value1, value2));
   }
-  TInstantSet *tix = tinstantset_make_free(instantsx, ti->count);
-  TInstantSet *tiy = tinstantset_make_free(instantsy, ti->count);
-  TInstantSet *tiz = NULL; /* keep compiler quiet */
-  if (hasz)
-    tiz = tinstantset_make_free(instantsz, ti->count);
-  double avgx = tnumberinstset_twavg(tix);
-  double avgy = tnumberinstset_twavg(tiy);
-  double avgz;
-  if (hasz)
-    avgz = tnumberinstset_twavg(tiz);
-  LWPOINT *lwpoint;
-  if (hasz)
-    lwpoint = lwpoint_make3dz(srid, avgx, avgy, avgz);
-  else
-    lwpoint = lwpoint_make2d(srid, avgx, avgy);
-  Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
-
-  pfree(lwpoint);
-  pfree(tix); pfree(tiy);
-  if (hasz)
-    pfree(tiz);
-
+  tsegment_cursor_free(&cur);
   return result;
 }
 
+PG_FUNCTION_INFO_V1(tpoint_length_period);
 /**
- * Returns the time-weighed centroid of the temporal geometry point of
- * sequence duration
+ * Returns the length traversed by the temporal sequence (set) point
+ * restricted to the period. As for the restriction, the result is NULL
+ * when the temporal point does not intersect the period.
  */
-Datum
-tgeompointseq_twcentroid(const TSequence *seq)
+PGDLLEXPORT Datum
+tpoint_length_period(PG_FUNCTION_ARGS)
 {
-  int srid = tpointseq_srid(seq);
-  TInstant **instantsx = palloc(sizeof(TInstant *) * seq->count);
-  TInstant **instantsy = palloc(sizeof(TInstant *) * seq->count);
-  TInstant **instantsz;
-  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
-  if (hasz)
-    instantsz = palloc(sizeof(TInstant *) * seq->count);
-
-  for (int i = 0; i < seq->count; i++)
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  if (! temporal_intersects_period_internal(temp, p))
   {
-    TInstant *inst = tsequence_inst_n(seq, i);
-    POINT4D point = datum_get_point4d(tinstant_value(inst));
-    instantsx[i] = tinstant_make(Float8GetDatum(point.x), inst->t,
-      FLOAT8OID);
-    instantsy[i] = tinstant_make(Float8GetDatum(point.y), inst->t,
-      FLOAT8OID);
-    if (hasz)
-      instantsz[i] = tinstant_make(Float8GetDatum(point.z), inst->t,
-        FLOAT8OID);
+    PG_FREE_IF_COPY(temp, 0);
+    PG_RETURN_NULL();
   }
-  TSequence *seqx = tsequence_make_free(instantsx, seq->count,
-    seq->period.lower_inc, seq->period.upper_inc,
-    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-  TSequence *seqy = tsequence_make_free(instantsy, seq->count,
-    seq->period.lower_inc, seq->period.upper_inc,
-    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-  TSequence *seqz;
-  if (hasz)
-    seqz = tsequence_make_free(instantsz, seq->count, seq->period.lower_inc,
-      seq->period.upper_inc, MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-  double twavgx = tnumberseq_twavg(seqx);
-  double twavgy = tnumberseq_twavg(seqy);
-  LWPOINT *lwpoint;
-  if (hasz)
+  double result = 0.0;
+  if (temp->duration == INSTANT || temp->duration == INSTANTSET ||
+    ! MOBDB_FLAGS_GET_LINEAR(temp->flags))
+    ;
+  else
+    result = tpoint_length_period1(temp, p);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_FLOAT8(result);
+}
+
+/**
+ * Returns the speed of the temporal sequence (set) point restricted to the
+ * period, or whether the speed is above the threshold
+ *
+ * @param[in] temp Temporal point
+ * @param[in] p Period
+ * @param[in] compare True when the speed is compared with the threshold,
+ * in which case the result is a temporal boolean
+ * @param[in] threshold Threshold
+ */
+static Temporal *
+tpoint_speed_period1(const Temporal *temp, const Period *p, bool compare,
+  double threshold)
+{
+  Datum (*func)(Datum, Datum);
+  if (MOBDB_FLAGS_GET_GEODETIC(temp->flags))
+    func = &geog_distance;
+  else
+    func = MOBDB_FLAGS_GET_Z(temp->flags) ? &pt_distance3d : &pt_distance2d;
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  Oid restypid = compare ? BOOLOID : FLOAT8OID;
+  int count = (temp->duration == SEQUENCE) ? 1 :
+    ((TSequenceSet *) temp)->count;
+  TSequence **sequences = palloc(sizeof(TSequence *) * count);
+  TInstant **instants = NULL;
+  int k = 0, l = 0;
+  TSegmentCursor cur;
+  tsegment_cursor_init(&cur, temp, p);
+  while (tsegment_cursor_next(&cur))
   {
-    double twavgz = tnumberseq_twavg(seqz);
-    lwpoint = lwpoint_make3dz(srid, twavgx, twavgy, twavgz);
+    /* Instantaneous sequences have no speed */
+    if (cur.start == cur.end)
+      continue;
+    if (cur.newseq)
+    {
+      instants = palloc(sizeof(TInstant *) * (cur.seq->count + 1));
+      l = 0;
+    }
+    double speed = 0;
+    if (linear)
+    {
+      Datum value1 = tinstant_value(cur.start);
+      Datum value2 = tinstant_value(cur.end);
+      if (! datum_point_eq(value1, value2))
+        speed = DatumGetFloat8(func(value1, value2)) /
+          ((double)(cur.end->t - cur.start->t) / 1000000);
+    }
+    Datum value = compare ? BoolGetDatum(speed > threshold) :
+      Float8GetDatum(speed);
+    instants[l++] = tinstant_make(value, cur.start->t, restypid);
+    /* The resulting sequences have step interpolation */
+    if (cur.end->t == cur.seqperiod.upper)
+    {
+      instants[l++] = tinstant_make(value, cur.end->t, restypid);
+      sequences[k++] = tsequence_make_free(instants, l,
+        cur.seqperiod.lower_inc, cur.seqperiod.upper_inc, STEP, NORMALIZE);
+    }
   }
+  tsegment_cursor_free(&cur);
+  Temporal *result = NULL;
+  if (temp->duration == SEQUENCESET)
+    result = (Temporal *) tsequenceset_make_free(sequences, k, NORMALIZE);
   else
-    lwpoint = lwpoint_make2d(srid, twavgx, twavgy);
-  Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
-
-  pfree(lwpoint);  pfree(seqx); pfree(seqy);
-  if (hasz)
-    pfree(seqz);
-
+  {
+    if (k > 0)
+      result = (Temporal *) sequences[0];
+    pfree(sequences);
+  }
   return result;
 }
 
+PG_FUNCTION_INFO_V1(tpoint_speed_period);
 /**
- * Returns the time-weighed centroid of the temporal geometry point of
- * sequence set duration
+ * Returns the speed of the temporal sequence (set) point restricted to the
+ * period
  */
-Datum
-tgeompoints_twcentroid(const TSequenceSet *ts)
+PGDLLEXPORT Datum
+tpoint_speed_period(PG_FUNCTION_ARGS)
 {
-  int srid = tpointseqset_srid(ts);
-  TSequence **sequencesx = palloc(sizeof(TSequence *) * ts->count);
-  TSequence **sequencesy = palloc(sizeof(TSequence *) * ts->count);
-  TSequence **sequencesz = NULL; /* keep compiler quiet */
-  bool hasz = MOBDB_FLAGS_GET_Z(ts->flags);
-  if (hasz)
-    sequencesz = palloc(sizeof(TSequence *) * ts->count);
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    TInstant **instantsx = palloc(sizeof(TInstant *) * seq->count);
-    TInstant **instantsy = palloc(sizeof(TInstant *) * seq->count);
-    TInstant **instantsz;
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  Temporal *result = NULL;
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == SEQUENCE || temp->duration == SEQUENCESET)
+    result = tpoint_speed_period1(temp, p, false, 0);
+  PG_FREE_IF_COPY(temp, 0);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_speed_above);
+/**
+ * Returns whether the speed of the temporal sequence (set) point restricted
+ * to the period is above the threshold
+ */
+PGDLLEXPORT Datum
+tpoint_speed_above(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  double threshold = PG_GETARG_FLOAT8(2);
+  Temporal *result = NULL;
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == SEQUENCE || temp->duration == SEQUENCESET)
+    result = tpoint_speed_period1(temp, p, true, threshold);
+  PG_FREE_IF_COPY(temp, 0);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Time-weighed centroid for temporal geometry points
+ *****************************************************************************/
+
+/**
+ * Returns the time-weighed centroid of the temporal geometry point of
+ * instant set duration
+ */
+Datum
+tgeompointi_twcentroid(const TInstantSet *ti)
+{
+  int srid = tpointinstset_srid(ti);
+  bool hasz = MOBDB_FLAGS_GET_Z(ti->flags);
+  double avgx = 0, avgy = 0, avgz = 0;
+  for (int i = 0; i < ti->count; i++)
+  {
+    POINT4D point = datum_get_point4d(tinstant_value(tinstantset_inst_n(ti, i)));
+    avgx += point.x;
+    avgy += point.y;
+    if (hasz)
+      avgz += point.z;
+  }
+  avgx /= ti->count;
+  avgy /= ti->count;
+  avgz /= ti->count;
+  LWPOINT *lwpoint = hasz ?
+    lwpoint_make3dz(srid, avgx, avgy, avgz) :
+    lwpoint_make2d(srid, avgx, avgy);
+  Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
+  pfree(lwpoint);
+  return result;
+}
+
+/**
+ * Returns the coordinates of the temporal geometry point as C arrays of
+ * doubles, which are used for computing its time-weighted centroid
+ *
+ * @param[out] x,y,z Arrays of coordinates, `z` is only filled when it is not
+ * NULL and the temporal point has Z dimension
+ * @param[in] seq Temporal point
+ * @note The coordinates are read directly from the serialized points
+ * without building the corresponding LWGEOM
+ */
+static int
+tgeompointseq_coords1(double *x, double *y, double *z, const TSequence *seq)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  for (int i = 0; i < seq->count; i++)
+  {
+    Datum value = tinstant_value(tsequence_inst_n(seq, i));
     if (hasz)
-      instantsz = palloc(sizeof(TInstant *) * seq->count);
-    for (int j = 0; j < seq->count; j++)
     {
-      TInstant *inst = tsequence_inst_n(seq, j);
-      POINT4D point = datum_get_point4d(tinstant_value(inst));
-      instantsx[j] = tinstant_make(Float8GetDatum(point.x),
-        inst->t, FLOAT8OID);
-      instantsy[j] = tinstant_make(Float8GetDatum(point.y),
-        inst->t, FLOAT8OID);
-      if (hasz)
-        instantsz[j] = tinstant_make(Float8GetDatum(point.z),
-          inst->t, FLOAT8OID);
+      const POINT3DZ *point = datum_get_point3dz_p(value);
+      x[i] = point->x;
+      y[i] = point->y;
+      if (z != NULL)
+        z[i] = point->z;
+    }
+    else
+    {
+      const POINT2D *point = datum_get_point2d_p(value);
+      x[i] = point->x;
+      y[i] = point->y;
     }
-    sequencesx[i] = tsequence_make_free(instantsx, seq->count,
-      seq->period.lower_inc, seq->period.upper_inc,
-      MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-    sequencesy[i] = tsequence_make_free(instantsy,
-      seq->count, seq->period.lower_inc, seq->period.upper_inc,
-      MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
-    if (hasz)
-      sequencesz[i] = tsequence_make_free(instantsz, seq->count,
-        seq->period.lower_inc, seq->period.upper_inc,
-        MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
   }
-  TSequenceSet *tsx = tsequenceset_make_free(sequencesx, ts->count, NORMALIZE);
-  TSequenceSet *tsy = tsequenceset_make_free(sequencesy, ts->count, NORMALIZE);
-  TSequenceSet *tsz = NULL; /* keep compiler quiet */
-  if (hasz)
-    tsz = tsequenceset_make_free(sequencesz, ts->count, NORMALIZE);
+  return seq->count;
+}
 
-  double twavgx = tnumberseqset_twavg(tsx);
-  double twavgy = tnumberseqset_twavg(tsy);
-  LWPOINT *lwpoint;
+/**
+ * Computes in the last arguments the integrals of the coordinates of the
+ * temporal geometry point of sequence duration
+ */
+static void
+tgeompointseq_integral(const TSequence *seq, double *intx, double *inty,
+  double *intz)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  TimestampTz *times = palloc(sizeof(TimestampTz) * seq->count);
+  double *x = palloc(sizeof(double) * seq->count);
+  double *y = palloc(sizeof(double) * seq->count);
+  double *z = hasz ? palloc(sizeof(double) * seq->count) : NULL;
+  tsequence_timestamps1(times, seq);
+  tgeompointseq_coords1(x, y, z, seq);
+  *intx = tnumberarr_integral(times, x, seq->count, linear);
+  *inty = tnumberarr_integral(times, y, seq->count, linear);
   if (hasz)
   {
-    double twavgz = tnumberseqset_twavg(tsz);
-    lwpoint = lwpoint_make3dz(srid, twavgx, twavgy, twavgz);
+    *intz = tnumberarr_integral(times, z, seq->count, linear);
+    pfree(z);
+  }
+  pfree(times); pfree(x); pfree(y);
+  return;
+}
+
+/**
+ * Returns the time-weighed centroid of the temporal geometry point of
+ * sequence duration
+ */
+Datum
+tgeompointseq_twcentroid(const TSequence *seq)
+{
+  int srid = tpointseq_srid(seq);
+  bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+  double duration = (double) (seq->period.upper - seq->period.lower);
+  double twavgx, twavgy, twavgz = 0;
+  if (duration == 0.0)
+  {
+    /* Instantaneous sequence */
+    POINT4D point = datum_get_point4d(tinstant_value(tsequence_inst_n(seq, 0)));
+    twavgx = point.x;
+    twavgy = point.y;
+    twavgz = point.z;
   }
   else
-    lwpoint = lwpoint_make2d(srid, twavgx, twavgy);
+  {
+    tgeompointseq_integral(seq, &twavgx, &twavgy, &twavgz);
+    twavgx /= duration;
+    twavgy /= duration;
+    twavgz /= duration;
+  }
+  LWPOINT *lwpoint = hasz ?
+    lwpoint_make3dz(srid, twavgx, twavgy, twavgz) :
+    lwpoint_make2d(srid, twavgx, twavgy);
   Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
-
   pfree(lwpoint);
-  pfree(tsx); pfree(tsy);
-  if (hasz)
-    pfree(tsz);
+  return result;
+}
 
+/**
+ * Returns the time-weighed centroid of the temporal geometry point of
+ * sequence set duration
+ */
+Datum
+tgeompoints_twcentroid(const TSequenceSet *ts)
+{
+  int srid = tpointseqset_srid(ts);
+  bool hasz = MOBDB_FLAGS_GET_Z(ts->flags);
+  double duration = tsequenceset_interval_double(ts);
+  double twavgx = 0, twavgy = 0, twavgz = 0;
+  for (int i = 0; i < ts->count; i++)
+  {
+    TSequence *seq = tsequenceset_seq_n(ts, i);
+    if (duration == 0.0)
+    {
+      /* All composing sequences are instantaneous */
+      POINT4D point = datum_get_point4d(tinstant_value(tsequence_inst_n(seq, 0)));
+      twavgx += point.x;
+      twavgy += point.y;
+      if (hasz)
+        twavgz += point.z;
+    }
+    else
+    {
+      double intx, inty, intz = 0;
+      tgeompointseq_integral(seq, &intx, &inty, &intz);
+      twavgx += intx;
+      twavgy += inty;
+      twavgz += intz;
+    }
+  }
+  double denom = (duration == 0.0) ? (double) ts->count : duration;
+  twavgx /= denom;
+  twavgy /= denom;
+  twavgz /= denom;
+  LWPOINT *lwpoint = hasz ?
+    lwpoint_make3dz(srid, twavgx, twavgy, twavgz) :
+    lwpoint_make2d(srid, twavgx, twavgy);
+  Datum result = PointerGetDatum(geo_serialize((LWGEOM *)lwpoint));
+  pfree(lwpoint);
   return result;
 }
 
@@ -2705,6 +3343,105 @@ tpoint_azimuth(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/**
+ * Returns the temporal azimuth of the temporal sequence (set) point
+ * restricted to the period
+ *
+ * The function is equivalent to applying the azimuth function to the
+ * restriction of the temporal point to the period but consumes the segments
+ * of the temporal point with a cursor without building the restriction.
+ */
+static TSequenceSet *
+tpoint_azimuth_period1(const Temporal *temp, const Period *p)
+{
+  /* Determine the PostGIS function to call */
+  Datum (*func)(Datum, Datum) = MOBDB_FLAGS_GET_GEODETIC(temp->flags) ?
+    &geog_azimuth : &geom_azimuth;
+  int totalcount = (temp->duration == SEQUENCE) ?
+    ((TSequence *) temp)->count : ((TSequenceSet *) temp)->totalcount;
+  TSequence **sequences = palloc(sizeof(TSequence *) * totalcount);
+  TInstant **instants = NULL;
+  int k = 0, l = 0;
+  Datum azimuth = 0; /* Make the compiler quiet */
+  bool lower_inc = false;
+  TSegmentCursor cur;
+  tsegment_cursor_init(&cur, temp, p);
+  while (tsegment_cursor_next(&cur))
+  {
+    /* Instantaneous sequences have no azimuth */
+    if (cur.start == cur.end)
+      continue;
+    if (cur.newseq)
+    {
+      if (instants != NULL)
+        pfree(instants);
+      instants = palloc(sizeof(TInstant *) * (cur.seq->count + 1));
+      k = 0;
+      lower_inc = cur.seqperiod.lower_inc;
+    }
+    Datum value1 = tinstant_value(cur.start);
+    Datum value2 = tinstant_value(cur.end);
+    if (! datum_point_eq(value1, value2))
+    {
+      azimuth = func(value1, value2);
+      instants[k++] = tinstant_make(azimuth, cur.start->t, FLOAT8OID);
+      if (cur.end->t == cur.seqperiod.upper)
+      {
+        instants[k++] = tinstant_make(azimuth, cur.end->t, FLOAT8OID);
+        /* Resulting sequence has step interpolation */
+        sequences[l++] = tsequence_make(instants, k, lower_inc,
+          cur.seqperiod.upper_inc, STEP, NORMALIZE);
+        for (int j = 0; j < k; j++)
+          pfree(instants[j]);
+        k = 0;
+      }
+    }
+    else
+    {
+      /* A constant segment ends the current sequence */
+      if (k != 0)
+      {
+        instants[k++] = tinstant_make(azimuth, cur.start->t, FLOAT8OID);
+        /* Resulting sequence has step interpolation */
+        sequences[l++] = tsequence_make(instants, k, lower_inc, true,
+          STEP, NORMALIZE);
+        for (int j = 0; j < k; j++)
+          pfree(instants[j]);
+        k = 0;
+      }
+      lower_inc = true;
+    }
+  }
+  tsegment_cursor_free(&cur);
+  if (instants != NULL)
+    pfree(instants);
+  /* Resulting sequence set has step interpolation */
+  return tsequenceset_make_free(sequences, l, NORMALIZE);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_azimuth_period);
+/**
+ * Returns the temporal azimuth of the temporal point restricted to the
+ * period
+ */
+PGDLLEXPORT Datum
+tpoint_azimuth_period(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
+  Temporal *result = NULL;
+  ensure_valid_duration(temp->duration);
+  if ((temp->duration == SEQUENCE || temp->duration == SEQUENCESET) &&
+    MOBDB_FLAGS_GET_LINEAR(temp->flags))
+    result = (Temporal *) tpoint_azimuth_period1(temp, p);
+  PG_FREE_IF_COPY(temp, 0);
+  if (result == NULL)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************
  * Restriction functions
  * N.B. In the PostGIS version currently used by MobilityDB (2.5) there is no
@@ -2717,7 +3454,7 @@ tpoint_azimuth(PG_FUNCTION_ARGS)
 static TInstant *
 tpointinst_restrict_geometry(const TInstant *inst, Datum geom, bool atfunc)
 {
-  bool inter = DatumGetBool(call_function2(intersects, tinstant_value(inst), geom));
+  bool inter = DatumGetBool(geom_intersects2d(tinstant_value(inst), geom));
   if ((atfunc && !inter) || (!atfunc && inter))
     return NULL;
   return tinstant_copy(inst);
@@ -2734,7 +3471,7 @@ tpointinstset_restrict_geometry(const TInstantSet *ti, Datum geom, bool atfunc)
   for (int i = 0; i < ti->count; i++)
   {
     TInstant *inst = tinstantset_inst_n(ti, i);
-    bool inter = DatumGetBool(call_function2(intersects, tinstant_value(inst), geom));
+    bool inter = DatumGetBool(geom_intersects2d(tinstant_value(inst), geom));
     if ((atfunc && inter) || (!atfunc && !inter))
       instants[k++] = inst;
   }
@@ -2769,7 +3506,7 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
   bool equal = datum_point_eq(value1, value2);
   if (equal || ! linear)
   {
-    if (!DatumGetBool(call_function2(intersects, value1, geom)))
+    if (! DatumGetBool(geom_intersects2d(value1, geom)))
     {
       *count = 0;
       return NULL;
@@ -2785,7 +3522,7 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
       linear, NORMALIZE_NO);
     int k = 1;
     if (upper_inc != upper_inc1 &&
-      DatumGetBool(call_function2(intersects, value2, geom)))
+      DatumGetBool(geom_intersects2d(value2, geom)))
     {
       result[1] = tinstant_to_tsequence(inst2, linear);
       k = 2;
@@ -2796,8 +3533,16 @@ tpointseq_at_geometry1(const TInstant *inst1, const TInstant *inst2,
     return result;
   }
 
-  /* Look for intersections in linear segment */
+  /* Look for intersections in linear segment. The intersection is only
+   * computed when the segment intersects the geometry, which is tested
+   * with the prepared geometry */
   Datum line = geopoint_line(value1, value2);
+  if (! DatumGetBool(geom_intersects2d(line, geom)))
+  {
+    pfree(DatumGetPointer(line));
+    *count = 0;
+    return NULL;
+  }
   Datum inter = call_function2(intersection, line, geom);
   GSERIALIZED *gsinter = (GSERIALIZED *) PG_DETOAST_DATUM(inter);
   if (gserialized_is_empty(gsinter))
@@ -2933,21 +3678,47 @@ tpointseq_at_geometry2(const TSequence *seq, Datum geom, int *count)
 
   /* Temporal sequence has at least 2 instants */
   bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
-  TSequence ***sequences = palloc(sizeof(TSequence *) * (seq->count - 1));
-  int *countseqs = palloc0(sizeof(int) * (seq->count - 1));
-  int totalseqs = 0;
-  TInstant *inst1 = tsequence_inst_n(seq, 0);
-  bool lower_inc = seq->period.lower_inc;
+  /* Restrict only the segments whose bounding box overlaps the one of the
+   * geometry. The boxes of the segments are computed on the fly since a
+   * single box is looked up. */
+  GBOX box;
+  /* Non-empty geometries have a bounding box */
+  gserialized_get_gbox_p((GSERIALIZED *) DatumGetPointer(geom), &box);
+  int *segs = palloc(sizeof(int) * (seq->count - 1));
+  int countsegs = 0;
+  const POINT2D *p1 = datum_get_point2d_p(tinstant_value(
+    tsequence_inst_n(seq, 0)));
   for (int i = 0; i < seq->count - 1; i++)
   {
-    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
-    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
+    const POINT2D *p2 = datum_get_point2d_p(tinstant_value(
+      tsequence_inst_n(seq, i + 1)));
+    BoxRTreeNode segbox;
+    segment_box_set(&segbox, p1, p2);
+    if (box_rtree_box_overlaps(&segbox, &box))
+      segs[countsegs++] = i;
+    p1 = p2;
+  }
+  if (countsegs == 0)
+  {
+    pfree(segs);
+    *count = 0;
+    return NULL;
+  }
+  TSequence ***sequences = palloc(sizeof(TSequence *) * countsegs);
+  int *countseqs = palloc0(sizeof(int) * countsegs);
+  int totalseqs = 0;
+  for (int i = 0; i < countsegs; i++)
+  {
+    int segno = segs[i];
+    TInstant *inst1 = tsequence_inst_n(seq, segno);
+    TInstant *inst2 = tsequence_inst_n(seq, segno + 1);
+    bool lower_inc = (segno == 0) ? seq->period.lower_inc : true;
+    bool upper_inc = (segno == seq->count - 2) ? seq->period.upper_inc : false;
     sequences[i] = tpointseq_at_geometry1(inst1, inst2, linear,
       lower_inc, upper_inc, geom, &countseqs[i]);
     totalseqs += countseqs[i];
-    inst1 = inst2;
-    lower_inc = true;
   }
+  pfree(segs);
   /* Set the output parameter */
   *count = totalseqs;
   if (totalseqs == 0)
@@ -2956,7 +3727,7 @@ tpointseq_at_geometry2(const TSequence *seq, Datum geom, int *count)
     return NULL;
   }
   TSequence **result = tsequencearr2_to_tsequencearr(sequences, countseqs,
-    seq->count - 1, totalseqs);
+    countsegs, totalseqs);
   return result;
 }
 
@@ -3143,6 +3914,8 @@ tpoint_restrict_geometry(FunctionCallInfo fcinfo, bool atfunc)
   }
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *result = tpoint_restrict_geometry_internal(temp,
     PointerGetDatum(gs), atfunc);
   PG_FREE_IF_COPY(temp, 0);
@@ -3173,11 +3946,470 @@ tpoint_minus_geometry(PG_FUNCTION_ARGS)
   return tpoint_restrict_geometry(fcinfo, REST_MINUS);
 }
 
+/*****************************************************************************
+ * Length restricted to a geometry
+ *
+ * The functions below are equivalent to applying the length function to the
+ * restriction of the temporal point to a geometry but consume the segments
+ * of the temporal point with a cursor and only compute the length of the
+ * intersection of each segment with the geometry, without building the
+ * restriction.
+ *****************************************************************************/
+
+/**
+ * Returns the length traversed by the segment of a temporal point restricted
+ * to the geometry
+ *
+ * As in function tpointseq_at_geometry1, the bounds of each linear
+ * intersection are projected on the segment to obtain the timestamps at
+ * which the temporal point enters and leaves the geometry, and the length is
+ * computed between the values of the segment at these timestamps.
+ * Point intersections do not contribute to the length.
+ *
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] geom Geometry
+ * @param[in] func Distance function
+ * @pre The segment has linear interpolation and is not constant
+ */
+static double
+tpointsegm_length_geometry(const TInstant *inst1, const TInstant *inst2,
+  Datum geom, Datum (*func)(Datum, Datum))
+{
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  Datum line = geopoint_line(value1, value2);
+  if (! DatumGetBool(geom_intersects2d(line, geom)))
+  {
+    pfree(DatumGetPointer(line));
+    return 0;
+  }
+  Datum inter = call_function2(intersection, line, geom);
+  GSERIALIZED *gsinter = (GSERIALIZED *) PG_DETOAST_DATUM(inter);
+  double result = 0;
+  if (! gserialized_is_empty(gsinter))
+  {
+    const POINT2D *start = datum_get_point2d_p(value1);
+    const POINT2D *end = datum_get_point2d_p(value2);
+    LWGEOM *lwgeom_inter = lwgeom_from_gserialized(gsinter);
+    LWCOLLECTION *coll = lwgeom_is_collection(lwgeom_inter) ?
+      lwgeom_as_lwcollection(lwgeom_inter) : NULL;
+    int countinter = (coll != NULL) ? coll->ngeoms : 1;
+    double duration = (inst2->t - inst1->t);
+    for (int i = 0; i < countinter; i++)
+    {
+      LWGEOM *subgeom = (coll != NULL) ? coll->geoms[i] : lwgeom_inter;
+      if (subgeom->type != LINETYPE)
+        continue;
+      /* Each linear intersection is a linestring with two points */
+      LWLINE *lwline_inter = lwgeom_as_lwline(subgeom);
+      POINT2D p1, p2, closest;
+      getPoint2d_p(lwline_inter->points, 0, &p1);
+      getPoint2d_p(lwline_inter->points, 1, &p2);
+      double fraction1 = closest_point2d_on_segment_ratio(&p1, start, end,
+        &closest);
+      double fraction2 = closest_point2d_on_segment_ratio(&p2, start, end,
+        &closest);
+      TimestampTz t1 = inst1->t + (long) (duration * fraction1);
+      TimestampTz t2 = inst1->t + (long) (duration * fraction2);
+      if (t1 == t2)
+        continue;
+      Datum point1 = tsequence_value_at_timestamp1(inst1, inst2, true,
+        Min(t1, t2));
+      Datum point2 = tsequence_value_at_timestamp1(inst1, inst2, true,
+        Max(t1, t2));
+      result += DatumGetFloat8(func(point1, point2));
+      pfree(DatumGetPointer(point1)); pfree(DatumGetPointer(point2));
+    }
+    lwgeom_free(lwgeom_inter);
+  }
+  pfree(DatumGetPointer(line));
+  pfree(DatumGetPointer(inter));
+  POSTGIS_FREE_IF_COPY_P(gsinter, DatumGetPointer(gsinter));
+  return result;
+}
+
+/**
+ * Returns the length traversed by the temporal sequence (set) point
+ * restricted to the geometry
+ *
+ * @pre The arguments are of the same dimensionality, have the same SRID,
+ * and the geometry is not empty
+ */
+static double
+tpoint_length_geometry1(const Temporal *temp, Datum geom)
+{
+  /* Bounding box test */
+  STBOX box1, box2;
+  memset(&box1, 0, sizeof(STBOX));
+  memset(&box2, 0, sizeof(STBOX));
+  temporal_bbox(&box1, temp);
+  geo_to_stbox_internal(&box2, (GSERIALIZED *) DatumGetPointer(geom));
+  if (! overlaps_stbox_stbox_internal(&box1, &box2))
+    return 0;
+
+  Datum (*func)(Datum, Datum) = MOBDB_FLAGS_GET_Z(temp->flags) ?
+    &pt_distance3d : &pt_distance2d;
+  /* Only the segments whose bounding box overlaps the one of the geometry
+   * are intersected with the geometry */
+  GBOX box;
+  gserialized_get_gbox_p((GSERIALIZED *) DatumGetPointer(geom), &box);
+  double result = 0;
+  TSegmentCursor cur;
+  tsegment_cursor_init(&cur, temp, NULL);
+  while (tsegment_cursor_next(&cur))
+  {
+    /* Instantaneous sequences and constant segments have no length */
+    if (cur.start == cur.end)
+      continue;
+    Datum value1 = tinstant_value(cur.start);
+    Datum value2 = tinstant_value(cur.end);
+    if (datum_point_eq(value1, value2))
+      continue;
+    BoxRTreeNode segbox;
+    segment_box_set(&segbox, datum_get_point2d_p(value1),
+      datum_get_point2d_p(value2));
+    if (box_rtree_box_overlaps(&segbox, &box))
+      result += tpointsegm_length_geometry(cur.start, cur.end, geom, func);
+  }
+  tsegment_cursor_free(&cur);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_length_geometry);
+/**
+ * Returns the length traversed by the temporal point restricted to the
+ * geometry. As for the restriction, the result is NULL when the geometry
+ * is empty or when the temporal point does not intersect it.
+ */
+PGDLLEXPORT Datum
+tpoint_length_geometry(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+  if (gserialized_is_empty(gs))
+  {
+    PG_FREE_IF_COPY(temp, 0);
+    PG_FREE_IF_COPY(gs, 1);
+    PG_RETURN_NULL();
+  }
+  ensure_same_srid_tpoint_gs(temp, gs);
+  ensure_same_dimensionality_tpoint_gs(temp, gs);
+  ensure_valid_duration(temp->duration);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
+  double result = 0.0;
+  if ((temp->duration == SEQUENCE || temp->duration == SEQUENCESET) &&
+    MOBDB_FLAGS_GET_LINEAR(temp->flags))
+    result = tpoint_length_geometry1(temp, PointerGetDatum(gs));
+  /* A zero length does not tell whether the restriction is empty, e.g.,
+   * when the temporal point only touches the geometry */
+  bool isnull = false;
+  if (result == 0.0)
+  {
+    Temporal *at = tpoint_restrict_geometry_internal(temp,
+      PointerGetDatum(gs), REST_AT);
+    if (at == NULL)
+      isnull = true;
+    else
+      pfree(at);
+  }
+  PG_FREE_IF_COPY(temp, 0);
+  PG_FREE_IF_COPY(gs, 1);
+  if (isnull)
+    PG_RETURN_NULL();
+  PG_RETURN_FLOAT8(result);
+}
+
 /*****************************************************************************/
 
+/**
+ * Returns true if the point is inside the spatial extent of the box
+ */
+static bool
+point_inside_stbox(Datum value, const STBOX *box, bool hasz)
+{
+  if (hasz)
+  {
+    const POINT3DZ *p = datum_get_point3dz_p(value);
+    return p->x >= box->xmin && p->x <= box->xmax &&
+      p->y >= box->ymin && p->y <= box->ymax &&
+      p->z >= box->zmin && p->z <= box->zmax;
+  }
+  const POINT2D *p = datum_get_point2d_p(value);
+  return p->x >= box->xmin && p->x <= box->xmax &&
+    p->y >= box->ymin && p->y <= box->ymax;
+}
+
+/**
+ * Clips the segment of a temporal point to the spatial extent of the box
+ * using the Liang-Barsky algorithm
+ *
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] box Box
+ * @param[in] hasz True when the Z dimension of the box is considered
+ * @param[out] s1,s2 Fractions of the segment at which it enters and leaves
+ * the box
+ * @result Returns false when the segment does not intersect the box
+ */
+static bool
+tpointsegm_clip_stbox(const TInstant *inst1, const TInstant *inst2,
+  const STBOX *box, bool hasz, double *s1, double *s2)
+{
+  double a[3], b[3];
+  double lower[3] = {box->xmin, box->ymin, box->zmin};
+  double upper[3] = {box->xmax, box->ymax, box->zmax};
+  int dims = hasz ? 3 : 2;
+  if (hasz)
+  {
+    const POINT3DZ *p1 = datum_get_point3dz_p(tinstant_value(inst1));
+    const POINT3DZ *p2 = datum_get_point3dz_p(tinstant_value(inst2));
+    a[0] = p1->x; a[1] = p1->y; a[2] = p1->z;
+    b[0] = p2->x; b[1] = p2->y; b[2] = p2->z;
+  }
+  else
+  {
+    const POINT2D *p1 = datum_get_point2d_p(tinstant_value(inst1));
+    const POINT2D *p2 = datum_get_point2d_p(tinstant_value(inst2));
+    a[0] = p1->x; a[1] = p1->y;
+    b[0] = p2->x; b[1] = p2->y;
+  }
+  *s1 = 0.0;
+  *s2 = 1.0;
+  for (int i = 0; i < dims; i++)
+  {
+    double delta = b[i] - a[i];
+    if (delta == 0)
+    {
+      if (a[i] < lower[i] || a[i] > upper[i])
+        return false;
+      continue;
+    }
+    double r1 = (lower[i] - a[i]) / delta;
+    double r2 = (upper[i] - a[i]) / delta;
+    if (r1 > r2)
+    {
+      double tmp = r1; r1 = r2; r2 = tmp;
+    }
+    *s1 = Max(*s1, r1);
+    *s2 = Min(*s2, r2);
+    if (*s1 > *s2)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Appends a copy of the instant to the run of instants restricted to the
+ * box, unless it has the same timestamp as the last one
+ */
+static void
+tpointseq_stbox_append(TInstant **instants, int *count, const TInstant *inst)
+{
+  if (*count > 0 && instants[*count - 1]->t == inst->t)
+    return;
+  instants[(*count)++] = tinstant_copy(inst);
+  return;
+}
+
+/**
+ * Appends the instant of the linear segment at the fraction to the run of
+ * instants restricted to the box
+ */
+static void
+tpointseq_stbox_append_at(TInstant **instants, int *count,
+  const TInstant *inst1, const TInstant *inst2, double fraction)
+{
+  if (fraction == 0.0)
+    tpointseq_stbox_append(instants, count, inst1);
+  else if (fraction == 1.0)
+    tpointseq_stbox_append(instants, count, inst2);
+  else
+  {
+    TimestampTz t = inst1->t + (long) ((double)(inst2->t - inst1->t) * fraction);
+    if (*count > 0 && instants[*count - 1]->t == t)
+      return;
+    Datum value = tsequence_value_at_timestamp1(inst1, inst2, LINEAR, t);
+    instants[(*count)++] = tinstant_make(value, t, inst1->valuetypid);
+    pfree(DatumGetPointer(value));
+  }
+  return;
+}
+
+/**
+ * Closes the run of instants restricted to the box and adds the
+ * resulting sequence to the array
+ */
+static void
+tpointseq_stbox_close(TInstant **instants, int *count, bool lower_inc,
+  bool upper_inc, bool linear, TSequence **sequences, int *k)
+{
+  if (*count == 0)
+    return;
+  if (*count > 1 || (lower_inc && upper_inc))
+    sequences[(*k)++] = tsequence_make(instants, *count,
+      (*count > 1) ? lower_inc : true, (*count > 1) ? upper_inc : true,
+      linear, NORMALIZE);
+  for (int i = 0; i < *count; i++)
+    pfree(instants[i]);
+  *count = 0;
+  return;
+}
+
+/**
+ * Restricts the temporal sequence (set) point to the spatiotemporal box
+ *
+ * The segments of the temporal point, restricted to the period of the box
+ * if any, are clipped to the spatial extent of the box with the
+ * Liang-Barsky algorithm and the runs of consecutive clipped segments
+ * are assembled into sequences.
+ *
+ * @pre The box has spatial dimensions
+ */
+static TSequenceSet *
+tpointseq_at_stbox(const Temporal *temp, const STBOX *box)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(box->flags);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  int totalcount = (temp->duration == SEQUENCE) ?
+    ((TSequence *) temp)->count : ((TSequenceSet *) temp)->totalcount;
+  TSequence **sequences = palloc(sizeof(TSequence *) * totalcount * 2);
+  TInstant **instants = NULL;
+  int k = 0, count = 0;
+  bool lower_inc = false;
+  Period p;
+  if (MOBDB_FLAGS_GET_T(box->flags))
+    period_set(&p, box->tmin, box->tmax, true, true);
+  TSegmentCursor cur;
+  tsegment_cursor_init(&cur, temp, MOBDB_FLAGS_GET_T(box->flags) ? &p : NULL);
+  while (tsegment_cursor_next(&cur))
+  {
+    bool last = (cur.end->t == cur.seqperiod.upper);
+    if (cur.newseq)
+    {
+      if (instants != NULL)
+        pfree(instants);
+      instants = palloc(sizeof(TInstant *) * (cur.seq->count + 2));
+      count = 0;
+    }
+    /* Instantaneous sequence */
+    if (cur.start == cur.end)
+    {
+      if (point_inside_stbox(tinstant_value(cur.start), box, hasz))
+      {
+        tpointseq_stbox_append(instants, &count, cur.start);
+        tpointseq_stbox_close(instants, &count, true, true, linear,
+          sequences, &k);
+      }
+      continue;
+    }
+    bool seglower_inc = cur.newseq ? cur.seqperiod.lower_inc : true;
+    if (! linear)
+    {
+      /* The value is constant until the end of the segment */
+      if (point_inside_stbox(tinstant_value(cur.start), box, hasz))
+      {
+        if (count == 0)
+        {
+          tpointseq_stbox_append(instants, &count, cur.start);
+          lower_inc = seglower_inc;
+        }
+        if (point_inside_stbox(tinstant_value(cur.end), box, hasz))
+        {
+          tpointseq_stbox_append(instants, &count, cur.end);
+          if (last)
+            tpointseq_stbox_close(instants, &count, lower_inc,
+              cur.seqperiod.upper_inc, linear, sequences, &k);
+        }
+        else
+        {
+          instants[count++] = tinstant_make(tinstant_value(cur.start),
+            cur.end->t, cur.start->valuetypid);
+          tpointseq_stbox_close(instants, &count, lower_inc, false, linear,
+            sequences, &k);
+        }
+      }
+      else if (last && cur.seqperiod.upper_inc &&
+        point_inside_stbox(tinstant_value(cur.end), box, hasz))
+      {
+        tpointseq_stbox_append(instants, &count, cur.end);
+        tpointseq_stbox_close(instants, &count, true, true, linear,
+          sequences, &k);
+      }
+      continue;
+    }
+    double s1, s2;
+    if (! tpointsegm_clip_stbox(cur.start, cur.end, box, hasz, &s1, &s2))
+    {
+      tpointseq_stbox_close(instants, &count, lower_inc, true, linear,
+        sequences, &k);
+      continue;
+    }
+    /* The segment does not continue the current run */
+    if (count > 0 && s1 > 0.0)
+      tpointseq_stbox_close(instants, &count, lower_inc, true, linear,
+        sequences, &k);
+    if (count == 0)
+    {
+      tpointseq_stbox_append_at(instants, &count, cur.start, cur.end, s1);
+      lower_inc = (s1 == 0.0) ? seglower_inc : true;
+    }
+    tpointseq_stbox_append_at(instants, &count, cur.start, cur.end, s2);
+    if (s2 < 1.0)
+      tpointseq_stbox_close(instants, &count, lower_inc, true, linear,
+        sequences, &k);
+    else if (last)
+      tpointseq_stbox_close(instants, &count, lower_inc,
+        cur.seqperiod.upper_inc, linear, sequences, &k);
+  }
+  tsegment_cursor_free(&cur);
+  if (instants != NULL)
+    pfree(instants);
+  return tsequenceset_make_free(sequences, k, NORMALIZE);
+}
+
+/**
+ * Restricts the temporal instant (set) point to the spatiotemporal box
+ *
+ * @pre The box has spatial dimensions
+ */
+static Temporal *
+tpointinst_at_stbox(const Temporal *temp, const STBOX *box)
+{
+  bool hasz = MOBDB_FLAGS_GET_Z(box->flags);
+  bool hast = MOBDB_FLAGS_GET_T(box->flags);
+  if (temp->duration == INSTANT)
+  {
+    const TInstant *inst = (TInstant *) temp;
+    if ((hast && (inst->t < box->tmin || inst->t > box->tmax)) ||
+      ! point_inside_stbox(tinstant_value(inst), box, hasz))
+      return NULL;
+    return (Temporal *) tinstant_copy(inst);
+  }
+  /* temp->duration == INSTANTSET */
+  const TInstantSet *ti = (TInstantSet *) temp;
+  TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+  int k = 0;
+  for (int i = 0; i < ti->count; i++)
+  {
+    TInstant *inst = tinstantset_inst_n(ti, i);
+    if ((! hast || (inst->t >= box->tmin && inst->t <= box->tmax)) &&
+      point_inside_stbox(tinstant_value(inst), box, hasz))
+      instants[k++] = inst;
+  }
+  TInstantSet *result = NULL;
+  if (k != 0)
+    result = tinstantset_make(instants, k);
+  /* We cannot pfree the instants in the array */
+  pfree(instants);
+  return (Temporal *) result;
+}
+
 /**
  * Restrict the temporal point to the spatiotemporal box
  *
+ * Boxes with planar coordinates are handled by clipping the segments of the
+ * temporal point to the box. Geodetic boxes are converted into a geometry.
+ *
  * @pre The arguments are of the same dimensionality and
  * have the same SRID
  */
@@ -3192,6 +4424,21 @@ tpoint_at_stbox_internal(const Temporal *temp, const STBOX *box)
     return NULL;
 
   /* At least one of MOBDB_FLAGS_GET_T and MOBDB_FLAGS_GET_X is true */
+  if (! MOBDB_FLAGS_GET_X(box->flags))
+  {
+    Period p;
+    period_set(&p, box->tmin, box->tmax, true, true);
+    return temporal_at_period_internal(temp, &p);
+  }
+
+  /* Planar boxes are clipped directly */
+  if (! MOBDB_FLAGS_GET_GEODETIC(box->flags))
+  {
+    if (temp->duration == INSTANT || temp->duration == INSTANTSET)
+      return tpointinst_at_stbox(temp, box);
+    return (Temporal *) tpointseq_at_stbox(temp, box);
+  }
+
   Temporal *temp1;
   if (MOBDB_FLAGS_GET_T(box->flags))
   {
@@ -3201,23 +4448,16 @@ tpoint_at_stbox_internal(const Temporal *temp, const STBOX *box)
   }
   else
     temp1 = temporal_copy(temp);
-
-  Temporal *result;
-  if (MOBDB_FLAGS_GET_X(box->flags))
-  {
-    Datum gbox = PointerGetDatum(stbox_to_gbox(box));
-    Datum geom = MOBDB_FLAGS_GET_Z(box->flags) ?
-      call_function1(BOX3D_to_LWGEOM, gbox) :
-      call_function1(BOX2D_to_LWGEOM, gbox);
-    Datum geom1 = call_function2(LWGEOM_set_srid, geom,
-      Int32GetDatum(box->srid));
-    result = tpoint_restrict_geometry_internal(temp1, geom1, REST_AT);
-    pfree(DatumGetPointer(gbox)); pfree(DatumGetPointer(geom));
-    pfree(DatumGetPointer(geom1));
-    pfree(temp1);
-  }
-  else
-    result = temp1;
+  Datum gbox = PointerGetDatum(stbox_to_gbox(box));
+  Datum geom = MOBDB_FLAGS_GET_Z(box->flags) ?
+    call_function1(BOX3D_to_LWGEOM, gbox) :
+    call_function1(BOX2D_to_LWGEOM, gbox);
+  Datum geom1 = call_function2(LWGEOM_set_srid, geom,
+    Int32GetDatum(box->srid));
+  Temporal *result = tpoint_restrict_geometry_internal(temp1, geom1, REST_AT);
+  pfree(DatumGetPointer(gbox)); pfree(DatumGetPointer(geom));
+  pfree(DatumGetPointer(geom1));
+  pfree(temp1);
   return result;
 }
 
@@ -3225,8 +4465,9 @@ tpoint_at_stbox_internal(const Temporal *temp, const STBOX *box)
  * Restrict the temporal point to the complement of the spatiotemporal box.
  * (internal function).
  * We cannot make the difference from each dimension separately, i.e.,
- * restrict at the period and then restrict to the polygon. Therefore, we
- * compute the atStbox and then compute the complement of the value obtained.
+ * restrict at the period and then restrict to the spatial extent. Therefore,
+ * we compute the atStbox and then compute the complement of the value
+ * obtained.
  *
  * @pre The arguments are of the same dimensionality and have the same SRID
  */
@@ -3269,6 +4510,8 @@ tpoint_restrict_stbox(FunctionCallInfo fcinfo, bool atfunc)
   ensure_same_srid_tpoint_stbox(temp, box);
   if (MOBDB_FLAGS_GET_X(box->flags))
     ensure_same_spatial_dimensionality_tpoint_stbox(temp, box);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *result = atfunc ? tpoint_at_stbox_internal(temp, box) :
     tpoint_minus_stbox_internal(temp, box);
   PG_FREE_IF_COPY(temp, 0);
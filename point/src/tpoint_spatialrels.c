@@ -39,13 +39,31 @@
  * covers and coveredby are inverse to each other
  *****************************************************************************/
 
+/**
+ * Calls the PostGIS function with the 2 arguments using the catalog
+ * information of the external function
+ *
+ * The predicates below are called for every instant or segment of a
+ * temporal point with the same geometry as argument. PostGIS keeps in the
+ * fn_extra of the catalog information a cache keyed on the geometry that
+ * holds its prepared GEOS representation and, for point-in-polygon tests,
+ * an index of its edges, which is then reused across the calls and across
+ * the rows of the query instead of being rebuilt each time.
+ */
+static Datum
+geom_call2_cached(PGFunction func, Datum geom1, Datum geom2)
+{
+  return CallerFInfoFunctionCall2(func, (fetch_fcinfo())->flinfo,
+    InvalidOid, geom1, geom2);
+}
+
 /**
  * Calls the PostGIS function ST_Contains with the 2 arguments
  */
 Datum
 geom_contains(Datum geom1, Datum geom2)
 {
-  return call_function2(contains, geom1, geom2);
+  return geom_call2_cached(contains, geom1, geom2);
 }
 
 /**
@@ -54,7 +72,7 @@ geom_contains(Datum geom1, Datum geom2)
 Datum
 geom_containsproperly(Datum geom1, Datum geom2)
 {
-  return call_function2(containsproperly, geom1, geom2);
+  return geom_call2_cached(containsproperly, geom1, geom2);
 }
 
 /**
@@ -63,7 +81,7 @@ geom_containsproperly(Datum geom1, Datum geom2)
 Datum
 geom_covers(Datum geom1, Datum geom2)
 {
-  return call_function2(covers, geom1, geom2);
+  return geom_call2_cached(covers, geom1, geom2);
 }
 
 /**
@@ -72,7 +90,7 @@ geom_covers(Datum geom1, Datum geom2)
 Datum
 geom_coveredby(Datum geom1, Datum geom2)
 {
-  return call_function2(coveredby, geom1, geom2);
+  return geom_call2_cached(coveredby, geom1, geom2);
 }
 
 /**
@@ -108,7 +126,7 @@ geom_equals(Datum geom1, Datum geom2)
 Datum
 geom_intersects2d(Datum geom1, Datum geom2)
 {
-  return call_function2(intersects, geom1, geom2);
+  return geom_call2_cached(intersects, geom1, geom2);
 }
 
 /**
@@ -144,7 +162,7 @@ geom_touches(Datum geom1, Datum geom2)
 Datum
 geom_within(Datum geom1, Datum geom2)
 {
-  return call_function2(contains, geom2, geom1);
+  return geom_call2_cached(contains, geom2, geom1);
 }
 
 /**
@@ -936,10 +936,8 @@ PG_FUNCTION_INFO_V1(tpoint_spgist_compress);
 PGDLLEXPORT Datum
 tpoint_spgist_compress(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   STBOX *result = palloc0(sizeof(STBOX));
-  temporal_bbox(result, temp);
-  PG_FREE_IF_COPY(temp, 0);
+  temporal_bbox_slice(PG_GETARG_DATUM(0), result);
   PG_RETURN_STBOX_P(result);
 }
 #endif
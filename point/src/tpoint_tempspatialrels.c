@@ -27,6 +27,7 @@
 
 #include "tpoint_tempspatialrels.h"
 
+#include <math.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
@@ -211,15 +212,26 @@ tspatialrel_tpointseq_geo1(TInstant *inst1, TInstant *inst2, bool linear,
   bool constant = datum_point_eq(value1, value2);
   TInstant *instants[2];
   Datum line, intersections;
-  /* If not constant segment and linear interpolation look for intersections */
+  bool found = false;
+  /* If not constant segment and linear interpolation look for intersections.
+   * The intersection is only computed when the segment intersects the
+   * geometry, which is tested with the prepared geometry */
   if (! constant && linear)
   {
     line = geopoint_line(value1, value2);
-    intersections = call_function2(intersection, line, geo);
+    if (DatumGetBool(geom_intersects2d(line, geo)))
+    {
+      intersections = call_function2(intersection, line, geo);
+      found = ! DatumGetBool(call_function1(LWGEOM_isempty, intersections));
+      if (! found)
+        pfree(DatumGetPointer(intersections));
+    }
+    if (! found)
+      pfree(DatumGetPointer(line));
   }
 
   /* Constant segment or step interpolation or no intersections */
-  if (constant || ! linear || call_function1(LWGEOM_isempty, intersections))
+  if (! found)
   {
     TSequence **result = palloc(sizeof(TSequence *));
     Datum value = lfinfo.invert ? spatialrel(geo, value1, param, lfinfo) :
@@ -466,25 +478,480 @@ tspatialrel_tpoint_geo2(const Temporal *temp, Datum geo, Datum param,
 
 /*****************************************************************************
  * Functions to compute the tdwithin relationship between a temporal sequence
- * and a geometry. These functions are not available for geographies nor for
- * 3D since they are based on the tpointseq_at_geometry1 function.
+ * and a geometry. These functions are not available for geographies and
+ * consider only the x and y coordinates of the points.
+ * The periods during which each linear segment of the temporal point is
+ * within the distance of the edges and the vertices of the geometry are
+ * computed analytically, without buffering the geometry.
  * The functions use the st_dwithin function from PostGIS only for
- * instantaneous sequences.
- * This function is not available for geographies since it is based on the
- * function atGeometry.
+ * instantaneous sequences and constant segments.
  *****************************************************************************/
 
+/**
+ * Edge of a geometry used for computing the tdwithin relationship. The
+ * isolated points of the geometry are kept as edges whose two vertices are
+ * equal.
+ */
+typedef struct
+{
+  POINT2D p1;             /**< First vertex */
+  POINT2D p2;             /**< Second vertex */
+} DWithinEdge;
+
+/**
+ * Edges of a geometry together with an R-tree over their bounding boxes
+ */
+typedef struct
+{
+  DWithinEdge *edges;     /**< Array of edges */
+  int count;              /**< Number of edges */
+  int size;               /**< Allocated size of the array */
+  bool areal;             /**< True when the geometry has areal components */
+  BoxRTree *tree;         /**< R-tree over the bounding boxes of the edges */
+} DWithinEdges;
+
+/**
+ * Adds an edge to the array of edges
+ */
+static void
+dwithin_edges_add(DWithinEdges *edges, const POINT2D *p1, const POINT2D *p2)
+{
+  if (edges->count == edges->size)
+  {
+    edges->size *= 2;
+    edges->edges = repalloc(edges->edges, sizeof(DWithinEdge) * edges->size);
+  }
+  DWithinEdge *edge = &edges->edges[edges->count++];
+  edge->p1 = *p1;
+  edge->p2 = *p2;
+  return;
+}
+
+/**
+ * Adds the edges of the point array to the array of edges
+ */
+static void
+dwithin_edges_add_ptarray(DWithinEdges *edges, const POINTARRAY *pa)
+{
+  POINT2D p1, p2;
+  if (pa->npoints == 0)
+    return;
+  getPoint2d_p(pa, 0, &p1);
+  if (pa->npoints == 1)
+  {
+    dwithin_edges_add(edges, &p1, &p1);
+    return;
+  }
+  for (uint32_t i = 1; i < pa->npoints; i++)
+  {
+    getPoint2d_p(pa, i, &p2);
+    dwithin_edges_add(edges, &p1, &p2);
+    p1 = p2;
+  }
+  return;
+}
+
+/**
+ * Adds the edges of the geometry to the array of edges
+ */
+static void
+dwithin_edges_add_lwgeom(DWithinEdges *edges, const LWGEOM *geom)
+{
+  if (lwgeom_is_empty(geom))
+    return;
+  if (geom->type == POINTTYPE)
+    dwithin_edges_add_ptarray(edges, ((LWPOINT *) geom)->point);
+  else if (geom->type == LINETYPE)
+    dwithin_edges_add_ptarray(edges, ((LWLINE *) geom)->points);
+  else if (geom->type == TRIANGLETYPE)
+  {
+    dwithin_edges_add_ptarray(edges, ((LWTRIANGLE *) geom)->points);
+    edges->areal = true;
+  }
+  else if (geom->type == POLYGONTYPE)
+  {
+    LWPOLY *poly = (LWPOLY *) geom;
+    for (uint32_t i = 0; i < poly->nrings; i++)
+      dwithin_edges_add_ptarray(edges, poly->rings[i]);
+    edges->areal = true;
+  }
+  else if (lwgeom_is_collection(geom))
+  {
+    LWCOLLECTION *coll = (LWCOLLECTION *) geom;
+    for (uint32_t i = 0; i < coll->ngeoms; i++)
+      dwithin_edges_add_lwgeom(edges, coll->geoms[i]);
+  }
+  else
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("Unsupported geometry type in tdwithin: %s",
+        lwtype_name(geom->type))));
+  return;
+}
+
+/**
+ * Returns the edges of the geometry and the R-tree over their bounding
+ * boxes. Curved geometries are linearized.
+ *
+ * @pre The geometry is not empty
+ */
+static DWithinEdges *
+dwithin_edges_make(Datum geo)
+{
+  LWGEOM *geom = lwgeom_from_gserialized((GSERIALIZED *) DatumGetPointer(geo));
+  if (lwgeom_has_arc(geom))
+  {
+    LWGEOM *stroked = lwgeom_stroke(geom, 32);
+    lwgeom_free(geom);
+    geom = stroked;
+  }
+  DWithinEdges *result = palloc(sizeof(DWithinEdges));
+  result->size = 64;
+  result->edges = palloc(sizeof(DWithinEdge) * result->size);
+  result->count = 0;
+  result->areal = false;
+  dwithin_edges_add_lwgeom(result, geom);
+  lwgeom_free(geom);
+
+  /* Geometries whose components are all empty have no edges */
+  result->tree = NULL;
+  if (result->count == 0)
+    return result;
+  BoxRTreeNode *entries = palloc(sizeof(BoxRTreeNode) * result->count);
+  for (int i = 0; i < result->count; i++)
+  {
+    segment_box_set(&entries[i], &result->edges[i].p1,
+      &result->edges[i].p2);
+    entries[i].first = i;
+    entries[i].count = 1;
+  }
+  result->tree = box_rtree_make(entries, result->count);
+  return result;
+}
+
+/**
+ * Free the edges of the geometry
+ */
+static void
+dwithin_edges_free(DWithinEdges *edges)
+{
+  if (edges->tree)
+    box_rtree_free(edges->tree);
+  pfree(edges->edges);
+  pfree(edges);
+  return;
+}
+
+/**
+ * Restricts the interval [s1, s2] to the values of s such that
+ * lo <= alpha + beta * s <= hi
+ *
+ * @result Returns false when the restricted interval is empty
+ */
+static bool
+dwithin_restrict_linear(double alpha, double beta, double lo, double hi,
+  double *s1, double *s2)
+{
+  if (beta == 0)
+    return alpha >= lo && alpha <= hi;
+  double r1 = (lo - alpha) / beta;
+  double r2 = (hi - alpha) / beta;
+  if (r1 > r2)
+  {
+    double tmp = r1; r1 = r2; r2 = tmp;
+  }
+  *s1 = Max(*s1, r1);
+  *s2 = Min(*s2, r2);
+  return *s1 <= *s2;
+}
+
+/**
+ * Computes the interval of values s in [0, 1] such that the point
+ * a + s * (dx, dy) is within the distance of the point p
+ *
+ * @result Returns false when the interval is empty
+ */
+static bool
+dwithin_segment_point(const POINT2D *a, double dx, double dy,
+  const POINT2D *p, double dist, double *s1, double *s2)
+{
+  double ex = a->x - p->x;
+  double ey = a->y - p->y;
+  /* Solve the equation |a - p + s * (dx, dy)|^2 = dist^2 */
+  double qa = dx * dx + dy * dy;
+  double qb = 2 * (dx * ex + dy * ey);
+  double qc = ex * ex + ey * ey - dist * dist;
+  double disc = qb * qb - 4 * qa * qc;
+  if (disc < 0)
+    return false;
+  double sqrtdisc = sqrt(disc);
+  *s1 = Max(0.0, (-qb - sqrtdisc) / (2 * qa));
+  *s2 = Min(1.0, (-qb + sqrtdisc) / (2 * qa));
+  return *s1 <= *s2;
+}
+
+/**
+ * Computes the interval of values s in [0, 1] such that the point
+ * a + s * (dx, dy) is within the distance of the interior of the edge,
+ * that is, its projection on the line of the edge falls within the edge
+ * and its distance to this line is at most the distance
+ *
+ * @result Returns false when the interval is empty
+ */
+static bool
+dwithin_segment_edge(const POINT2D *a, double dx, double dy,
+  const DWithinEdge *edge, double dist, double *s1, double *s2)
+{
+  double ex = edge->p2.x - edge->p1.x;
+  double ey = edge->p2.y - edge->p1.y;
+  double len2 = ex * ex + ey * ey;
+  double len = sqrt(len2);
+  double ax = a->x - edge->p1.x;
+  double ay = a->y - edge->p1.y;
+  *s1 = 0.0;
+  *s2 = 1.0;
+  /* Fraction of the projection of the point on the edge */
+  if (! dwithin_restrict_linear((ax * ex + ay * ey) / len2,
+      (dx * ex + dy * ey) / len2, 0.0, 1.0, s1, s2))
+    return false;
+  /* Signed distance of the point to the line of the edge */
+  return dwithin_restrict_linear((ex * ay - ey * ax) / len,
+    (ex * dy - ey * dx) / len, -dist, dist, s1, s2);
+}
+
+/**
+ * Comparator for sorting the intervals by their lower bound
+ */
+static int
+dwithin_interval_cmp(const void *i1, const void *i2)
+{
+  double s1 = ((const double *) i1)[0];
+  double s2 = ((const double *) i2)[0];
+  return (s1 < s2) ? -1 : ((s1 > s2) ? 1 : 0);
+}
+
+/**
+ * Appends the period to the array of periods, merging it with the last
+ * one when they overlap or are adjacent
+ *
+ * @pre The lower bound of the period is not before the lower bound of
+ * the last period in the array
+ */
+static void
+dwithin_periods_append(Period **periods, int *count, int *size,
+  TimestampTz lower, TimestampTz upper, bool lower_inc, bool upper_inc)
+{
+  if (lower == upper && (! lower_inc || ! upper_inc))
+    return;
+  if (*count > 0)
+  {
+    Period *last = &(*periods)[*count - 1];
+    if (lower < last->upper ||
+      (lower == last->upper && (last->upper_inc || lower_inc)))
+    {
+      if (upper > last->upper)
+      {
+        last->upper = upper;
+        last->upper_inc = upper_inc;
+      }
+      else if (upper == last->upper)
+        last->upper_inc |= upper_inc;
+      return;
+    }
+  }
+  if (*count == *size)
+  {
+    *size *= 2;
+    *periods = repalloc(*periods, sizeof(Period) * *size);
+  }
+  period_set(&(*periods)[(*count)++], lower, upper, lower_inc, upper_inc);
+  return;
+}
+
+/**
+ * Computes the periods during which the linear segment of a temporal
+ * point is within the distance of the geometry
+ *
+ * The segment is within the distance of an edge of the geometry when it
+ * is within the distance of one of its vertices, which is given by the
+ * roots of a quadratic equation, or of its interior, which is given by
+ * two linear inequalities. Only the edges whose bounding box intersects
+ * the bounding box of the segment expanded by the distance are considered,
+ * which are found with the R-tree of the edges.
+ * For areal geometries, the parts of the segment that are farther than the
+ * distance from the boundary are either entirely inside or entirely
+ * outside of the geometry, which is determined with one point-in-polygon
+ * test for each part.
+ *
+ * @param[in] inst1,inst2 Instants defining the segment
+ * @param[in] lower_inc,upper_inc State whether the bounds are inclusive
+ * @param[in] edges Edges of the geometry
+ * @param[in] geo Geometry
+ * @param[in] dist Distance
+ * @param[in,out] periods,count,size Array of periods
+ * @pre The segment is not constant
+ */
+static void
+tdwithin_segment_geo(const TInstant *inst1, const TInstant *inst2,
+  bool lower_inc, bool upper_inc, const DWithinEdges *edges, Datum geo,
+  double dist, Period **periods, int *count, int *size)
+{
+  const POINT2D *a = datum_get_point2d_p(tinstant_value(inst1));
+  const POINT2D *b = datum_get_point2d_p(tinstant_value(inst2));
+  double dx = b->x - a->x;
+  double dy = b->y - a->y;
+  GBOX box;
+  box.xmin = Min(a->x, b->x) - dist; box.xmax = Max(a->x, b->x) + dist;
+  box.ymin = Min(a->y, b->y) - dist; box.ymax = Max(a->y, b->y) + dist;
+  int countedges = 0;
+  int *edgenos = edges->tree ?
+    box_rtree_search(edges->tree, &box, &countedges) : NULL;
+
+  /* Each edge yields at most three intervals and the areal geometries
+   * add at most one interval for each gap between them */
+  double *intervals = palloc(sizeof(double) * 2 * (6 * countedges + 1));
+  int n = 0;
+  for (int i = 0; i < countedges; i++)
+  {
+    const DWithinEdge *edge = &edges->edges[edgenos[i]];
+    if (dwithin_segment_point(a, dx, dy, &edge->p1, dist,
+        &intervals[2 * n], &intervals[2 * n + 1]))
+      n++;
+    if (edge->p1.x == edge->p2.x && edge->p1.y == edge->p2.y)
+      continue;
+    if (dwithin_segment_point(a, dx, dy, &edge->p2, dist,
+        &intervals[2 * n], &intervals[2 * n + 1]))
+      n++;
+    if (dwithin_segment_edge(a, dx, dy, edge, dist,
+        &intervals[2 * n], &intervals[2 * n + 1]))
+      n++;
+  }
+  if (edgenos)
+    pfree(edgenos);
+
+  /* Merge the intervals */
+  if (n > 1)
+    qsort(intervals, (size_t) n, sizeof(double) * 2, &dwithin_interval_cmp);
+  int m = 0;
+  for (int i = 0; i < n; i++)
+  {
+    if (m > 0 && intervals[2 * i] <= intervals[2 * m - 1])
+      intervals[2 * m - 1] = Max(intervals[2 * m - 1], intervals[2 * i + 1]);
+    else
+    {
+      intervals[2 * m] = intervals[2 * i];
+      intervals[2 * m + 1] = intervals[2 * i + 1];
+      m++;
+    }
+  }
+
+  double duration = (double) (inst2->t - inst1->t);
+  double prev = 0.0;
+  for (int i = 0; i <= m; i++)
+  {
+    /* Test whether the gap before the interval is inside the geometry */
+    double next = (i < m) ? intervals[2 * i] : 1.0;
+    if (edges->areal && prev < next)
+    {
+      double s = (prev + next) / 2;
+      LWPOINT *lwpoint = lwpoint_make2d(gserialized_get_srid(
+        (GSERIALIZED *) DatumGetPointer(geo)), a->x + s * dx, a->y + s * dy);
+      GSERIALIZED *gs = geo_serialize((LWGEOM *) lwpoint);
+      if (DatumGetBool(geom_intersects2d(PointerGetDatum(gs), geo)))
+      {
+        TimestampTz t1 = inst1->t + (TimestampTz) (duration * prev);
+        TimestampTz t2 = inst1->t + (TimestampTz) (duration * next);
+        dwithin_periods_append(periods, count, size, t1, t2,
+          prev == 0.0 ? lower_inc : true, next == 1.0 ? upper_inc : true);
+      }
+      lwpoint_free(lwpoint);
+      pfree(gs);
+    }
+    if (i == m)
+      break;
+    TimestampTz t1 = inst1->t + (TimestampTz) (duration * intervals[2 * i]);
+    TimestampTz t2 = inst1->t +
+      (TimestampTz) (duration * intervals[2 * i + 1]);
+    dwithin_periods_append(periods, count, size, t1, t2,
+      intervals[2 * i] == 0.0 ? lower_inc : true,
+      intervals[2 * i + 1] == 1.0 ? upper_inc : true);
+    prev = intervals[2 * i + 1];
+  }
+  pfree(intervals);
+  return;
+}
+
+/**
+ * Returns the periods during which the temporal sequence point is within
+ * the distance of the geometry, or NULL if there are none
+ *
+ * @param[in] seq Temporal point
+ * @param[in] geo Geometry
+ * @param[in] edges Edges of the geometry, which are only needed for linear
+ * interpolation
+ * @param[in] dist Distance
+ * @pre The sequence is not instantaneous
+ */
+static PeriodSet *
+tdwithin_tpointseq_geo_periods(const TSequence *seq, Datum geo,
+  const DWithinEdges *edges, Datum dist)
+{
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  int size = seq->count, count = 0;
+  Period *periods = palloc(sizeof(Period) * size);
+  TInstant *inst1 = tsequence_inst_n(seq, 0);
+  Datum value1 = tinstant_value(inst1);
+  bool lower_inc = seq->period.lower_inc;
+  for (int i = 1; i < seq->count; i++)
+  {
+    TInstant *inst2 = tsequence_inst_n(seq, i);
+    Datum value2 = tinstant_value(inst2);
+    bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
+    /* Constant segment or step interpolation */
+    if (! linear || datum_point_eq(value1, value2))
+    {
+      if (DatumGetBool(geom_dwithin2d(value1, geo, dist)))
+        dwithin_periods_append(&periods, &count, &size, inst1->t, inst2->t,
+          lower_inc, linear ? upper_inc : false);
+    }
+    else
+      tdwithin_segment_geo(inst1, inst2, lower_inc, upper_inc, edges, geo,
+        DatumGetFloat8(dist), &periods, &count, &size);
+    inst1 = inst2;
+    value1 = value2;
+    lower_inc = true;
+  }
+  /* The last instant of a sequence with step interpolation */
+  if (! linear && seq->period.upper_inc &&
+    DatumGetBool(geom_dwithin2d(value1, geo, dist)))
+    dwithin_periods_append(&periods, &count, &size, inst1->t, inst1->t,
+      true, true);
+
+  PeriodSet *result = NULL;
+  if (count > 0)
+  {
+    Period **pers = palloc(sizeof(Period *) * count);
+    for (int i = 0; i < count; i++)
+      pers[i] = &periods[i];
+    result = periodset_make(pers, count, NORMALIZE);
+    pfree(pers);
+  }
+  pfree(periods);
+  return result;
+}
+
 /**
  * Returns a temporal Boolean that states at each instant whether the
  * temporal sequence set point and the geometry are within the given distance
  *
  * @param[in] seq Temporal point
  * @param[in] geo Geometry
+ * @param[in] edges Edges of the geometry
  * @param[in] dist Distance
  * @param[out] count Number of elements in the resulting array
  */
 static TSequence **
-tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
+tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, const DWithinEdges *edges,
+  Datum dist, int *count)
 {
   TSequence **result;
   /* Instantaneous sequence */
@@ -500,10 +967,8 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
     return result;
   }
 
-  /* Restrict to the buffered geometry */
-  Datum geo_buffer = call_function2(buffer, geo, dist);
-  int count1;
-  TSequence **atbuffer = tpointseq_at_geometry2(seq, geo_buffer, &count1);
+  /* Get the periods during which the value is true */
+  PeriodSet *ps = tdwithin_tpointseq_geo_periods(seq, geo, edges, dist);
   Datum datum_true = BoolGetDatum(true);
   Datum datum_false = BoolGetDatum(false);
   /* We create two temporal instants with arbitrary values that are set in
@@ -512,7 +977,7 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
   TInstant *instants[2];
   instants[0] = tinstant_make(datum_false, seq->period.lower, BOOLOID);
   instants[1] = tinstant_make(datum_false, seq->period.upper, BOOLOID);
-  if (atbuffer == NULL)
+  if (ps == NULL)
   {
     result = palloc(sizeof(TSequence *));
     /*  The two instant values created above are the ones needed here */
@@ -523,15 +988,6 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
     return result;
   }
 
-  /* Get the periods during which the value is true */
-  Period **periods = palloc(sizeof(Period *) * count1);
-  for (int i = 0; i < count1; i++)
-    periods[i] = &atbuffer[i]->period;
-  /* The period set must be normalized */
-  PeriodSet *ps = periodset_make(periods, count1, NORMALIZE);
-  for (int i = 0; i < count1; i++)
-    pfree(atbuffer[i]);
-  pfree(periods);
   /* Get the periods during which the value is false */
   PeriodSet *minus = minus_period_periodset_internal(&seq->period, ps);
   if (minus == NULL)
@@ -591,10 +1047,12 @@ tdwithin_tpointseq_geo1(TSequence *seq, Datum geo, Datum dist, int *count)
  * temporal sequence point and the geometry are within the given distance
  */
 static TSequenceSet *
-tdwithin_tpointseq_geo(TSequence *seq, Datum geo, Datum dist)
+tdwithin_tpointseq_geo(TSequence *seq, Datum geo, const DWithinEdges *edges,
+  Datum dist)
 {
   int count;
-  TSequence **sequences = tdwithin_tpointseq_geo1(seq, geo, dist, &count);
+  TSequence **sequences = tdwithin_tpointseq_geo1(seq, geo, edges, dist,
+    &count);
   return tsequenceset_make_free(sequences, count, NORMALIZE);
 }
 
@@ -603,11 +1061,13 @@ tdwithin_tpointseq_geo(TSequence *seq, Datum geo, Datum dist)
  * temporal sequence set point and the geometry are within the given distance
  */
 static TSequenceSet *
-tdwithin_tpointseqset_geo(TSequenceSet *ts, Datum geo, Datum dist)
+tdwithin_tpointseqset_geo(TSequenceSet *ts, Datum geo,
+  const DWithinEdges *edges, Datum dist)
 {
   /* Singleton sequence set */
   if (ts->count == 1)
-    return tdwithin_tpointseq_geo(tsequenceset_seq_n(ts, 0), geo, dist);
+    return tdwithin_tpointseq_geo(tsequenceset_seq_n(ts, 0), geo, edges,
+      dist);
 
   TSequence ***sequences = palloc(sizeof(TSequence *) * ts->count);
   int *countseqs = palloc0(sizeof(int) * ts->count);
@@ -615,7 +1075,8 @@ tdwithin_tpointseqset_geo(TSequenceSet *ts, Datum geo, Datum dist)
   for (int i = 0; i < ts->count; i++)
   {
     TSequence *seq = tsequenceset_seq_n(ts, i);
-    sequences[i] = tdwithin_tpointseq_geo1(seq, geo, dist, &countseqs[i]);
+    sequences[i] = tdwithin_tpointseq_geo1(seq, geo, edges, dist,
+      &countseqs[i]);
     totalseqs += countseqs[i];
   }
   TSequence **allsequences = tsequencearr2_to_tsequencearr(sequences,
@@ -872,37 +1333,50 @@ tdwithin_tpointseq_tpointseq1(Datum sv1, Datum ev1, Datum sv2, Datum ev2,
  * Returns the timestamps at which the segments of two temporal points are
  * within the given distance
  *
+ * The segments of the temporal points are synchronized one pair at a time
+ * while iterating, without constructing the synchronized temporal points.
+ *
  * @param[out] result Array on which the pointers of the newly constructed
  * sequences are stored
  * @param[in] seq1,seq2 Temporal points
  * @param[in] dist Distance
  * @param[in] func DWithin function (2D or 3D)
  * @result Number of elements in the resulting array
- * @pre The temporal points must be synchronized.
  */
 static int
 tdwithin_tpointseq_tpointseq2(TSequence **result, const TSequence *seq1,
   const TSequence *seq2, Datum dist, Datum (*func)(Datum, Datum, Datum))
 {
-  TInstant *start1 = tsequence_inst_n(seq1, 0);
-  TInstant *start2 = tsequence_inst_n(seq2, 0);
-  if (seq1->count == 1)
+  /* Test whether the bounding period of the two temporal points overlap */
+  Period *inter = intersection_period_period_internal(&seq1->period,
+    &seq2->period);
+  if (inter == NULL)
+    return 0;
+
+  /* If the two sequences intersect at an instant */
+  if (inter->lower == inter->upper)
   {
-    TInstant *inst = tinstant_make(func(tinstant_value(start1),
-      tinstant_value(start2), dist), start1->t, BOOLOID);
+    Datum value1, value2;
+    tsequence_value_at_timestamp(seq1, inter->lower, &value1);
+    tsequence_value_at_timestamp(seq2, inter->lower, &value2);
+    TInstant *inst = tinstant_make(func(value1, value2, dist), inter->lower,
+      BOOLOID);
     result[0] = tinstant_to_tsequence(inst, STEP);
-    pfree(inst);
+    pfree(DatumGetPointer(value1)); pfree(DatumGetPointer(value2));
+    pfree(inst); pfree(inter);
     return 1;
   }
 
+  TSequenceSyncIter iter;
+  tsequence_sync_init(&iter, seq1, seq2, inter);
   int k = 0;
-  bool linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
-  bool linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
+  bool linear1 = iter.linear1;
+  bool linear2 = iter.linear2;
   bool hasz = MOBDB_FLAGS_GET_Z(seq1->flags);
-  Datum sv1 = tinstant_value(start1);
-  Datum sv2 = tinstant_value(start2);
-  TimestampTz lower = start1->t;
-  bool lower_inc = seq1->period.lower_inc;
+  Datum sv1 = tinstant_value(iter.start1);
+  Datum sv2 = tinstant_value(iter.start2);
+  TimestampTz lower = inter->lower;
+  bool lower_inc = inter->lower_inc;
   const Datum datum_true = BoolGetDatum(true);
   const Datum datum_false = BoolGetDatum(false);
   /* We create three temporal instants with arbitrary values that are set in
@@ -912,15 +1386,13 @@ tdwithin_tpointseq_tpointseq2(TSequence **result, const TSequence *seq1,
   instants[0] = tinstant_make(datum_true, lower, BOOLOID);
   instants[1] = tinstant_copy(instants[0]);
   instants[2] = tinstant_copy(instants[0]);
-  for (int i = 1; i < seq1->count; i++)
+  while (tsequence_sync_next(&iter))
   {
-    /* Each iteration of the for loop adds between one and three sequences */
-    TInstant *end1 = tsequence_inst_n(seq1, i);
-    TInstant *end2 = tsequence_inst_n(seq2, i);
-    Datum ev1 = tinstant_value(end1);
-    Datum ev2 = tinstant_value(end2);
-    TimestampTz upper = end1->t;
-    bool upper_inc = (i == seq1->count - 1) ? seq1->period.upper_inc : false;
+    /* Each iteration of the loop adds between one and three sequences */
+    Datum ev1 = tinstant_value(iter.end1);
+    Datum ev2 = tinstant_value(iter.end2);
+    TimestampTz upper = iter.end1->t;
+    bool upper_inc = (upper == inter->upper) ? inter->upper_inc : false;
 
     /* Both segments are constant or have step interpolation */
     if ((datum_point_eq(sv1, ev1) && datum_point_eq(sv2, ev2)) ||
@@ -1000,6 +1472,8 @@ tdwithin_tpointseq_tpointseq2(TSequence **result, const TSequence *seq1,
     lower_inc = true;
   }
   pfree(instants[0]); pfree(instants[1]); pfree(instants[2]);
+  tsequence_sync_free(&iter);
+  pfree(inter);
   return k;
 }
 
@@ -1010,14 +1484,19 @@ tdwithin_tpointseq_tpointseq2(TSequence **result, const TSequence *seq1,
  * @param[in] seq1,seq2 Temporal points
  * @param[in] dist Distance
  * @param[in] func DWithin function (2D or 3D)
- * @pre The temporal points must be synchronized.
  */
 static TSequenceSet *
 tdwithin_tpointseq_tpointseq(const TSequence *seq1, const TSequence *seq2,
   Datum dist, Datum (*func)(Datum, Datum, Datum))
 {
-  TSequence **sequences = palloc(sizeof(TSequence *) * seq1->count * 4);
+  TSequence **sequences = palloc(sizeof(TSequence *) *
+    (seq1->count + seq2->count) * 4);
   int count = tdwithin_tpointseq_tpointseq2(sequences, seq1, seq2, dist, func);
+  if (count == 0)
+  {
+    pfree(sequences);
+    return NULL;
+  }
   return tsequenceset_make_free(sequences, count, NORMALIZE);
 }
 
@@ -1025,28 +1504,77 @@ tdwithin_tpointseq_tpointseq(const TSequence *seq1, const TSequence *seq2,
  * Returns the timestamps at which the segments of two temporal points are
  * within the given distance
  *
- * @param[in] ts1,ts2 Temporal points
+ * @param[in] ts,seq Temporal points
  * @param[in] dist Distance
  * @param[in] func DWithin function (2D or 3D)
- * @pre The temporal points must be synchronized.
  */
 static TSequenceSet *
-tdwithin_tpointseqset_tpointseqset(const TSequenceSet *ts1, const TSequenceSet *ts2, Datum dist,
-  Datum (*func)(Datum, Datum, Datum))
+tdwithin_tpointseqset_tpointseq(const TSequenceSet *ts, const TSequence *seq,
+  Datum dist, Datum (*func)(Datum, Datum, Datum))
 {
-  /* Singleton sequence set */
-  if (ts1->count == 1)
-    return tdwithin_tpointseq_tpointseq(tsequenceset_seq_n(ts1, 0),
-      tsequenceset_seq_n(ts2, 0), dist, func);
-
-  TSequence **sequences = palloc(sizeof(TSequence *) * ts1->totalcount * 4);
+  int loc;
+  tsequenceset_find_timestamp(ts, seq->period.lower, &loc);
+  TSequence **sequences = palloc(sizeof(TSequence *) *
+    (ts->totalcount + seq->count) * 4);
   int k = 0;
-  for (int i = 0; i < ts1->count; i++)
+  for (int i = loc; i < ts->count; i++)
+  {
+    TSequence *seq1 = tsequenceset_seq_n(ts, i);
+    k += tdwithin_tpointseq_tpointseq2(&sequences[k], seq1, seq, dist, func);
+    int cmp = timestamp_cmp_internal(seq->period.upper, seq1->period.upper);
+    if (cmp < 0 ||
+      (cmp == 0 && (!seq->period.upper_inc || seq1->period.upper_inc)))
+      break;
+  }
+  if (k == 0)
+  {
+    pfree(sequences);
+    return NULL;
+  }
+  return tsequenceset_make_free(sequences, k, NORMALIZE);
+}
+
+/**
+ * Returns the timestamps at which the segments of two temporal points are
+ * within the given distance
+ *
+ * @param[in] ts1,ts2 Temporal points
+ * @param[in] dist Distance
+ * @param[in] func DWithin function (2D or 3D)
+ */
+static TSequenceSet *
+tdwithin_tpointseqset_tpointseqset(const TSequenceSet *ts1,
+  const TSequenceSet *ts2, Datum dist, Datum (*func)(Datum, Datum, Datum))
+{
+  TSequence **sequences = palloc(sizeof(TSequence *) *
+    (ts1->totalcount + ts2->totalcount) * 4);
+  int i = 0, j = 0, k = 0;
+  while (i < ts1->count && j < ts2->count)
   {
     TSequence *seq1 = tsequenceset_seq_n(ts1, i);
-    TSequence *seq2 = tsequenceset_seq_n(ts2, i);
-    k += tdwithin_tpointseq_tpointseq2(&sequences[k], seq1, seq2, dist,
-      func);
+    TSequence *seq2 = tsequenceset_seq_n(ts2, j);
+    k += tdwithin_tpointseq_tpointseq2(&sequences[k], seq1, seq2, dist, func);
+    int cmp = timestamp_cmp_internal(seq1->period.upper, seq2->period.upper);
+    if (cmp == 0)
+    {
+      if (!seq1->period.upper_inc && seq2->period.upper_inc)
+        cmp = -1;
+      else if (seq1->period.upper_inc && !seq2->period.upper_inc)
+        cmp = 1;
+    }
+    if (cmp == 0)
+    {
+      i++; j++;
+    }
+    else if (cmp < 0)
+      i++;
+    else
+      j++;
+  }
+  if (k == 0)
+  {
+    pfree(sequences);
+    return NULL;
   }
   return tsequenceset_make_free(sequences, k, NORMALIZE);
 }
@@ -1097,6 +1625,8 @@ tspatialrel_geo_tpoint(FunctionCallInfo fcinfo, Datum (*func)(Datum, ...),
   if (gserialized_is_empty(gs))
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(1);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Datum param = (numparam == 3) ? PG_GETARG_DATUM(2) : (Datum) NULL;
   Temporal *result = tspatialrel_tpoint_geo1(temp, gs, param, func, numparam,
     restypid, INVERT, withZ);
@@ -1122,6 +1652,8 @@ tspatialrel_tpoint_geo(FunctionCallInfo fcinfo, Datum (*func)(Datum, ...),
   if (gserialized_is_empty(gs))
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(0);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Datum param = (numparam == 3) ? PG_GETARG_DATUM(2) : (Datum) NULL;
   Temporal *result = tspatialrel_tpoint_geo1(temp, gs, param, func, numparam,
     restypid, INVERT_NO, withZ);
@@ -1145,6 +1677,8 @@ tspatialrel_tpoint_tpoint(FunctionCallInfo fcinfo, Datum (*func)(Datum, ...),
 {
   Temporal *temp1 = PG_GETARG_TEMPORAL(0);
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Datum param = (numparam == 3) ? PG_GETARG_DATUM(2) : (Datum) NULL;
   ensure_same_srid_tpoint(temp1, temp2);
   if (withZ)
@@ -1268,6 +1802,8 @@ tdisjoint_geo_tpoint(PG_FUNCTION_ARGS)
   if (gserialized_is_empty(gs))
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(1);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *negresult = tintersects_tpoint_geo1(temp, gs);
   Temporal *result = tnot_tbool_internal(negresult);
   pfree(negresult);
@@ -1288,6 +1824,8 @@ tdisjoint_tpoint_geo(PG_FUNCTION_ARGS)
   if (gserialized_is_empty(gs))
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(0);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *negresult = tintersects_tpoint_geo1(temp, gs);
   Temporal *result = tnot_tbool_internal(negresult);
   pfree(negresult);
@@ -1385,6 +1923,8 @@ tintersects_geo_tpoint(PG_FUNCTION_ARGS)
   if (gserialized_is_empty(gs))
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(1);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *result = tintersects_tpoint_geo1(temp, gs);
   PG_FREE_IF_COPY(gs, 0);
   PG_FREE_IF_COPY(temp, 1);
@@ -1403,6 +1943,8 @@ tintersects_tpoint_geo(PG_FUNCTION_ARGS)
   if (gserialized_is_empty(gs))
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(0);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *result = tintersects_tpoint_geo1(temp, gs);
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(gs, 1);
@@ -1509,6 +2051,9 @@ twithin_tpoint_geo(PG_FUNCTION_ARGS)
 static Temporal *
 tdwithin_tpoint_geo_internal(const Temporal *temp, GSERIALIZED *gs, Datum dist)
 {
+  if (DatumGetFloat8(dist) < 0.0)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The distance cannot be negative")));
   ensure_same_srid_tpoint_gs(temp, gs);
   ensure_same_dimensionality_tpoint_gs(temp, gs);
   LiftedFunctionInfo lfinfo;
@@ -1525,12 +2070,20 @@ tdwithin_tpoint_geo_internal(const Temporal *temp, GSERIALIZED *gs, Datum dist)
   else if (temp->duration == INSTANTSET)
     result = (Temporal *)tfunc_tinstantset_base((TInstantSet *)temp,
       PointerGetDatum(gs), temp->valuetypid, dist, lfinfo);
-  else if (temp->duration == SEQUENCE)
-    result = (Temporal *)tdwithin_tpointseq_geo((TSequence *)temp,
-        PointerGetDatum(gs), dist);
-  else /* temp->duration == SEQUENCESET */
-    result = (Temporal *)tdwithin_tpointseqset_geo((TSequenceSet *)temp,
-        PointerGetDatum(gs), dist);
+  else
+  {
+    /* The edges of the geometry are indexed once for all the segments */
+    DWithinEdges *edges = MOBDB_FLAGS_GET_LINEAR(temp->flags) ?
+      dwithin_edges_make(PointerGetDatum(gs)) : NULL;
+    if (temp->duration == SEQUENCE)
+      result = (Temporal *)tdwithin_tpointseq_geo((TSequence *)temp,
+        PointerGetDatum(gs), edges, dist);
+    else /* temp->duration == SEQUENCESET */
+      result = (Temporal *)tdwithin_tpointseqset_geo((TSequenceSet *)temp,
+        PointerGetDatum(gs), edges, dist);
+    if (edges)
+      dwithin_edges_free(edges);
+  }
   return result;
 }
 
@@ -1547,6 +2100,8 @@ tdwithin_geo_tpoint(PG_FUNCTION_ARGS)
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(1);
   Datum dist = PG_GETARG_DATUM(2);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *result = tdwithin_tpoint_geo_internal(temp, gs, dist);
   PG_FREE_IF_COPY(gs, 0);
   PG_FREE_IF_COPY(temp, 1);
@@ -1566,6 +2121,8 @@ tdwithin_tpoint_geo(PG_FUNCTION_ARGS)
     PG_RETURN_NULL();
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   Datum dist = PG_GETARG_DATUM(2);
+  /* Store fcinfo into a global variable */
+  store_fcinfo(fcinfo);
   Temporal *result = tdwithin_tpoint_geo_internal(temp, gs, dist);
   PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(gs, 1);
@@ -1582,6 +2139,28 @@ static Temporal *
 tdwithin_tpoint_tpoint_internal(const Temporal *temp1, const Temporal *temp2,
   Datum dist)
 {
+  Datum (*func)(Datum, Datum, Datum);
+  if (MOBDB_FLAGS_GET_GEODETIC(temp1->flags))
+    func = &geog_dwithin;
+  else
+    func = MOBDB_FLAGS_GET_Z(temp1->flags) ? &geom_dwithin3d :
+      &geom_dwithin2d;
+
+  /* Temporal points with continuous duration are synchronized segment
+   * by segment while computing the result */
+  if (temp1->duration == SEQUENCE && temp2->duration == SEQUENCE)
+    return (Temporal *) tdwithin_tpointseq_tpointseq(
+      (TSequence *)temp1, (TSequence *)temp2, dist, func);
+  if (temp1->duration == SEQUENCESET && temp2->duration == SEQUENCE)
+    return (Temporal *) tdwithin_tpointseqset_tpointseq(
+      (TSequenceSet *)temp1, (TSequence *)temp2, dist, func);
+  if (temp1->duration == SEQUENCE && temp2->duration == SEQUENCESET)
+    return (Temporal *) tdwithin_tpointseqset_tpointseq(
+      (TSequenceSet *)temp2, (TSequence *)temp1, dist, func);
+  if (temp1->duration == SEQUENCESET && temp2->duration == SEQUENCESET)
+    return (Temporal *) tdwithin_tpointseqset_tpointseqset(
+      (TSequenceSet *)temp1, (TSequenceSet *)temp2, dist, func);
+
   Temporal *sync1, *sync2;
   /* Return false if the temporal points do not intersect in time
    * The operation is synchronization without adding crossings */
@@ -1589,12 +2168,6 @@ tdwithin_tpoint_tpoint_internal(const Temporal *temp1, const Temporal *temp2,
     &sync1, &sync2))
     return NULL;
 
-  Datum (*func)(Datum, Datum, Datum);
-  if (MOBDB_FLAGS_GET_GEODETIC(temp1->flags))
-    func = &geog_dwithin;
-  else
-    func = MOBDB_FLAGS_GET_Z(temp1->flags) ? &geom_dwithin3d :
-      &geom_dwithin2d;
   LiftedFunctionInfo lfinfo;
   lfinfo.func = (varfunc) func;
   lfinfo.numparam = 3;
@@ -1604,15 +2177,9 @@ tdwithin_tpoint_tpoint_internal(const Temporal *temp1, const Temporal *temp2,
   if (sync1->duration == INSTANT)
     result = (Temporal *)sync_tfunc_tinstant_tinstant(
       (TInstant *)sync1, (TInstant *)sync2, dist, lfinfo);
-  else if (sync1->duration == INSTANTSET)
+  else /* sync1->duration == INSTANTSET */
     result = (Temporal *)sync_tfunc_tinstantset_tinstantset(
       (TInstantSet *)sync1, (TInstantSet *)sync2, dist, lfinfo);
-  else if (sync1->duration == SEQUENCE)
-    result = (Temporal *)tdwithin_tpointseq_tpointseq(
-      (TSequence *)sync1, (TSequence *)sync2, dist, func);
-  else /* sync1->duration == SEQUENCESET */
-    result = (Temporal *)tdwithin_tpointseqset_tpointseqset(
-      (TSequenceSet *)sync1, (TSequenceSet *)sync2, dist, func);
 
   pfree(sync1); pfree(sync2);
   return result;
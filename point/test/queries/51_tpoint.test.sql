@@ -8,6 +8,7 @@ SELECT asText(tgeompoint 'Point(1 1)@2012-01-01 08:00:00');
 SELECT asText(tgeompoint '  Point(2 2)@2012-01-01 08:00:00  ');
 SELECT asText(tgeogpoint 'Point(1 1)@2012-01-01 08:00:00');
 SELECT asText(tgeogpoint '  Point(2 2) @ 2012-01-01 08:00:00  ');
+SELECT asText(tgeompoint ' Point Z (1 2 3) @ 2012-01-01 08:00:00 ');
 /* Errors */
 SELECT tgeompoint 'TRUE@2012-01-01 08:00:00';
 SELECT tgeogpoint 'ABC@2012-01-01 08:00:00';
@@ -67,6 +68,7 @@ SELECT asText(tgeogpoint '  { [ Point(1 1)@2001-01-01 08:00:00 , Point(2 2)@2001
  [ Point(1 1)@2001-01-01 09:00:00 , Point(2 2)@2001-01-01 09:05:00 , Point(1 1)@2001-01-01 09:06:00 ] } ');
 SELECT asText(tgeogpoint '{[Point(1 1)@2001-01-01 08:00:00,Point(2 2)@2001-01-01 08:05:00,Point(3 3)@2001-01-01 08:06:00],
  [Point(1 1)@2001-01-01 09:00:00,Point(2 2)@2001-01-01 09:05:00,Point(1 1)@2001-01-01 09:06:00]}');
+SELECT srid(tgeompoint '{[Point(1 1)@2001-01-01, Point(2 2)@2001-01-02], [SRID=5676;Point(1 1)@2001-01-03]}');
 
 /* Errors */
 SELECT tgeompoint '{[Point(1 1)@2001-01-01 08:00:00, Point(2 2)@2001-01-01 08:05:00, Point(3 3)@2001-01-01 08:06:00],
@@ -63,4 +63,13 @@ select asEWKT(fromEWKB(asEWKB(tgeompoint 'SRID=5676;Point(1 1 1)@2000-01-01', 'X
 /* Errors */
 select asEWKT(fromEWKB(asEWKB(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', 'ABC')));
 
+-----------------------------------------------------------------------
+
+SELECT tgeompointFromCompressed(compress(tgeompoint 'Point(1 2)@2000-01-01')) = tgeompoint 'Point(1 2)@2000-01-01';
+SELECT tgeompointFromCompressed(compress(tgeompoint '{Point(1 2)@2000-01-01, Point(3 4)@2000-01-02}')) = tgeompoint '{Point(1 2)@2000-01-01, Point(3 4)@2000-01-02}';
+SELECT tgeompointFromCompressed(compress(tgeompoint '[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02)')) = tgeompoint '[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02)';
+SELECT tgeompointFromCompressed(compress(tgeompoint 'SRID=5676;{[Point(1 2 3)@2000-01-01, Point(4 5 6)@2000-01-02],[Point(1 2 3)@2000-01-03, Point(4 5 6)@2000-01-04]}')) = tgeompoint 'SRID=5676;{[Point(1 2 3)@2000-01-01, Point(4 5 6)@2000-01-02],[Point(1 2 3)@2000-01-03, Point(4 5 6)@2000-01-04]}';
+SELECT tgeogpointFromCompressed(compress(tgeogpoint '[Point(1.5 2.5)@2000-01-01, Point(1.5 2.6)@2000-01-02]')) = tgeogpoint '[Point(1.5 2.5)@2000-01-01, Point(1.5 2.6)@2000-01-02]';
+SELECT srid(tgeompointFromCompressed(compress(tgeompoint 'SRID=5676;[Point(1 2)@2000-01-01, Point(3 4)@2000-01-02]'))) = 5676;
+
 ----------------------------------------------------------------------
\ No newline at end of file
@@ -87,6 +87,12 @@ select asEWKB(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', 'ABCD');
 
 -------------------------------------------------------------------------------
 
+SELECT substring(temporal_send(tgeompoint 'Point(1 1)@2000-01-01') from 14) = geometry_send(geometry 'Point(1 1)');
+SELECT substring(temporal_send(tgeompoint 'SRID=5676;Point(1 1 1)@2000-01-01') from 14) = geometry_send(geometry 'SRID=5676;Point(1 1 1)');
+SELECT substring(temporal_send(tgeogpoint 'Point(1 1)@2000-01-01') from 14) = geography_send(geography 'Point(1 1)');
+
+-------------------------------------------------------------------------------
+
 SELECT astext('{}'::geometry[]);
 
 -------------------------------------------------------------------------------
@@ -212,6 +212,13 @@ SELECT round(speed(tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.
 SELECT round(speed(tgeogpoint 'Interp=Stepwise;[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03]'), 6);
 SELECT round(speed(tgeogpoint 'Interp=Stepwise;{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}'), 6);
 
+SELECT round(length(tgeompoint '[Point(0 0)@2000-01-01, Point(86400 0)@2000-01-02, Point(86400 0)@2000-01-03]', period '[2000-01-01 12:00:00, 2000-01-02 12:00:00]')::numeric, 6);
+SELECT round(length(tgeompoint '[Point(0 0)@2000-01-01, Point(86400 0)@2000-01-02, Point(86400 0)@2000-01-03]', period '[2000-01-05, 2000-01-06]')::numeric, 6);
+SELECT round(length(tgeompoint '{Point(0 0)@2000-01-01, Point(86400 0)@2000-01-02}', period '[2000-01-01 12:00:00, 2000-01-01 18:00:00]')::numeric, 6);
+SELECT round(length(tgeompoint '{Point(0 0)@2000-01-01, Point(86400 0)@2000-01-02}', period '[2000-01-01 12:00:00, 2000-01-02 12:00:00]')::numeric, 6);
+SELECT speed(tgeompoint '[Point(0 0)@2000-01-01, Point(86400 0)@2000-01-02, Point(86400 0)@2000-01-03]', period '[2000-01-01 12:00:00, 2000-01-02 12:00:00]');
+SELECT speedAbove(tgeompoint '[Point(0 0)@2000-01-01, Point(86400 0)@2000-01-02, Point(86400 0)@2000-01-03]', period '[2000-01-01 12:00:00, 2000-01-02 12:00:00]', 0.5);
+
 -- 2D
 SELECT st_astext(twcentroid(tgeompoint 'Point(1 1)@2000-01-01'));
 SELECT st_astext(twcentroid(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}'));
@@ -279,6 +286,10 @@ SELECT round(degrees(azimuth(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000
 SELECT round(degrees(azimuth(tgeompoint '(Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(1 1)@2000-01-03, Point(0 0)@2000-01-04]')), 6);
 SELECT round(degrees(azimuth(tgeompoint '(Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(1 1)@2000-01-03, Point(0 0)@2000-01-04)')), 6);
 
+SELECT round(degrees(azimuth(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(1 1)@2000-01-03, Point(0 0)@2000-01-04]', period '[2000-01-01 12:00:00, 2000-01-03 12:00:00]')), 6);
+SELECT round(degrees(azimuth(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(1 1)@2000-01-03, Point(0 0)@2000-01-04]', period '[2000-01-02, 2000-01-03]')), 6);
+SELECT azimuth(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(4.5 4.5)@2000-01-05]}', period '[2000-01-01 12:00:00, 2000-01-04 12:00:00]') = azimuth(atPeriod(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(4.5 4.5)@2000-01-05]}', period '[2000-01-01 12:00:00, 2000-01-04 12:00:00]'));
+
 --------------------------------------------------------
 
 -- 2D
@@ -319,6 +330,9 @@ SELECT asText(atGeometry(tgeompoint '[Point(1 1)@2000-01-01]', geometry 'Linestr
 SELECT asText(atGeometry(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]}', geometry 'Linestring(0 1,1 2)'));
 SELECT asText(atGeometry(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02)', geometry 'Linestring(1 1,2 2)'));
 
+SELECT asText(startInstant(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((50.5 -1,51.5 -1,51.5 2,50.5 2,50.5 -1))'))) FROM generate_series(0, 99) i;
+SELECT asText(endInstant(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((50.5 -1,51.5 -1,51.5 2,50.5 2,50.5 -1))'))) FROM generate_series(0, 99) i;
+
 /* Errors */
 SELECT atGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Linestring(1 1,2 2)');
 SELECT atGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Linestring(1 1 1,2 2 2)');
@@ -358,6 +372,18 @@ SELECT asText(minusGeometry(tgeompoint '{[Point(1 1)@2000-01-01, Point(3 3)@2000
 SELECT minusGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Linestring(1 1,2 2)');
 SELECT minusGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Linestring(1 1 1,2 2 2)');
 
+SELECT round(length(tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05, Point(4 4)@2000-01-09]', geometry 'Polygon((1 -1,5 -1,5 2,1 2,1 -1))')::numeric, 6);
+SELECT round(length(tgeompoint '{[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02], [Point(2 0)@2000-01-03, Point(0 2)@2000-01-04]}', geometry 'Linestring(0 2,2 0)')::numeric, 6);
+SELECT round(length(tgeompoint '[Point(0 0 0)@2000-01-01, Point(4 0 4)@2000-01-05]', geometry 'Polygon((1 -1 0,3 -1 0,3 1 0,1 1 0,1 -1 0))')::numeric, 6);
+SELECT round(length(tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05, Point(4 4)@2000-01-09]', geometry 'Polygon empty')::numeric, 6);
+SELECT round(length(tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05, Point(4 4)@2000-01-09]', geometry 'Linestring(10 10,11 11)')::numeric, 6);
+SELECT round(length(tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05]', geometry 'Linestring(2 0,2 2)')::numeric, 6);
+SELECT round(length(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((50.5 -1,51.5 -1,51.5 2,50.5 2,50.5 -1))')::numeric, 6) =
+  round(length(atGeometry(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Polygon((50.5 -1,51.5 -1,51.5 2,50.5 2,50.5 -1))'))::numeric, 6) FROM generate_series(0, 99) i;
+/* Errors */
+SELECT length(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', geometry 'SRID=5676;Linestring(1 1,2 2)');
+SELECT length(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', geometry 'Linestring(1 1 1,2 2 2)');
+
 --------------------------------------------------------
 
 SELECT asText(atStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
@@ -369,6 +395,8 @@ SELECT asText(atStbox(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point
 
 SELECT asText(atStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX((1,1),(2,2))'));
 SELECT asText(atStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX T((,2000-01-01),(,2000-01-02))'));
+SELECT asText(atStbox(tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05]', 'STBOX((1,-1),(3,1))'));
+SELECT asText(atStbox(tgeompoint '[Point(0 0 0)@2000-01-01, Point(4 0 4)@2000-01-05]', 'STBOX Z((0,-1,1),(4,1,3))'));
 
 SELECT asText(minusStbox(tgeompoint 'Point(1 1)@2000-01-01', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
 SELECT asText(minusStbox(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
@@ -376,6 +404,7 @@ SELECT asText(minusStbox(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-
 SELECT asText(minusStbox(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
 SELECT asText(minusStbox(tgeompoint 'Interp=Stepwise;[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
 SELECT asText(minusStbox(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', 'STBOX T((1,1,2000-01-01),(2,2,2000-01-02))'));
+SELECT asText(minusStbox(tgeompoint '[Point(0 0)@2000-01-01, Point(4 0)@2000-01-05]', 'STBOX((1,-1),(3,1))'));
 
 /* Errors */
 SELECT asText(atStbox(tgeompoint 'SRID=4326;Point(1 1)@2000-01-01', 'GEODSTBOX T((1,1,1,2000-01-01),(2,2,2,2000-01-02))'));
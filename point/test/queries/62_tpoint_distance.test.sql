@@ -183,6 +183,8 @@ SELECT asText(NearestApproachInstant(tgeompoint 'Interp=Stepwise;[Point(1 1)@200
 SELECT asText(NearestApproachInstant(tgeompoint 'Interp=Stepwise;{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', geometry 'Linestring empty'));
 
 SELECT asText(NearestApproachInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(1 1)@2000-01-02]', geometry 'Linestring(1 1,3 3)'));
+SELECT asText(NearestApproachInstant(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Point(70.2 0.8)')) FROM generate_series(0, 99) i;
+SELECT asText(NearestApproachInstant(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), geometry 'Linestring(120 5,130 5)')) FROM generate_series(0, 99) i;
 
 SELECT asText(setPrecision(NearestApproachInstant(tgeogpoint 'Point(1.5 1.5)@2000-01-01', geography 'Linestring(0 0,3 3)'),6));
 SELECT asText(setPrecision(NearestApproachInstant(tgeogpoint '{Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03}', geography 'Linestring(0 0,3 3)'),6));
@@ -236,6 +238,8 @@ SELECT asText(NearestApproachInstant(tgeompoint '{[Point(1 1)@2000-01-01, Point(
 
 SELECT asText(NearestApproachInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02)', tgeompoint '[Point(3 3)@2000-01-01, Point(2 2)@2000-01-02)'));
 SELECT asText(NearestApproachInstant(tgeompoint '{[Point(0 0)@2000-01-01, Point(0 0)@2000-01-02], (Point(1 1)@2000-01-03, Point(0 0)@2000-01-04]}', tgeompoint '[Point(3 3)@2000-01-01, Point(3 3)@2000-01-02, Point(2 2)@2000-01-03, Point(3 3)@2000-01-04)'));
+SELECT asText(NearestApproachInstant(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(99 - i, 3), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)))) FROM generate_series(0, 99) i;
+SELECT asText(NearestApproachInstant(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-03]', tgeompoint '{[Point(5 0)@2000-01-01, Point(5 0)@2000-01-03), [Point(1 0)@2000-01-03, Point(5 0)@2000-01-05]}'));
 
 SELECT asText(NearestApproachInstant(tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint 'Point(2 2 2)@2000-01-01'));
 SELECT asText(NearestApproachInstant(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}', tgeompoint 'Point(2 2 2)@2000-01-01'));
@@ -402,6 +406,8 @@ SELECT round(NearestApproachDistance(tgeompoint 'Point(1 1)@2000-01-01', tgeompo
 SELECT round(NearestApproachDistance(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}', tgeompoint '{[Point(2 2)@2000-01-01, Point(1 1)@2000-01-02, Point(2 2)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}')::numeric, 6);
 SELECT round(NearestApproachDistance(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]', tgeompoint '{[Point(2 2)@2000-01-01, Point(1 1)@2000-01-02, Point(2 2)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}')::numeric, 6);
 SELECT round(NearestApproachDistance(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', tgeompoint '{[Point(2 2)@2000-01-01, Point(1 1)@2000-01-02, Point(2 2)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}')::numeric, 6);
+SELECT round(NearestApproachDistance(tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(i, i % 2), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)), tgeompointseq(array_agg(tgeompointinst(ST_MakePoint(99 - i, 3), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)))::numeric, 6) FROM generate_series(0, 99) i;
+SELECT round(NearestApproachDistance(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-03]', tgeompoint '{[Point(5 0)@2000-01-01, Point(5 0)@2000-01-03), [Point(1 0)@2000-01-03, Point(5 0)@2000-01-05]}')::numeric, 6);
 
 SELECT round(NearestApproachDistance(tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint 'Point(2 2 2)@2000-01-01')::numeric, 6);
 SELECT round(NearestApproachDistance(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}', tgeompoint 'Point(2 2 2)@2000-01-01')::numeric, 6);
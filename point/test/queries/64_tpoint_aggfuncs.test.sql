@@ -3,6 +3,13 @@
 SELECT asText(tcentroid(temp)) FROM (VALUES
 (NULL::tgeompoint),('Point(1 1)@2000-01-01'::tgeompoint),(NULL::tgeompoint)) t(temp);
 
+SELECT asText(tcentroid(temp)) FROM (VALUES 
+  (tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02}'),
+  (tgeompoint '{Point(3 3)@2000-01-01, Point(4 4)@2000-01-03}')) t(temp);
+SELECT asText(tcentroid(temp)) FROM (VALUES 
+  (tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-03]'),
+  (tgeompoint '[Point(2 0)@2000-01-02, Point(2 2)@2000-01-03]')) t(temp);
+
 SELECT asText(tcentroid(temp)) FROM (VALUES 
   (tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02)'),
   (tgeompoint '[Point(3 3)@2000-01-03, Point(4 4)@2000-01-04)'),
@@ -11,6 +18,10 @@ SELECT asText(tcentroid(temp)) FROM (VALUES
   (tgeompoint '[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02)'),
   (tgeompoint '[Point(3 3 3)@2000-01-03, Point(4 4 4)@2000-01-04)'),
   (tgeompoint '[Point(2 2 2)@2000-01-02, Point(3 3 3)@2000-01-03)')) t(temp);
+SELECT asText(tcentroid(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW)) FROM (VALUES
+  (1, tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-03]'),
+  (2, tgeompoint '[Point(2 0)@2000-01-01, Point(4 2)@2000-01-03]'),
+  (3, tgeompoint '[Point(4 0)@2000-01-01, Point(6 2)@2000-01-03]')) t(k, temp);
 
 /* Errors */
 SELECT asText(tcentroid(temp)) FROM (VALUES 
@@ -43,6 +54,10 @@ SELECT extent(temp) FROM (VALUES
   (tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02)'),
   (tgeompoint '[Point(3 3)@2000-01-03, Point(4 4)@2000-01-04)'),
   (tgeompoint '[Point(2 2)@2000-01-02, Point(3 3)@2000-01-03)')) t(temp);
+SELECT extent(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+  (1, tgeompoint '[Point(1 1)@2000-01-01, Point(3 3)@2000-01-03]'),
+  (2, tgeompoint '[Point(2 0)@2000-01-02, Point(2 4)@2000-01-04]'),
+  (3, tgeompoint '[Point(5 5)@2000-01-03, Point(6 6)@2000-01-05]')) t(k, temp);
 SELECT setprecision(extent(temp), 13) FROM (VALUES
   (tgeogpoint '[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02)'),
   (tgeogpoint '[Point(3 3 3)@2000-01-03, Point(4 4 4)@2000-01-04)'),
@@ -54,3 +69,42 @@ SELECT extent(temp) FROM (VALUES
   (tgeompoint 'Point(1 1)@2000-01-01')) t(temp);
 
 -------------------------------------------------------------------------------
+
+-------------------------------------------------------------------------------
+
+SELECT asText(tgeompointSeq(g, t ORDER BY t)) FROM (VALUES
+  (geometry 'Point(1 1)', timestamptz '2000-01-01'), ('Point(2 2)', '2000-01-02'),
+  ('Point(3 3)', '2000-01-03'), ('Point(1 1)', '2000-01-04')) t(g, t);
+SELECT asText(tgeompointSeq(g, t, interval '1 hour' ORDER BY t)) FROM (VALUES
+  (geometry 'Point(1 1)', timestamptz '2000-01-01 08:00'), ('Point(2 2)', '2000-01-01 08:30'),
+  ('Point(3 3)', '2000-01-01 10:00')) t(g, t);
+SELECT asText(tgeogpointSeq(g, t ORDER BY t)) FROM (VALUES
+  (geography 'Point(1 1)', timestamptz '2000-01-01'), ('Point(2 2)', '2000-01-02')) t(g, t);
+/* Errors */
+SELECT tgeompointSeq(g, t ORDER BY t) FROM (VALUES
+  (geometry 'Point(1 1)', timestamptz '2000-01-01'), ('Linestring(1 1,2 2)', '2000-01-02')) t(g, t);
+SELECT tgeompointSeq(g, t ORDER BY t) FROM (VALUES
+  (geometry 'Point(1 1)', timestamptz '2000-01-01'), ('Point(1 1 1)', '2000-01-02')) t(g, t);
+
+SELECT asText(appendInstant(inst ORDER BY getTimestamp(inst))) FROM (VALUES
+  (tgeompoint 'Point(1 1)@2000-01-01'), ('Point(2 2)@2000-01-02'), ('Point(3 3)@2000-01-03'),
+  ('Point(1 1)@2000-01-04')) t(inst);
+WITH temp(inst) AS (
+  SELECT tgeompointinst(ST_MakePoint(i % 10, (i * i) % 13), timestamptz '2000-01-01' + i * interval '1 hour')
+  FROM generate_series(1, 1000) i )
+SELECT appendInstant(inst ORDER BY getTimestamp(inst)) = tgeompointseq(array_agg(inst ORDER BY getTimestamp(inst)))
+FROM temp;
+WITH temp(inst) AS (
+  SELECT tgeompointinst(ST_MakePoint(i % 10, (i * i) % 13, i % 3), timestamptz '2000-01-01' + i * interval '1 hour')
+  FROM generate_series(1, 1000) i )
+SELECT ST_AsText(trajectory(appendInstant(inst ORDER BY getTimestamp(inst)))) =
+  ST_AsText(trajectory(tgeompointseq(array_agg(inst ORDER BY getTimestamp(inst)))))
+FROM temp;
+WITH temp(inst) AS (
+  SELECT tgeogpointinst(ST_MakePoint(i % 10, (i * i) % 13)::geography, timestamptz '2000-01-01' + i * interval '1 hour')
+  FROM generate_series(1, 1000) i )
+SELECT appendInstant(inst ORDER BY getTimestamp(inst)) = tgeogpointseq(array_agg(inst ORDER BY getTimestamp(inst)))
+FROM temp;
+/* Errors */
+SELECT appendInstant(inst) FROM (VALUES
+  (tgeompoint 'Point(1 1)@2000-01-01'), ('Point(1 1 1)@2000-01-02')) t(inst);
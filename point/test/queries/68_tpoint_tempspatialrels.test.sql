@@ -540,6 +540,9 @@ SELECT tdwithin(tgeompoint 'Point(1 1)@2000-01-01',  geometry 'Point(1 1)', 2);
 SELECT tdwithin(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}',  geometry 'Point(1 1)', 2);
 SELECT tdwithin(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]',  geometry 'Point(1 1)', 2);
 SELECT tdwithin(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}',  geometry 'Point(1 1)', 2);
+SELECT tdwithin(tgeompoint '[Point(0 0)@2000-01-01, Point(2 0)@2000-01-03]',  geometry 'Polygon((1 1,3 1,3 3,1 3,1 1))', 1);
+SELECT tdwithin(tgeompoint '[Point(5 5)@2000-01-01, Point(6 5)@2000-01-02]',  geometry 'Polygon((0 0,10 0,10 10,0 10,0 0))', 1);
+SELECT tdwithin(tgeompoint '[Point(50.2 5)@2000-01-01, Point(50.2 -5)@2000-01-11]', ST_MakeLine(array_agg(ST_MakePoint(i, i % 2) ORDER BY i)), 0.5) = tdwithin(tgeompoint '[Point(50.2 5)@2000-01-01, Point(50.2 -5)@2000-01-11]', geometry 'Linestring(49 1,50 0,51 1,52 0)', 0.5) FROM generate_series(0, 99) i;
 
 SELECT tdwithin(tgeompoint 'Point(1 1)@2000-01-01',  geometry 'Point empty', 2);
 SELECT tdwithin(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}',  geometry 'Point empty', 2);
@@ -579,6 +582,7 @@ SELECT tdwithin(tgeompoint '[Point(0 1)@2000-01-01, Point(0 0)@2000-01-02]', tge
 SELECT tdwithin(tgeompoint '[Point(1 1)@2000-01-01, Point(0 0)@2000-01-02]', tgeompoint '[Point(2 0)@2000-01-01, Point(1 1)@2000-01-02]', 1);
 SELECT tdwithin(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02]', tgeompoint '[Point(0 2)@2000-01-01, Point(1 3)@2000-01-02]', 1);
 SELECT tdwithin(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02]', tgeompoint '[Point(4 0)@2000-01-01, Point(3 1)@2000-01-02]', 0);
+SELECT tdwithin(tgeompoint '[Point(0 0)@2000-01-01, Point(0 0)@2000-01-03]', tgeompoint '[Point(3 0)@2000-01-02, Point(-1 0)@2000-01-04]', 2);
 
 SELECT tdwithin(tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint 'Point(1 1 1)@2000-01-01', 2);
 SELECT tdwithin(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}', tgeompoint 'Point(1 1 1)@2000-01-01', 2);
@@ -644,6 +648,8 @@ SELECT tdwithin(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Point(1
 SELECT tdwithin(tgeompoint 'SRID=5676;Point(1 1)@2000-01-01', tgeompoint 'Point(1 1)@2000-01-01', 2);
 SELECT tdwithin(geometry 'Point(1 1 1)', tgeompoint 'Point(1 1)@2000-01-01', 2);
 SELECT tdwithin(tgeompoint 'Point(1 1 1)@2000-01-01', geometry 'Point(1 1)', 2);
+SELECT tdwithin(geometry 'Point(1 1)', tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', -1);
+SELECT tdwithin(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', geometry 'Point(1 1)', -1);
 SELECT tdwithin(tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint 'Point(1 1)@2000-01-01', 2);
 
 SELECT tdwithin(tgeogpoint 'SRID=4283;Point(1 1)@2000-01-01', tgeogpoint 'Point(1.5 1.5)@2000-01-01', 2);
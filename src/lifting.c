@@ -951,25 +951,11 @@ static int
 sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
   const TSequence *seq2, Datum param, LiftedFunctionInfo lfinfo, Period *inter)
 {
-  /* This array keeps the new instants added for the synchronization */
-  TInstant **tofree = palloc(sizeof(TInstant *) *
-    (seq1->count + seq2->count) * 2);
-  TInstant *start1 = tsequence_inst_n(seq1, 0);
-  TInstant *start2 = tsequence_inst_n(seq2, 0);
-  int i = 1, j = 1, k = 0, l = 0;
-  /* Synchronize the start instant */
-  if (start1->t < inter->lower)
-  {
-    start1 = tsequence_at_timestamp(seq1, inter->lower);
-    tofree[l++] = start1;
-    i = tsequence_find_timestamp(seq1, inter->lower) + 1;
-  }
-  else if (start2->t < inter->lower)
-  {
-    start2 = tsequence_at_timestamp(seq2, inter->lower);
-    tofree[l++] = start2;
-    j = tsequence_find_timestamp(seq2, inter->lower) + 1;
-  }
+  TSequenceSyncIter iter;
+  tsequence_sync_init(&iter, seq1, seq2, inter);
+  TInstant *start1 = iter.start1;
+  TInstant *start2 = iter.start2;
+  int k = 0;
   bool lower_inc = inter->lower_inc;
   /* Compute the function at the start instant */
   Datum startvalue1 = tinstant_value(start1);
@@ -979,29 +965,11 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
   bool linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
   bool linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
   TInstant *instants[2];
-  while (i < seq1->count && j < seq2->count)
+  while (tsequence_sync_next(&iter))
   {
     /* Each iteration of the loop adds between one and three sequences */
-    TInstant *end1 = tsequence_inst_n(seq1, i);
-    TInstant *end2 = tsequence_inst_n(seq2, j);
-    /* Synchronize the instants */
-    int cmp = timestamp_cmp_internal(end1->t, end2->t);
-    if (cmp == 0)
-    {
-      i++; j++;
-    }
-    else if (cmp < 0)
-    {
-      i++;
-      end2 = tsequence_at_timestamp1(start2, end2, linear2, end1->t);
-      tofree[l++] = end2;
-    }
-    else
-    {
-      j++;
-      end1 = tsequence_at_timestamp1(start1, end1, linear1, end2->t);
-      tofree[l++] = end1;
-    }
+    TInstant *end1 = iter.end1;
+    TInstant *end2 = iter.end2;
     /* Compute the function at the end instant */
     Datum endvalue1 = tinstant_value(end1);
     Datum endvalue2 = tinstant_value(end2);
@@ -1120,10 +1088,9 @@ sync_tfunc_tsequence_tsequence2(TSequence **result, const TSequence *seq1,
     startresult = endresult;
     lower_inc = true;
   }
+  DATUM_FREE(startresult, lfinfo.restypid);
+  tsequence_sync_free(&iter);
   pfree(inter);
-  for (int i = 0; i < l; i++)
-    pfree(tofree[i]);
-  pfree(tofree);
   return k;
 }
 
@@ -1151,60 +1118,32 @@ sync_tfunc_tsequence_tsequence3(TSequence **result, const TSequence *seq1,
    * where X, I, and * are values computed, respectively at synchronization points,
    * intermediate points, and common points
    */
-  TInstant *inst1 = tsequence_inst_n(seq1, 0);
-  TInstant *inst2 = tsequence_inst_n(seq2, 0);
-  TInstant *tofreeinst = NULL;
-  int i = 0, j = 0, k = 0, l = 0;
-  if (inst1->t < inter->lower)
-  {
-    inst1 = tsequence_at_timestamp(seq1, inter->lower);
-    tofreeinst = inst1;
-    i = tsequence_find_timestamp(seq1, inter->lower);
-  }
-  else if (inst2->t < inter->lower)
-  {
-    inst2 = tsequence_at_timestamp(seq2, inter->lower);
-    tofreeinst = inst2;
-    j = tsequence_find_timestamp(seq2, inter->lower);
-  }
-  int count = (seq1->count - i + seq2->count - j) * 2;
+  TSequenceSyncIter iter;
+  tsequence_sync_init(&iter, seq1, seq2, inter);
+  int count = (seq1->count + seq2->count) * 2;
   TInstant **instants = palloc(sizeof(TInstant *) * count);
-  TInstant **tofree = palloc(sizeof(TInstant *) * count);
-  if (tofreeinst != NULL)
-    tofree[l++] = tofreeinst;
-  TInstant *prev1, *prev2;
+  int k = 0;
   Datum value;
   TimestampTz intertime;
-  bool linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
-  bool linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
-  while (i < seq1->count && j < seq2->count &&
-    (inst1->t <= inter->upper || inst2->t <= inter->upper))
+  bool linear1 = iter.linear1;
+  bool linear2 = iter.linear2;
+  /* Compute the function at the start instant */
+  value = tfunc_base_base(tinstant_value(iter.start1),
+    tinstant_value(iter.start2), seq1->valuetypid, seq2->valuetypid, param,
+    lfinfo);
+  instants[k++] = tinstant_make(value, iter.start1->t, lfinfo.restypid);
+  DATUM_FREE(value, lfinfo.restypid);
+  while (tsequence_sync_next(&iter))
   {
-    int cmp = timestamp_cmp_internal(inst1->t, inst2->t);
-    if (cmp == 0)
-    {
-      i++; j++;
-    }
-    else if (cmp < 0)
+    /* Compute the function on the potential intermediate point before
+       adding the new instants */
+    if (lfinfo.tpfunc != NULL &&
+      lfinfo.tpfunc(iter.start1, iter.end1, iter.start2, iter.end2,
+        &intertime))
     {
-      i++;
-      inst2 = tsequence_at_timestamp(seq2, inst1->t);
-      tofree[l++] = inst2;
-    }
-    else
-    {
-      j++;
-      inst1 = tsequence_at_timestamp(seq1, inst2->t);
-      tofree[l++] = inst1;
-    }
-    /* If not the first instant compute the function on the potential
-       intermediate point before adding the new instants */
-    if (lfinfo.tpfunc != NULL && k > 0 &&
-      lfinfo.tpfunc(prev1, inst1, prev2, inst2, &intertime))
-    {
-      Datum inter1 = tsequence_value_at_timestamp1(prev1, inst1,
+      Datum inter1 = tsequence_value_at_timestamp1(iter.start1, iter.end1,
         linear1, intertime);
-      Datum inter2 = tsequence_value_at_timestamp1(prev2, inst2,
+      Datum inter2 = tsequence_value_at_timestamp1(iter.start2, iter.end2,
         linear2, intertime);
       value = tfunc_base_base(inter1, inter2, seq1->valuetypid,
         seq2->valuetypid, param, lfinfo);
@@ -1213,34 +1152,27 @@ sync_tfunc_tsequence_tsequence3(TSequence **result, const TSequence *seq1,
       DATUM_FREE(inter2, seq2->valuetypid);
       DATUM_FREE(value, lfinfo.restypid);
     }
-    Datum value1 = tinstant_value(inst1);
-    Datum value2 = tinstant_value(inst2);
-    value = tfunc_base_base(value1, value2, seq1->valuetypid,
-      seq2->valuetypid, param, lfinfo);
-    instants[k++] = tinstant_make(value, inst1->t, lfinfo.restypid);
+    value = tfunc_base_base(tinstant_value(iter.end1),
+      tinstant_value(iter.end2), seq1->valuetypid, seq2->valuetypid, param,
+      lfinfo);
+    instants[k++] = tinstant_make(value, iter.end1->t, lfinfo.restypid);
     DATUM_FREE(value, lfinfo.restypid);
-    if (i == seq1->count || j == seq2->count)
-      break;
-    prev1 = inst1; prev2 = inst2;
-    inst1 = tsequence_inst_n(seq1, i);
-    inst2 = tsequence_inst_n(seq2, j);
   }
+  tsequence_sync_free(&iter);
   /* We are sure that k != 0 due to the period intersection test above */
   /* The last two values of sequences with step interpolation and
      exclusive upper bound must be equal */
   if (!lfinfo.reslinear && !inter->upper_inc && k > 1)
   {
-    tofree[l++] = instants[k - 1];
+    TInstant *last = instants[k - 1];
     value = tinstant_value(instants[k - 2]);
-    instants[k - 1] = tinstant_make(value, instants[k - 1]->t, lfinfo.restypid);
+    instants[k - 1] = tinstant_make(value, last->t, lfinfo.restypid);
+    pfree(last);
   }
 
-  for (i = 0; i < l; i++)
-    pfree(tofree[i]);
-  pfree(tofree); pfree(inter);
-
   result[0] = tsequence_make_free(instants, k, inter->lower_inc,
     inter->upper_inc, lfinfo.reslinear, NORMALIZE);
+  pfree(inter);
   return 1;
 }
 
@@ -1260,90 +1192,55 @@ static int
 sync_tfunc_tsequence_tsequence4(TSequence **result, const TSequence *seq1,
   const TSequence *seq2, Datum param, LiftedFunctionInfo lfinfo, Period *inter)
 {
-  /* This array keeps the new instants added for the synchronization */
-  TInstant **tofree = palloc(sizeof(TInstant *) *
-    (seq1->count + seq2->count) * 2);
-  TInstant *start1 = tsequence_inst_n(seq1, 0);
-  TInstant *start2 = tsequence_inst_n(seq2, 0);
-  int i = 1, j = 1, k = 0, l = 0;
-  /* Synchronize the start instant */
-  if (start1->t < inter->lower)
-  {
-    start1 = tsequence_at_timestamp(seq1, inter->lower);
-    tofree[l++] = start1;
-    i = tsequence_find_timestamp(seq1, inter->lower) + 1;
-  }
-  else if (start2->t < inter->lower)
-  {
-    start2 = tsequence_at_timestamp(seq2, inter->lower);
-    tofree[l++] = start2;
-    j = tsequence_find_timestamp(seq2, inter->lower) + 1;
-  }
+  TSequenceSyncIter iter;
+  tsequence_sync_init(&iter, seq1, seq2, inter);
+  int k = 0;
   bool lower_inc = inter->lower_inc;
-  bool linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
-  bool linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
+  bool linear1 = iter.linear1;
+  bool linear2 = iter.linear2;
   TInstant *instants[2];
   Datum startvalue1, startvalue2, startresult;
   /* Each iteration of the loop adds one sequence */
-  while (i < seq1->count && j < seq2->count)
+  while (tsequence_sync_next(&iter))
   {
+    TInstant *start1 = iter.start1;
+    TInstant *start2 = iter.start2;
     /* Compute the function at the start instant */
     startvalue1 = tinstant_value(start1);
     startvalue2 = tinstant_value(start2);
     startresult = tfunc_base_base(startvalue1, startvalue2,
       seq1->valuetypid, seq2->valuetypid, param, lfinfo);
-    /* Synchronize the instants */
-    TInstant *end1 = tsequence_inst_n(seq1, i);
-    TInstant *end2 = tsequence_inst_n(seq2, j);
-    int cmp = timestamp_cmp_internal(end1->t, end2->t);
-    if (cmp == 0)
-    {
-      i++; j++;
-    }
-    else if (cmp < 0)
-    {
-      i++;
-      end2 = tsequence_at_timestamp1(start2, end2, linear2, end1->t);
-      tofree[l++] = end2;
-    }
-    else
-    {
-      j++;
-      end1 = tsequence_at_timestamp1(start1, end1, linear1, end2->t);
-      tofree[l++] = end1;
-    }
     /* Compute the function at the end instant */
-    Datum endvalue1 = linear1 ? tinstant_value(end1) : startvalue1;
-    Datum endvalue2 = linear2 ? tinstant_value(end2) : startvalue2;
+    Datum endvalue1 = linear1 ? tinstant_value(iter.end1) : startvalue1;
+    Datum endvalue2 = linear2 ? tinstant_value(iter.end2) : startvalue2;
     Datum endresult = tfunc_base_base(endvalue1, endvalue2, seq1->valuetypid,
       seq2->valuetypid, param, lfinfo);
     instants[0] = tinstant_make(startresult, start1->t, lfinfo.restypid);
-    instants[1] = tinstant_make(endresult, end1->t, lfinfo.restypid);
+    instants[1] = tinstant_make(endresult, iter.end1->t, lfinfo.restypid);
     result[k++] = tsequence_make(instants, 2, lower_inc, false,
       lfinfo.reslinear, NORMALIZE_NO);
     pfree(instants[0]); pfree(instants[1]);
     DATUM_FREE(startresult, lfinfo.restypid);
     DATUM_FREE(endresult, lfinfo.restypid);
-    start1 = end1; start2 = end2;
     lower_inc = true;
-    }
+  }
 
   /* Add extra final point if any */
   if (inter->upper_inc)
   {
-    startvalue1 = tinstant_value(start1);
-    startvalue2 = tinstant_value(start2);
+    TInstant *end1 = iter.end1 != NULL ? iter.end1 : iter.start1;
+    TInstant *end2 = iter.end2 != NULL ? iter.end2 : iter.start2;
+    startvalue1 = tinstant_value(end1);
+    startvalue2 = tinstant_value(end2);
     startresult = tfunc_base_base(startvalue1, startvalue2,
       seq1->valuetypid, seq2->valuetypid, param, lfinfo);
-    instants[0] = tinstant_make(startresult, start1->t, lfinfo.restypid);
+    instants[0] = tinstant_make(startresult, end1->t, lfinfo.restypid);
     result[k++] = tinstant_to_tsequence(instants[0], lfinfo.reslinear);
     pfree(instants[0]);
     DATUM_FREE(startresult, lfinfo.restypid);
   }
+  tsequence_sync_free(&iter);
   pfree(inter);
-  for (int i = 0; i < l; i++)
-    pfree(tofree[i]);
-  pfree(tofree);
   return k;
 }
 
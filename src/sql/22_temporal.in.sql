@@ -195,6 +195,36 @@ CREATE CAST (tint AS tint) WITH FUNCTION tint(tint, integer) AS IMPLICIT;
 CREATE CAST (tfloat AS tfloat) WITH FUNCTION tfloat(tfloat, integer) AS IMPLICIT;
 CREATE CAST (ttext AS ttext) WITH FUNCTION ttext(ttext, integer) AS IMPLICIT;
 
+/******************************************************************************
+ * Compression
+ ******************************************************************************/
+
+CREATE FUNCTION compress(tbool)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tint)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tfloat)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_compress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tboolFromCompressed(bytea)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'temporal_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tintFromCompressed(bytea)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tfloatFromCompressed(bytea)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'temporal_decompress'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /******************************************************************************
  * Constructors
  ******************************************************************************/
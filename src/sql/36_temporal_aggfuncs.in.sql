@@ -22,17 +22,45 @@ CREATE OR REPLACE FUNCTION temporal_extent_combinefn(period, period)
   RETURNS period
   AS 'MODULE_PATHNAME'
   LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mtransfn(internal, tbool)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mtransfn(internal, ttext)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_minvfn(internal, tbool)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_minvfn(internal, ttext)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mfinalfn(internal)
+  RETURNS period
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE extent(tbool) (
   SFUNC = temporal_extent_transfn,
   STYPE = period,
   COMBINEFUNC = temporal_extent_combinefn,
+  MSFUNC = temporal_extent_mtransfn,
+  MINVFUNC = temporal_extent_minvfn,
+  MSTYPE = internal,
+  MFINALFUNC = temporal_extent_mfinalfn,
   PARALLEL = safe
 );
 CREATE AGGREGATE extent(ttext) (
   SFUNC = temporal_extent_transfn,
   STYPE = period,
   COMBINEFUNC = temporal_extent_combinefn,
+  MSFUNC = temporal_extent_mtransfn,
+  MINVFUNC = temporal_extent_minvfn,
+  MSTYPE = internal,
+  MFINALFUNC = temporal_extent_mfinalfn,
   PARALLEL = safe
 );
 
@@ -48,17 +76,45 @@ CREATE OR REPLACE FUNCTION tnumber_extent_combinefn(tbox, tbox)
   RETURNS tbox
   AS 'MODULE_PATHNAME'
   LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mtransfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_mtransfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_minvfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION temporal_extent_minvfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME'
+  LANGUAGE 'c' IMMUTABLE PARALLEL SAFE;
+CREATE OR REPLACE FUNCTION tnumber_extent_mfinalfn(internal)
+  RETURNS tbox
+  AS 'MODULE_PATHNAME', 'temporal_extent_mfinalfn'
+  LANGUAGE 'c' IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE extent(tint) (
   SFUNC = tnumber_extent_transfn,
   STYPE = tbox,
   COMBINEFUNC = tnumber_extent_combinefn,
+  MSFUNC = temporal_extent_mtransfn,
+  MINVFUNC = temporal_extent_minvfn,
+  MSTYPE = internal,
+  MFINALFUNC = tnumber_extent_mfinalfn,
   PARALLEL = safe
 );
 CREATE AGGREGATE extent(tfloat) (
   SFUNC = tnumber_extent_transfn,
   STYPE = tbox,
   COMBINEFUNC = tnumber_extent_combinefn,
+  MSFUNC = temporal_extent_mtransfn,
+  MINVFUNC = temporal_extent_minvfn,
+  MSTYPE = internal,
+  MFINALFUNC = tnumber_extent_mfinalfn,
   PARALLEL = safe
 );
 
@@ -74,10 +130,39 @@ CREATE FUNCTION tagg_deserialize(bytea, internal)
   AS 'MODULE_PATHNAME', 'temporal_tagg_deserialize'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tcount_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_tcount_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tcount_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_tcount_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tcount_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tavg_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_tavg_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tavg_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tavg_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION tcount_transfn(internal, tbool)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tbool)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tcount_combinefn(internal, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_combinefn'
@@ -111,9 +196,13 @@ CREATE AGGREGATE tcount(tbool) (
   SFUNC = tcount_transfn,
   STYPE = internal,
   COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  FINALFUNC = tcount_finalfn,
+  SERIALFUNC = tcount_serialize,
+  DESERIALFUNC = tcount_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcount_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tand(tbool) (
@@ -165,10 +254,18 @@ CREATE FUNCTION tcount_transfn(internal, tint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tavg_transfn(internal, tint)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tnumber_tavg_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_invfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_tavg_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tavg_combinefn(internal, internal)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tnumber_tavg_combinefn'
@@ -177,6 +274,10 @@ CREATE FUNCTION tavg_finalfn(internal)
   RETURNS tfloat
   AS 'MODULE_PATHNAME', 'tnumber_tavg_finalfn'
   LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tint_tsum_mfinalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'tint_tsum_mfinalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE tmin(tint) (
   SFUNC = tint_tmin_transfn,
@@ -203,15 +304,23 @@ CREATE AGGREGATE tsum(tint) (
   FINALFUNC = tint_tagg_finalfn,
   SERIALFUNC = tagg_serialize,
   DESERIALFUNC = tagg_deserialize,
+  MSFUNC = tavg_transfn,
+  MINVFUNC = tavg_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tint_tsum_mfinalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tint) (
   SFUNC = tcount_transfn,
   STYPE = internal,
   COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  FINALFUNC = tcount_finalfn,
+  SERIALFUNC = tcount_serialize,
+  DESERIALFUNC = tcount_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcount_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tavg(tint) (
@@ -219,8 +328,12 @@ CREATE AGGREGATE tavg(tint) (
   STYPE = internal,
   COMBINEFUNC = tavg_combinefn,
   FINALFUNC = tavg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  SERIALFUNC = tavg_serialize,
+  DESERIALFUNC = tavg_deserialize,
+  MSFUNC = tavg_transfn,
+  MINVFUNC = tavg_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tavg_finalfn,
   PARALLEL = SAFE
 );
 
@@ -252,6 +365,10 @@ CREATE FUNCTION tcount_transfn(internal, tfloat)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tfloat_tagg_finalfn(internal)
   RETURNS tfloat
   AS 'MODULE_PATHNAME', 'temporal_tagg_finalfn'
@@ -260,6 +377,14 @@ CREATE FUNCTION tavg_transfn(internal, tfloat)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'tnumber_tavg_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_invfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_tavg_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloat_tsum_mfinalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tfloat_tsum_mfinalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE tmin(tfloat) (
   SFUNC = tfloat_tmin_transfn,
@@ -286,15 +411,23 @@ CREATE AGGREGATE tsum(tfloat) (
   FINALFUNC = tfloat_tagg_finalfn,
   SERIALFUNC = tagg_serialize,
   DESERIALFUNC = tagg_deserialize,
+  MSFUNC = tavg_transfn,
+  MINVFUNC = tavg_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tfloat_tsum_mfinalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tfloat) (
   SFUNC = tcount_transfn,
   STYPE = internal,
   COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  FINALFUNC = tcount_finalfn,
+  SERIALFUNC = tcount_serialize,
+  DESERIALFUNC = tcount_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcount_finalfn,
   PARALLEL = SAFE
 );
 CREATE AGGREGATE tavg(tfloat) (
@@ -302,8 +435,12 @@ CREATE AGGREGATE tavg(tfloat) (
   STYPE = internal,
   COMBINEFUNC = tavg_combinefn,
   FINALFUNC = tavg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  SERIALFUNC = tavg_serialize,
+  DESERIALFUNC = tavg_deserialize,
+  MSFUNC = tavg_transfn,
+  MINVFUNC = tavg_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tavg_finalfn,
   PARALLEL = SAFE
 );
  
@@ -329,6 +466,10 @@ CREATE FUNCTION tcount_transfn(internal, ttext)
   RETURNS internal
   AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
   LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invfn(internal, ttext)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_invfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION ttext_tagg_finalfn(internal)
   RETURNS ttext
   AS 'MODULE_PATHNAME', 'temporal_tagg_finalfn'
@@ -356,9 +497,399 @@ CREATE AGGREGATE tcount(ttext) (
   SFUNC = tcount_transfn,
   STYPE = internal,
   COMBINEFUNC = tcount_combinefn,
-  FINALFUNC = tint_tagg_finalfn,
-  SERIALFUNC = tagg_serialize,
-  DESERIALFUNC = tagg_deserialize,
+  FINALFUNC = tcount_finalfn,
+  SERIALFUNC = tcount_serialize,
+  DESERIALFUNC = tcount_deserialize,
+  MSFUNC = tcount_transfn,
+  MINVFUNC = tcount_invfn,
+  MSTYPE = internal,
+  MFINALFUNC = tcount_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregates building a temporal sequence (set) from the values and the
+ * timestamps of the rows, which must be given in increasing order of time,
+ * e.g., tfloatSeq(val, t ORDER BY t). With an interval argument, a new
+ * sequence is started when two consecutive rows are separated by more than
+ * the interval and the result is a sequence set.
+ *****************************************************************************/
+
+CREATE FUNCTION tbool_seq_transfn(internal, boolean, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tbool_seq_transfn(internal, boolean, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tbool_seq_finalfn(internal)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'temporal_seq_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tboolSeq(boolean, timestamptz) (
+  SFUNC = tbool_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tbool_seq_finalfn,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tboolSeq(boolean, timestamptz, interval) (
+  SFUNC = tbool_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tbool_seq_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tint_seq_transfn(internal, integer, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_seq_transfn(internal, integer, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_seq_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_seq_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tintSeq(integer, timestamptz) (
+  SFUNC = tint_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tint_seq_finalfn,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tintSeq(integer, timestamptz, interval) (
+  SFUNC = tint_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tint_seq_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tfloat_seq_transfn(internal, float, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloat_seq_transfn(internal, float, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloat_seq_finalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'temporal_seq_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tfloatSeq(float, timestamptz) (
+  SFUNC = tfloat_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tfloat_seq_finalfn,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tfloatSeq(float, timestamptz, interval) (
+  SFUNC = tfloat_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = tfloat_seq_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION ttext_seq_transfn(internal, text, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION ttext_seq_transfn(internal, text, timestamptz, interval)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_seq_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION ttext_seq_finalfn(internal)
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'temporal_seq_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE ttextSeq(text, timestamptz) (
+  SFUNC = ttext_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = ttext_seq_finalfn,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE ttextSeq(text, timestamptz, interval) (
+  SFUNC = ttext_seq_transfn,
+  STYPE = internal,
+  FINALFUNC = ttext_seq_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregates building a temporal sequence by appending the instants of the
+ * rows, which must be given in increasing order of time, e.g.,
+ * appendInstant(inst ORDER BY getTimestamp(inst)).
+ *****************************************************************************/
+
+CREATE FUNCTION tbool_append_transfn(internal, tbool)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_append_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tbool_append_finalfn(internal)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'temporal_append_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE appendInstant(tbool) (
+  SFUNC = tbool_append_transfn,
+  STYPE = internal,
+  FINALFUNC = tbool_append_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tint_append_transfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_append_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_append_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_append_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE appendInstant(tint) (
+  SFUNC = tint_append_transfn,
+  STYPE = internal,
+  FINALFUNC = tint_append_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION tfloat_append_transfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_append_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloat_append_finalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'temporal_append_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE appendInstant(tfloat) (
+  SFUNC = tfloat_append_transfn,
+  STYPE = internal,
+  FINALFUNC = tfloat_append_finalfn,
+  PARALLEL = SAFE
+);
+
+CREATE FUNCTION ttext_append_transfn(internal, ttext)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_append_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION ttext_append_finalfn(internal)
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'temporal_append_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE appendInstant(ttext) (
+  SFUNC = ttext_append_transfn,
+  STYPE = internal,
+  FINALFUNC = ttext_append_finalfn,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregates computing the temporal count or the temporal average for each
+ * bucket of a fixed width starting at an origin, e.g.,
+ * tavgBucket(temp, '1 hour', '2000-01-01'). The result is a step temporal
+ * value that has for each bucket the aggregated value on the bucket.
+ *****************************************************************************/
+
+CREATE FUNCTION bucket_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_bucket_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION bucket_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_bucket_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION bucket_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_bucket_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tcount_bucket_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tavg_bucket_finalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'tnumber_tavg_bucket_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tcount_bucket_transfn(internal, tbool, interval, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_bucket_transfn(internal, tint, interval, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_bucket_transfn(internal, tfloat, interval, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_bucket_transfn(internal, ttext, interval, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_tcount_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_bucket_transfn(internal, tint, interval, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_tavg_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_bucket_transfn(internal, tfloat, interval, timestamptz)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'tnumber_tavg_bucket_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE tcountBucket(tbool, interval, timestamptz) (
+  SFUNC = tcount_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tcount_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountBucket(tint, interval, timestamptz) (
+  SFUNC = tcount_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tcount_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountBucket(tfloat, interval, timestamptz) (
+  SFUNC = tcount_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tcount_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tcountBucket(ttext, interval, timestamptz) (
+  SFUNC = tcount_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tcount_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tavgBucket(tint, interval, timestamptz) (
+  SFUNC = tavg_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tavg_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE tavgBucket(tfloat, interval, timestamptz) (
+  SFUNC = tavg_bucket_transfn,
+  STYPE = internal,
+  COMBINEFUNC = bucket_combinefn,
+  FINALFUNC = tavg_bucket_finalfn,
+  SERIALFUNC = bucket_serialize,
+  DESERIALFUNC = bucket_deserialize,
+  PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregate merging temporal values that do not overlap on time, e.g., the
+ * fragments of a trip kept in different partitions. The result is a
+ * sequence set, instants are merged as instantaneous sequences.
+ *****************************************************************************/
+
+CREATE FUNCTION merge_combinefn(internal, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_combinefn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION merge_serialize(internal)
+  RETURNS bytea
+  AS 'MODULE_PATHNAME', 'temporal_merge_serialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge_deserialize(bytea, internal)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_deserialize'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge_transfn(internal, tbool)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tbool_merge_finalfn(internal)
+  RETURNS tbool
+  AS 'MODULE_PATHNAME', 'temporal_merge_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge_transfn(internal, tint)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_merge_finalfn(internal)
+  RETURNS tint
+  AS 'MODULE_PATHNAME', 'temporal_merge_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge_transfn(internal, tfloat)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloat_merge_finalfn(internal)
+  RETURNS tfloat
+  AS 'MODULE_PATHNAME', 'temporal_merge_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge_transfn(internal, ttext)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'temporal_merge_transfn'
+  LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION ttext_merge_finalfn(internal)
+  RETURNS ttext
+  AS 'MODULE_PATHNAME', 'temporal_merge_finalfn'
+  LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE merge(tbool) (
+  SFUNC = merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = merge_combinefn,
+  FINALFUNC = tbool_merge_finalfn,
+  SERIALFUNC = merge_serialize,
+  DESERIALFUNC = merge_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE merge(tint) (
+  SFUNC = merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = merge_combinefn,
+  FINALFUNC = tint_merge_finalfn,
+  SERIALFUNC = merge_serialize,
+  DESERIALFUNC = merge_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE merge(tfloat) (
+  SFUNC = merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = merge_combinefn,
+  FINALFUNC = tfloat_merge_finalfn,
+  SERIALFUNC = merge_serialize,
+  DESERIALFUNC = merge_deserialize,
+  PARALLEL = SAFE
+);
+CREATE AGGREGATE merge(ttext) (
+  SFUNC = merge_transfn,
+  STYPE = internal,
+  COMBINEFUNC = merge_combinefn,
+  FINALFUNC = ttext_merge_finalfn,
+  SERIALFUNC = merge_serialize,
+  DESERIALFUNC = merge_deserialize,
   PARALLEL = SAFE
 );
 
@@ -950,20 +950,22 @@ temporal_out(PG_FUNCTION_ARGS)
  *
  * @param[in] temp Temporal value
  * @param[in] buf Buffer
+ * @param[in] flinfo Information of the calling send function, whose
+ * fn_extra caches the send function of the base type
  */
 void
-temporal_write(Temporal *temp, StringInfo buf)
+temporal_write(Temporal *temp, StringInfo buf, FmgrInfo *flinfo)
 {
   pq_sendbyte(buf, (uint8) temp->duration);
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT)
-    tinstant_write((TInstant *) temp, buf);
+    tinstant_write((TInstant *) temp, buf, flinfo);
   else if (temp->duration == INSTANTSET)
-    tinstantset_write((TInstantSet *) temp, buf);
+    tinstantset_write((TInstantSet *) temp, buf, flinfo);
   else if (temp->duration == SEQUENCE)
-    tsequence_write((TSequence *) temp, buf);
+    tsequence_write((TSequence *) temp, buf, flinfo);
   else /* temp->duration == SEQUENCESET */
-    tsequenceset_write((TSequenceSet *) temp, buf);
+    tsequenceset_write((TSequenceSet *) temp, buf, flinfo);
   return;
 }
 
@@ -977,7 +979,7 @@ temporal_send(PG_FUNCTION_ARGS)
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   StringInfoData buf;
   pq_begintypsend(&buf);
-  temporal_write(temp, &buf) ;
+  temporal_write(temp, &buf, fcinfo->flinfo) ;
   PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
@@ -988,21 +990,23 @@ temporal_send(PG_FUNCTION_ARGS)
  *
  * @param[in] buf Buffer
  * @param[in] valuetypid Oid of the base type
+ * @param[in] flinfo Information of the calling receive function, whose
+ * fn_extra caches the receive function of the base type
  */
 Temporal *
-temporal_read(StringInfo buf, Oid valuetypid)
+temporal_read(StringInfo buf, Oid valuetypid, FmgrInfo *flinfo)
 {
   int16 type = (int16) pq_getmsgbyte(buf);
   Temporal *result;
   ensure_valid_duration(type);
   if (type == INSTANT)
-    result = (Temporal *) tinstant_read(buf, valuetypid);
+    result = (Temporal *) tinstant_read(buf, valuetypid, flinfo);
   else if (type == INSTANTSET)
-    result = (Temporal *) tinstantset_read(buf, valuetypid);
+    result = (Temporal *) tinstantset_read(buf, valuetypid, flinfo);
   else if (type == SEQUENCE)
-    result = (Temporal *) tsequence_read(buf, valuetypid);
+    result = (Temporal *) tsequence_read(buf, valuetypid, flinfo);
   else /* type == SEQUENCESET */
-    result = (Temporal *) tsequenceset_read(buf, valuetypid);
+    result = (Temporal *) tsequenceset_read(buf, valuetypid, flinfo);
   return result;
 }
 
@@ -1016,7 +1020,7 @@ temporal_recv(PG_FUNCTION_ARGS)
   StringInfo buf = (StringInfo)PG_GETARG_POINTER(0);
   Oid temptypid = PG_GETARG_OID(1);
   Oid valuetypid = temporal_valuetypid(temptypid);
-  Temporal *result = temporal_read(buf, valuetypid) ;
+  Temporal *result = temporal_read(buf, valuetypid, fcinfo->flinfo) ;
   PG_RETURN_POINTER(result);
 }
 
@@ -1240,7 +1244,7 @@ temporal_append_tinstant(PG_FUNCTION_ARGS)
       (TInstant *)inst);
   else if (temp->duration == SEQUENCE)
     result = (Temporal *)tsequence_append_tinstant((TSequence *)temp,
-      (TInstant *)inst);
+      (TInstant *)inst, false);
   else /* temp->duration == SEQUENCESET */
     result = (Temporal *)tsequenceset_append_tinstant((TSequenceSet *)temp,
       (TInstant *)inst);
@@ -1962,6 +1966,119 @@ temporal_bbox(void *box, const Temporal *temp)
   return;
 }
 
+/**
+ * Size of the largest prefix of a temporal value containing its header and
+ * its bounding box, which is obtained for temporal points of sequence
+ * duration
+ */
+#define TEMPORAL_PREFIX_SIZE \
+  (double_pad(sizeof(TSequence)) + double_pad(sizeof(STBOX)))
+
+/**
+ * Returns true if fetching a prefix of the toasted temporal value avoids
+ * detoasting it completely
+ */
+static bool
+temporal_slice_worthwhile(Datum tempdatum)
+{
+  struct varlena *attr = (struct varlena *) DatumGetPointer(tempdatum);
+  if (VARATT_IS_EXTERNAL_ONDISK(attr))
+  {
+#if MOBDB_PGSQL_VERSION < 130000
+    /* Before PostgreSQL 13 a slice of a compressed external value requires
+     * to fetch and decompress the whole value */
+    struct varatt_external toast_pointer;
+    VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+    return ! VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer);
+#else
+    return true;
+#endif
+  }
+#if MOBDB_PGSQL_VERSION >= 120000
+  /* Since PostgreSQL 12 only the prefix of a compressed value is
+   * decompressed when a slice is requested */
+  return VARATT_IS_COMPRESSED(attr);
+#else
+  return false;
+#endif
+}
+
+/**
+ * Set the first argument to the bounding box of the temporal value given
+ * as a datum
+ *
+ * When the value is toasted, only the prefix of the value containing the
+ * header and the bounding box is fetched instead of detoasting the whole
+ * value. Since the bounding box follows the fixed-size header, the size of
+ * this prefix only depends on the type of the value. This makes bounding box
+ * operators and index support functions independent of the number of
+ * instants of the value.
+ */
+void
+temporal_bbox_slice(Datum tempdatum, void *box)
+{
+  Temporal *temp;
+  if (temporal_slice_worthwhile(tempdatum))
+  {
+    temp = (Temporal *) PG_DETOAST_DATUM_SLICE(tempdatum, 0,
+      TEMPORAL_PREFIX_SIZE);
+    /* The values written by previous versions keep the bounding box after
+     * the instants or the sequences */
+    if (temp->duration != INSTANT && MOBDB_FLAGS_GET_PREFIXBOX(temp->flags))
+    {
+      memcpy(box, temporal_bbox_ptr(temp),
+        temporal_bbox_size(temp->valuetypid));
+      pfree(temp);
+      return;
+    }
+    pfree(temp);
+  }
+  temp = (Temporal *) PG_DETOAST_DATUM(tempdatum);
+  temporal_bbox(box, temp);
+  if ((Pointer) temp != DatumGetPointer(tempdatum))
+    pfree(temp);
+  return;
+}
+
+/**
+ * Set the first argument to the bounding period of the temporal value given
+ * as a datum, fetching only a prefix of the value when it is toasted
+ *
+ * @note The period of a sequence is kept in its header. For the other
+ * durations, the period can only be obtained from the bounding box of
+ * temporal alphanumeric types since the bounding boxes of the other types
+ * do not keep the inclusive/exclusive bounds.
+ */
+void
+temporal_period_slice(Datum tempdatum, Period *p)
+{
+  Temporal *temp;
+  if (temporal_slice_worthwhile(tempdatum))
+  {
+    temp = (Temporal *) PG_DETOAST_DATUM_SLICE(tempdatum, 0,
+      TEMPORAL_PREFIX_SIZE);
+    if (temp->duration == SEQUENCE)
+    {
+      tsequence_period(p, (TSequence *) temp);
+      pfree(temp);
+      return;
+    }
+    if (temp->duration != INSTANT && MOBDB_FLAGS_GET_PREFIXBOX(temp->flags) &&
+        talpha_base_type(temp->valuetypid))
+    {
+      memcpy(p, temporal_bbox_ptr(temp), sizeof(Period));
+      pfree(temp);
+      return;
+    }
+    pfree(temp);
+  }
+  temp = (Temporal *) PG_DETOAST_DATUM(tempdatum);
+  temporal_period(p, temp);
+  if ((Pointer) temp != DatumGetPointer(tempdatum))
+    pfree(temp);
+  return;
+}
+
 PG_FUNCTION_INFO_V1(tnumber_to_tbox);
 /**
  * Returns the bounding box of the temporal value
@@ -4088,15 +4205,13 @@ temporal_intersects_timestampset(PG_FUNCTION_ARGS)
   PG_RETURN_BOOL(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_intersects_period);
 /**
  * Returns true if the temporal value intersects the period
+ * (dispatch function)
  */
-PGDLLEXPORT Datum
-temporal_intersects_period(PG_FUNCTION_ARGS)
+bool
+temporal_intersects_period_internal(const Temporal *temp, const Period *p)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
-  Period *p = PG_GETARG_PERIOD(1);
   bool result;
   ensure_valid_duration(temp->duration);
   if (temp->duration == INSTANT)
@@ -4107,6 +4222,19 @@ temporal_intersects_period(PG_FUNCTION_ARGS)
     result = tsequence_intersects_period((TSequence *)temp, p);
   else /* temp->duration == SEQUENCESET */
     result = tsequenceset_intersects_period((TSequenceSet *)temp, p);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_intersects_period);
+/**
+ * Returns true if the temporal value intersects the period
+ */
+PGDLLEXPORT Datum
+temporal_intersects_period(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  Period *p = PG_GETARG_PERIOD(1);
+  bool result = temporal_intersects_period_internal(temp, p);
   PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_BOOL(result);
 }
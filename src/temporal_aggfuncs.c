@@ -17,8 +17,8 @@
 #include <string.h>
 #include <catalog/pg_collation.h>
 #include <libpq/pqformat.h>
+#include <utils/builtins.h>
 #include <utils/timestamp.h>
-#include <executor/spi.h>
 #include <gsl/gsl_rng.h>
 
 #include "period.h"
@@ -29,6 +29,7 @@
 #include "tbool_boolops.h"
 #include "temporal_boxops.h"
 #include "doublen.h"
+#include "tpoint_spatialfuncs.h"
 
 static TInstant **
 tinstant_tagg(TInstant **instants1, int count1, TInstant **instants2, 
@@ -65,54 +66,63 @@ unset_aggregation_context(MemoryContext ctx)
 }
 
 /**
- * Allocate memory for the skiplist
+ * Returns the forward pointers of an element of the skiplist
+ *
+ * @note The pointer is no longer valid after allocating a new element
  */
-static int
-skiplist_alloc(FunctionCallInfo fcinfo, SkipList *list)
+static inline int *
+skiplist_next(const SkipList *list, int cur)
 {
-  list->length ++;
-  if (! list->freecount)
-  {
-    /* No free list, give first available entry */
-    if (list->next >= list->capacity)
-    {
-      /* No more capacity, let's grow */
-      list->capacity <<= SKIPLIST_GROW;
-      MemoryContext ctx = set_aggregation_context(fcinfo);
-      list->elems = repalloc(list->elems, sizeof(Elem) * list->capacity);
-      unset_aggregation_context(ctx);
-    }
-    list->next ++;
-    return list->next - 1;
-  }
-  else 
-  {
-    list->freecount --;
-    return list->freed[list->freecount];
-  }
+  return &list->levels[list->elems[cur].levels];
 }
 
 /**
- * Free memory for the skiplist
+ * Allocate an element of the given height in the skiplist
  */
-static void
-skiplist_free(FunctionCallInfo fcinfo, SkipList *list, int cur)
+static int
+skiplist_alloc(FunctionCallInfo fcinfo, SkipList *list, int height)
 {
-  if (! list->freed)
+  list->length ++;
+  int result = list->freed[height - 1];
+  if (result != -1)
   {
-    list->freecap = SKIPLIST_INITIAL_FREELIST;
+    /* Reuse a freed element of the same height, which are chained through
+     * their first forward pointer */
+    list->freed[height - 1] = skiplist_next(list, result)[0];
+    return result;
+  }
+  if (list->next >= list->capacity)
+  {
+    /* No more capacity, let's grow */
+    list->capacity <<= SKIPLIST_GROW;
     MemoryContext ctx = set_aggregation_context(fcinfo);
-    list->freed = palloc(sizeof(int) * list->freecap);
+    list->elems = repalloc(list->elems, sizeof(Elem) * list->capacity);
     unset_aggregation_context(ctx);
   }
-  else if (list->freecount == list->freecap)
+  if (list->levelnext + height > list->levelcap)
   {
-    list->freecap <<= 1;
+    while (list->levelnext + height > list->levelcap)
+      list->levelcap <<= SKIPLIST_GROW;
     MemoryContext ctx = set_aggregation_context(fcinfo);
-    list->freed = repalloc(list->freed, sizeof(int) * list->freecap);
+    list->levels = repalloc(list->levels, sizeof(int) * list->levelcap);
     unset_aggregation_context(ctx);
   }
-  list->freed[list->freecount ++] = cur;
+  result = list->next ++;
+  list->elems[result].height = height;
+  list->elems[result].levels = list->levelnext;
+  list->levelnext += height;
+  return result;
+}
+
+/**
+ * Free an element of the skiplist
+ */
+static void
+skiplist_free(SkipList *list, int cur)
+{
+  int height = list->elems[cur].height;
+  skiplist_next(list, cur)[0] = list->freed[height - 1];
+  list->freed[height - 1] = cur;
   list->length --;
   return;
 }
@@ -194,6 +204,7 @@ skiplist_print(const SkipList *list)
   while (cur != -1)
   {
     Elem *e = &list->elems[cur];
+    int *next = skiplist_next(list, cur);
     len += sprintf(buf+len, "\telm%d [label=\"", cur);
     for (int l = e->height - 1; l > 0; l --)
     {
@@ -204,19 +215,18 @@ skiplist_print(const SkipList *list)
     else
       len += sprintf(buf+len, "<p0>%f\"];\n", 
         DatumGetFloat8(temporal_min_value_internal(e->value)));
-    if (e->next[0] != -1)
+    if (next[0] != -1)
     {
       for (int l = 0; l < e->height; l ++)
       {
-        int next = e->next[l];
-        len += sprintf(buf+len, "\telm%d:p%d -> elm%d:p%d ", cur, l, next, l);
+        len += sprintf(buf+len, "\telm%d:p%d -> elm%d:p%d ", cur, l, next[l], l);
         if (l == 0)
           len += sprintf(buf+len, "[weight=100];\n");
         else
           len += sprintf(buf+len, ";\n");
       }
     }
-    cur = e->next[0];
+    cur = next[0];
   }
   sprintf(buf+len, "}\n");
   ereport(WARNING, (errcode(ERRCODE_WARNING), errmsg("SKIPLIST: %s", buf)));
@@ -251,7 +261,8 @@ static long int gsl_random48()
 static int
 random_level()
 {
-  return ffsl(~(gsl_random48() & ((1l << SKIPLIST_MAXLEVEL) - 1)));
+  int result = ffsl(~(gsl_random48() & ((1l << SKIPLIST_MAXLEVEL) - 1)));
+  return Min(result, SKIPLIST_MAXLEVEL);
 }
 
 /**
@@ -280,6 +291,32 @@ skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
   result->length = count - 2;
   result->extra = NULL;
   result->extrasize = 0;
+  for (int level = 0; level < SKIPLIST_MAXLEVEL; level ++)
+    result->freed[level] = -1;
+
+  /* Compute the height of the elements in the balanced list. The head and 
+   * the tail reserve all levels since their height changes afterwards */
+  int levelcount = 0;
+  for (int i = 0; i < count; i ++)
+  {
+    int h = height;
+    if (i != 0 && i != count - 1)
+    {
+      h = 1;
+      while (h < height && i % (1 << h) == 0)
+        h ++;
+    }
+    result->elems[i].height = h;
+    result->elems[i].levels = levelcount;
+    levelcount += (i == 0 || i == count - 1) ? SKIPLIST_MAXLEVEL : h;
+  }
+  /* The average height of the elements is 2 */
+  int levelcap = capacity << 1;
+  while (levelcap <= levelcount)
+    levelcap <<= 1;
+  result->levels = palloc0(sizeof(int) * levelcap);
+  result->levelcap = levelcap;
+  result->levelnext = levelcount;
 
   /* Fill values first */
   result->elems[0].value = NULL;
@@ -295,18 +332,12 @@ skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
     for (int i = 0; i < count; i += step)
     {
       int next = i + step < count ? i + step : count - 1;
-      if (i != count - 1)
-      {
-        result->elems[i].next[level] = next;
-        result->elems[i].height = level + 1;
-      }
-      else
-      {
-        result->elems[i].next[level] = - 1;
-        result->elems[i].height = height;
-      }
+      skiplist_next(result, i)[level] = (i != count - 1) ? next : -1;
     }
+    /* Last element of the level before the tail */
+    result->finger[level] = ((count - 2) >> level) << level;
   }
+  result->fingered = true;
   unset_aggregation_context(oldctx);
   return result;
 }
@@ -317,7 +348,7 @@ skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
 Temporal *
 skiplist_headval(SkipList *list)
 {
-  return list->elems[list->elems[0].next[0]].value;
+  return list->elems[skiplist_next(list, 0)[0]].value;
 }
 
 /*  Function not currently used
@@ -326,11 +357,10 @@ skiplist_tailval(SkipList *list)
 {
   // Despite the look, this is pretty much O(1)
   int cur = 0;
-  Elem *e = &list->elems[cur];
-  int height = e->height;
-  while (e->next[height - 1] != list->tail)
-    e = &list->elems[e->next[height - 1]];
-  return e->value;
+  int height = list->elems[cur].height;
+  while (skiplist_next(list, cur)[height - 1] != list->tail)
+    cur = skiplist_next(list, cur)[height - 1];
+  return list->elems[cur].value;
 }
 */
 
@@ -341,12 +371,12 @@ Temporal **
 skiplist_values(SkipList *list)
 {
   Temporal **result = palloc(sizeof(Temporal *) * list->length);
-  int cur = list->elems[0].next[0];
+  int cur = skiplist_next(list, 0)[0];
   int count = 0;
   while (cur != list->tail)
   {
     result[count++] = list->elems[cur].value;
-    cur = list->elems[cur].next[0];
+    cur = skiplist_next(list, cur)[0];
   }
   return result;
 }
@@ -355,6 +385,14 @@ skiplist_values(SkipList *list)
  * Splice the skiplist with the array of temporal values using the aggregation 
  * function
  *
+ * When the values arrive ordered by time, they are spliced at the end of the
+ * list. The search then starts from the finger of the list, that is, the
+ * last element of each level, and climbs the levels until it finds an
+ * element before the values. This makes the search depend on the number of
+ * elements overlapping the values rather than on the length of the list.
+ * The finger is invalidated when the values are spliced elsewhere and is
+ * restored by the next splice at the end of the list.
+ *
  * @param[in] fcinfo Catalog information about the external function
  * @param[inout] list Skiplist
  * @param[in] values Array of temporal values
@@ -387,35 +425,52 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
   memset(update, 0, sizeof(update));
   int cur = 0;
   int height = list->elems[cur].height;
-  Elem *e = &list->elems[cur];
-  for (int level = height - 1; level >= 0; level --)
+  int start = height - 1;
+  if (list->fingered)
+  {
+    int level = 0;
+    while (level < height &&
+      skiplist_elmpos(list, list->finger[level], period.lower) != AFTER)
+      level ++;
+    if (level < height)
+    {
+      for (int l = level; l < height; l ++)
+        update[l] = list->finger[l];
+      cur = list->finger[level];
+      start = level - 1;
+    }
+  }
+  int *next = skiplist_next(list, cur);
+  for (int level = start; level >= 0; level --)
   {
-    while (e->next[level] != -1 && 
-      skiplist_elmpos(list, e->next[level], period.lower) == AFTER)
+    while (next[level] != -1 && 
+      skiplist_elmpos(list, next[level], period.lower) == AFTER)
     {
-      cur = e->next[level];
-      e = &list->elems[cur];
+      cur = next[level];
+      next = skiplist_next(list, cur);
     }
     update[level] = cur;
   }
 
-  int lower = e->next[0];
+  int lower = next[0];
   cur = lower;
-  e = &list->elems[cur];
+  next = skiplist_next(list, cur);
 
   int spliced_count = 0;
   while (skiplist_elmpos(list, cur, period.upper) == AFTER)
   {
-    cur = e->next[0];
-    e = &list->elems[cur];
+    cur = next[0];
+    next = skiplist_next(list, cur);
     spliced_count ++;
   }
   int upper = cur;
   if (upper >= 0 && skiplist_elmpos(list, upper, period.upper) == DURING)
   {
-    upper = e->next[0]; /* if found upper, one more to remove */
+    upper = next[0]; /* if found upper, one more to remove */
     spliced_count ++;
   }
+  /* The values are spliced at the end of the list */
+  bool attail = (upper == list->tail);
 
   /* Delete spliced-out elements but remember their values for later */
   cur = lower;
@@ -423,22 +478,25 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
   spliced_count = 0;
   while (cur != upper && cur != -1)
   {
+    next = skiplist_next(list, cur);
     for (int level = 0; level < height; level ++)
     {
-      Elem *prev = &list->elems[update[level]];
-      if (prev->next[level] != cur)
+      int *prev = skiplist_next(list, update[level]);
+      if (prev[level] != cur)
         break;
-      prev->next[level] = list->elems[cur].next[level];
+      prev[level] = next[level];
     }
     spliced[spliced_count++] = list->elems[cur].value;
-    skiplist_free(fcinfo, list, cur);
-    cur = list->elems[cur].next[0];
+    int succ = next[0];
+    skiplist_free(list, cur);
+    cur = succ;
   }
 
   /* Level down head & tail if necessary */
   Elem *head = &list->elems[0];
   Elem *tail = &list->elems[list->tail];
-  while (head->height > 1 && head->next[head->height - 1] == list->tail)
+  while (head->height > 1 && 
+    skiplist_next(list, 0)[head->height - 1] == list->tail)
   {
     head->height--;
     tail->height--;
@@ -462,7 +520,9 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
     pfree(spliced);
   }
 
-  /* Insert new elements */
+  /* Insert new elements. Since they are inserted backwards, the first new
+   * element of each level is the last one of the level */
+  int fingerlevel = 0;
   for (int i = count - 1; i >= 0; i--)
   {
     int rheight = random_level();
@@ -471,28 +531,40 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
       for (int l = height; l < rheight; l ++)
         update[l] = 0;
       /* Grow head and tail as appropriate */
-      head->height = rheight;
-      tail->height = rheight;
+      list->elems[0].height = rheight;
+      list->elems[list->tail].height = rheight;
     }
-    int new = skiplist_alloc(fcinfo, list);
-    Elem *newelm = &list->elems[new];
+    int new = skiplist_alloc(fcinfo, list, rheight);
     MemoryContext ctx = set_aggregation_context(fcinfo);
-    newelm->value = temporal_copy(values[i]);
+    list->elems[new].value = temporal_copy(values[i]);
     unset_aggregation_context(ctx);
-    newelm->height = rheight;
 
+    int *newnext = skiplist_next(list, new);
     for (int level = 0; level < rheight; level ++)
     {
-      newelm->next[level] = list->elems[update[level]].next[level];
-      list->elems[update[level]].next[level] = new;
+      int *prev = skiplist_next(list, update[level]);
+      newnext[level] = prev[level];
+      prev[level] = new;
       if (level >= height && update[0] != list->tail)
       {
-        newelm->next[level] = list->tail;
+        newnext[level] = list->tail;
       }
     }
+    if (attail)
+    {
+      for (int level = fingerlevel; level < rheight; level ++)
+        list->finger[level] = new;
+      fingerlevel = Max(fingerlevel, rheight);
+    }
     if (rheight > height)
       height = rheight;
   }
+  if (attail)
+  {
+    for (int level = fingerlevel; level < height; level ++)
+      list->finger[level] = update[level];
+  }
+  list->fingered = attail;
 
   if (spliced_count != 0)
   {
@@ -616,6 +688,12 @@ datum_sum_double4(Datum l, Datum r)
 /**
  * Writes the state value into the buffer
  *
+ * The temporal values are copied as they are laid out in memory since the
+ * state is only exchanged between the processes of a parallel aggregation.
+ * Each value starts at a maximally aligned offset from the start of the
+ * buffer so that the values can be used in place when reading the state
+ * from a maximally aligned copy of the buffer.
+ *
  * @param[in] state State
  * @param[in] buf Buffer
  */
@@ -627,20 +705,17 @@ aggstate_write(SkipList *state, StringInfo buf)
   pq_sendint(buf, (uint32) state->length, 4);
 #else
   pq_sendint32(buf, (uint32) state->length);
-#endif
-  Oid valuetypid = InvalidOid;
-  if (state->length > 0)
-    valuetypid = values[0]->valuetypid;
-#if MOBDB_PGSQL_VERSION < 110000
-  pq_sendint(buf, valuetypid, 4);
-#else
-  pq_sendint32(buf, valuetypid);
 #endif
   for (int i = 0; i < state->length; i ++)
   {
-    SPI_connect();
-    temporal_write(values[i], buf);
-    SPI_finish();
+    int padding = MAXALIGN(buf->len) - buf->len;
+    if (padding)
+    {
+      enlargeStringInfo(buf, padding);
+      memset(buf->data + buf->len, 0, padding);
+      buf->len += padding;
+    }
+    appendBinaryStringInfo(buf, (char *) values[i], VARSIZE(values[i]));
   }
   pq_sendint64(buf, state->extrasize);
   if (state->extra)
@@ -649,20 +724,42 @@ aggstate_write(SkipList *state, StringInfo buf)
   return;
 }
 
+/**
+ * Returns the serialized state value or a maximally aligned copy of it.
+ * A bytea is only guaranteed to be int aligned, e.g., when it is not
+ * detoasted, while the values it contains are read in place.
+ *
+ * @param[in] data Serialized state value
+ */
+static bytea *
+aggstate_bytea_align(bytea *data)
+{
+  if ((uintptr_t) data == MAXALIGN(data))
+    return data;
+  bytea *result = palloc(VARSIZE(data));
+  memcpy(result, data, VARSIZE(data));
+  return result;
+}
+
 /**
  * Reads the state value from the buffer
  *
  * @param[in] fcinfo Catalog information about the external function
  * @param[in] buf Buffer
+ * @pre The buffer is maximally aligned
  */
 static SkipList *
 aggstate_read(FunctionCallInfo fcinfo, StringInfo buf)
 {
   int size = pq_getmsgint(buf, 4);
-  Oid valuetypid = pq_getmsgint(buf, 4);
   Temporal **values = palloc0(sizeof(Temporal *) * size);
   for (int i = 0; i < size; i ++)
-    values[i] = temporal_read(buf, valuetypid);
+  {
+    /* The values are copied when constructing the skiplist */
+    buf->cursor = MAXALIGN(buf->cursor);
+    values[i] = (Temporal *) (buf->data + buf->cursor);
+    pq_getmsgbytes(buf, VARSIZE(values[i]));
+  }
   SkipList *result = skiplist_make(fcinfo, values, size);
   size_t extrasize = (size_t) pq_getmsgint64(buf);
   if (extrasize)
@@ -670,8 +767,6 @@ aggstate_read(FunctionCallInfo fcinfo, StringInfo buf)
     const char *extra = pq_getmsgbytes(buf, (int) extrasize);
     aggstate_set_extra(fcinfo, result, (void *)extra, extrasize);
   }
-  for (int i = 0; i < size; i ++)
-    pfree(values[i]);
   pfree(values);
   return result;
 }
@@ -718,11 +813,13 @@ PG_FUNCTION_INFO_V1(temporal_tagg_deserialize);
 PGDLLEXPORT Datum
 temporal_tagg_deserialize(PG_FUNCTION_ARGS)
 {
-  bytea *data = PG_GETARG_BYTEA_P(0);
+  bytea *data = aggstate_bytea_align(PG_GETARG_BYTEA_P(0));
+  /* The offsets in the buffer are those of the serialization function,
+   * which start after the header of the bytea */
   StringInfoData buf =
   {
-    .cursor = 0,
-    .data = VARDATA(data),
+    .cursor = VARHDRSZ,
+    .data = (char *) data,
     .len = VARSIZE(data),
     .maxlen = VARSIZE(data)
   };
@@ -1260,261 +1357,350 @@ temporal_tagg_finalfn(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************
- * Generic functions for aggregating temporal values that require a 
- * transformation to be applied to each composing instant/sequence
- * such as average and centroid. The function passed as
- * argument is the function for transforming the temporal instant value
+ * Temporal count
+ *
+ * The state of the aggregation keeps the timestamps of the instants or the
+ * periods of the sequences of the aggregated values. The final function
+ * sorts the bounds of the periods and computes the count in a single sweep
+ * over them.
  *****************************************************************************/
 
 /**
- * Transform a temporal instant set value for aggregation 
+ * Enumeration for the kind of the bounds of the periods in the sweep of the
+ * temporal count
  */
-TInstant **
-tinstantset_transform_tagg(const TInstantSet *ti, 
-  TInstant *(*func)(const TInstant *))
+typedef enum
 {
-  TInstant **result = palloc(sizeof(TInstant *) * ti->count);
-  for (int i = 0; i < ti->count; i++)
-  {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    result[i] = func(inst);
-  }
+  START_INC,
+  START_EXC,
+  END_INC,
+  END_EXC
+} TCountBoundKind;
+
+/**
+ * Structure to represent the bounds of the periods in the sweep of the 
+ * temporal count
+ */
+typedef struct
+{
+  TimestampTz t;
+  TCountBoundKind kind;
+} TCountBound;
+
+/**
+ * Comparator of the bounds of the periods in the sweep of the temporal count
+ */
+static int
+tcount_bound_cmp(const void *a, const void *b)
+{
+  TimestampTz t1 = ((const TCountBound *) a)->t;
+  TimestampTz t2 = ((const TCountBound *) b)->t;
+  return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
+}
+
+/**
+ * Create the state of the temporal count aggregation in the aggregation
+ * context
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] duration Duration of the elements of the state, either INSTANT
+ * or SEQUENCE
+ * @param[in] capacity Initial capacity of the state
+ */
+static TCountState *
+tcount_state_make(FunctionCallInfo fcinfo, int16 duration, int capacity)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  TCountState *result = palloc(sizeof(TCountState));
+  result->duration = duration;
+  result->count = 0;
+  result->capacity = capacity;
+  result->data = palloc(TCOUNT_ELEMSIZE(duration) * capacity);
+  unset_aggregation_context(ctx);
   return result;
 }
 
 /**
- * Transform a temporal sequence value for aggregation 
+ * Enlarge the state of the temporal count aggregation to hold the given
+ * number of additional elements
  */
-TSequence *
-tsequence_transform_tagg(const TSequence *seq, 
-  TInstant *(*func)(const TInstant *))
+static void
+tcount_state_expand(FunctionCallInfo fcinfo, TCountState *state, int count)
 {
-  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
-  for (int i = 0; i < seq->count; i++)
-  {
-    TInstant *inst = tsequence_inst_n(seq, i);
-    instants[i] = func(inst);
-  }
-  return tsequence_make_free(instants, seq->count,
-    seq->period.lower_inc, seq->period.upper_inc,
-    MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE_NO);
+  if (state->count + count <= state->capacity)
+    return;
+  while (state->count + count > state->capacity)
+    state->capacity <<= 1;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->data = repalloc(state->data,
+    TCOUNT_ELEMSIZE(state->duration) * state->capacity);
+  unset_aggregation_context(ctx);
+  return;
 }
 
 /**
- * Transform a temporal sequence set value for aggregation 
+ * Returns the duration of the elements of the state of the temporal count
+ * and average aggregations for the temporal value
  */
-TSequence **
-tsequenceset_transform_tagg(const TSequenceSet *ts, 
-  TInstant *(*func)(const TInstant *))
+static int16
+tagg_duration(const Temporal *temp)
 {
-  TSequence **result = palloc(sizeof(TSequence *) * ts->count);
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    result[i] = tsequence_transform_tagg(seq, func);
-  }
-  return result;
+  return (temp->duration == INSTANT || temp->duration == INSTANTSET) ?
+    INSTANT : SEQUENCE;
 }
 
 /**
- * Transform a temporal value for aggregation (dispatch function)
+ * Ensure that the duration of the temporal value is compatible with the one
+ * of the state of the temporal count aggregation
  */
-Temporal **
-temporal_transform_tagg(const Temporal *temp, int *count, 
-  TInstant *(*func)(const TInstant *))
+static void
+ensure_same_duration_tcount(const TCountState *state, int16 duration)
 {
-  Temporal **result;
-  if (temp->duration == INSTANT) 
+  if (state->duration != duration)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different duration")));
+}
+
+/**
+ * Add the timestamps or the periods of the temporal value to the state of 
+ * the temporal count aggregation
+ */
+static void
+tcount_state_add(FunctionCallInfo fcinfo, TCountState *state,
+  const Temporal *temp)
+{
+  ensure_same_duration_tcount(state, tagg_duration(temp));
+  if (temp->duration == INSTANT)
   {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)func((TInstant *)temp);
-    *count = 1;
+    tcount_state_expand(fcinfo, state, 1);
+    TimestampTz *times = (TimestampTz *) state->data;
+    times[state->count++] = ((TInstant *) temp)->t;
   }
   else if (temp->duration == INSTANTSET)
   {
-    result = (Temporal **)tinstantset_transform_tagg((
-      TInstantSet *) temp, func);
-    *count = ((TInstantSet *)temp)->count;
-  } 
+    TInstantSet *ti = (TInstantSet *) temp;
+    tcount_state_expand(fcinfo, state, ti->count);
+    TimestampTz *times = (TimestampTz *) state->data;
+    for (int i = 0; i < ti->count; i++)
+      times[state->count++] = tinstantset_inst_n(ti, i)->t;
+  }
   else if (temp->duration == SEQUENCE)
   {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tsequence_transform_tagg(
-      (TSequence *) temp, func);
-    *count = 1;
+    tcount_state_expand(fcinfo, state, 1);
+    Period *periods = (Period *) state->data;
+    periods[state->count++] = ((TSequence *) temp)->period;
   }
   else /* temp->duration == SEQUENCESET */
   {
-    result = (Temporal **)tsequenceset_transform_tagg(
-      (TSequenceSet *) temp, func);
-    *count = ((TSequenceSet *)temp)->count;
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    tcount_state_expand(fcinfo, state, ts->count);
+    Period *periods = (Period *) state->data;
+    for (int i = 0; i < ts->count; i++)
+      periods[state->count++] = tsequenceset_seq_n(ts, i)->period;
   }
-  assert(result != NULL);
-  return result;
+  return;
 }
 
-/*****************************************************************************/
-
 /**
- * Transition function for aggregating temporal values that require a
- * transformation to each composing instant/sequence
- * 
- * @param[in] fcinfo Catalog information about the external function
- * @param[in] func Aggregate function
- * @param[in] crossings State whether turning points are added in the segments
- * @param[in] transform Transform function
+ * Remove the timestamps or the periods of the temporal value from the state
+ * of the temporal count aggregation. Since the frames of window functions
+ * remove the values in the order in which they were added, the elements of
+ * the value are expected at the start of the state.
+ *
+ * @return False when the elements of the value do not start the state
  */
-Datum
-temporal_tagg_transform_transfn(FunctionCallInfo fcinfo, 
-  Datum (*func)(Datum, Datum), bool crossings,
-  TInstant *(*transform)(const TInstant *))
+static bool
+tcount_state_remove(TCountState *state, const Temporal *temp)
 {
-  SkipList *state = PG_ARGISNULL(0) ? NULL : 
-    (SkipList *) PG_GETARG_POINTER(0);
-  if (PG_ARGISNULL(1))
-  {
-    if (state)
-      PG_RETURN_POINTER(state);
-    else
-      PG_RETURN_NULL();
-  }
-
-  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  if (state->duration != tagg_duration(temp))
+    return false;
   int count;
-  Temporal **temparr = temporal_transform_tagg(temp, &count, transform);
-  if (state)
-  {
-    if (skiplist_headval(state)->duration != temparr[0]->duration)
-      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-        errmsg("Cannot aggregate temporal values of different duration")));
-    skiplist_splice(fcinfo, state, temparr, count, func, crossings);
-  }
-  else
-    state = skiplist_make(fcinfo, temparr, count);
-
-  for (int i = 0; i< count; i++)
-    pfree(temparr[i]);
-  pfree(temparr);
-  PG_FREE_IF_COPY(temp, 1);
-  PG_RETURN_POINTER(state);
-}
-
-/*****************************************************************************
- * Temporal count
- *****************************************************************************/
-
-/**
- * Transform a temporal instant value into a temporal integer value for
- * performing temporal count aggregation 
- */
-static TInstant *
-tinstant_transform_tcount(const TInstant *inst)
-{
-  return tinstant_make(Int32GetDatum(1), inst->t, INT4OID);
-}
+  if (temp->duration == INSTANT || temp->duration == SEQUENCE)
+    count = 1;
+  else if (temp->duration == INSTANTSET)
+    count = ((TInstantSet *) temp)->count;
+  else /* temp->duration == SEQUENCESET */
+    count = ((TSequenceSet *) temp)->count;
+  if (count > state->count)
+    return false;
 
-/**
- * Transform a temporal instant set value into a temporal integer value for
- * performing temporal count aggregation 
- */
-static TInstant **
-tinstantset_transform_tcount(const TInstantSet *ti)
-{
-  TInstant **result = palloc(sizeof(TInstant *) * ti->count);
-  Datum datum_one = Int32GetDatum(1);
-  for (int i = 0; i < ti->count; i++)
+  for (int i = 0; i < count; i++)
   {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    result[i] = tinstant_make(datum_one, inst->t, INT4OID);
+    bool found;
+    if (temp->duration == INSTANT)
+      found = ((TimestampTz *) state->data)[i] == ((TInstant *) temp)->t;
+    else if (temp->duration == INSTANTSET)
+      found = ((TimestampTz *) state->data)[i] ==
+        tinstantset_inst_n((TInstantSet *) temp, i)->t;
+    else if (temp->duration == SEQUENCE)
+      found = period_eq_internal(&((Period *) state->data)[i],
+        &((TSequence *) temp)->period);
+    else /* temp->duration == SEQUENCESET */
+      found = period_eq_internal(&((Period *) state->data)[i],
+        &tsequenceset_seq_n((TSequenceSet *) temp, i)->period);
+    if (! found)
+      return false;
   }
-  return result;
+  size_t elemsize = TCOUNT_ELEMSIZE(state->duration);
+  memmove(state->data, (char *) state->data + elemsize * count,
+    elemsize * (state->count - count));
+  state->count -= count;
+  return true;
 }
 
 /**
- * Transform a temporal sequence value into a temporal integer value for
- * performing temporal count aggregation 
+ * Returns the temporal count of the timestamps
  */
-static TSequence *
-tsequence_transform_tcount(const TSequence *seq)
+static TInstantSet *
+tcount_instants(const TimestampTz *times, int count)
 {
-  TSequence *result;
-  Datum datum_one = Int32GetDatum(1);
-  if (seq->count == 1)
+  /* The state is not modified since the final function may be called
+   * several times, e.g., in window functions */
+  TimestampTz *sorted = palloc(sizeof(TimestampTz) * count);
+  memcpy(sorted, times, sizeof(TimestampTz) * count);
+  timestamparr_sort(sorted, count);
+  TInstant **instants = palloc(sizeof(TInstant *) * count);
+  int k = 0;
+  for (int i = 0; i < count; )
   {
-    TInstant *inst = tinstant_make(datum_one, seq->period.lower, INT4OID);
-    result = tinstant_to_tsequence(inst, STEP);
-    pfree(inst);
-    return result;
+    int j = i + 1;
+    while (j < count && sorted[j] == sorted[i])
+      j++;
+    instants[k++] = tinstant_make(Int32GetDatum(j - i), sorted[i], INT4OID);
+    i = j;
   }
-
-  TInstant *instants[2];
-  instants[0] = tinstant_make(datum_one, seq->period.lower, INT4OID);
-  instants[1] = tinstant_make(datum_one, seq->period.upper, INT4OID);
-  result = tsequence_make(instants, 2, seq->period.lower_inc,
-    seq->period.upper_inc, STEP, NORMALIZE_NO);
-  pfree(instants[0]); pfree(instants[1]); 
-  return result;
+  pfree(sorted);
+  return tinstantset_make_free(instants, k);
 }
 
 /**
- * Transform a temporal sequence set value into a temporal integer value for
- * performing temporal count aggregation 
+ * Construct a sequence from the instants computed by the sweep of the
+ * temporal count or average and free them
  */
-static TSequence **
-tsequenceset_transform_tcount(const TSequenceSet *ts)
+static TSequence *
+tagg_sequence_make(TInstant **instants, int count, bool lower_inc,
+  bool upper_inc, bool linear)
 {
-  TSequence **result = palloc(sizeof(TSequence *) * ts->count);
-  for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    result[i] = tsequence_transform_tcount(seq);
-  }
+  TSequence *result = tsequence_make(instants, count, lower_inc, upper_inc,
+    linear, NORMALIZE);
+  for (int i = 0; i < count; i++)
+    pfree(instants[i]);
   return result;
 }
 
 /**
- * Transform a temporal value into a temporal integer value for
- * performing temporal count aggregation (dispatch function)
+ * Returns the temporal count of the periods
+ *
+ * The bounds of the periods are swept in time order. For each timestamp 
+ * the sweep computes the count at the timestamp and the count on the open
+ * interval after it from the count on the open interval before it, which 
+ * determines whether the current sequence continues, is closed, or whether
+ * an instantaneous sequence is needed for the timestamp.
  */
-static Temporal **
-temporal_transform_tcount(const Temporal *temp, int *count)
+static TSequenceSet *
+tcount_sequences(const Period *periods, int count)
 {
-  Temporal **result;
-  if (temp->duration == INSTANT) 
-  {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tinstant_transform_tcount((TInstant *)temp);
-    *count = 1;
-  }
-  else if (temp->duration == INSTANTSET)
-  {
-    result = (Temporal **)tinstantset_transform_tcount((TInstantSet *) temp);
-    *count = ((TInstantSet *)temp)->count;
-  } 
-  else if (temp->duration == SEQUENCE)
+  TCountBound *bounds = palloc(sizeof(TCountBound) * count * 2);
+  for (int i = 0; i < count; i++)
   {
-    result = palloc(sizeof(Temporal *));
-    result[0] = (Temporal *)tsequence_transform_tcount((TSequence *) temp);
-    *count = 1;
+    bounds[2 * i].t = periods[i].lower;
+    bounds[2 * i].kind = periods[i].lower_inc ? START_INC : START_EXC;
+    bounds[2 * i + 1].t = periods[i].upper;
+    bounds[2 * i + 1].kind = periods[i].upper_inc ? END_INC : END_EXC;
   }
-  else /* temp->duration == SEQUENCESET */
+  qsort(bounds, count * 2, sizeof(TCountBound), &tcount_bound_cmp);
+
+  /* Each timestamp adds at most one instant to the current sequence and 
+   * produces at most two sequences */
+  TInstant **instants = palloc(sizeof(TInstant *) * (count * 2 + 1));
+  TSequence **sequences = palloc(sizeof(TSequence *) * count * 4);
+  int ninsts = 0, nseqs = 0;
+  bool lower_inc = false;
+  /* Count on the open interval before the current timestamp */
+  int before = 0;
+  int i = 0;
+  while (i < count * 2)
   {
-    result = (Temporal **)tsequenceset_transform_tcount((TSequenceSet *) temp);
-    *count = ((TSequenceSet *)temp)->count;
+    TimestampTz t = bounds[i].t;
+    int start_inc = 0, start_exc = 0, end_inc = 0, end_exc = 0;
+    for ( ; i < count * 2 && bounds[i].t == t; i++)
+    {
+      if (bounds[i].kind == START_INC)
+        start_inc++;
+      else if (bounds[i].kind == START_EXC)
+        start_exc++;
+      else if (bounds[i].kind == END_INC)
+        end_inc++;
+      else
+        end_exc++;
+    }
+    /* Count at the timestamp and on the open interval after it */
+    int at = before + start_inc - end_exc;
+    int after = before + start_inc + start_exc - end_inc - end_exc;
+
+    bool covered = false;
+    if (before > 0)
+    {
+      /* There is a current sequence */
+      if (at == before && after == before)
+        continue;
+      if (at == after)
+      {
+        if (at > 0)
+        {
+          instants[ninsts++] = tinstant_make(Int32GetDatum(at), t, INT4OID);
+          before = after;
+          continue;
+        }
+        instants[ninsts++] = tinstant_make(Int32GetDatum(before), t, INT4OID);
+        sequences[nseqs++] = tagg_sequence_make(instants, ninsts,
+          lower_inc, false, STEP);
+      }
+      else
+      {
+        covered = (at == before);
+        instants[ninsts++] = tinstant_make(Int32GetDatum(before), t, INT4OID);
+        sequences[nseqs++] = tagg_sequence_make(instants, ninsts,
+          lower_inc, covered, STEP);
+      }
+      ninsts = 0;
+    }
+    if (! covered && at > 0)
+    {
+      instants[0] = tinstant_make(Int32GetDatum(at), t, INT4OID);
+      if (at == after)
+      {
+        /* Start a sequence including the timestamp */
+        ninsts = 1;
+        lower_inc = true;
+        before = after;
+        continue;
+      }
+      sequences[nseqs++] = tagg_sequence_make(instants, 1, true, true, STEP);
+    }
+    if (after > 0)
+    {
+      /* Start a sequence excluding the timestamp */
+      instants[0] = tinstant_make(Int32GetDatum(after), t, INT4OID);
+      ninsts = 1;
+      lower_inc = false;
+    }
+    before = after;
   }
-  assert(result != NULL);
-  return result;
+  pfree(instants);
+  pfree(bounds);
+  return tsequenceset_make_free(sequences, nseqs, NORMALIZE);
 }
 
 PG_FUNCTION_INFO_V1(temporal_tcount_transfn);
 /**
- * Generic transition function for temporal aggregation
+ * Transition function for temporal count aggregation
  */
-PGDLLEXPORT Datum 
+PGDLLEXPORT Datum
 temporal_tcount_transfn(PG_FUNCTION_ARGS)
 {
-  SkipList *state = PG_ARGISNULL(0) ? NULL : 
-    (SkipList *) PG_GETARG_POINTER(0);
+  TCountState *state = PG_ARGISNULL(0) ? NULL : 
+    (TCountState *) PG_GETARG_POINTER(0);
   if (PG_ARGISNULL(1))
   {
     if (state)
@@ -1524,72 +1710,168 @@ temporal_tcount_transfn(PG_FUNCTION_ARGS)
   }
 
   Temporal *temp = PG_GETARG_TEMPORAL(1);
-  int count;
-  Temporal **tsequenceset = temporal_transform_tcount(temp, &count);
-  if (state)
-  {
-    if (skiplist_headval(state)->duration != tsequenceset[0]->duration)
-      ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-        errmsg("Cannot aggregate temporal values of different duration")));
-    skiplist_splice(fcinfo, state, tsequenceset, count, &datum_sum_int32, false);
-  }
-  else
-    state = skiplist_make(fcinfo, tsequenceset, count);
+  if (! state)
+    state = tcount_state_make(fcinfo, tagg_duration(temp),
+      TCOUNT_INITIAL_CAPACITY);
+  tcount_state_add(fcinfo, state, temp);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_invfn);
+/**
+ * Inverse transition function for moving temporal count aggregation
+ *
+ * @note Returning NULL when the value cannot be removed or when the state
+ * becomes empty makes the executor restart the aggregation for the current
+ * frame
+ */
+PGDLLEXPORT Datum
+temporal_tcount_invfn(PG_FUNCTION_ARGS)
+{
+  TCountState *state = PG_ARGISNULL(0) ? NULL : 
+    (TCountState *) PG_GETARG_POINTER(0);
+  if (! state)
+    PG_RETURN_NULL();
+  if (PG_ARGISNULL(1))
+    PG_RETURN_POINTER(state);
 
-  for (int i = 0; i< count; i++)
-    pfree(tsequenceset[i]);
-  pfree(tsequenceset);
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  bool removed = tcount_state_remove(state, temp);
   PG_FREE_IF_COPY(temp, 1);
+  if (! removed || state->count == 0)
+    PG_RETURN_NULL();
   PG_RETURN_POINTER(state);
 }
 
 PG_FUNCTION_INFO_V1(temporal_tcount_combinefn);
 /**
- * Generic combine function for temporal aggregation
+ * Combine function for temporal count aggregation
  */
 PGDLLEXPORT Datum 
 temporal_tcount_combinefn(PG_FUNCTION_ARGS)
 {
-  return temporal_tagg_combinefn(fcinfo, &datum_sum_int32, false);
+  TCountState *state1 = PG_ARGISNULL(0) ? NULL :
+    (TCountState *) PG_GETARG_POINTER(0);
+  TCountState *state2 = PG_ARGISNULL(1) ? NULL :
+    (TCountState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (! state1)
+    PG_RETURN_POINTER(state2);
+  if (! state2)
+    PG_RETURN_POINTER(state1);
+
+  ensure_same_duration_tcount(state1, state2->duration);
+  tcount_state_expand(fcinfo, state1, state2->count);
+  size_t elemsize = TCOUNT_ELEMSIZE(state1->duration);
+  memcpy((char *) state1->data + elemsize * state1->count, state2->data,
+    elemsize * state2->count);
+  state1->count += state2->count;
+  PG_RETURN_POINTER(state1);
 }
 
-/*****************************************************************************
- * Temporal extent
- *****************************************************************************/
-
-PG_FUNCTION_INFO_V1(temporal_extent_transfn);
+PG_FUNCTION_INFO_V1(temporal_tcount_finalfn);
 /**
- * Transition function for temporal extent aggregation of temporal values
- * with period bounding box
+ * Final function for temporal count aggregation
  */
-PGDLLEXPORT Datum 
-temporal_extent_transfn(PG_FUNCTION_ARGS)
+PGDLLEXPORT Datum
+temporal_tcount_finalfn(PG_FUNCTION_ARGS)
 {
-  Period *p = PG_ARGISNULL(0) ? NULL : PG_GETARG_PERIOD(0);
-  Temporal *temp = PG_ARGISNULL(1) ? NULL : PG_GETARG_TEMPORAL(1);
-  Period *result;
-  
-  /* Can't do anything with null inputs */
-  if (!p && !temp)
+  /* The final function is strict, we do not need to test for null values */
+  TCountState *state = (TCountState *) PG_GETARG_POINTER(0);
+  if (state->count == 0)
     PG_RETURN_NULL();
-  /* Null period and non-null temporal, return the bbox of the temporal */
-  if (!p)
-  {
-    result = palloc0(sizeof(Period));
-    temporal_bbox(result, temp);
-    PG_RETURN_POINTER(result);
-  }
-  /* Non-null period and null temporal, return the period */
-  if (!temp)
-  {
-    result = palloc0(sizeof(Period));
-    memcpy(result, p, sizeof(Period));
-    PG_RETURN_POINTER(result);
-  }
 
-  Period p1;
-  temporal_bbox(&p1, temp);
-  result = period_super_union(p, &p1);
+  Temporal *result = (state->duration == INSTANT) ?
+    (Temporal *) tcount_instants((TimestampTz *) state->data, state->count) :
+    (Temporal *) tcount_sequences((Period *) state->data, state->count);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_serialize);
+/**
+ * Serialize the state value of temporal count aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tcount_serialize(PG_FUNCTION_ARGS)
+{
+  TCountState *state = (TCountState *) PG_GETARG_POINTER(0);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->duration, 4);
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->duration);
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  pq_sendbytes(&buf, state->data,
+    (int) (TCOUNT_ELEMSIZE(state->duration) * state->count));
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_deserialize);
+/**
+ * Deserialize the state value of temporal count aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tcount_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data) - VARHDRSZ,
+    .maxlen = VARSIZE(data) - VARHDRSZ
+  };
+  int16 duration = (int16) pq_getmsgint(&buf, 4);
+  int count = pq_getmsgint(&buf, 4);
+  TCountState *result = tcount_state_make(fcinfo, duration, Max(count, 1));
+  size_t size = TCOUNT_ELEMSIZE(duration) * count;
+  memcpy(result->data, pq_getmsgbytes(&buf, (int) size), size);
+  result->count = count;
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Temporal extent
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(temporal_extent_transfn);
+/**
+ * Transition function for temporal extent aggregation of temporal values
+ * with period bounding box
+ */
+PGDLLEXPORT Datum 
+temporal_extent_transfn(PG_FUNCTION_ARGS)
+{
+  Period *p = PG_ARGISNULL(0) ? NULL : PG_GETARG_PERIOD(0);
+  Temporal *temp = PG_ARGISNULL(1) ? NULL : PG_GETARG_TEMPORAL(1);
+  Period *result;
+  
+  /* Can't do anything with null inputs */
+  if (!p && !temp)
+    PG_RETURN_NULL();
+  /* Null period and non-null temporal, return the bbox of the temporal */
+  if (!p)
+  {
+    result = palloc0(sizeof(Period));
+    temporal_bbox(result, temp);
+    PG_RETURN_POINTER(result);
+  }
+  /* Non-null period and null temporal, return the period */
+  if (!temp)
+  {
+    result = palloc0(sizeof(Period));
+    memcpy(result, p, sizeof(Period));
+    PG_RETURN_POINTER(result);
+  }
+
+  Period p1;
+  temporal_bbox(&p1, temp);
+  result = period_super_union(p, &p1);
 
   PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_POINTER(result);
@@ -1675,6 +1957,189 @@ tnumber_extent_combinefn(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Moving temporal extent
+ *
+ * In window frames whose start moves, the rows leave the frame in the order
+ * in which they entered it. The state keeps the bounding boxes of the rows
+ * of the frame so that the extent can shrink when a row leaves the frame
+ * instead of restarting the aggregation, which detoasts all the values of
+ * the frame again.
+ *****************************************************************************/
+
+/**
+ * Create the state of a moving extent aggregation
+ */
+static ExtentAggState *
+extentagg_state_make(FunctionCallInfo fcinfo, Oid valuetypid)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  ExtentAggState *result = palloc0(sizeof(ExtentAggState));
+  result->valuetypid = valuetypid;
+  result->boxsize = temporal_bbox_size(valuetypid);
+  result->capacity = EXTENTAGG_INITIAL_CAPACITY;
+  result->boxes = palloc(result->boxsize * result->capacity);
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Returns the n-th bounding box of the state
+ */
+static void *
+extentagg_box_n(const ExtentAggState *state, int n)
+{
+  return state->boxes +
+    ((state->start + n) % state->capacity) * state->boxsize;
+}
+
+/**
+ * Append the bounding box at the end of the state
+ */
+static void
+extentagg_append(FunctionCallInfo fcinfo, ExtentAggState *state,
+  const void *box)
+{
+  if (state->count == state->capacity)
+  {
+    /* Enlarge the buffer, moving the boxes to its beginning */
+    MemoryContext ctx = set_aggregation_context(fcinfo);
+    char *boxes = palloc(state->boxsize * state->capacity * 2);
+    for (int i = 0; i < state->count; i++)
+      memcpy(boxes + i * state->boxsize, extentagg_box_n(state, i),
+        state->boxsize);
+    pfree(state->boxes);
+    state->boxes = boxes;
+    state->start = 0;
+    state->capacity *= 2;
+    unset_aggregation_context(ctx);
+  }
+  memcpy(extentagg_box_n(state, state->count), box, state->boxsize);
+  if (state->count == 0)
+    memcpy(&state->extent, box, state->boxsize);
+  else
+    temporal_bbox_expand(&state->extent, box, state->valuetypid);
+  state->count++;
+  return;
+}
+
+/**
+ * Returns true if the bounding box reaches a bound of the extent of the
+ * state, in which case the extent may shrink when the box is removed
+ */
+static bool
+extentagg_reaches_bound(const ExtentAggState *state, const void *box)
+{
+  if (talpha_base_type(state->valuetypid))
+  {
+    const Period *p = &state->extent.p, *p1 = (const Period *) box;
+    return p1->lower == p->lower || p1->upper == p->upper;
+  }
+  if (tnumber_base_type(state->valuetypid))
+  {
+    const TBOX *b = &state->extent.b, *b1 = (const TBOX *) box;
+    return b1->xmin == b->xmin || b1->xmax == b->xmax ||
+      b1->tmin == b->tmin || b1->tmax == b->tmax;
+  }
+  /* tgeo_base_type(state->valuetypid) */
+  const STBOX *g = &state->extent.g, *g1 = (const STBOX *) box;
+  bool hasz = MOBDB_FLAGS_GET_Z(g->flags) ||
+    MOBDB_FLAGS_GET_GEODETIC(g->flags);
+  return g1->xmin == g->xmin || g1->xmax == g->xmax ||
+    g1->ymin == g->ymin || g1->ymax == g->ymax ||
+    (hasz && (g1->zmin == g->zmin || g1->zmax == g->zmax)) ||
+    g1->tmin == g->tmin || g1->tmax == g->tmax;
+}
+
+/**
+ * Remove the first bounding box of the state, which is the one of the
+ * oldest row of the frame
+ */
+static void
+extentagg_remove_first(ExtentAggState *state)
+{
+  bool recompute = extentagg_reaches_bound(state, extentagg_box_n(state, 0));
+  state->start = (state->start + 1) % state->capacity;
+  state->count--;
+  if (recompute && state->count > 0)
+  {
+    memcpy(&state->extent, extentagg_box_n(state, 0), state->boxsize);
+    for (int i = 1; i < state->count; i++)
+      temporal_bbox_expand(&state->extent, extentagg_box_n(state, i),
+        state->valuetypid);
+  }
+  return;
+}
+
+PG_FUNCTION_INFO_V1(temporal_extent_mtransfn);
+/**
+ * Transition function for moving temporal extent aggregation
+ */
+PGDLLEXPORT Datum
+temporal_extent_mtransfn(PG_FUNCTION_ARGS)
+{
+  ExtentAggState *state = PG_ARGISNULL(0) ? NULL :
+    (ExtentAggState *) PG_GETARG_POINTER(0);
+  /* Null rows are ignored, also by the inverse transition function */
+  if (PG_ARGISNULL(1))
+  {
+    if (state == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(state);
+  }
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  if (state == NULL)
+    state = extentagg_state_make(fcinfo, temp->valuetypid);
+  else if (state->count > 0 && tgeo_base_type(state->valuetypid))
+  {
+    ensure_same_srid_tpoint_stbox(temp, &state->extent.g);
+    ensure_same_dimensionality_tpoint_stbox(temp, &state->extent.g);
+    ensure_same_geodetic_tpoint_stbox(temp, &state->extent.g);
+  }
+  bboxunion box;
+  memset(&box, 0, sizeof(bboxunion));
+  temporal_bbox(&box, temp);
+  extentagg_append(fcinfo, state, &box);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_extent_minvfn);
+/**
+ * Inverse transition function for moving temporal extent aggregation
+ *
+ * @note The value removed is the one of the oldest row of the frame, whose
+ * bounding box is the first one of the state. The state is null only when
+ * all the rows were null, NULL is then returned, which restarts the
+ * aggregation.
+ */
+PGDLLEXPORT Datum
+temporal_extent_minvfn(PG_FUNCTION_ARGS)
+{
+  if (PG_ARGISNULL(0))
+    PG_RETURN_NULL();
+  ExtentAggState *state = (ExtentAggState *) PG_GETARG_POINTER(0);
+  if (! PG_ARGISNULL(1))
+    extentagg_remove_first(state);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_extent_mfinalfn);
+/**
+ * Final function for moving temporal extent aggregation
+ */
+PGDLLEXPORT Datum
+temporal_extent_mfinalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  ExtentAggState *state = (ExtentAggState *) PG_GETARG_POINTER(0);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+  void *result = palloc(state->boxsize);
+  memcpy(result, &state->extent, state->boxsize);
+  PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************
  * Temporal boolean functions
  *****************************************************************************/
@@ -1885,108 +2350,2076 @@ ttext_tmax_combinefn(PG_FUNCTION_ARGS)
 
 /*****************************************************************************
  * Temporal average
+ *
+ * The state of the aggregation keeps in parallel arrays the timestamps and
+ * the values of the instants of the aggregated values. The final function
+ * sorts the instants and sweeps them in time order while keeping the
+ * segments of the sequences that are active. The sums at a timestamp are
+ * computed from the values of the instants at the timestamp and from the
+ * active segments evaluated at the timestamp, rather than carried forward
+ * from the previous timestamp, so that rounding errors do not accumulate
+ * along the sweep and a value leaving the sums does not absorb the others.
+ * The state is shared by the temporal centroid, whose values have several
+ * components, and by the moving temporal sum.
  *****************************************************************************/
 
 /**
- * Transform a temporal number into a temporal double2 value for 
- * performing temporal average aggregation
+ * Enumeration for the kind of the events in the state of the temporal
+ * average, which are the instants of the aggregated values. An inner
+ * instant of a sequence ends a segment and starts the next one.
  */
-TInstant *
-tnumberinst_transform_tavg(const TInstant *inst)
+typedef enum
+{
+  TAVG_POINT,
+  TAVG_START_INC,
+  TAVG_START_EXC,
+  TAVG_INNER,
+  TAVG_END_INC,
+  TAVG_END_EXC
+} TAvgEventKind;
+
+/**
+ * Create the state of the temporal average aggregation in the aggregation
+ * context
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] duration Duration of the elements of the state, either INSTANT
+ * or SEQUENCE
+ * @param[in] linear True when the sequences have linear interpolation
+ * @param[in] dim Number of components of the values
+ * @param[in] capacity Initial capacity of the state
+ */
+static TAvgState *
+tavg_state_make1(FunctionCallInfo fcinfo, int16 duration, bool linear,
+  int16 dim, int capacity)
 {
-  double value = datum_double(tinstant_value(inst), inst->valuetypid);
-  double2 dvalue;
-  double2_set(&dvalue, value, 1);
-  TInstant *result = tinstant_make(PointerGetDatum(&dvalue), inst->t,
-    type_oid(T_DOUBLE2));
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  TAvgState *result = palloc(sizeof(TAvgState));
+  result->duration = duration;
+  result->linear = linear;
+  result->dim = dim;
+  result->srid = 0;
+  result->count = 0;
+  result->capacity = capacity;
+  result->times = palloc(sizeof(TimestampTz) * capacity);
+  result->kinds = (duration == INSTANT) ? NULL :
+    palloc(sizeof(uint8) * capacity);
+  result->values = palloc(sizeof(double) * dim * capacity);
+  unset_aggregation_context(ctx);
   return result;
 }
 
-PG_FUNCTION_INFO_V1(tnumber_tavg_transfn);
 /**
- * Transition function for temporal average aggregation
+ * Returns true if the temporal value has sequences with linear
+ * interpolation
  */
-PGDLLEXPORT Datum
-tnumber_tavg_transfn(PG_FUNCTION_ARGS)
+static bool
+tavg_linear(const Temporal *temp)
 {
-  return temporal_tagg_transform_transfn(fcinfo, &datum_sum_double2,
-    CROSSINGS_NO, &tnumberinst_transform_tavg);
+  return (temp->duration == SEQUENCE || temp->duration == SEQUENCESET) &&
+    MOBDB_FLAGS_GET_LINEAR(temp->flags);
 }
 
-PG_FUNCTION_INFO_V1(tnumber_tavg_combinefn);
 /**
- * Combine function for temporal average aggregation
+ * Create the state of the temporal average aggregation for the temporal 
+ * value
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] temp First aggregated value
+ * @param[in] dim Number of components of the values
  */
-PGDLLEXPORT Datum
-tnumber_tavg_combinefn(PG_FUNCTION_ARGS)
+TAvgState *
+tavg_state_make(FunctionCallInfo fcinfo, const Temporal *temp, int16 dim)
 {
-  return temporal_tagg_combinefn(fcinfo, &datum_sum_double2, false);
+  return tavg_state_make1(fcinfo, tagg_duration(temp), tavg_linear(temp),
+    dim, TAVG_INITIAL_CAPACITY);
 }
 
-/* Final function for tavg */
+/**
+ * Enlarge the state of the temporal average aggregation to hold the given
+ * number of additional events
+ */
+static void
+tavg_state_expand(FunctionCallInfo fcinfo, TAvgState *state, int count)
+{
+  if (state->count + count <= state->capacity)
+    return;
+  while (state->count + count > state->capacity)
+    state->capacity <<= 1;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->times = repalloc(state->times,
+    sizeof(TimestampTz) * state->capacity);
+  if (state->kinds)
+    state->kinds = repalloc(state->kinds, sizeof(uint8) * state->capacity);
+  state->values = repalloc(state->values,
+    sizeof(double) * state->dim * state->capacity);
+  unset_aggregation_context(ctx);
+  return;
+}
 
 /**
- * Final function for temporal average aggregation of temporal instat values
+ * Ensure that the duration and the interpolation of the aggregated values
+ * are compatible with those of the state of the temporal average aggregation
  */
-static TInstantSet *
-tinstant_tavg_finalfn(TInstant **instants, int count)
+static void
+ensure_same_duration_interp_tavg(const TAvgState *state, int16 duration,
+  bool linear)
 {
-  TInstant **newinstants = palloc(sizeof(TInstant *) * count);
-  for (int i = 0; i < count; i++)
+  if (state->duration != duration)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different duration")));
+  if (state->linear != linear)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different interpolation")));
+  return;
+}
+
+/**
+ * Returns the number of events of a temporal value in the state of the 
+ * temporal average aggregation
+ */
+static int
+tavg_events(const Temporal *temp)
+{
+  if (temp->duration == INSTANT)
+    return 1;
+  if (temp->duration == INSTANTSET)
+    return ((TInstantSet *) temp)->count;
+  if (temp->duration == SEQUENCE)
+    return ((TSequence *) temp)->count;
+  /* temp->duration == SEQUENCESET */
+  return ((TSequenceSet *) temp)->totalcount;
+}
+
+/**
+ * Append an event to the state of the temporal average aggregation, whose
+ * capacity has been enlarged before
+ */
+static void
+tavg_state_append(TAvgState *state, TimestampTz t, TAvgEventKind kind,
+  const double *value)
+{
+  int n = state->count++;
+  state->times[n] = t;
+  if (state->kinds)
+    state->kinds[n] = (uint8) kind;
+  memcpy(&state->values[n * state->dim], value,
+    sizeof(double) * state->dim);
+  return;
+}
+
+/**
+ * Append the events of a temporal sequence to the state of the temporal 
+ * average aggregation
+ *
+ * @param[inout] state State
+ * @param[in] seq Temporal value
+ * @param[in] func Function computing the components of the value of an 
+ * instant
+ */
+static void
+tavg_state_add_seq(TAvgState *state, const TSequence *seq,
+  void (*func)(const TInstant *, double *))
+{
+  double value[TAVG_MAXDIM];
+  for (int i = 0; i < seq->count; i++)
   {
-    TInstant *inst = instants[i];
-    double2 *value = (double2 *)DatumGetPointer(tinstant_value_ptr(inst));
-    double tavg = value->a / value->b;
-    newinstants[i] = tinstant_make(Float8GetDatum(tavg), inst->t,
-      FLOAT8OID);
+    TInstant *inst = tsequence_inst_n(seq, i);
+    TAvgEventKind kind;
+    if (seq->count == 1)
+      kind = TAVG_POINT;
+    else if (i == 0)
+      kind = seq->period.lower_inc ? TAVG_START_INC : TAVG_START_EXC;
+    else if (i == seq->count - 1)
+      kind = seq->period.upper_inc ? TAVG_END_INC : TAVG_END_EXC;
+    else
+      kind = TAVG_INNER;
+    func(inst, value);
+    tavg_state_append(state, inst->t, kind, value);
   }
-  return tinstantset_make_free(newinstants, count);
+  return;
 }
 
 /**
- * Final function for temporal average aggregation of temporal sequence values
+ * Add the events of the temporal value to the state of the temporal average
+ * aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[inout] state State
+ * @param[in] temp Temporal value
+ * @param[in] func Function computing the components of the value of an 
+ * instant
  */
-static TSequenceSet *
-tsequence_tavg_finalfn(TSequence **sequences, int count)
+void
+tavg_state_add(FunctionCallInfo fcinfo, TAvgState *state, 
+  const Temporal *temp, void (*func)(const TInstant *, double *))
 {
-  TSequence **newsequences = palloc(sizeof(TSequence *) * count);
-  for (int i = 0; i < count; i++)
+  ensure_same_duration_interp_tavg(state, tagg_duration(temp),
+    tavg_linear(temp));
+  tavg_state_expand(fcinfo, state, tavg_events(temp));
+  double value[TAVG_MAXDIM];
+  if (temp->duration == INSTANT)
+  {
+    TInstant *inst = (TInstant *) temp;
+    func(inst, value);
+    tavg_state_append(state, inst->t, TAVG_POINT, value);
+  }
+  else if (temp->duration == INSTANTSET)
   {
-    TSequence *seq = sequences[i];
-    TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
-    for (int j = 0; j < seq->count; j++)
+    TInstantSet *ti = (TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
     {
-      TInstant *inst = tsequence_inst_n(seq, j);
-      double2 *value2 = (double2 *)DatumGetPointer(tinstant_value_ptr(inst));
-      double value = value2->a / value2->b;
-      instants[j] = tinstant_make(Float8GetDatum(value), inst->t,
-        FLOAT8OID);
+      TInstant *inst = tinstantset_inst_n(ti, i);
+      func(inst, value);
+      tavg_state_append(state, inst->t, TAVG_POINT, value);
     }
-    newsequences[i] = tsequence_make_free(instants, seq->count, 
-      seq->period.lower_inc, seq->period.upper_inc, 
-      MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE);
   }
-  return tsequenceset_make_free(newsequences, count, NORMALIZE);
+  else if (temp->duration == SEQUENCE)
+    tavg_state_add_seq(state, (TSequence *) temp, func);
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      tavg_state_add_seq(state, tsequenceset_seq_n(ts, i), func);
+  }
+  return;
 }
 
-PG_FUNCTION_INFO_V1(tnumber_tavg_finalfn);
 /**
- * Final function for temporal average aggregation
+ * Remove the events of the temporal value from the state of the temporal 
+ * average aggregation. Since the frames of window functions remove the 
+ * values in the order in which they were added, the events of the value are
+ * expected at the start of the state.
+ *
+ * @return False when the events of the value do not start the state
  */
-PGDLLEXPORT Datum
-tnumber_tavg_finalfn(PG_FUNCTION_ARGS)
+bool
+tavg_state_remove(TAvgState *state, const Temporal *temp)
 {
-  /* The final function is strict, we do not need to test for null values */
-  SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
-  if (state->length == 0)
-    PG_RETURN_NULL();
+  if (state->duration != tagg_duration(temp) ||
+      state->linear != tavg_linear(temp))
+    return false;
+  int count = tavg_events(temp);
+  if (count > state->count)
+    return false;
+  Period p;
+  temporal_period(&p, temp);
+  if (state->times[0] != p.lower || state->times[count - 1] != p.upper)
+    return false;
+
+  int dim = state->dim;
+  int rest = state->count - count;
+  memmove(state->times, &state->times[count], sizeof(TimestampTz) * rest);
+  if (state->kinds)
+    memmove(state->kinds, &state->kinds[count], sizeof(uint8) * rest);
+  memmove(state->values, &state->values[count * dim],
+    sizeof(double) * dim * rest);
+  state->count = rest;
+  return true;
+}
 
-  Temporal **values = skiplist_values(state);
-  assert(values[0]->duration == INSTANT || values[0]->duration == SEQUENCE);
-  Temporal *result = (values[0]->duration == INSTANT) ?
-    (Temporal *)tinstant_tavg_finalfn((TInstant **)values, state->length) :
-    (Temporal *)tsequence_tavg_finalfn((TSequence **)values, state->length);
-  pfree(values);
+/**
+ * Append the events of the second state of the temporal average aggregation
+ * to the first one
+ */
+TAvgState *
+tavg_state_combine(FunctionCallInfo fcinfo, TAvgState *state1,
+  const TAvgState *state2)
+{
+  ensure_same_duration_interp_tavg(state1, state2->duration, state2->linear);
+  tavg_state_expand(fcinfo, state1, state2->count);
+  int dim = state1->dim;
+  int n = state1->count;
+  memcpy(&state1->times[n], state2->times,
+    sizeof(TimestampTz) * state2->count);
+  if (state1->kinds)
+    memcpy(&state1->kinds[n], state2->kinds, sizeof(uint8) * state2->count);
+  memcpy(&state1->values[n * dim], state2->values,
+    sizeof(double) * dim * state2->count);
+  state1->count += state2->count;
+  return state1;
+}
+
+/**
+ * Comparator of the events of the state of the temporal average, which are
+ * given by their position in the arrays of the state. Events with the same
+ * timestamp are kept in the order of their position so that the values are
+ * summed in the same order at every timestamp.
+ */
+static int
+tavg_event_cmp(const void *a, const void *b, void *arg)
+{
+  const TimestampTz *times = (const TimestampTz *) arg;
+  int n1 = *(const int *) a;
+  int n2 = *(const int *) b;
+  if (times[n1] != times[n2])
+    return (times[n1] < times[n2]) ? -1 : 1;
+  return (n1 < n2) ? -1 : ((n1 > n2) ? 1 : 0);
+}
+
+/**
+ * Returns the positions of the events of the state of the temporal average
+ * sorted by time. The state is not modified since the final function may be
+ * called several times, e.g., in window functions.
+ */
+static int *
+tavg_state_sort(const TAvgState *state)
+{
+  int *result = palloc(sizeof(int) * state->count);
+  for (int i = 0; i < state->count; i++)
+    result[i] = i;
+  qsort_arg(result, (size_t) state->count, sizeof(int), &tavg_event_cmp,
+    (void *) state->times);
+  return result;
+}
+
+/**
+ * Compute the resulting value from the sums and the number of values
+ *
+ * @param[out] result Components of the resulting value
+ * @param[in] sum Sums of the components of the values
+ * @param[in] count Number of values
+ * @param[in] dim Number of components
+ * @param[in] avg True when computing the average, the sum otherwise
+ */
+static void
+tavg_value(double *result, const double *sum, int count, int16 dim, bool avg)
+{
+  for (int k = 0; k < dim; k++)
+    result[k] = avg ? sum[k] / count : sum[k];
+  return;
+}
+
+/**
+ * Returns true if the two resulting values are equal
+ */
+static bool
+tavg_value_eq(const double *value1, const double *value2, int16 dim)
+{
+  for (int k = 0; k < dim; k++)
+  {
+    if (value1[k] != value2[k])
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Adds the value of an event of the state of the temporal average to the
+ * sums
+ */
+static void
+tavg_sum_add(double *sum, const double *value, int16 dim)
+{
+  for (int k = 0; k < dim; k++)
+    sum[k] += value[k];
+  return;
+}
+
+/**
+ * Construct a temporal instant from a resulting value
+ *
+ * @param[in] state State
+ * @param[in] value Components of the value
+ * @param[in] t Timestamp
+ * @param[in] func Function constructing the value from its components
+ * @param[in] valuetypid Oid of the base type of the result
+ */
+static TInstant *
+tavg_instant_make(const TAvgState *state, const double *value, TimestampTz t,
+  Datum (*func)(const double *, const TAvgState *), Oid valuetypid)
+{
+  Datum d = func(value, state);
+  TInstant *result = tinstant_make(d, t, valuetypid);
+  if (! get_typbyval_fast(valuetypid))
+    pfree(DatumGetPointer(d));
+  return result;
+}
+
+/**
+ * Returns the temporal average or sum of the instants of the state
+ */
+static TInstantSet *
+tavg_instants(const TAvgState *state, bool avg,
+  Datum (*func)(const double *, const TAvgState *), Oid valuetypid)
+{
+  int16 dim = state->dim;
+  int *order = tavg_state_sort(state);
+  TInstant **instants = palloc(sizeof(TInstant *) * state->count);
+  double sum[TAVG_MAXDIM], value[TAVG_MAXDIM];
+  int k = 0;
+  for (int i = 0; i < state->count; )
+  {
+    TimestampTz t = state->times[order[i]];
+    memset(sum, 0, sizeof(sum));
+    int count = 0;
+    for ( ; i < state->count && state->times[order[i]] == t; i++)
+    {
+      tavg_sum_add(sum, &state->values[order[i] * dim], dim);
+      count++;
+    }
+    tavg_value(value, sum, count, dim, avg);
+    instants[k++] = tavg_instant_make(state, value, t, func, valuetypid);
+  }
+  pfree(order);
+  return tinstantset_make_free(instants, k);
+}
+
+/**
+ * Sets the value at the timestamp of the segment of the state starting at
+ * the event in the given position, as done by function
+ * tsequence_value_at_timestamp1
+ */
+static void
+tavg_segment_value(const TAvgState *state, int n, TimestampTz t,
+  double *value)
+{
+  int16 dim = state->dim;
+  const double *value1 = &state->values[n * dim];
+  const double *value2 = &state->values[(n + 1) * dim];
+  TimestampTz t1 = state->times[n];
+  TimestampTz t2 = state->times[n + 1];
+  if (! state->linear || t == t1)
+    memcpy(value, value1, sizeof(double) * dim);
+  else if (t == t2)
+    memcpy(value, value2, sizeof(double) * dim);
+  else
+  {
+    double ratio = (double) (t - t1) / (double) (t2 - t1);
+    for (int k = 0; k < dim; k++)
+      value[k] = (value1[k] == value2[k]) ? value1[k] :
+        value1[k] + (value2[k] - value1[k]) * ratio;
+  }
+  return;
+}
+
+/**
+ * Returns the location of the segment starting at the event in the given
+ * position in the sorted array of active segments of the sweep of the
+ * temporal average, or the location where it must be inserted
+ */
+static int
+tavg_active_find(const int *active, int count, int n)
+{
+  int first = 0, last = count;
+  while (first < last)
+  {
+    int middle = (first + last) / 2;
+    if (active[middle] < n)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  return first;
+}
+
+/**
+ * Update the sorted array of active segments of the sweep of the temporal
+ * average with the event in the given position
+ */
+static void
+tavg_active_update(const TAvgState *state, int *active, int *count, int n)
+{
+  TAvgEventKind kind = (TAvgEventKind) state->kinds[n];
+  int loc;
+  if (kind == TAVG_INNER || kind == TAVG_END_INC || kind == TAVG_END_EXC)
+  {
+    /* The segment ending at the event is no longer active */
+    loc = tavg_active_find(active, *count, n - 1);
+    assert(loc < *count && active[loc] == n - 1);
+    memmove(&active[loc], &active[loc + 1],
+      sizeof(int) * (*count - loc - 1));
+    (*count)--;
+  }
+  if (kind == TAVG_START_INC || kind == TAVG_START_EXC || kind == TAVG_INNER)
+  {
+    /* The segment starting at the event becomes active */
+    loc = tavg_active_find(active, *count, n);
+    memmove(&active[loc + 1], &active[loc], sizeof(int) * (*count - loc));
+    active[loc] = n;
+    (*count)++;
+  }
+  return;
+}
+
+/**
+ * Returns the temporal average or sum of the sequences of the state
+ *
+ * The events are swept in time order. At each timestamp the sweep computes
+ * the sums of the values on the open interval before the timestamp, at the
+ * timestamp, and on the open interval after it. The sums are computed in
+ * the order of the positions of the events in the state, which is the
+ * order of the aggregated values, so that equal values lead to equal sums.
+ * As for the temporal count, these sums determine whether the current
+ * sequence continues, is closed, or whether an instantaneous sequence is
+ * needed for the timestamp.
+ */
+static TSequenceSet *
+tavg_sequences(const TAvgState *state, bool avg,
+  Datum (*func)(const double *, const TAvgState *), Oid valuetypid)
+{
+  int16 dim = state->dim;
+  bool linear = state->linear;
+  int *order = tavg_state_sort(state);
+  /* Each timestamp adds at most one instant to the current sequence and 
+   * produces at most two sequences */
+  TInstant **instants = palloc(sizeof(TInstant *) * (state->count + 1));
+  TSequence **sequences = palloc(sizeof(TSequence *) * state->count * 2);
+  /* Positions of the events starting the active segments in increasing
+   * order */
+  int *active = palloc(sizeof(int) * state->count);
+  int nactive = 0, ninsts = 0, nseqs = 0;
+  bool lower_inc = false;
+  int i = 0;
+  while (i < state->count)
+  {
+    TimestampTz t = state->times[order[i]];
+    int j = i;
+    while (j < state->count && state->times[order[j]] == t)
+      j++;
+    /* Sums before, at, and after the timestamp */
+    double before[TAVG_MAXDIM], at[TAVG_MAXDIM], after[TAVG_MAXDIM],
+      value[TAVG_MAXDIM];
+    memset(before, 0, sizeof(before));
+    memset(at, 0, sizeof(at));
+    memset(after, 0, sizeof(after));
+    for (int a = 0; a < nactive; a++)
+    {
+      tavg_segment_value(state, active[a], t, value);
+      tavg_sum_add(before, value, dim);
+    }
+    int nbefore = nactive;
+    for (int e = i; e < j; e++)
+      tavg_active_update(state, active, &nactive, order[e]);
+    int nafter = nactive, nat = 0;
+    /* The events at the timestamp that do not start a segment are merged
+     * by position with the active segments */
+    int e = i;
+    for (int a = 0; a <= nactive; a++)
+    {
+      int n = (a < nactive) ? active[a] : state->count;
+      for ( ; e < j && order[e] < n; e++)
+      {
+        TAvgEventKind kind = (TAvgEventKind) state->kinds[order[e]];
+        if (kind == TAVG_POINT || kind == TAVG_END_INC)
+        {
+          tavg_sum_add(at, &state->values[order[e] * dim], dim);
+          nat++;
+        }
+      }
+      if (a == nactive)
+        break;
+      tavg_segment_value(state, n, t, value);
+      tavg_sum_add(after, value, dim);
+      if (state->times[n] < t || state->kinds[n] != TAVG_START_EXC)
+      {
+        tavg_sum_add(at, value, dim);
+        nat++;
+      }
+    }
+    i = j;
+
+    /* Values before, at, and after the timestamp */
+    double vbefore[TAVG_MAXDIM], vat[TAVG_MAXDIM], vafter[TAVG_MAXDIM];
+    if (nbefore > 0)
+      tavg_value(vbefore, before, nbefore, dim, avg);
+    if (nat > 0)
+      tavg_value(vat, at, nat, dim, avg);
+    if (nafter > 0)
+      tavg_value(vafter, after, nafter, dim, avg);
+    bool atbefore = nbefore > 0 && nat > 0 &&
+      tavg_value_eq(vat, vbefore, dim);
+    bool atafter = nat > 0 && nafter > 0 && tavg_value_eq(vat, vafter, dim);
+
+    bool covered = false;
+    if (nbefore > 0)
+    {
+      /* There is a current sequence */
+      if (atafter && (atbefore || ! linear))
+      {
+        /* The sequence continues after the timestamp */
+        if (linear || ! atbefore)
+          instants[ninsts++] = tavg_instant_make(state, vat, t, func,
+            valuetypid);
+        continue;
+      }
+      if (nat > 0 && (atbefore || ! linear))
+      {
+        instants[ninsts++] = tavg_instant_make(state, vat, t, func,
+          valuetypid);
+        covered = true;
+      }
+      else
+        instants[ninsts++] = tavg_instant_make(state, vbefore, t, func,
+          valuetypid);
+      sequences[nseqs++] = tagg_sequence_make(instants, ninsts, lower_inc,
+        covered, linear);
+      ninsts = 0;
+    }
+    if (! covered && nat > 0)
+    {
+      instants[0] = tavg_instant_make(state, vat, t, func, valuetypid);
+      if (atafter)
+      {
+        /* Start a sequence including the timestamp */
+        ninsts = 1;
+        lower_inc = true;
+        continue;
+      }
+      sequences[nseqs++] = tagg_sequence_make(instants, 1, true, true,
+        linear);
+    }
+    if (nafter > 0)
+    {
+      /* Start a sequence excluding the timestamp */
+      instants[0] = tavg_instant_make(state, vafter, t, func, valuetypid);
+      ninsts = 1;
+      lower_inc = false;
+    }
+  }
+  pfree(active);
+  pfree(instants);
+  pfree(order);
+  return tsequenceset_make_free(sequences, nseqs, NORMALIZE);
+}
+
+/**
+ * Returns the temporal average or sum of the values of the state
+ *
+ * @param[in] state State, which must not be empty
+ * @param[in] avg True when computing the average, the sum otherwise
+ * @param[in] func Function constructing a value from its components
+ * @param[in] valuetypid Oid of the base type of the result
+ */
+Temporal *
+tavg_state_final(const TAvgState *state, bool avg,
+  Datum (*func)(const double *, const TAvgState *), Oid valuetypid)
+{
+  assert(state->count > 0);
+  if (state->duration == INSTANT)
+    return (Temporal *) tavg_instants(state, avg, func, valuetypid);
+  return (Temporal *) tavg_sequences(state, avg, func, valuetypid);
+}
+
+/*****************************************************************************/
+
+/**
+ * Sets the value of a temporal number instant for the temporal average
+ * aggregation
+ */
+static void
+tnumberinst_tavg_value(const TInstant *inst, double *value)
+{
+  value[0] = datum_double(tinstant_value(inst), inst->valuetypid);
+  return;
+}
+
+/**
+ * Returns the float value of the temporal average or sum
+ */
+static Datum
+tavg_float8(const double *value, const TAvgState *state)
+{
+  return Float8GetDatum(value[0]);
+}
+
+/**
+ * Returns the integer value of the temporal sum
+ */
+static Datum
+tavg_int32(const double *value, const TAvgState *state)
+{
+  return Int32GetDatum((int32) rint(value[0]));
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_transfn);
+/**
+ * Transition function for temporal average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_transfn(PG_FUNCTION_ARGS)
+{
+  TAvgState *state = PG_ARGISNULL(0) ? NULL : 
+    (TAvgState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  if (! state)
+    state = tavg_state_make(fcinfo, temp, 1);
+  tavg_state_add(fcinfo, state, temp, &tnumberinst_tavg_value);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_combinefn);
+/**
+ * Combine function for temporal average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_combinefn(PG_FUNCTION_ARGS)
+{
+  TAvgState *state1 = PG_ARGISNULL(0) ? NULL :
+    (TAvgState *) PG_GETARG_POINTER(0);
+  TAvgState *state2 = PG_ARGISNULL(1) ? NULL :
+    (TAvgState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (! state1)
+    PG_RETURN_POINTER(state2);
+  if (! state2)
+    PG_RETURN_POINTER(state1);
+  PG_RETURN_POINTER(tavg_state_combine(fcinfo, state1, state2));
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_invfn);
+/**
+ * Inverse transition function for moving temporal average and sum 
+ * aggregation
+ *
+ * @note Returning NULL when the value cannot be removed or when the state
+ * becomes empty makes the executor restart the aggregation for the current
+ * frame
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_invfn(PG_FUNCTION_ARGS)
+{
+  TAvgState *state = PG_ARGISNULL(0) ? NULL : 
+    (TAvgState *) PG_GETARG_POINTER(0);
+  if (! state)
+    PG_RETURN_NULL();
+  if (PG_ARGISNULL(1))
+    PG_RETURN_POINTER(state);
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  bool removed = tavg_state_remove(state, temp);
+  PG_FREE_IF_COPY(temp, 1);
+  if (! removed || state->count == 0)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_finalfn);
+/**
+ * Final function for temporal average aggregation
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  TAvgState *state = (TAvgState *) PG_GETARG_POINTER(0);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+  Temporal *result = tavg_state_final(state, true, &tavg_float8, FLOAT8OID);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tint_tsum_mfinalfn);
+/**
+ * Final function for moving temporal sum aggregation of temporal integer
+ * values, whose state is the one of the temporal average
+ */
+PGDLLEXPORT Datum
+tint_tsum_mfinalfn(PG_FUNCTION_ARGS)
+{
+  TAvgState *state = (TAvgState *) PG_GETARG_POINTER(0);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+  Temporal *result = tavg_state_final(state, false, &tavg_int32, INT4OID);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tfloat_tsum_mfinalfn);
+/**
+ * Final function for moving temporal sum aggregation of temporal float
+ * values, whose state is the one of the temporal average
+ */
+PGDLLEXPORT Datum
+tfloat_tsum_mfinalfn(PG_FUNCTION_ARGS)
+{
+  TAvgState *state = (TAvgState *) PG_GETARG_POINTER(0);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+  Temporal *result = tavg_state_final(state, false, &tavg_float8, FLOAT8OID);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tavg_serialize);
+/**
+ * Serialize the state value of temporal average aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tavg_serialize(PG_FUNCTION_ARGS)
+{
+  TAvgState *state = (TAvgState *) PG_GETARG_POINTER(0);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->duration, 4);
+  pq_sendint(&buf, (uint32) state->dim, 4);
+  pq_sendint(&buf, (uint32) state->srid, 4);
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->duration);
+  pq_sendint32(&buf, (uint32) state->dim);
+  pq_sendint32(&buf, (uint32) state->srid);
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  pq_sendbyte(&buf, (int) state->linear);
+  int count = state->count;
+  pq_sendbytes(&buf, (char *) state->times,
+    (int) (sizeof(TimestampTz) * count));
+  if (state->kinds)
+    pq_sendbytes(&buf, (char *) state->kinds, (int) (sizeof(uint8) * count));
+  pq_sendbytes(&buf, (char *) state->values,
+    (int) (sizeof(double) * state->dim * count));
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(temporal_tavg_deserialize);
+/**
+ * Deserialize the state value of temporal average aggregation
+ */
+PGDLLEXPORT Datum
+temporal_tavg_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data) - VARHDRSZ,
+    .maxlen = VARSIZE(data) - VARHDRSZ
+  };
+  int16 duration = (int16) pq_getmsgint(&buf, 4);
+  int16 dim = (int16) pq_getmsgint(&buf, 4);
+  int32 srid = (int32) pq_getmsgint(&buf, 4);
+  int count = pq_getmsgint(&buf, 4);
+  bool linear = (bool) pq_getmsgbyte(&buf);
+  TAvgState *result = tavg_state_make1(fcinfo, duration, linear, dim,
+    Max(count, 1));
+  result->srid = srid;
+  size_t size = sizeof(TimestampTz) * count;
+  memcpy(result->times, pq_getmsgbytes(&buf, (int) size), size);
+  if (result->kinds)
+  {
+    size = sizeof(uint8) * count;
+    memcpy(result->kinds, pq_getmsgbytes(&buf, (int) size), size);
+  }
+  size = sizeof(double) * dim * count;
+  memcpy(result->values, pq_getmsgbytes(&buf, (int) size), size);
+  result->count = count;
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Sequence-building aggregate functions
+ *****************************************************************************/
+
+/**
+ * Create the state of a sequence-building aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] maxgap Maximum time interval between two consecutive instants
+ * of a sequence, NULL when the sequences are not split
+ */
+static SeqAggState *
+seqagg_state_make(FunctionCallInfo fcinfo, Oid valuetypid,
+  const Interval *maxgap)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  SeqAggState *result = palloc0(sizeof(SeqAggState));
+  result->valuetypid = valuetypid;
+  result->linear = linear_interpolation(valuetypid);
+  if (maxgap != NULL)
+  {
+    result->hasgap = true;
+    memcpy(&result->maxgap, maxgap, sizeof(Interval));
+  }
+  result->capacity = SEQAGG_INITIAL_CAPACITY;
+  result->offsets = palloc(sizeof(size_t) * result->capacity);
+  /* The buffer is enlarged when the first instant is added */
+  result->datacap = 0;
+  result->data = NULL;
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Returns the n-th instant of the current sequence of the state
+ */
+static TInstant *
+seqagg_inst_n(const SeqAggState *state, int n)
+{
+  return (TInstant *) (state->data + state->offsets[n]);
+}
+
+/**
+ * Construct a sequence from the instants of the current sequence of the
+ * state. The instants in the buffer are already normalized.
+ */
+static TSequence *
+seqagg_make_sequence(const SeqAggState *state)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * state->count);
+  for (int i = 0; i < state->count; i++)
+    instants[i] = seqagg_inst_n(state, i);
+  TSequence *result = tsequence_make(instants, state->count, true, true,
+    state->linear, NORMALIZE_NO);
+  pfree(instants);
+  return result;
+}
+
+/**
+ * Close the current sequence of the state. The buffer of instants is kept
+ * for the next sequence.
+ */
+static void
+seqagg_close(FunctionCallInfo fcinfo, SeqAggState *state)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  if (state->seqcount == state->seqcap)
+  {
+    state->seqcap = state->seqcap == 0 ? SEQAGG_INITIAL_CAPACITY :
+      state->seqcap * 2;
+    state->sequences = state->sequences == NULL ?
+      palloc(sizeof(TSequence *) * state->seqcap) :
+      repalloc(state->sequences, sizeof(TSequence *) * state->seqcap);
+  }
+  state->sequences[state->seqcount++] = seqagg_make_sequence(state);
+  unset_aggregation_context(ctx);
+  state->count = 0;
+  state->datasize = 0;
+  return;
+}
+
+/**
+ * Append the instant at the end of the current sequence of the state
+ */
+static void
+seqagg_append(FunctionCallInfo fcinfo, SeqAggState *state,
+  const TInstant *inst)
+{
+  size_t size = double_pad(VARSIZE(inst));
+  if (state->count == state->capacity ||
+    state->datasize + size > state->datacap)
+  {
+    MemoryContext ctx = set_aggregation_context(fcinfo);
+    if (state->count == state->capacity)
+    {
+      state->capacity *= 2;
+      state->offsets = repalloc(state->offsets,
+        sizeof(size_t) * state->capacity);
+    }
+    if (state->datasize + size > state->datacap)
+    {
+      size_t datacap = state->datacap == 0 ?
+        size * SEQAGG_INITIAL_CAPACITY : state->datacap;
+      while (state->datasize + size > datacap)
+        datacap *= 2;
+      state->data = state->data == NULL ? palloc(datacap) :
+        repalloc(state->data, datacap);
+      state->datacap = datacap;
+    }
+    unset_aggregation_context(ctx);
+  }
+  memcpy(state->data + state->datasize, inst, VARSIZE(inst));
+  state->offsets[state->count++] = state->datasize;
+  state->datasize += size;
+  return;
+}
+
+/**
+ * Returns the last instant added to the state
+ */
+static TInstant *
+seqagg_last_inst(const SeqAggState *state)
+{
+  if (state->count > 0)
+    return seqagg_inst_n(state, state->count - 1);
+  if (state->seqcount > 0)
+  {
+    TSequence *seq = state->sequences[state->seqcount - 1];
+    return tsequence_inst_n(seq, seq->count - 1);
+  }
+  return NULL;
+}
+
+PG_FUNCTION_INFO_V1(temporal_seq_transfn);
+/**
+ * Transition function for the aggregates that build a temporal sequence
+ * (set) from the values and the timestamps of the rows.
+ *
+ * The rows must be given in increasing order of timestamps. Consecutive rows
+ * with the same timestamp and value are ignored, redundant instants are
+ * removed as they arrive so that the resulting sequences are normalized.
+ * When a maximum time interval is given, a new sequence is started when two
+ * consecutive rows are separated by more than this interval.
+ */
+PGDLLEXPORT Datum
+temporal_seq_transfn(PG_FUNCTION_ARGS)
+{
+  SeqAggState *state = PG_ARGISNULL(0) ? NULL :
+    (SeqAggState *) PG_GETARG_POINTER(0);
+  /* Rows with a null value or timestamp are ignored */
+  if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+  {
+    if (state == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(state);
+  }
+  Datum value = PG_GETARG_ANYDATUM(1);
+  TimestampTz t = PG_GETARG_TIMESTAMPTZ(2);
+  if (state == NULL)
+  {
+    Interval *maxgap = NULL;
+    if (PG_NARGS() > 3 && ! PG_ARGISNULL(3))
+    {
+      maxgap = PG_GETARG_INTERVAL_P(3);
+      ensure_positive_interval(maxgap);
+    }
+    state = seqagg_state_make(fcinfo, get_fn_expr_argtype(fcinfo->flinfo, 1),
+      maxgap);
+  }
+
+  TInstant *last = seqagg_last_inst(state);
+  if (tgeo_base_type(state->valuetypid))
+  {
+    GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(value);
+    ensure_point_type(gs);
+    ensure_non_empty(gs);
+    if (last != NULL)
+    {
+      ensure_same_srid_tpoint_gs((Temporal *) last, gs);
+      ensure_same_dimensionality_tpoint_gs((Temporal *) last, gs);
+    }
+  }
+
+  /* Duplicate rows are ignored */
+  if (last != NULL && last->t == t &&
+    datum_eq(tinstant_value(last), value, state->valuetypid))
+    PG_RETURN_POINTER(state);
+
+  TInstant *inst = tinstant_make(value, t, state->valuetypid);
+  if (last != NULL)
+  {
+    ensure_increasing_timestamps(last, inst, false);
+    if (state->hasgap)
+    {
+      TimestampTz upper = DatumGetTimestampTz(DirectFunctionCall2(
+        timestamptz_pl_interval, TimestampTzGetDatum(last->t),
+        PointerGetDatum(&state->maxgap)));
+      if (t > upper)
+        seqagg_close(fcinfo, state);
+    }
+    /* Remove the last instant of the buffer if it is redundant */
+    if (state->count > 1 && tinstant_redundant(
+      seqagg_inst_n(state, state->count - 2), last, inst, state->linear))
+    {
+      state->count--;
+      state->datasize = state->offsets[state->count];
+    }
+  }
+  seqagg_append(fcinfo, state, inst);
+  pfree(inst);
+  DATUM_FREE_IF_COPY(value, state->valuetypid, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_seq_finalfn);
+/**
+ * Final function for the aggregates that build a temporal sequence (set).
+ * The result is a sequence when the rows are not split by a gap and a
+ * sequence set otherwise.
+ */
+PGDLLEXPORT Datum
+temporal_seq_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  SeqAggState *state = (SeqAggState *) PG_GETARG_POINTER(0);
+  if (state->count == 0 && state->seqcount == 0)
+    PG_RETURN_NULL();
+
+  /* The state is not modified since the final function may be called
+   * several times, e.g., in window functions */
+  TSequence *seq = (state->count > 0) ? seqagg_make_sequence(state) : NULL;
+  if (state->seqcount == 0)
+    PG_RETURN_POINTER(seq);
+
+  int count = state->seqcount + (seq != NULL ? 1 : 0);
+  TSequence **sequences = palloc(sizeof(TSequence *) * count);
+  memcpy(sequences, state->sequences, sizeof(TSequence *) * state->seqcount);
+  if (seq != NULL)
+    sequences[count - 1] = seq;
+  TSequenceSet *result = tsequenceset_make(sequences, count, NORMALIZE_NO);
+  pfree(sequences);
+  if (seq != NULL)
+    pfree(seq);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Aggregate appending instants
+ *****************************************************************************/
+
+/**
+ * Close the last sequence of the state, which is given compact
+ */
+static void
+appendagg_close(AppendAggState *state, TSequence *seq)
+{
+  if (state->count == state->capacity)
+  {
+    state->capacity = state->capacity == 0 ? APPENDAGG_INITIAL_CAPACITY :
+      state->capacity * 2;
+    state->sequences = state->sequences == NULL ?
+      palloc(sizeof(TSequence *) * state->capacity) :
+      repalloc(state->sequences, sizeof(TSequence *) * state->capacity);
+  }
+  state->sequences[state->count++] = seq;
+  return;
+}
+
+PG_FUNCTION_INFO_V1(temporal_append_transfn);
+/**
+ * Transition function for the aggregate that builds a temporal sequence by
+ * appending the instants of the rows, which must be given in increasing
+ * order of time.
+ *
+ * The last sequence of the state is owned by the aggregation and has spare
+ * capacity. The instants are appended to it in place, updating in place the
+ * bounding box, so that appending an instant takes amortized constant time.
+ * The trajectory of temporal points is only computed when the sequence is
+ * compacted, e.g., by the final function. When an instant
+ * starts a new sequence, the last sequence is closed and the instant
+ * becomes the new last sequence, so that the instants are still appended
+ * in place once the result is a sequence set.
+ */
+PGDLLEXPORT Datum
+temporal_append_transfn(PG_FUNCTION_ARGS)
+{
+  AppendAggState *state = PG_ARGISNULL(0) ? NULL :
+    (AppendAggState *) PG_GETARG_POINTER(0);
+  /* Null rows are ignored */
+  if (PG_ARGISNULL(1))
+  {
+    if (state == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(state);
+  }
+  Temporal *inst = PG_GETARG_TEMPORAL(1);
+  if (inst->duration != INSTANT)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The argument must be of instant duration")));
+
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  if (state == NULL)
+  {
+    state = palloc0(sizeof(AppendAggState));
+    state->seq = tinstant_to_tsequence((TInstant *) inst,
+      MOBDB_FLAGS_GET_LINEAR(inst->flags));
+  }
+  else
+  {
+    ensure_spatial_validity((Temporal *) state->seq, inst);
+    Temporal *temp = tsequence_append_tinstant(state->seq, (TInstant *) inst,
+      true);
+    if (temp->duration == SEQUENCE)
+    {
+      if ((TSequence *) temp != state->seq)
+      {
+        pfree(state->seq);
+        state->seq = (TSequence *) temp;
+      }
+    }
+    else /* temp->duration == SEQUENCESET */
+    {
+      /* The first sequence of the result is the compact last sequence of
+       * the state, the second one is the instant */
+      TSequenceSet *ts = (TSequenceSet *) temp;
+      appendagg_close(state, tsequence_copy(tsequenceset_seq_n(ts, 0)));
+      pfree(state->seq);
+      state->seq = tsequence_copy(tsequenceset_seq_n(ts, 1));
+      pfree(ts);
+    }
+  }
+  unset_aggregation_context(ctx);
+  PG_FREE_IF_COPY(inst, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_append_finalfn);
+/**
+ * Final function for the aggregate that builds a temporal sequence by
+ * appending instants. The result does not have the spare capacity of
+ * the state.
+ */
+PGDLLEXPORT Datum
+temporal_append_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  AppendAggState *state = (AppendAggState *) PG_GETARG_POINTER(0);
+  /* The state is not modified since the final function may be called
+   * several times, e.g., in window functions */
+  TSequence *seq = tsequence_compact(state->seq);
+  if (state->count == 0)
+    PG_RETURN_POINTER(seq);
+
+  TSequence **sequences = palloc(sizeof(TSequence *) * (state->count + 1));
+  memcpy(sequences, state->sequences, sizeof(TSequence *) * state->count);
+  sequences[state->count] = seq;
+  TSequenceSet *result = tsequenceset_make(sequences, state->count + 1,
+    NORMALIZE_NO);
+  pfree(sequences);
+  pfree(seq);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Bucket aggregate functions
+ *
+ * The time line is split into buckets of a fixed width starting at an
+ * origin and the aggregated values are accumulated into a dense array
+ * indexed by the number of the bucket. The result is a step temporal value
+ * that has for each bucket the aggregated value on the bucket.
+ *****************************************************************************/
+
+/**
+ * Returns the width in microseconds of the buckets defined by the interval
+ *
+ * @note Days are taken as 24 hours so that the buckets have a fixed width
+ */
+static int64
+tbucket_width(const Interval *interval)
+{
+  ensure_positive_interval(interval);
+  if (interval->month != 0)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("The bucket width cannot have months or years")));
+  return interval->time + (int64) interval->day * USECS_PER_DAY;
+}
+
+/**
+ * Returns the number of the bucket containing the timestamp
+ */
+static int64
+tbucket_no(const TBucketState *state, TimestampTz t)
+{
+  int64 delta = t - state->origin;
+  int64 result = delta / state->width;
+  if (delta % state->width < 0)
+    result--;
+  return result;
+}
+
+/**
+ * Returns the start of the bucket
+ */
+static TimestampTz
+tbucket_start(const TBucketState *state, int64 bucket)
+{
+  return state->origin + bucket * state->width;
+}
+
+/**
+ * Returns the bucket of the state
+ *
+ * @pre The bucket is covered by the state
+ */
+static TBucket *
+tbucket_get(const TBucketState *state, int64 bucket)
+{
+  return &state->buckets[state->start + (bucket - state->first)];
+}
+
+/**
+ * Create the state of a bucket aggregation in the aggregation context
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] width Width of the buckets in microseconds
+ * @param[in] origin Origin of the buckets
+ */
+static TBucketState *
+tbucket_state_make(FunctionCallInfo fcinfo, int64 width, TimestampTz origin)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  TBucketState *result = palloc0(sizeof(TBucketState));
+  unset_aggregation_context(ctx);
+  result->origin = origin;
+  result->width = width;
+  /* The array is allocated when the first buckets are covered */
+  result->buckets = NULL;
+  return result;
+}
+
+/**
+ * Ensure that the buckets of the state are the given ones
+ */
+static void
+ensure_same_buckets(const TBucketState *state, int64 width,
+  TimestampTz origin)
+{
+  if (state->width != width || state->origin != origin)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values with different buckets")));
+}
+
+/**
+ * Enlarge the state of a bucket aggregation to cover the buckets from lower
+ * to upper. The array is reallocated only when the buckets do not fit in
+ * its free slots, in which case the new array has free slots on the side
+ * on which the state grows.
+ */
+static void
+tbucket_state_cover(FunctionCallInfo fcinfo, TBucketState *state,
+  int64 lower, int64 upper)
+{
+  bool left = false;
+  if (state->count > 0)
+  {
+    left = lower < state->first;
+    lower = Min(lower, state->first);
+    upper = Max(upper, state->first + state->count - 1);
+    int64 start = state->start + (lower - state->first);
+    if (start >= 0 && start + (upper - lower) < state->capacity)
+    {
+      /* The slots outside the buckets of the state are zeroed */
+      state->start = (int) start;
+      state->first = lower;
+      state->count = (int) (upper - lower + 1);
+      return;
+    }
+  }
+
+  int64 count = upper - lower + 1;
+  int64 maxcount = (int64) (MaxAllocSize / sizeof(TBucket));
+  if (count > maxcount)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Too many buckets in the aggregation")));
+  int64 capacity = Max(state->capacity, TBUCKET_INITIAL_CAPACITY);
+  while (capacity < count * 2)
+    capacity <<= 1;
+  capacity = Min(capacity, maxcount);
+  int start = left ? (int) (capacity - count) : 0;
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  TBucket *buckets = palloc0(sizeof(TBucket) * capacity);
+  unset_aggregation_context(ctx);
+  if (state->count > 0)
+  {
+    memcpy(&buckets[start + (state->first - lower)],
+      &state->buckets[state->start], sizeof(TBucket) * state->count);
+    pfree(state->buckets);
+  }
+  state->buckets = buckets;
+  state->capacity = (int) capacity;
+  state->start = start;
+  state->first = lower;
+  state->count = (int) count;
+  return;
+}
+
+/**
+ * Add the temporal instant value to the state of a bucket aggregation
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in,out] state State of the aggregation
+ * @param[in] inst Temporal value
+ * @param[in] avg True when the values are accumulated for the average
+ * @param[in,out] last Last bucket counted for the current temporal value,
+ * used to count a value only once per bucket
+ */
+static void
+tbucket_state_add_inst(FunctionCallInfo fcinfo, TBucketState *state,
+  const TInstant *inst, bool avg, int64 *last)
+{
+  int64 bucket = tbucket_no(state, inst->t);
+  tbucket_state_cover(fcinfo, state, bucket, bucket);
+  TBucket *b = tbucket_get(state, bucket);
+  if (bucket != *last)
+  {
+    b->count++;
+    *last = bucket;
+  }
+  if (avg)
+  {
+    b->ninsts++;
+    b->sum += datum_double(tinstant_value(inst), inst->valuetypid);
+  }
+  return;
+}
+
+/**
+ * Returns the value of the temporal number given by the parallel arrays of
+ * its timestamps and values at the timestamp
+ *
+ * @param[in] times,values Arrays of timestamps and values
+ * @param[in] count Number of elements in the arrays
+ * @param[in] k Segment containing the timestamp, that is, times[k] <= t
+ * and t <= times[k + 1] unless k is the last element
+ * @param[in] t Timestamp
+ * @param[in] linear True when the interpolation is linear
+ */
+static double
+tbucket_value_at(const TimestampTz *times, const double *values, int count,
+  int k, TimestampTz t, bool linear)
+{
+  if (! linear || k == count - 1 || t == times[k])
+    return values[k];
+  return values[k] + (values[k + 1] - values[k]) *
+    (double) (t - times[k]) / (double) (times[k + 1] - times[k]);
+}
+
+/**
+ * Add the temporal sequence value to the state of a bucket aggregation.
+ * For the average, the sequence is clipped to each bucket and the integral
+ * of the clipped sequence is accumulated together with its duration.
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in,out] state State of the aggregation
+ * @param[in] seq Temporal value
+ * @param[in] avg True when the values are accumulated for the average
+ * @param[in,out] last Last bucket counted for the current temporal value
+ */
+static void
+tbucket_state_add_seq(FunctionCallInfo fcinfo, TBucketState *state,
+  const TSequence *seq, bool avg, int64 *last)
+{
+  if (seq->count == 1)
+  {
+    tbucket_state_add_inst(fcinfo, state, tsequence_inst_n(seq, 0), avg, last);
+    return;
+  }
+
+  const Period *p = &seq->period;
+  int64 lower = tbucket_no(state, p->lower);
+  int64 upper = tbucket_no(state, p->upper);
+  /* An exclusive upper bound at the start of a bucket does not reach it */
+  if (! p->upper_inc && upper > lower && p->upper == tbucket_start(state, upper))
+    upper--;
+  tbucket_state_cover(fcinfo, state, lower, upper);
+  for (int64 bucket = Max(lower, *last + 1); bucket <= upper; bucket++)
+    tbucket_get(state, bucket)->count++;
+  *last = upper;
+  if (! avg)
+    return;
+
+  int n = seq->count;
+  TimestampTz *times = palloc(sizeof(TimestampTz) * n);
+  double *values = palloc(sizeof(double) * n);
+  for (int i = 0; i < n; i++)
+  {
+    TInstant *inst = tsequence_inst_n(seq, i);
+    times[i] = inst->t;
+    values[i] = datum_double(tinstant_value(inst), inst->valuetypid);
+  }
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  /* Buffers for the sequence clipped to a bucket */
+  TimestampTz *btimes = palloc(sizeof(TimestampTz) * (n + 2));
+  double *bvalues = palloc(sizeof(double) * (n + 2));
+  int k = 0;
+  for (int64 bucket = lower; bucket <= upper; bucket++)
+  {
+    TimestampTz start = tbucket_start(state, bucket);
+    TimestampTz t1 = Max(p->lower, start);
+    TimestampTz t2 = Min(p->upper, start + state->width);
+    while (k < n - 1 && times[k + 1] <= t1)
+      k++;
+    int nb = 0;
+    btimes[nb] = t1;
+    bvalues[nb++] = tbucket_value_at(times, values, n, k, t1, linear);
+    int j = k + 1;
+    for ( ; j < n && times[j] < t2; j++)
+    {
+      btimes[nb] = times[j];
+      bvalues[nb++] = values[j];
+    }
+    TBucket *b = tbucket_get(state, bucket);
+    if (t2 > t1)
+    {
+      btimes[nb] = t2;
+      bvalues[nb++] = tbucket_value_at(times, values, n, j - 1, t2, linear);
+      b->integral += tnumberarr_integral(btimes, bvalues, nb, linear);
+      b->duration += (double) (t2 - t1);
+    }
+    else
+    {
+      /* The sequence only touches the bucket at its inclusive upper bound */
+      b->ninsts++;
+      b->sum += bvalues[0];
+    }
+    k = j - 1;
+  }
+  pfree(times); pfree(values);
+  pfree(btimes); pfree(bvalues);
+  return;
+}
+
+/**
+ * Add the temporal value to the state of a bucket aggregation
+ */
+static void
+tbucket_state_add(FunctionCallInfo fcinfo, TBucketState *state,
+  const Temporal *temp, bool avg)
+{
+  int64 last = PG_INT64_MIN;
+  if (temp->duration == INSTANT)
+    tbucket_state_add_inst(fcinfo, state, (TInstant *) temp, avg, &last);
+  else if (temp->duration == INSTANTSET)
+  {
+    TInstantSet *ti = (TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+      tbucket_state_add_inst(fcinfo, state, tinstantset_inst_n(ti, i), avg,
+        &last);
+  }
+  else if (temp->duration == SEQUENCE)
+    tbucket_state_add_seq(fcinfo, state, (TSequence *) temp, avg, &last);
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      tbucket_state_add_seq(fcinfo, state, tsequenceset_seq_n(ts, i), avg,
+        &last);
+  }
+  return;
+}
+
+/**
+ * Construct a step sequence from the instants at the start of consecutive
+ * buckets, which is closed at the end of the last bucket, and free them
+ *
+ * @pre The array of instants has space for the closing instant
+ */
+static TSequence *
+tbucket_sequence_make(TInstant **instants, int count, TimestampTz upper)
+{
+  instants[count] = tinstant_make(tinstant_value(instants[count - 1]), upper,
+    instants[count - 1]->valuetypid);
+  return tagg_sequence_make(instants, count + 1, true, false, STEP);
+}
+
+/**
+ * Returns the result of a bucket aggregation. Consecutive non-empty buckets
+ * are merged into a single sequence.
+ *
+ * @param[in] state State of the aggregation
+ * @param[in] avg True for the average, false for the count
+ */
+static TSequenceSet *
+tbucket_state_final(const TBucketState *state, bool avg)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * (state->count + 1));
+  TSequence **sequences = palloc(sizeof(TSequence *) * state->count);
+  int ninsts = 0, nseqs = 0;
+  for (int i = 0; i < state->count; i++)
+  {
+    const TBucket *b = &state->buckets[state->start + i];
+    TimestampTz start = tbucket_start(state, state->first + i);
+    bool empty = avg ? (b->duration == 0 && b->ninsts == 0) : b->count == 0;
+    if (empty)
+    {
+      if (ninsts > 0)
+        sequences[nseqs++] = tbucket_sequence_make(instants, ninsts, start);
+      ninsts = 0;
+      continue;
+    }
+    if (avg)
+    {
+      /* The instantaneous values only count when there is no duration */
+      double value = (b->duration > 0) ? b->integral / b->duration :
+        b->sum / b->ninsts;
+      instants[ninsts++] = tinstant_make(Float8GetDatum(value), start,
+        FLOAT8OID);
+    }
+    else
+      instants[ninsts++] = tinstant_make(Int32GetDatum(b->count), start,
+        INT4OID);
+  }
+  if (ninsts > 0)
+    sequences[nseqs++] = tbucket_sequence_make(instants, ninsts,
+      tbucket_start(state, state->first + state->count));
+  pfree(instants);
+  if (nseqs == 0)
+  {
+    pfree(sequences);
+    return NULL;
+  }
+  return tsequenceset_make_free(sequences, nseqs, NORMALIZE);
+}
+
+/**
+ * Generic transition function for the bucket aggregations
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] avg True for the average, false for the count
+ */
+static Datum
+temporal_bucket_transfn(FunctionCallInfo fcinfo, bool avg)
+{
+  TBucketState *state = PG_ARGISNULL(0) ? NULL :
+    (TBucketState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+  if (PG_ARGISNULL(2) || PG_ARGISNULL(3))
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("The bucket width and origin cannot be null")));
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  int64 width = tbucket_width(PG_GETARG_INTERVAL_P(2));
+  TimestampTz origin = PG_GETARG_TIMESTAMPTZ(3);
+  if (! state)
+    state = tbucket_state_make(fcinfo, width, origin);
+  else
+    ensure_same_buckets(state, width, origin);
+  tbucket_state_add(fcinfo, state, temp, avg);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_bucket_transfn);
+/**
+ * Transition function for the temporal count per bucket
+ */
+PGDLLEXPORT Datum
+temporal_tcount_bucket_transfn(PG_FUNCTION_ARGS)
+{
+  return temporal_bucket_transfn(fcinfo, false);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_bucket_transfn);
+/**
+ * Transition function for the temporal average per bucket
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_bucket_transfn(PG_FUNCTION_ARGS)
+{
+  return temporal_bucket_transfn(fcinfo, true);
+}
+
+PG_FUNCTION_INFO_V1(temporal_bucket_combinefn);
+/**
+ * Combine function for the bucket aggregations
+ */
+PGDLLEXPORT Datum
+temporal_bucket_combinefn(PG_FUNCTION_ARGS)
+{
+  TBucketState *state1 = PG_ARGISNULL(0) ? NULL :
+    (TBucketState *) PG_GETARG_POINTER(0);
+  TBucketState *state2 = PG_ARGISNULL(1) ? NULL :
+    (TBucketState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (! state1)
+    PG_RETURN_POINTER(state2);
+  if (! state2 || state2->count == 0)
+    PG_RETURN_POINTER(state1);
+
+  ensure_same_buckets(state1, state2->width, state2->origin);
+  tbucket_state_cover(fcinfo, state1, state2->first,
+    state2->first + state2->count - 1);
+  for (int i = 0; i < state2->count; i++)
+  {
+    const TBucket *b2 = &state2->buckets[state2->start + i];
+    TBucket *b1 = tbucket_get(state1, state2->first + i);
+    b1->count += b2->count;
+    b1->ninsts += b2->ninsts;
+    b1->sum += b2->sum;
+    b1->integral += b2->integral;
+    b1->duration += b2->duration;
+  }
+  PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_bucket_finalfn);
+/**
+ * Final function for the temporal count per bucket
+ */
+PGDLLEXPORT Datum
+temporal_tcount_bucket_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  TBucketState *state = (TBucketState *) PG_GETARG_POINTER(0);
+  TSequenceSet *result = tbucket_state_final(state, false);
+  if (! result)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_bucket_finalfn);
+/**
+ * Final function for the temporal average per bucket
+ */
+PGDLLEXPORT Datum
+tnumber_tavg_bucket_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  TBucketState *state = (TBucketState *) PG_GETARG_POINTER(0);
+  TSequenceSet *result = tbucket_state_final(state, true);
+  if (! result)
+    PG_RETURN_NULL();
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_bucket_serialize);
+/**
+ * Serialize the state value of the bucket aggregations
+ */
+PGDLLEXPORT Datum
+temporal_bucket_serialize(PG_FUNCTION_ARGS)
+{
+  TBucketState *state = (TBucketState *) PG_GETARG_POINTER(0);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+  pq_sendint64(&buf, state->origin);
+  pq_sendint64(&buf, state->width);
+  pq_sendint64(&buf, state->first);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  if (state->count > 0)
+    pq_sendbytes(&buf, (char *) &state->buckets[state->start],
+      (int) (sizeof(TBucket) * state->count));
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(temporal_bucket_deserialize);
+/**
+ * Deserialize the state value of the bucket aggregations
+ */
+PGDLLEXPORT Datum
+temporal_bucket_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = PG_GETARG_BYTEA_P(0);
+  StringInfoData buf =
+  {
+    .cursor = 0,
+    .data = VARDATA(data),
+    .len = VARSIZE(data) - VARHDRSZ,
+    .maxlen = VARSIZE(data) - VARHDRSZ
+  };
+  TimestampTz origin = pq_getmsgint64(&buf);
+  int64 width = pq_getmsgint64(&buf);
+  int64 first = pq_getmsgint64(&buf);
+  int count = pq_getmsgint(&buf, 4);
+  TBucketState *result = tbucket_state_make(fcinfo, width, origin);
+  if (count > 0)
+  {
+    tbucket_state_cover(fcinfo, result, first, first + count - 1);
+    size_t size = sizeof(TBucket) * count;
+    memcpy(&result->buckets[result->start], pq_getmsgbytes(&buf, (int) size),
+      size);
+  }
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Merge aggregate functions
+ *
+ * The aggregate merges temporal values that do not overlap on time, e.g.,
+ * the fragments of a trip kept in different partitions. The incoming
+ * sequences are buffered and the buffer is merged with the sequences merged
+ * so far each time it is full, so that the state only keeps the merged
+ * sequences and a bounded number of pending ones.
+ *****************************************************************************/
+
+/**
+ * Create the state of the merge aggregation in the aggregation context
+ *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[in] linear True when the sequences are linear
+ */
+static MergeAggState *
+mergeagg_state_make(FunctionCallInfo fcinfo, bool linear)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  MergeAggState *result = palloc0(sizeof(MergeAggState));
+  result->linear = linear;
+  result->capacity = MERGEAGG_INITIAL_CAPACITY;
+  result->sequences = palloc(sizeof(TSequence *) * result->capacity);
+  unset_aggregation_context(ctx);
+  return result;
+}
+
+/**
+ * Ensure that the interpolation of the temporal value is the one of the
+ * state of the merge aggregation
+ */
+static void
+ensure_same_interpolation_mergeagg(const MergeAggState *state, bool linear)
+{
+  if (state->linear != linear)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("Input values must be of the same interpolation")));
+}
+
+/**
+ * Merge the sequences with the merged sequences of the state. The sequences
+ * must be allocated in the aggregation context and are freed.
+ *
+ * Only the merged sequences that may overlap or be adjacent to the new ones
+ * are merged again. When the sequences arrive roughly in time order, which
+ * is the usual case, this is at most the last merged sequence.
+ */
+static void
+mergeagg_merge(FunctionCallInfo fcinfo, MergeAggState *state,
+  TSequence **sequences, int count)
+{
+  if (count == 0)
+    return;
+  tsequencearr_sort(sequences, count);
+  TimestampTz lower = sequences[0]->period.lower;
+  int from = state->count;
+  while (from > 0 && state->sequences[from - 1]->period.upper >= lower)
+    from--;
+  int nold = state->count - from;
+  int n = nold + count;
+  TSequence **all = palloc(sizeof(TSequence *) * n);
+  memcpy(all, &state->sequences[from], sizeof(TSequence *) * nold);
+  memcpy(&all[nold], sequences, sizeof(TSequence *) * count);
+
+  /* The validity of the sequences is tested when merging them */
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  int newcount;
+  TSequence **newseqs = tsequence_merge_array1(all, n, &newcount);
+  if (from + newcount > state->capacity)
+  {
+    while (from + newcount > state->capacity)
+      state->capacity <<= 1;
+    state->sequences = repalloc(state->sequences,
+      sizeof(TSequence *) * state->capacity);
+  }
+  unset_aggregation_context(ctx);
+  memcpy(&state->sequences[from], newseqs, sizeof(TSequence *) * newcount);
+  state->count = from + newcount;
+  for (int i = 0; i < n; i++)
+    pfree(all[i]);
+  pfree(all); pfree(newseqs);
+  return;
+}
+
+/**
+ * Merge the buffer of pending sequences of the state
+ */
+static void
+mergeagg_flush(FunctionCallInfo fcinfo, MergeAggState *state)
+{
+  mergeagg_merge(fcinfo, state, state->pending, state->npending);
+  state->npending = 0;
+  return;
+}
+
+/**
+ * Add a copy of the sequence to the buffer of pending sequences of the
+ * state, which is merged when it is full
+ */
+static void
+mergeagg_add(FunctionCallInfo fcinfo, MergeAggState *state,
+  const TSequence *seq)
+{
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  state->pending[state->npending++] = tsequence_copy(seq);
+  unset_aggregation_context(ctx);
+  if (state->npending == MERGEAGG_BUFFER_SIZE)
+    mergeagg_flush(fcinfo, state);
+  return;
+}
+
+/**
+ * Add the temporal value to the state of the merge aggregation. Instants
+ * are added as instantaneous sequences.
+ */
+static void
+mergeagg_add_temporal(FunctionCallInfo fcinfo, MergeAggState *state,
+  const Temporal *temp)
+{
+  if (temp->duration == INSTANT)
+  {
+    TSequence *seq = tinstant_to_tsequence((TInstant *) temp, state->linear);
+    mergeagg_add(fcinfo, state, seq);
+    pfree(seq);
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    TInstantSet *ti = (TInstantSet *) temp;
+    for (int i = 0; i < ti->count; i++)
+    {
+      TSequence *seq = tinstant_to_tsequence(tinstantset_inst_n(ti, i),
+        state->linear);
+      mergeagg_add(fcinfo, state, seq);
+      pfree(seq);
+    }
+  }
+  else if (temp->duration == SEQUENCE)
+    mergeagg_add(fcinfo, state, (TSequence *) temp);
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    for (int i = 0; i < ts->count; i++)
+      mergeagg_add(fcinfo, state, tsequenceset_seq_n(ts, i));
+  }
+  return;
+}
+
+PG_FUNCTION_INFO_V1(temporal_merge_transfn);
+/**
+ * Transition function for the merge aggregation
+ */
+PGDLLEXPORT Datum
+temporal_merge_transfn(PG_FUNCTION_ARGS)
+{
+  MergeAggState *state = PG_ARGISNULL(0) ? NULL :
+    (MergeAggState *) PG_GETARG_POINTER(0);
+  if (PG_ARGISNULL(1))
+  {
+    if (state)
+      PG_RETURN_POINTER(state);
+    else
+      PG_RETURN_NULL();
+  }
+
+  Temporal *temp = PG_GETARG_TEMPORAL(1);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  if (! state)
+    state = mergeagg_state_make(fcinfo, linear);
+  else
+    ensure_same_interpolation_mergeagg(state, linear);
+  mergeagg_add_temporal(fcinfo, state, temp);
+  PG_FREE_IF_COPY(temp, 1);
+  PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_merge_combinefn);
+/**
+ * Combine function for the merge aggregation
+ */
+PGDLLEXPORT Datum
+temporal_merge_combinefn(PG_FUNCTION_ARGS)
+{
+  MergeAggState *state1 = PG_ARGISNULL(0) ? NULL :
+    (MergeAggState *) PG_GETARG_POINTER(0);
+  MergeAggState *state2 = PG_ARGISNULL(1) ? NULL :
+    (MergeAggState *) PG_GETARG_POINTER(1);
+  if (state1 == NULL && state2 == NULL)
+    PG_RETURN_NULL();
+  if (! state1)
+    PG_RETURN_POINTER(state2);
+  if (! state2)
+    PG_RETURN_POINTER(state1);
+
+  ensure_same_interpolation_mergeagg(state1, state2->linear);
+  mergeagg_flush(fcinfo, state1);
+  mergeagg_flush(fcinfo, state2);
+  /* The sequences of the second state are taken over by the first one */
+  mergeagg_merge(fcinfo, state1, state2->sequences, state2->count);
+  state2->count = 0;
+  PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(temporal_merge_finalfn);
+/**
+ * Final function for the merge aggregation
+ */
+PGDLLEXPORT Datum
+temporal_merge_finalfn(PG_FUNCTION_ARGS)
+{
+  /* The final function is strict, we do not need to test for null values */
+  MergeAggState *state = (MergeAggState *) PG_GETARG_POINTER(0);
+  mergeagg_flush(fcinfo, state);
+  if (state->count == 0)
+    PG_RETURN_NULL();
+  TSequenceSet *result = tsequenceset_make(state->sequences, state->count,
+    NORMALIZE_NO);
+  PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_merge_serialize);
+/**
+ * Serialize the state value of the merge aggregation
+ */
+PGDLLEXPORT Datum
+temporal_merge_serialize(PG_FUNCTION_ARGS)
+{
+  MergeAggState *state = (MergeAggState *) PG_GETARG_POINTER(0);
+  mergeagg_flush(fcinfo, state);
+  StringInfoData buf;
+  pq_begintypsend(&buf);
+  pq_sendbyte(&buf, state->linear ? 1 : 0);
+#if MOBDB_PGSQL_VERSION < 110000
+  pq_sendint(&buf, (uint32) state->count, 4);
+#else
+  pq_sendint32(&buf, (uint32) state->count);
+#endif
+  for (int i = 0; i < state->count; i++)
+  {
+    int padding = MAXALIGN(buf.len) - buf.len;
+    if (padding)
+    {
+      enlargeStringInfo(&buf, padding);
+      memset(buf.data + buf.len, 0, padding);
+      buf.len += padding;
+    }
+    appendBinaryStringInfo(&buf, (char *) state->sequences[i],
+      VARSIZE(state->sequences[i]));
+  }
+  PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(temporal_merge_deserialize);
+/**
+ * Deserialize the state value of the merge aggregation
+ */
+PGDLLEXPORT Datum
+temporal_merge_deserialize(PG_FUNCTION_ARGS)
+{
+  bytea *data = aggstate_bytea_align(PG_GETARG_BYTEA_P(0));
+  /* The offsets in the buffer are those of the serialization function,
+   * which start after the header of the bytea */
+  StringInfoData buf =
+  {
+    .cursor = VARHDRSZ,
+    .data = (char *) data,
+    .len = VARSIZE(data),
+    .maxlen = VARSIZE(data)
+  };
+  bool linear = (bool) pq_getmsgbyte(&buf);
+  int count = pq_getmsgint(&buf, 4);
+  MergeAggState *result = mergeagg_state_make(fcinfo, linear);
+  MemoryContext ctx = set_aggregation_context(fcinfo);
+  if (count > result->capacity)
+  {
+    while (count > result->capacity)
+      result->capacity <<= 1;
+    result->sequences = repalloc(result->sequences,
+      sizeof(TSequence *) * result->capacity);
+  }
+  /* The sequences are already merged */
+  for (int i = 0; i < count; i++)
+  {
+    buf.cursor = MAXALIGN(buf.cursor);
+    TSequence *seq = (TSequence *) (buf.data + buf.cursor);
+    pq_getmsgbytes(&buf, VARSIZE(seq));
+    result->sequences[i] = tsequence_copy(seq);
+  }
+  unset_aggregation_context(ctx);
+  result->count = count;
   PG_RETURN_POINTER(result);
 }
 
@@ -110,6 +110,26 @@ temporal_bbox_cmp(const void *box1, const void *box2, Oid valuetypid)
   return result;
 }
 
+/**
+ * Expand the first bounding box with the second one
+ *
+ * @param[in,out] box1 Bounding box to expand
+ * @param[in] box2 Bounding box
+ * @param[in] valuetypid Oid of the base type
+ */
+void
+temporal_bbox_expand(void *box1, const void *box2, Oid valuetypid)
+{
+  ensure_temporal_base_type(valuetypid);
+  if (talpha_base_type(valuetypid))
+    period_expand((Period *)box1, (Period *)box2);
+  else if (tnumber_base_type(valuetypid))
+    tbox_expand((TBOX *)box1, (TBOX *)box2);
+  else if (tgeo_base_type(valuetypid))
+    stbox_expand((STBOX *)box1, (STBOX *)box2);
+  return;
+}
+
 /**
  * Shift and/or scale the time span of the bounding box with the two intervals
  *
@@ -318,11 +338,9 @@ boxop_period_temporal(FunctionCallInfo fcinfo,
   bool (*func)(const Period *, const Period *))
 {
   Period *p = PG_GETARG_PERIOD(0);
-  Temporal *temp = PG_GETARG_TEMPORAL(1);
   Period p1;
-  temporal_period(&p1, temp);
+  temporal_period_slice(PG_GETARG_DATUM(1), &p1);
   bool result = func(p, &p1);
-  PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_BOOL(result);
 }
 
@@ -336,12 +354,10 @@ Datum
 boxop_temporal_period(FunctionCallInfo fcinfo,
   bool (*func)(const Period *, const Period *))
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   Period *p = PG_GETARG_PERIOD(1);
   Period p1;
-  temporal_period(&p1, temp);
+  temporal_period_slice(PG_GETARG_DATUM(0), &p1);
   bool result = func(&p1, p);
-  PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_BOOL(result);
 }
 
@@ -355,14 +371,10 @@ Datum
 boxop_temporal_temporal(FunctionCallInfo fcinfo,
   bool (*func)(const Period *, const Period *))
 {
-  Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-  Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   Period p1, p2;
-  temporal_period(&p1, temp1);
-  temporal_period(&p2, temp2);
+  temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+  temporal_period_slice(PG_GETARG_DATUM(1), &p2);
   bool result = func(&p1, &p2);
-  PG_FREE_IF_COPY(temp1, 0);
-  PG_FREE_IF_COPY(temp2, 1);
   PG_RETURN_BOOL(result);
 }
 
@@ -576,15 +588,13 @@ boxop_range_tnumber(FunctionCallInfo fcinfo,
   char flags = range_get_flags(range);
   if (flags & RANGE_EMPTY)
     PG_RETURN_BOOL(func == &contained_tbox_tbox_internal);
-  Temporal *temp = PG_GETARG_TEMPORAL(1);
   TBOX box1, box2;
   memset(&box1, 0, sizeof(TBOX));
   memset(&box2, 0, sizeof(TBOX));
   range_to_tbox_internal(&box1, range);
-  temporal_bbox(&box2, temp);
+  temporal_bbox_slice(PG_GETARG_DATUM(1), &box2);
   bool result = func(&box1, &box2);
   PG_FREE_IF_COPY(range, 0);
-  PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_BOOL(result);
 }
 
@@ -598,7 +608,6 @@ Datum
 boxop_tnumber_range(FunctionCallInfo fcinfo,
   bool (*func)(const TBOX *, const TBOX *))
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
 #if MOBDB_PGSQL_VERSION < 110000
   RangeType  *range = PG_GETARG_RANGE(1);
 #else
@@ -611,10 +620,9 @@ boxop_tnumber_range(FunctionCallInfo fcinfo,
   TBOX box1, box2;
   memset(&box1, 0, sizeof(TBOX));
   memset(&box2, 0, sizeof(TBOX));
-  temporal_bbox(&box1, temp);
+  temporal_bbox_slice(PG_GETARG_DATUM(0), &box1);
   range_to_tbox_internal(&box2, range);
   bool result = func(&box1, &box2);
-  PG_FREE_IF_COPY(temp, 0);
   PG_FREE_IF_COPY(range, 1);
   PG_RETURN_BOOL(result);
 }
@@ -630,12 +638,10 @@ boxop_tbox_tnumber(FunctionCallInfo fcinfo,
   bool (*func)(const TBOX *, const TBOX *))
 {
   TBOX *box = PG_GETARG_TBOX_P(0);
-  Temporal *temp = PG_GETARG_TEMPORAL(1);
   TBOX box1;
   memset(&box1, 0, sizeof(TBOX));
-  temporal_bbox(&box1, temp);
+  temporal_bbox_slice(PG_GETARG_DATUM(1), &box1);
   bool result = func(box, &box1);
-  PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_BOOL(result);
 }
 
@@ -649,13 +655,11 @@ Datum
 boxop_tnumber_tbox(FunctionCallInfo fcinfo,
   bool (*func)(const TBOX *, const TBOX *))
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   TBOX *box = PG_GETARG_TBOX_P(1);
   TBOX box1;
   memset(&box1, 0, sizeof(TBOX));
-  temporal_bbox(&box1, temp);
+  temporal_bbox_slice(PG_GETARG_DATUM(0), &box1);
   bool result = func(&box1, box);
-  PG_FREE_IF_COPY(temp, 0);
   PG_RETURN_BOOL(result);
 }
 
@@ -669,16 +673,12 @@ Datum
 boxop_tnumber_tnumber(FunctionCallInfo fcinfo,
   bool (*func)(const TBOX *, const TBOX *))
 {
-  Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-  Temporal *temp2 = PG_GETARG_TEMPORAL(1);
   TBOX box1, box2;
   memset(&box1, 0, sizeof(TBOX));
   memset(&box2, 0, sizeof(TBOX));
-  temporal_bbox(&box1, temp1);
-  temporal_bbox(&box2, temp2);
+  temporal_bbox_slice(PG_GETARG_DATUM(0), &box1);
+  temporal_bbox_slice(PG_GETARG_DATUM(1), &box2);
   bool result = func(&box1, &box2);
-  PG_FREE_IF_COPY(temp1, 0);
-  PG_FREE_IF_COPY(temp2, 1);
   PG_RETURN_BOOL(result);
 }
 
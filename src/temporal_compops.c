@@ -16,10 +16,599 @@
 
 #include "temporaltypes.h"
 #include "temporal_util.h"
+#include "timeops.h"
 #include "lifting.h"
 #include "oidcache.h"
 #include "tpoint_spatialfuncs.h"
 
+/*****************************************************************************
+ * Bounding box short-circuit
+ *
+ * The value range of the bounding box of a temporal number contains all the
+ * values taken by the temporal number. When the value ranges of the operands
+ * state that the comparison has the same result at every instant, the
+ * result is a constant temporal Boolean over the time extent, which is
+ * computed without applying the comparison to the instants.
+ *****************************************************************************/
+
+/**
+ * Returns true if the comparison of all the values in the first range with
+ * all the values in the second range has the same result
+ *
+ * @param[in] oper Enumeration that states the comparison operator
+ * @param[in] xmin1,xmax1 First value range
+ * @param[in] xmin2,xmax2 Second value range
+ * @param[out] result Result of the comparison
+ * @note Zeros of different sign are equal as doubles, while the lifted
+ * comparison compares floats bitwise. Therefore, the ties on zero that
+ * determine the result of an equality are left to the lifted comparison.
+ */
+static bool
+tcomp_range_range(TComparison oper, double xmin1, double xmax1,
+  double xmin2, double xmax2, bool *result)
+{
+  bool found = true;
+  if (oper == EQ || oper == NE)
+  {
+    if (xmax1 < xmin2 || xmax2 < xmin1)
+      *result = (oper == NE);
+    else if (xmin1 == xmax1 && xmin2 == xmax2 && xmin1 == xmin2 &&
+        xmin1 != 0.0)
+      *result = (oper == EQ);
+    else
+      found = false;
+  }
+  else if (oper == LT)
+  {
+    if (xmax1 < xmin2)
+      *result = true;
+    else if (xmin1 >= xmax2)
+      *result = false;
+    else
+      found = false;
+  }
+  else if (oper == LE)
+  {
+    if (xmax1 < xmin2 || (xmax1 == xmin2 && xmin2 != 0.0))
+      *result = true;
+    else if (xmin1 > xmax2)
+      *result = false;
+    else
+      found = false;
+  }
+  else if (oper == GT)
+  {
+    if (xmin1 > xmax2)
+      *result = true;
+    else if (xmax1 <= xmin2)
+      *result = false;
+    else
+      found = false;
+  }
+  else /* oper == GE */
+  {
+    if (xmin1 > xmax2 || (xmin1 == xmax2 && xmax2 != 0.0))
+      *result = true;
+    else if (xmax1 < xmin2)
+      *result = false;
+    else
+      found = false;
+  }
+  return found;
+}
+
+/**
+ * Returns a temporal Boolean with constant value defined on the time of
+ * the temporal value. The result has the same duration as the result of
+ * the lifted comparison.
+ */
+static Temporal *
+tbool_const_temporal(const Temporal *temp, bool value)
+{
+  Datum datum = BoolGetDatum(value);
+  Temporal *result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result = (Temporal *) tinstant_make(datum, ((TInstant *) temp)->t,
+      BOOLOID);
+  else if (temp->duration == INSTANTSET)
+  {
+    TInstantSet *ti = (TInstantSet *) temp;
+    TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+    for (int i = 0; i < ti->count; i++)
+      instants[i] = tinstant_make(datum, tinstantset_inst_n(ti, i)->t,
+        BOOLOID);
+    result = (Temporal *) tinstantset_make_free(instants, ti->count);
+  }
+  else if (temp->duration == SEQUENCE)
+  {
+    TSequence *seq = (TSequence *) temp;
+    TSequence *seqresult = tsequence_from_base_internal(datum, BOOLOID,
+      &seq->period, STEP);
+    /* Comparisons of linear sequences have instantaneous discontinuities
+     * and thus result in a sequence set */
+    if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
+    {
+      result = (Temporal *) tsequence_to_tsequenceset(seqresult);
+      pfree(seqresult);
+    }
+    else
+      result = (Temporal *) seqresult;
+  }
+  else /* temp->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) temp;
+    TSequence **sequences = palloc(sizeof(TSequence *) * ts->count);
+    for (int i = 0; i < ts->count; i++)
+      sequences[i] = tsequence_from_base_internal(datum, BOOLOID,
+        &tsequenceset_seq_n(ts, i)->period, STEP);
+    result = (Temporal *) tsequenceset_make_free(sequences, ts->count,
+      NORMALIZE);
+  }
+  return result;
+}
+
+/**
+ * Returns the comparison of the temporal number and the number if the
+ * bounding box of the temporal number determines a constant result,
+ * returns NULL otherwise
+ *
+ * @param[in] temp Temporal number
+ * @param[in] value Number
+ * @param[in] valuetypid Oid of the base type of the number
+ * @param[in] oper Enumeration that states the comparison operator
+ * @param[in] invert True when the base value is the first argument
+ * of the function
+ */
+static Temporal *
+tcomp_tnumber_base_bbox(const Temporal *temp, Datum value, Oid valuetypid,
+  TComparison oper, bool invert)
+{
+  if (! tnumber_base_type(temp->valuetypid) || ! tnumber_base_type(valuetypid))
+    return NULL;
+  TBOX box;
+  memset(&box, 0, sizeof(TBOX));
+  temporal_bbox(&box, temp);
+  double d = datum_double(value, valuetypid);
+  bool result;
+  bool found = invert ?
+    tcomp_range_range(oper, d, d, box.xmin, box.xmax, &result) :
+    tcomp_range_range(oper, box.xmin, box.xmax, d, d, &result);
+  if (! found)
+    return NULL;
+  return tbool_const_temporal(temp, result);
+}
+
+/**
+ * Returns the comparison of the temporal numbers if their bounding boxes
+ * determine a constant result, returns NULL otherwise
+ *
+ * @param[in] temp1,temp2 Temporal numbers
+ * @param[in] oper Enumeration that states the comparison operator
+ * @param[out] found True when the bounding boxes determine the result
+ * @note The shortcut is only applied to temporal numbers of sequence or
+ * sequence set duration, for which the lifting is the most expensive
+ */
+static Temporal *
+tcomp_tnumber_tnumber_bbox(const Temporal *temp1, const Temporal *temp2,
+  TComparison oper, bool *found)
+{
+  *found = false;
+  if (! tnumber_base_type(temp1->valuetypid) ||
+      temp1->duration < SEQUENCE || temp2->duration < SEQUENCE)
+    return NULL;
+  TBOX box1, box2;
+  memset(&box1, 0, sizeof(TBOX));
+  memset(&box2, 0, sizeof(TBOX));
+  temporal_bbox(&box1, temp1);
+  temporal_bbox(&box2, temp2);
+  bool value;
+  if (! tcomp_range_range(oper, box1.xmin, box1.xmax, box2.xmin, box2.xmax,
+      &value))
+    return NULL;
+
+  *found = true;
+  Datum datum = BoolGetDatum(value);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) ||
+    MOBDB_FLAGS_GET_LINEAR(temp2->flags);
+  /* The result is a sequence only for two step sequences */
+  if (temp1->duration == SEQUENCE && temp2->duration == SEQUENCE && ! linear)
+  {
+    Period *inter = intersection_period_period_internal(
+      &((TSequence *) temp1)->period, &((TSequence *) temp2)->period);
+    if (inter == NULL)
+      return NULL;
+    Temporal *result = (Temporal *) tsequence_from_base_internal(datum,
+      BOOLOID, inter, STEP);
+    pfree(inter);
+    return result;
+  }
+  PeriodSet *ps1 = temporal_get_time_internal(temp1);
+  PeriodSet *ps2 = temporal_get_time_internal(temp2);
+  PeriodSet *inter = intersection_periodset_periodset_internal(ps1, ps2);
+  pfree(ps1); pfree(ps2);
+  if (inter == NULL)
+    return NULL;
+  Temporal *result = (Temporal *) tsequenceset_from_base_internal(datum,
+    BOOLOID, inter, STEP);
+  pfree(inter);
+  return result;
+}
+
+/*****************************************************************************
+ * Specialized kernels
+ *
+ * The comparison of a temporal number and a number is computed by testing
+ * the values of the instants directly rather than by calling the comparison
+ * function through the lifting framework. For linear temporal floats, the
+ * constant segments of the result are joined as soon as they are computed,
+ * following the rules of function tsequencearr_normalize, instead of being
+ * constructed as sequences and normalized afterwards. The result is thus
+ * the same as the one of the lifted comparison.
+ *****************************************************************************/
+
+/**
+ * Number to which the values of a temporal number are compared
+ */
+typedef struct
+{
+  Datum value;        /**< Number */
+  Oid valuetypid;     /**< Oid of the base type of the number */
+  double d;           /**< Number as a double */
+  Oid temptypid;      /**< Oid of the base type of the temporal number */
+  TComparison oper;   /**< Comparison operator */
+  bool invert;        /**< True when the number is the first argument */
+} TCompNumber;
+
+/**
+ * Returns true if the value of the temporal number is equal to the number,
+ * as done by function datum_eq2
+ */
+static bool
+tcomp_number_eq(Datum value, const TCompNumber *num)
+{
+  if (num->temptypid == num->valuetypid)
+    return value == num->value;
+  return datum_double(value, num->temptypid) == num->d;
+}
+
+/**
+ * Returns the comparison of the value of the temporal number and the number
+ */
+static bool
+tcomp_number(Datum value, const TCompNumber *num)
+{
+  double x = datum_double(value, num->temptypid);
+  bool eq = tcomp_number_eq(value, num);
+  bool lt = num->invert ? num->d < x : x < num->d;
+  bool gt = num->invert ? x < num->d : num->d < x;
+  bool result = false; /* make compiler quiet */
+  if (num->oper == EQ)
+    result = eq;
+  else if (num->oper == NE)
+    result = ! eq;
+  else if (num->oper == LT)
+    result = lt;
+  else if (num->oper == LE)
+    result = eq || lt;
+  else if (num->oper == GT)
+    result = gt;
+  else /* num->oper == GE */
+    result = eq || gt;
+  return result;
+}
+
+/**
+ * Returns the comparison of the temporal instant number and the number
+ */
+static TInstant *
+tcomp_tnumberinst_base(const TInstant *inst, const TCompNumber *num)
+{
+  bool result = tcomp_number(tinstant_value(inst), num);
+  return tinstant_make(BoolGetDatum(result), inst->t, BOOLOID);
+}
+
+/**
+ * Returns the comparison of the temporal instant set number and the number
+ */
+static TInstantSet *
+tcomp_tnumberinstset_base(const TInstantSet *ti, const TCompNumber *num)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+  for (int i = 0; i < ti->count; i++)
+    instants[i] = tcomp_tnumberinst_base(tinstantset_inst_n(ti, i), num);
+  return tinstantset_make_free(instants, ti->count);
+}
+
+/**
+ * Returns the comparison of the temporal sequence number with step
+ * interpolation and the number
+ *
+ * @note Only the instants at which the result changes are constructed,
+ * which are those kept by the normalization of the result
+ */
+static TSequence *
+tcomp_tnumberseq_step_base(const TSequence *seq, const TCompNumber *num)
+{
+  TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  bool lastresult = false; /* make compiler quiet */
+  int k = 0;
+  for (int i = 0; i < seq->count; i++)
+  {
+    TInstant *inst = tsequence_inst_n(seq, i);
+    bool result = tcomp_number(tinstant_value(inst), num);
+    if (i == 0 || i == seq->count - 1 || result != lastresult)
+    {
+      instants[k++] = tinstant_make(BoolGetDatum(result), inst->t, BOOLOID);
+      lastresult = result;
+    }
+  }
+  return tsequence_make_free(instants, k, seq->period.lower_inc,
+    seq->period.upper_inc, STEP, NORMALIZE_NO);
+}
+
+/**
+ * Sequences of the temporal Boolean resulting from the comparison of a
+ * linear temporal float and a number
+ */
+typedef struct
+{
+  TSequence **sequences;  /**< Sequences constructed so far */
+  int count;              /**< Number of sequences constructed so far */
+  TInstant **instants;    /**< Instants of the current sequence */
+  int ninsts;             /**< Number of instants of the current sequence */
+  bool lower_inc;         /**< Lower bound of the current sequence */
+  bool upper_inc;         /**< Upper bound of the current sequence */
+} TBoolSeqState;
+
+/**
+ * Constructs the current sequence of the state
+ */
+static void
+tboolseq_state_flush(TBoolSeqState *state)
+{
+  state->sequences[state->count++] = tsequence_make1(state->instants,
+    state->ninsts, state->lower_inc, state->upper_inc, STEP, NORMALIZE_NO);
+  for (int i = 0; i < state->ninsts; i++)
+    pfree(state->instants[i]);
+  state->ninsts = 0;
+  return;
+}
+
+/**
+ * Adds the instants of the constant segment to the current sequence of the
+ * state
+ */
+static void
+tboolseq_state_append(TBoolSeqState *state, bool value, TimestampTz lower,
+  TimestampTz upper)
+{
+  state->instants[state->ninsts++] = tinstant_make(BoolGetDatum(value),
+    lower, BOOLOID);
+  if (lower < upper)
+    state->instants[state->ninsts++] = tinstant_make(BoolGetDatum(value),
+      upper, BOOLOID);
+  return;
+}
+
+/**
+ * Adds a constant segment to the state, joining it to the current sequence
+ * when function tsequencearr_normalize would join them
+ *
+ * @param[in,out] state State
+ * @param[in] value Value of the segment
+ * @param[in] lower,upper Bounds of the segment, which is instantaneous
+ * when they are equal
+ * @param[in] lower_inc,upper_inc True when the bounds are inclusive
+ */
+static void
+tboolseq_state_add(TBoolSeqState *state, bool value, TimestampTz lower,
+  TimestampTz upper, bool lower_inc, bool upper_inc)
+{
+  /* Empty segment */
+  if (lower == upper && (! lower_inc || ! upper_inc))
+    return;
+
+  if (state->ninsts > 0)
+  {
+    TInstant *last1 = state->instants[state->ninsts - 1];
+    bool last1value = DatumGetBool(tinstant_value(last1));
+    bool adjacent = last1->t == lower && (state->upper_inc || lower_inc);
+    if (adjacent && state->ninsts > 1 && lower < upper &&
+      DatumGetBool(tinstant_value(state->instants[state->ninsts - 2])) ==
+        last1value && last1value == value)
+    {
+      /* The last segment is extended up to the end of the new one */
+      tinstant_set(last1, BoolGetDatum(value), upper);
+    }
+    else if (adjacent && ! state->upper_inc)
+    {
+      /* The last instant is replaced by the new segment */
+      pfree(last1);
+      state->ninsts--;
+      tboolseq_state_append(state, value, lower, upper);
+    }
+    else if (adjacent && last1value == value)
+    {
+      /* The new segment continues the last instant */
+      if (lower < upper)
+        state->instants[state->ninsts++] = tinstant_make(BoolGetDatum(value),
+          upper, BOOLOID);
+    }
+    else
+    {
+      tboolseq_state_flush(state);
+      tboolseq_state_append(state, value, lower, upper);
+      state->lower_inc = lower_inc;
+    }
+  }
+  else
+  {
+    tboolseq_state_append(state, value, lower, upper);
+    state->lower_inc = lower_inc;
+  }
+  state->upper_inc = upper_inc;
+  return;
+}
+
+/**
+ * Adds to the state the comparison of the temporal sequence float with
+ * linear interpolation and the number
+ *
+ * @note The segments of the result are those computed by function
+ * tfunc_tsequence_base_discont1
+ */
+static void
+tcomp_tfloatseq_linear_base(TBoolSeqState *state, const TSequence *seq,
+  const TCompNumber *num)
+{
+  TInstant *start = tsequence_inst_n(seq, 0);
+  Datum startvalue = tinstant_value(start);
+  bool startresult = tcomp_number(startvalue, num);
+  if (seq->count == 1)
+  {
+    tboolseq_state_add(state, startresult, start->t, start->t, true, true);
+    return;
+  }
+
+  bool lower_inc = seq->period.lower_inc;
+  for (int i = 1; i < seq->count; i++)
+  {
+    TInstant *end = tsequence_inst_n(seq, i);
+    Datum endvalue = tinstant_value(end);
+    bool endresult = tcomp_number(endvalue, num);
+    bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
+    Datum intvalue;
+    bool intresult, lower_eq, upper_eq;
+    TimestampTz inttime;
+    /* Constant segment */
+    if (datum_eq(startvalue, endvalue, FLOAT8OID))
+      tboolseq_state_add(state, startresult, start->t, end->t, lower_inc,
+        upper_inc);
+    /* Segment starting or ending at the number: the result is constant
+     * in the interior of the segment */
+    else if (tcomp_number_eq(startvalue, num) ||
+      tcomp_number_eq(endvalue, num))
+    {
+      inttime = start->t + ((end->t - start->t) / 2);
+      intvalue = tsequence_value_at_timestamp1(start, end, LINEAR, inttime);
+      intresult = tcomp_number(intvalue, num);
+      lower_eq = lower_inc && startresult == intresult;
+      upper_eq = upper_inc && intresult == endresult;
+      if (lower_inc && ! lower_eq)
+        tboolseq_state_add(state, startresult, start->t, start->t, true, true);
+      tboolseq_state_add(state, intresult, start->t, end->t, lower_eq,
+        upper_eq);
+      if (upper_inc && ! upper_eq)
+        tboolseq_state_add(state, endresult, end->t, end->t, true, true);
+    }
+    /* Segment that does not cross the number */
+    else if (! tlinearseq_intersection_value(start, end, num->value,
+      num->valuetypid, &intvalue, &inttime))
+    {
+      tboolseq_state_add(state, startresult, start->t, end->t, lower_inc,
+        false);
+      if (upper_inc)
+        tboolseq_state_add(state, endresult, end->t, end->t, true, true);
+    }
+    /* Segment crossing the number */
+    else
+    {
+      intresult = tcomp_number(intvalue, num);
+      lower_eq = startresult == intresult;
+      upper_eq = upper_inc && intresult == endresult;
+      if (lower_eq && upper_eq)
+        tboolseq_state_add(state, startresult, start->t, end->t, lower_inc,
+          true);
+      else
+      {
+        tboolseq_state_add(state, startresult, start->t, inttime, lower_inc,
+          lower_eq);
+        if (! lower_eq && ! upper_eq)
+          tboolseq_state_add(state, intresult, inttime, inttime, true, true);
+        tboolseq_state_add(state, endresult, inttime, end->t, upper_eq,
+          upper_inc);
+      }
+    }
+    start = end;
+    startvalue = endvalue;
+    startresult = endresult;
+    lower_inc = true;
+  }
+  return;
+}
+
+/**
+ * Returns the comparison of the temporal number and the number
+ *
+ * @param[in] temp Temporal number
+ * @param[in] value Number
+ * @param[in] valuetypid Oid of the base type of the number
+ * @param[in] oper Enumeration that states the comparison operator
+ * @param[in] invert True when the base value is the first argument
+ * of the function
+ */
+static Temporal *
+tcomp_tnumber_base(const Temporal *temp, Datum value, Oid valuetypid,
+  TComparison oper, bool invert)
+{
+  TCompNumber num;
+  num.value = value;
+  num.valuetypid = valuetypid;
+  num.d = datum_double(value, valuetypid);
+  num.temptypid = temp->valuetypid;
+  num.oper = oper;
+  num.invert = invert;
+
+  Temporal *result;
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+    result = (Temporal *) tcomp_tnumberinst_base((TInstant *) temp, &num);
+  else if (temp->duration == INSTANTSET)
+    result = (Temporal *) tcomp_tnumberinstset_base((TInstantSet *) temp,
+      &num);
+  else if (! MOBDB_FLAGS_GET_LINEAR(temp->flags))
+  {
+    if (temp->duration == SEQUENCE)
+      result = (Temporal *) tcomp_tnumberseq_step_base((TSequence *) temp,
+        &num);
+    else /* temp->duration == SEQUENCESET */
+    {
+      TSequenceSet *ts = (TSequenceSet *) temp;
+      TSequence **sequences = palloc(sizeof(TSequence *) * ts->count);
+      for (int i = 0; i < ts->count; i++)
+        sequences[i] = tcomp_tnumberseq_step_base(tsequenceset_seq_n(ts, i),
+          &num);
+      result = (Temporal *) tsequenceset_make_free(sequences, ts->count,
+        NORMALIZE);
+    }
+  }
+  else
+  {
+    /* Each segment adds at most three segments of two instants */
+    int totalcount = (temp->duration == SEQUENCE) ?
+      ((TSequence *) temp)->count : ((TSequenceSet *) temp)->totalcount;
+    TBoolSeqState state;
+    state.sequences = palloc(sizeof(TSequence *) * totalcount * 3);
+    state.count = 0;
+    state.instants = palloc(sizeof(TInstant *) * totalcount * 6);
+    state.ninsts = 0;
+    if (temp->duration == SEQUENCE)
+      tcomp_tfloatseq_linear_base(&state, (TSequence *) temp, &num);
+    else /* temp->duration == SEQUENCESET */
+    {
+      TSequenceSet *ts = (TSequenceSet *) temp;
+      for (int i = 0; i < ts->count; i++)
+        tcomp_tfloatseq_linear_base(&state, tsequenceset_seq_n(ts, i), &num);
+    }
+    tboolseq_state_flush(&state);
+    pfree(state.instants);
+    result = (Temporal *) tsequenceset_make_free(state.sequences, state.count,
+      NORMALIZE_NO);
+  }
+  return result;
+}
+
 /*****************************************************************************
  * Generic dispatch function
  *****************************************************************************/
@@ -40,13 +629,18 @@ tcomp_temporal_base1(const Temporal *temp, Datum value, Oid valuetypid,
 
 PGDLLEXPORT Datum
 tcomp_base_temporal(FunctionCallInfo fcinfo, 
-  Datum (*func)(Datum, Datum, Oid, Oid))
+  Datum (*func)(Datum, Datum, Oid, Oid), TComparison oper)
 {
   Datum value = PG_GETARG_ANYDATUM(0);
   Temporal *temp = PG_GETARG_TEMPORAL(1);
   Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 0);
-  Temporal *result = tcomp_temporal_base1(temp, value, valuetypid,
-    func, INVERT);
+  Temporal *result = tcomp_tnumber_base_bbox(temp, value, valuetypid,
+    oper, INVERT);
+  if (result == NULL)
+    result = tnumber_base_type(temp->valuetypid) &&
+      tnumber_base_type(valuetypid) ?
+      tcomp_tnumber_base(temp, value, valuetypid, oper, INVERT) :
+      tcomp_temporal_base1(temp, value, valuetypid, func, INVERT);
   DATUM_FREE_IF_COPY(value, valuetypid, 0);
   PG_FREE_IF_COPY(temp, 1);
   PG_RETURN_POINTER(result);
@@ -54,13 +648,18 @@ tcomp_base_temporal(FunctionCallInfo fcinfo,
 
 Datum
 tcomp_temporal_base(FunctionCallInfo fcinfo, 
-  Datum (*func)(Datum, Datum, Oid, Oid))
+  Datum (*func)(Datum, Datum, Oid, Oid), TComparison oper)
 {
   Temporal *temp = PG_GETARG_TEMPORAL(0);
   Datum value = PG_GETARG_ANYDATUM(1);
   Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
-  Temporal *result = tcomp_temporal_base1(temp, value, valuetypid,
-    func, INVERT_NO);
+  Temporal *result = tcomp_tnumber_base_bbox(temp, value, valuetypid,
+    oper, INVERT_NO);
+  if (result == NULL)
+    result = tnumber_base_type(temp->valuetypid) &&
+      tnumber_base_type(valuetypid) ?
+      tcomp_tnumber_base(temp, value, valuetypid, oper, INVERT_NO) :
+      tcomp_temporal_base1(temp, value, valuetypid, func, INVERT_NO);
   PG_FREE_IF_COPY(temp, 0);
   DATUM_FREE_IF_COPY(value, valuetypid, 1);
   PG_RETURN_POINTER(result);
@@ -68,7 +667,7 @@ tcomp_temporal_base(FunctionCallInfo fcinfo,
 
 PGDLLEXPORT Datum
 tcomp_temporal_temporal(FunctionCallInfo fcinfo, 
-  Datum (*func)(Datum, Datum, Oid, Oid))
+  Datum (*func)(Datum, Datum, Oid, Oid), TComparison oper)
 {
   Temporal *temp1 = PG_GETARG_TEMPORAL(0);
   Temporal *temp2 = PG_GETARG_TEMPORAL(1);
@@ -77,6 +676,16 @@ tcomp_temporal_temporal(FunctionCallInfo fcinfo,
     ensure_same_srid_tpoint(temp1, temp2);
     ensure_same_dimensionality_tpoint(temp1, temp2);
   }
+  bool found;
+  Temporal *result = tcomp_tnumber_tnumber_bbox(temp1, temp2, oper, &found);
+  if (found)
+  {
+    PG_FREE_IF_COPY(temp1, 0);
+    PG_FREE_IF_COPY(temp2, 1);
+    if (result == NULL)
+      PG_RETURN_NULL();
+    PG_RETURN_POINTER(result);
+  }
   LiftedFunctionInfo lfinfo;
   lfinfo.func = (varfunc) func;
   lfinfo.numparam = 4;
@@ -86,8 +695,7 @@ tcomp_temporal_temporal(FunctionCallInfo fcinfo,
   lfinfo.discont = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
     MOBDB_FLAGS_GET_LINEAR(temp2->flags);
   lfinfo.tpfunc = NULL;
-  Temporal *result = sync_tfunc_temporal_temporal(temp1, temp2, (Datum) NULL,
-    lfinfo);
+  result = sync_tfunc_temporal_temporal(temp1, temp2, (Datum) NULL, lfinfo);
   PG_FREE_IF_COPY(temp1, 0);
   PG_FREE_IF_COPY(temp2, 1);
   if (result == NULL)
@@ -103,7 +711,7 @@ PG_FUNCTION_INFO_V1(teq_base_temporal);
 PGDLLEXPORT Datum
 teq_base_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_base_temporal(fcinfo, &datum2_eq2);
+  return tcomp_base_temporal(fcinfo, &datum2_eq2, EQ);
 }
 
 PG_FUNCTION_INFO_V1(teq_temporal_base);
@@ -111,7 +719,7 @@ PG_FUNCTION_INFO_V1(teq_temporal_base);
 PGDLLEXPORT Datum
 teq_temporal_base(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_base(fcinfo, &datum2_eq2);
+  return tcomp_temporal_base(fcinfo, &datum2_eq2, EQ);
 }
 
 PG_FUNCTION_INFO_V1(teq_temporal_temporal);
@@ -119,7 +727,7 @@ PG_FUNCTION_INFO_V1(teq_temporal_temporal);
 PGDLLEXPORT Datum
 teq_temporal_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_temporal(fcinfo, &datum2_eq2);
+  return tcomp_temporal_temporal(fcinfo, &datum2_eq2, EQ);
 }
 
 /*****************************************************************************
@@ -131,7 +739,7 @@ PG_FUNCTION_INFO_V1(tne_base_temporal);
 PGDLLEXPORT Datum
 tne_base_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_base_temporal(fcinfo, &datum2_ne2);
+  return tcomp_base_temporal(fcinfo, &datum2_ne2, NE);
 }
 
 PG_FUNCTION_INFO_V1(tne_temporal_base);
@@ -139,7 +747,7 @@ PG_FUNCTION_INFO_V1(tne_temporal_base);
 PGDLLEXPORT Datum
 tne_temporal_base(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_base(fcinfo, &datum2_ne2);
+  return tcomp_temporal_base(fcinfo, &datum2_ne2, NE);
 }
 
 PG_FUNCTION_INFO_V1(tne_temporal_temporal);
@@ -147,7 +755,7 @@ PG_FUNCTION_INFO_V1(tne_temporal_temporal);
 PGDLLEXPORT Datum
 tne_temporal_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_temporal(fcinfo, &datum2_ne2);
+  return tcomp_temporal_temporal(fcinfo, &datum2_ne2, NE);
 }
 
 /*****************************************************************************
@@ -159,7 +767,7 @@ PG_FUNCTION_INFO_V1(tlt_base_temporal);
 PGDLLEXPORT Datum
 tlt_base_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_base_temporal(fcinfo, &datum2_lt2);
+  return tcomp_base_temporal(fcinfo, &datum2_lt2, LT);
 }
 
 PG_FUNCTION_INFO_V1(tlt_temporal_base);
@@ -167,7 +775,7 @@ PG_FUNCTION_INFO_V1(tlt_temporal_base);
 PGDLLEXPORT Datum
 tlt_temporal_base(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_base(fcinfo, &datum2_lt2);
+  return tcomp_temporal_base(fcinfo, &datum2_lt2, LT);
 }
 
 PG_FUNCTION_INFO_V1(tlt_temporal_temporal);
@@ -175,7 +783,7 @@ PG_FUNCTION_INFO_V1(tlt_temporal_temporal);
 PGDLLEXPORT Datum
 tlt_temporal_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_temporal(fcinfo, &datum2_lt2);
+  return tcomp_temporal_temporal(fcinfo, &datum2_lt2, LT);
 }
 
 /*****************************************************************************
@@ -187,7 +795,7 @@ PG_FUNCTION_INFO_V1(tle_base_temporal);
 PGDLLEXPORT Datum
 tle_base_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_base_temporal(fcinfo, &datum2_le2);
+  return tcomp_base_temporal(fcinfo, &datum2_le2, LE);
 }
 
 PG_FUNCTION_INFO_V1(tle_temporal_base);
@@ -195,7 +803,7 @@ PG_FUNCTION_INFO_V1(tle_temporal_base);
 PGDLLEXPORT Datum
 tle_temporal_base(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_base(fcinfo, &datum2_le2);
+  return tcomp_temporal_base(fcinfo, &datum2_le2, LE);
 }
 
 PG_FUNCTION_INFO_V1(tle_temporal_temporal);
@@ -203,7 +811,7 @@ PG_FUNCTION_INFO_V1(tle_temporal_temporal);
 PGDLLEXPORT Datum
 tle_temporal_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_temporal(fcinfo, &datum2_le2);
+  return tcomp_temporal_temporal(fcinfo, &datum2_le2, LE);
 }
 
 /*****************************************************************************
@@ -215,7 +823,7 @@ PG_FUNCTION_INFO_V1(tgt_base_temporal);
 PGDLLEXPORT Datum
 tgt_base_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_base_temporal(fcinfo, &datum2_gt2);
+  return tcomp_base_temporal(fcinfo, &datum2_gt2, GT);
 }
 
 PG_FUNCTION_INFO_V1(tgt_temporal_base);
@@ -223,7 +831,7 @@ PG_FUNCTION_INFO_V1(tgt_temporal_base);
 PGDLLEXPORT Datum
 tgt_temporal_base(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_base(fcinfo, &datum2_gt2);
+  return tcomp_temporal_base(fcinfo, &datum2_gt2, GT);
 }
 
 PG_FUNCTION_INFO_V1(tgt_temporal_temporal);
@@ -231,7 +839,7 @@ PG_FUNCTION_INFO_V1(tgt_temporal_temporal);
 PGDLLEXPORT Datum
 tgt_temporal_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_temporal(fcinfo, &datum2_gt2);
+  return tcomp_temporal_temporal(fcinfo, &datum2_gt2, GT);
 }
 
 /*****************************************************************************
@@ -243,7 +851,7 @@ PG_FUNCTION_INFO_V1(tge_base_temporal);
 PGDLLEXPORT Datum
 tge_base_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_base_temporal(fcinfo, &datum2_ge2);
+  return tcomp_base_temporal(fcinfo, &datum2_ge2, GE);
 }
 
 PG_FUNCTION_INFO_V1(tge_temporal_base);
@@ -251,7 +859,7 @@ PG_FUNCTION_INFO_V1(tge_temporal_base);
 PGDLLEXPORT Datum
 tge_temporal_base(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_base(fcinfo, &datum2_ge2);
+  return tcomp_temporal_base(fcinfo, &datum2_ge2, GE);
 }
 
 PG_FUNCTION_INFO_V1(tge_temporal_temporal);
@@ -259,7 +867,7 @@ PG_FUNCTION_INFO_V1(tge_temporal_temporal);
 PGDLLEXPORT Datum
 tge_temporal_temporal(PG_FUNCTION_ARGS)
 {
-  return tcomp_temporal_temporal(fcinfo, &datum2_ge2);
+  return tcomp_temporal_temporal(fcinfo, &datum2_ge2, GE);
 }
 
 /*****************************************************************************/
@@ -0,0 +1,696 @@
+/*****************************************************************************
+ *
+ * temporal_compress.c
+ *    Compressed binary encoding of temporal types.
+ *
+ * The timestamps are encoded with delta-of-delta values stored in a variable
+ * number of bits, float values and point coordinates are encoded by XORing
+ * each value with the previous one as in the Gorilla time series database,
+ * integer values are encoded as deltas, and Boolean values take one bit.
+ * This encoding is very compact for the typical sensor streams where
+ * observations are sampled at regular intervals with slowly changing values.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *     Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_compress.h"
+
+#include <string.h>
+#include <lib/stringinfo.h>
+#include <utils/builtins.h>
+
+#include "temporaltypes.h"
+#include "oidcache.h"
+#include "temporal_util.h"
+#include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
+
+/*****************************************************************************
+ * Bit streams
+ *****************************************************************************/
+
+/**
+ * Structure to write a stream of bits into a buffer
+ */
+typedef struct
+{
+  StringInfo buf;     /**< Buffer where the complete bytes are written */
+  uint8 byte;         /**< Byte currently being filled */
+  int nbits;          /**< Number of bits used in the current byte */
+} BitWriter;
+
+/**
+ * Structure to read a stream of bits from a buffer
+ */
+typedef struct
+{
+  const uint8 *data;  /**< Bytes to read */
+  size_t size;        /**< Number of bytes */
+  size_t pos;         /**< Position of the next bit to read */
+} BitReader;
+
+/**
+ * Structure to keep the state of the XOR encoding of float values
+ */
+typedef struct
+{
+  uint64 prev;        /**< Bits of the previous value */
+  int leading;        /**< Leading zeros of the current window, -1 if none */
+  int trailing;       /**< Trailing zeros of the current window */
+} XorState;
+
+static void
+ensure_valid_compressed(bool cond)
+{
+  if (! cond)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Invalid compressed temporal value")));
+}
+
+/**
+ * Write the last n bits of the value into the bit stream
+ */
+static void
+bitwriter_put(BitWriter *bw, uint64 value, int n)
+{
+  while (n > 0)
+  {
+    int room = 8 - bw->nbits;
+    int take = Min(room, n);
+    uint8 chunk = (uint8) ((value >> (n - take)) & ((1 << take) - 1));
+    bw->byte |= (uint8) (chunk << (room - take));
+    bw->nbits += take;
+    n -= take;
+    if (bw->nbits == 8)
+    {
+      appendStringInfoChar(bw->buf, (char) bw->byte);
+      bw->byte = 0;
+      bw->nbits = 0;
+    }
+  }
+}
+
+/**
+ * Write the pending bits of the bit stream padding with zeros
+ */
+static void
+bitwriter_flush(BitWriter *bw)
+{
+  if (bw->nbits > 0)
+  {
+    appendStringInfoChar(bw->buf, (char) bw->byte);
+    bw->byte = 0;
+    bw->nbits = 0;
+  }
+}
+
+/**
+ * Read n bits from the bit stream
+ */
+static uint64
+bitreader_get(BitReader *br, int n)
+{
+  uint64 result = 0;
+  ensure_valid_compressed(br->pos + n <= br->size * 8);
+  while (n > 0)
+  {
+    int room = 8 - (int) (br->pos % 8);
+    int take = Min(room, n);
+    uint8 chunk = (uint8) ((br->data[br->pos / 8] >> (room - take)) &
+      ((1 << take) - 1));
+    result = (result << take) | chunk;
+    br->pos += take;
+    n -= take;
+  }
+  return result;
+}
+
+/*****************************************************************************
+ * Encoding of integers
+ *****************************************************************************/
+
+/**
+ * Map signed integers to unsigned ones so that values of small magnitude
+ * have a small representation
+ */
+static uint64
+zigzag_encode(int64 value)
+{
+  return ((uint64) value << 1) ^ (uint64) (value >> 63);
+}
+
+static int64
+zigzag_decode(uint64 value)
+{
+  return (int64) (value >> 1) ^ -((int64) (value & 1));
+}
+
+/**
+ * Write a signed integer into the bit stream using a prefix code:
+ * '0' for zero, '10' followed by 8 bits, '110' followed by 16 bits,
+ * '1110' followed by 32 bits, and '1111' followed by 64 bits
+ */
+static void
+bitwriter_put_signed(BitWriter *bw, int64 value)
+{
+  uint64 zz = zigzag_encode(value);
+  if (zz == 0)
+    bitwriter_put(bw, 0, 1);
+  else if (zz < (UINT64CONST(1) << 8))
+  {
+    bitwriter_put(bw, 2, 2);
+    bitwriter_put(bw, zz, 8);
+  }
+  else if (zz < (UINT64CONST(1) << 16))
+  {
+    bitwriter_put(bw, 6, 3);
+    bitwriter_put(bw, zz, 16);
+  }
+  else if (zz < (UINT64CONST(1) << 32))
+  {
+    bitwriter_put(bw, 14, 4);
+    bitwriter_put(bw, zz, 32);
+  }
+  else
+  {
+    bitwriter_put(bw, 15, 4);
+    bitwriter_put(bw, zz, 64);
+  }
+}
+
+static int64
+bitreader_get_signed(BitReader *br)
+{
+  if (! bitreader_get(br, 1))
+    return 0;
+  if (! bitreader_get(br, 1))
+    return zigzag_decode(bitreader_get(br, 8));
+  if (! bitreader_get(br, 1))
+    return zigzag_decode(bitreader_get(br, 16));
+  if (! bitreader_get(br, 1))
+    return zigzag_decode(bitreader_get(br, 32));
+  return zigzag_decode(bitreader_get(br, 64));
+}
+
+/*****************************************************************************
+ * Encoding of floats
+ *****************************************************************************/
+
+static uint64
+double_bits(double d)
+{
+  uint64 result;
+  memcpy(&result, &d, sizeof(uint64));
+  return result;
+}
+
+static double
+bits_double(uint64 bits)
+{
+  double result;
+  memcpy(&result, &bits, sizeof(double));
+  return result;
+}
+
+static int
+leading_zeros(uint64 value)
+{
+  int result = 0;
+  while (! (value & (UINT64CONST(1) << 63)))
+  {
+    value <<= 1;
+    result++;
+  }
+  return result;
+}
+
+static int
+trailing_zeros(uint64 value)
+{
+  int result = 0;
+  while (! (value & 1))
+  {
+    value >>= 1;
+    result++;
+  }
+  return result;
+}
+
+/**
+ * Write the float value into the bit stream. The first value is written
+ * verbatim, the next ones are XORed with the previous value. A XOR equal
+ * to zero is written as '0'. Otherwise, if the meaningful bits of the XOR
+ * fall within the window of the previous one they are written after '10',
+ * else they are written after '11' followed by 5 bits with the number of
+ * leading zeros and 6 bits with the number of meaningful bits.
+ */
+static void
+bitwriter_put_double(BitWriter *bw, XorState *state, double d, bool first)
+{
+  uint64 bits = double_bits(d);
+  uint64 xor = bits ^ state->prev;
+  state->prev = bits;
+  if (first)
+  {
+    bitwriter_put(bw, bits, 64);
+    return;
+  }
+  if (xor == 0)
+  {
+    bitwriter_put(bw, 0, 1);
+    return;
+  }
+  int leading = leading_zeros(xor);
+  int trailing = trailing_zeros(xor);
+  /* The number of leading zeros is written in 5 bits */
+  if (leading > 31)
+    leading = 31;
+  if (state->leading >= 0 && leading >= state->leading &&
+    trailing >= state->trailing)
+  {
+    bitwriter_put(bw, 2, 2);
+    bitwriter_put(bw, xor >> state->trailing,
+      64 - state->leading - state->trailing);
+  }
+  else
+  {
+    int meaningful = 64 - leading - trailing;
+    bitwriter_put(bw, 3, 2);
+    bitwriter_put(bw, (uint64) leading, 5);
+    /* A value of 64 meaningful bits is written as 0 */
+    bitwriter_put(bw, (uint64) (meaningful & 63), 6);
+    bitwriter_put(bw, xor >> trailing, meaningful);
+    state->leading = leading;
+    state->trailing = trailing;
+  }
+}
+
+static double
+bitreader_get_double(BitReader *br, XorState *state, bool first)
+{
+  if (first)
+    state->prev = bitreader_get(br, 64);
+  else if (bitreader_get(br, 1))
+  {
+    if (! bitreader_get(br, 1))
+    {
+      ensure_valid_compressed(state->leading >= 0);
+      state->prev ^= bitreader_get(br, 64 - state->leading - state->trailing)
+        << state->trailing;
+    }
+    else
+    {
+      int leading = (int) bitreader_get(br, 5);
+      int meaningful = (int) bitreader_get(br, 6);
+      if (meaningful == 0)
+        meaningful = 64;
+      ensure_valid_compressed(leading + meaningful <= 64);
+      state->leading = leading;
+      state->trailing = 64 - leading - meaningful;
+      state->prev ^= bitreader_get(br, meaningful) << state->trailing;
+    }
+  }
+  return bits_double(state->prev);
+}
+
+/*****************************************************************************
+ * Encoding of arrays of instants
+ *****************************************************************************/
+
+/**
+ * Returns the tag of the base type in the compressed format
+ */
+static uint8
+compress_base_type_tag(Oid valuetypid)
+{
+  if (valuetypid == BOOLOID)
+    return COMPRESS_BOOL;
+  if (valuetypid == INT4OID)
+    return COMPRESS_INT4;
+  if (valuetypid == FLOAT8OID)
+    return COMPRESS_FLOAT8;
+  if (valuetypid == type_oid(T_GEOMETRY))
+    return COMPRESS_GEOMETRY;
+  if (valuetypid == type_oid(T_GEOGRAPHY))
+    return COMPRESS_GEOGRAPHY;
+  ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+    errmsg("Compression is not supported for this temporal type")));
+  return 0; /* make compiler quiet */
+}
+
+/**
+ * Write the array of instants into the bit stream. The timestamps are
+ * written first followed by the values.
+ *
+ * @param[in] bw Bit stream
+ * @param[in] instants Array of instants
+ * @param[in] count Number of elements in the array
+ * @param[in] tag Tag of the base type
+ * @param[in] hasz True when the points have Z dimension
+ */
+static void
+tinstarr_compress(BitWriter *bw, const TInstant **instants, int count,
+  uint8 tag, bool hasz)
+{
+  /* Timestamps */
+  bitwriter_put(bw, (uint64) instants[0]->t, 64);
+  int64 prevdelta = 0;
+  for (int i = 1; i < count; i++)
+  {
+    int64 delta = (int64) ((uint64) instants[i]->t -
+      (uint64) instants[i - 1]->t);
+    bitwriter_put_signed(bw, (int64) ((uint64) delta - (uint64) prevdelta));
+    prevdelta = delta;
+  }
+
+  /* Values */
+  if (tag == COMPRESS_BOOL)
+  {
+    for (int i = 0; i < count; i++)
+      bitwriter_put(bw, DatumGetBool(tinstant_value(instants[i])) ? 1 : 0, 1);
+  }
+  else if (tag == COMPRESS_INT4)
+  {
+    int64 prev = 0;
+    for (int i = 0; i < count; i++)
+    {
+      int64 value = DatumGetInt32(tinstant_value(instants[i]));
+      bitwriter_put_signed(bw, value - prev);
+      prev = value;
+    }
+  }
+  else if (tag == COMPRESS_FLOAT8)
+  {
+    XorState state = {0, -1, 0};
+    for (int i = 0; i < count; i++)
+      bitwriter_put_double(bw, &state,
+        DatumGetFloat8(tinstant_value(instants[i])), i == 0);
+  }
+  else /* tag == COMPRESS_GEOMETRY || tag == COMPRESS_GEOGRAPHY */
+  {
+    XorState statex = {0, -1, 0}, statey = {0, -1, 0}, statez = {0, -1, 0};
+    for (int i = 0; i < count; i++)
+    {
+      Datum value = tinstant_value(instants[i]);
+      if (hasz)
+      {
+        const POINT3DZ *point = datum_get_point3dz_p(value);
+        bitwriter_put_double(bw, &statex, point->x, i == 0);
+        bitwriter_put_double(bw, &statey, point->y, i == 0);
+        bitwriter_put_double(bw, &statez, point->z, i == 0);
+      }
+      else
+      {
+        const POINT2D *point = datum_get_point2d_p(value);
+        bitwriter_put_double(bw, &statex, point->x, i == 0);
+        bitwriter_put_double(bw, &statey, point->y, i == 0);
+      }
+    }
+  }
+}
+
+/**
+ * Returns the point built from the coordinates
+ */
+static Datum
+point_make(double x, double y, double z, bool hasz, int srid, bool geodetic)
+{
+  LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, x, y, z) :
+    lwpoint_make2d(srid, x, y);
+  FLAGS_SET_GEODETIC(lwpoint->flags, geodetic);
+  GSERIALIZED *result = geo_serialize((LWGEOM *) lwpoint);
+  lwpoint_free(lwpoint);
+  return PointerGetDatum(result);
+}
+
+/**
+ * Read the array of instants from the bit stream
+ *
+ * @param[in] br Bit stream
+ * @param[in] count Number of elements in the array
+ * @param[in] tag Tag of the base type
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] hasz True when the points have Z dimension
+ * @param[in] srid SRID of the points
+ */
+static TInstant **
+tinstarr_decompress(BitReader *br, int count, uint8 tag, Oid valuetypid,
+  bool hasz, int srid)
+{
+  TimestampTz *times = palloc(sizeof(TimestampTz) * count);
+  TInstant **result = palloc(sizeof(TInstant *) * count);
+
+  /* Timestamps */
+  times[0] = (TimestampTz) bitreader_get(br, 64);
+  int64 delta = 0;
+  for (int i = 1; i < count; i++)
+  {
+    delta = (int64) ((uint64) delta + (uint64) bitreader_get_signed(br));
+    times[i] = (TimestampTz) ((uint64) times[i - 1] + (uint64) delta);
+  }
+
+  /* Values */
+  if (tag == COMPRESS_BOOL)
+  {
+    for (int i = 0; i < count; i++)
+      result[i] = tinstant_make(BoolGetDatum(bitreader_get(br, 1) == 1),
+        times[i], valuetypid);
+  }
+  else if (tag == COMPRESS_INT4)
+  {
+    int64 value = 0;
+    for (int i = 0; i < count; i++)
+    {
+      value += bitreader_get_signed(br);
+      ensure_valid_compressed(value >= PG_INT32_MIN && value <= PG_INT32_MAX);
+      result[i] = tinstant_make(Int32GetDatum((int32) value), times[i],
+        valuetypid);
+    }
+  }
+  else if (tag == COMPRESS_FLOAT8)
+  {
+    XorState state = {0, -1, 0};
+    for (int i = 0; i < count; i++)
+      result[i] = tinstant_make(Float8GetDatum(bitreader_get_double(br,
+        &state, i == 0)), times[i], valuetypid);
+  }
+  else /* tag == COMPRESS_GEOMETRY || tag == COMPRESS_GEOGRAPHY */
+  {
+    XorState statex = {0, -1, 0}, statey = {0, -1, 0}, statez = {0, -1, 0};
+    bool geodetic = (tag == COMPRESS_GEOGRAPHY);
+    for (int i = 0; i < count; i++)
+    {
+      double x = bitreader_get_double(br, &statex, i == 0);
+      double y = bitreader_get_double(br, &statey, i == 0);
+      double z = hasz ? bitreader_get_double(br, &statez, i == 0) : 0;
+      Datum value = point_make(x, y, z, hasz, srid, geodetic);
+      result[i] = tinstant_make(value, times[i], valuetypid);
+      pfree(DatumGetPointer(value));
+    }
+  }
+  pfree(times);
+  return result;
+}
+
+/*****************************************************************************
+ * Compression and decompression of temporal values
+ *****************************************************************************/
+
+/**
+ * Write the sequence into the bit stream
+ */
+static void
+tsequence_compress(BitWriter *bw, const TSequence *seq, uint8 tag, bool hasz)
+{
+  const TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+  for (int i = 0; i < seq->count; i++)
+    instants[i] = tsequence_inst_n(seq, i);
+  bitwriter_put(bw, seq->period.lower_inc ? 1 : 0, 1);
+  bitwriter_put(bw, seq->period.upper_inc ? 1 : 0, 1);
+  bitwriter_put(bw, (uint64) seq->count, 32);
+  tinstarr_compress(bw, instants, seq->count, tag, hasz);
+  pfree(instants);
+}
+
+/**
+ * Read a sequence from the bit stream
+ */
+static TSequence *
+tsequence_decompress(BitReader *br, uint8 tag, Oid valuetypid, bool linear,
+  bool hasz, int srid)
+{
+  bool lower_inc = bitreader_get(br, 1) == 1;
+  bool upper_inc = bitreader_get(br, 1) == 1;
+  int count = (int) bitreader_get(br, 32);
+  ensure_valid_compressed(count > 0);
+  TInstant **instants = tinstarr_decompress(br, count, tag, valuetypid,
+    hasz, srid);
+  return tsequence_make_free(instants, count, lower_inc, upper_inc, linear,
+    NORMALIZE_NO);
+}
+
+/**
+ * Returns the compressed representation of the temporal value
+ *
+ * The format starts with a header composed of the version of the format,
+ * the tag of the base type, the duration, and the flags, followed by the
+ * SRID for temporal points. The instants are then encoded in blocks
+ * preceded by their number and, for sequences, by their bounds.
+ */
+bytea *
+temporal_compress_internal(const Temporal *temp)
+{
+  uint8 tag = compress_base_type_tag(temp->valuetypid);
+  bool hasz = MOBDB_FLAGS_GET_Z(temp->flags);
+  StringInfoData buf;
+  BitWriter bw;
+  initStringInfo(&buf);
+  appendStringInfoSpaces(&buf, VARHDRSZ);
+  bw.buf = &buf;
+  bw.byte = 0;
+  bw.nbits = 0;
+
+  /* Header */
+  bitwriter_put(&bw, COMPRESS_VERSION, 8);
+  bitwriter_put(&bw, tag, 8);
+  bitwriter_put(&bw, (uint64) temp->duration, 8);
+  bitwriter_put(&bw, (MOBDB_FLAGS_GET_LINEAR(temp->flags) ? 1 : 0) |
+    (hasz ? 2 : 0), 8);
+  if (tag == COMPRESS_GEOMETRY || tag == COMPRESS_GEOGRAPHY)
+    bitwriter_put(&bw, (uint32) tpoint_srid_internal(temp), 32);
+
+  /* Body */
+  ensure_valid_duration(temp->duration);
+  if (temp->duration == INSTANT)
+  {
+    const TInstant *inst = (const TInstant *) temp;
+    tinstarr_compress(&bw, &inst, 1, tag, hasz);
+  }
+  else if (temp->duration == INSTANTSET)
+  {
+    const TInstantSet *ti = (const TInstantSet *) temp;
+    const TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+    for (int i = 0; i < ti->count; i++)
+      instants[i] = tinstantset_inst_n(ti, i);
+    bitwriter_put(&bw, (uint64) ti->count, 32);
+    tinstarr_compress(&bw, instants, ti->count, tag, hasz);
+    pfree(instants);
+  }
+  else if (temp->duration == SEQUENCE)
+    tsequence_compress(&bw, (const TSequence *) temp, tag, hasz);
+  else /* temp->duration == SEQUENCESET */
+  {
+    const TSequenceSet *ts = (const TSequenceSet *) temp;
+    bitwriter_put(&bw, (uint64) ts->count, 32);
+    for (int i = 0; i < ts->count; i++)
+      tsequence_compress(&bw, tsequenceset_seq_n(ts, i), tag, hasz);
+  }
+  bitwriter_flush(&bw);
+
+  bytea *result = (bytea *) buf.data;
+  SET_VARSIZE(result, buf.len);
+  return result;
+}
+
+/**
+ * Returns the temporal value from its compressed representation
+ *
+ * @param[in] bytes Compressed representation
+ * @param[in] valuetypid Oid of the base type of the result
+ */
+Temporal *
+temporal_decompress_internal(const bytea *bytes, Oid valuetypid)
+{
+  BitReader br;
+  br.data = (const uint8 *) VARDATA_ANY(bytes);
+  br.size = VARSIZE_ANY_EXHDR(bytes);
+  br.pos = 0;
+
+  /* Header */
+  uint8 version = (uint8) bitreader_get(&br, 8);
+  if (version != COMPRESS_VERSION)
+    ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+      errmsg("Unsupported version of the compressed format: %d", version)));
+  uint8 tag = (uint8) bitreader_get(&br, 8);
+  if (tag != compress_base_type_tag(valuetypid))
+    ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+      errmsg("The compressed value is not of the expected temporal type")));
+  TDuration duration = (TDuration) bitreader_get(&br, 8);
+  ensure_valid_duration(duration);
+  uint8 flags = (uint8) bitreader_get(&br, 8);
+  bool linear = (flags & 1) && linear_interpolation(valuetypid);
+  bool hasz = (flags & 2) != 0;
+  int srid = 0;
+  if (tag == COMPRESS_GEOMETRY || tag == COMPRESS_GEOGRAPHY)
+    srid = (int32) bitreader_get(&br, 32);
+
+  /* Body */
+  Temporal *result;
+  if (duration == INSTANT)
+  {
+    TInstant **instants = tinstarr_decompress(&br, 1, tag, valuetypid,
+      hasz, srid);
+    result = (Temporal *) instants[0];
+    pfree(instants);
+  }
+  else if (duration == INSTANTSET)
+  {
+    int count = (int) bitreader_get(&br, 32);
+    ensure_valid_compressed(count > 0);
+    TInstant **instants = tinstarr_decompress(&br, count, tag, valuetypid,
+      hasz, srid);
+    result = (Temporal *) tinstantset_make_free(instants, count);
+  }
+  else if (duration == SEQUENCE)
+    result = (Temporal *) tsequence_decompress(&br, tag, valuetypid, linear,
+      hasz, srid);
+  else /* duration == SEQUENCESET */
+  {
+    int count = (int) bitreader_get(&br, 32);
+    ensure_valid_compressed(count > 0);
+    TSequence **sequences = palloc(sizeof(TSequence *) * count);
+    for (int i = 0; i < count; i++)
+      sequences[i] = tsequence_decompress(&br, tag, valuetypid, linear,
+        hasz, srid);
+    result = (Temporal *) tsequenceset_make_free(sequences, count,
+      NORMALIZE_NO);
+  }
+  /* Only the padding bits of the last byte may remain */
+  ensure_valid_compressed((br.pos + 7) / 8 == br.size);
+  return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_compress);
+/**
+ * Returns the compressed representation of the temporal value
+ */
+PGDLLEXPORT Datum
+temporal_compress(PG_FUNCTION_ARGS)
+{
+  Temporal *temp = PG_GETARG_TEMPORAL(0);
+  bytea *result = temporal_compress_internal(temp);
+  PG_FREE_IF_COPY(temp, 0);
+  PG_RETURN_BYTEA_P(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_decompress);
+/**
+ * Returns the temporal value from its compressed representation. The
+ * temporal type of the result is given by the return type of the function.
+ */
+PGDLLEXPORT Datum
+temporal_decompress(PG_FUNCTION_ARGS)
+{
+  bytea *bytes = PG_GETARG_BYTEA_P(0);
+  Oid temptypid = get_fn_expr_rettype(fcinfo->flinfo);
+  Temporal *result = temporal_decompress_internal(bytes,
+    temporal_valuetypid(temptypid));
+  PG_FREE_IF_COPY(bytes, 0);
+  PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
@@ -3,10 +3,8 @@
  * temporal_parser.c
  *    Functions for parsing time types and temporal types.
  *
- * Many functions make two passes for parsing, the first one to obtain the 
- * number of elements in order to do memory allocation with palloc, the second
- * one to create the type. This is the only approach we can see at the moment
- * which is both correct and simple.
+ * The functions parse their input in a single pass. The elements of the
+ * values are collected in arrays that are enlarged as needed.
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  *    Universite Libre de Bruxelles
@@ -17,6 +15,11 @@
 
 #include "temporal_parser.h"
 
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <utils/builtins.h>
+
 #include "periodset.h"
 #include "period.h"
 #include "timestampset.h"
@@ -173,6 +176,81 @@ double_parse(char **str)
   return result;
 }
 
+/**
+ * Parse a base value of type bool, int4, or float8 followed by the at sign
+ * of the instant without calling the input function of the base type.
+ *
+ * @return False, without consuming the buffer, when the value must be
+ * parsed by the input function, which also reports the errors
+ */
+static bool
+basetype_parse_fast(char **str, Oid basetype, Datum *result)
+{
+  char *ptr = *str;
+  if (basetype == BOOLOID)
+  {
+    bool value;
+    if (strncmp(ptr, "true", 4) == 0)
+    {
+      value = true;
+      ptr += 4;
+    }
+    else if (strncmp(ptr, "false", 5) == 0)
+    {
+      value = false;
+      ptr += 5;
+    }
+    else if (*ptr == 't' || *ptr == 'f')
+    {
+      value = (*ptr == 't');
+      ptr++;
+    }
+    else
+      return false;
+    *result = BoolGetDatum(value);
+  }
+  else if (basetype == INT4OID)
+  {
+    bool neg = false;
+    int64 value = 0;
+    if (*ptr == '-' || *ptr == '+')
+      neg = (*ptr++ == '-');
+    if (! isdigit((unsigned char) *ptr))
+      return false;
+    while (isdigit((unsigned char) *ptr))
+    {
+      value = value * 10 + (*ptr++ - '0');
+      /* Out of range values are reported by the input function */
+      if (value > (int64) PG_INT32_MAX + 1)
+        return false;
+    }
+    if (neg)
+      value = -value;
+    if (value < PG_INT32_MIN || value > PG_INT32_MAX)
+      return false;
+    *result = Int32GetDatum((int32) value);
+  }
+  else if (basetype == FLOAT8OID)
+  {
+    char *end;
+    errno = 0;
+    double value = strtod(ptr, &end);
+    /* Special and out of range values are left to the input function */
+    if (end == ptr || errno != 0 || ! isfinite(value))
+      return false;
+    ptr = end;
+    *result = Float8GetDatum(value);
+  }
+  else
+    return false;
+  p_whitespace(&ptr);
+  if (*ptr != '@')
+    return false;
+  /* Consume the at */
+  *str = ptr + 1;
+  return true;
+}
+
 /**
  * Parse a base value from the buffer
  */
@@ -180,6 +258,9 @@ Datum
 basetype_parse(char **str, Oid basetype)
 {
   p_whitespace(str);
+  Datum result;
+  if (basetype_parse_fast(str, basetype, &result))
+    return result;
   int delim = 0;
   bool isttext = false;
   /* ttext values must be enclosed between double quotes */
@@ -201,7 +282,7 @@ basetype_parse(char **str, Oid basetype)
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse element value")));
   (*str)[delim] = '\0';
-  Datum result = call_input(basetype, *str);
+  result = call_input(basetype, *str);
   if (isttext)
     /* Replace the double quote */
     (*str)[delim++] = '"';
@@ -307,7 +388,9 @@ timestamp_parse(char **str)
     delim++;
   char bak = (*str)[delim];
   (*str)[delim] = '\0';
-  Datum result = call_input(TIMESTAMPTZOID, *str);
+  /* Call directly the input function to avoid looking it up every time */
+  Datum result = DirectFunctionCall3(timestamptz_in, CStringGetDatum(*str),
+    ObjectIdGetDatum(InvalidOid), Int32GetDatum(-1));
   (*str)[delim] = bak;
   *str += delim;
   return result;
@@ -355,27 +438,20 @@ timestampset_parse(char **str)
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse timestamp set")));
 
-  /* First parsing */
-  char *bak = *str;
-  timestamp_parse(str);
-  int count = 1;
-  while (p_comma(str)) 
+  int count = 0, capacity = PARSER_INITIAL_CAPACITY;
+  TimestampTz *times = palloc(sizeof(TimestampTz) * capacity);
+  do
   {
-    count++;
-    timestamp_parse(str);
-  }
+    if (count == capacity)
+    {
+      capacity *= 2;
+      times = repalloc(times, sizeof(TimestampTz) * capacity);
+    }
+    times[count++] = timestamp_parse(str);
+  } while (p_comma(str));
   if (!p_cbrace(str))
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse timestamp set")));
-
-  *str = bak;
-  TimestampTz *times = palloc(sizeof(TimestampTz) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    times[i] = timestamp_parse(str);
-  }
-  p_cbrace(str);
   return timestampset_make_free(times, count);
 }
 
@@ -389,28 +465,20 @@ periodset_parse(char **str)
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse period set")));
 
-  /* First parsing */
-  char *bak = *str;
-  period_parse(str, false);
-  int count = 1;
-  while (p_comma(str)) 
+  int count = 0, capacity = PARSER_INITIAL_CAPACITY;
+  Period **periods = palloc(sizeof(Period *) * capacity);
+  do
   {
-    count++;
-    period_parse(str, false);
-  }
+    if (count == capacity)
+    {
+      capacity *= 2;
+      periods = repalloc(periods, sizeof(Period *) * capacity);
+    }
+    periods[count++] = period_parse(str, true);
+  } while (p_comma(str));
   if (!p_cbrace(str))
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse period set")));
-
-  /* Second parsing */
-  *str = bak;
-  Period **periods = palloc(sizeof(Period *) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    periods[i] = period_parse(str, true);
-  }
-  p_cbrace(str);
   return periodset_make_free(periods, count, NORMALIZE);
 }
 
@@ -424,19 +492,60 @@ periodset_parse(char **str)
  * @param[in] basetype Oid of the base type
  * @param[in] end Set to true when reading a single instant to ensure there is
  * no more input after the instant
- * @param[in] make Set to false for the first pass to do not create the instant
  */
 TInstant *
-tinstant_parse(char **str, Oid basetype, bool end, bool make) 
+tinstant_parse(char **str, Oid basetype, bool end) 
 {
   p_whitespace(str);
   /* The next two instructions will throw an exception if they fail */
   Datum elem = basetype_parse(str, basetype);
   TimestampTz t = timestamp_parse(str);
   ensure_end_input(str, end);
-  if (! make)
-    return NULL;
-  return tinstant_make(elem, t, basetype);
+  TInstant *result = tinstant_make(elem, t, basetype);
+  DATUM_FREE(elem, basetype);
+  return result;
+}
+
+/**
+ * Append the instant to the array of instants being parsed, enlarging the
+ * array if needed
+ *
+ * @param[inout] instants Array of instants
+ * @param[inout] count Number of elements in the array
+ * @param[inout] capacity Capacity of the array
+ * @param[in] inst Instant
+ */
+void
+tinstantarr_parse_append(TInstant ***instants, int *count, int *capacity,
+  TInstant *inst)
+{
+  if (*count == *capacity)
+  {
+    *capacity *= 2;
+    *instants = repalloc(*instants, sizeof(TInstant *) * *capacity);
+  }
+  (*instants)[(*count)++] = inst;
+}
+
+/**
+ * Append the sequence to the array of sequences being parsed, enlarging the
+ * array if needed
+ *
+ * @param[inout] sequences Array of sequences
+ * @param[inout] count Number of elements in the array
+ * @param[inout] capacity Capacity of the array
+ * @param[in] seq Sequence
+ */
+void
+tsequencearr_parse_append(TSequence ***sequences, int *count, int *capacity,
+  TSequence *seq)
+{
+  if (*count == *capacity)
+  {
+    *capacity *= 2;
+    *sequences = repalloc(*sequences, sizeof(TSequence *) * *capacity);
+  }
+  (*sequences)[(*count)++] = seq;
 }
 
 /**
@@ -453,29 +562,17 @@ tinstantset_parse(char **str, Oid basetype)
    * to call this function in the dispatch function temporal_parse */
   p_obrace(str);
 
-  /* First parsing */
-  char *bak = *str;
-  tinstant_parse(str, basetype, false, false);
-  int count = 1;
-  while (p_comma(str)) 
+  int count = 0, capacity = PARSER_INITIAL_CAPACITY;
+  TInstant **instants = palloc(sizeof(TInstant *) * capacity);
+  do
   {
-    count++;
-    tinstant_parse(str, basetype, false, false);
-  }
+    tinstantarr_parse_append(&instants, &count, &capacity,
+      tinstant_parse(str, basetype, false));
+  } while (p_comma(str));
   if (!p_cbrace(str))
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse temporal value")));
   ensure_end_input(str, true);
-
-  /* Second parsing */
-  *str = bak;
-  TInstant **instants = palloc(sizeof(TInstant *) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    instants[i] = tinstant_parse(str, basetype, false, true);
-  }
-  p_cbrace(str);
   return tinstantset_make_free(instants, count);
 }
 
@@ -485,12 +582,11 @@ tinstantset_parse(char **str, Oid basetype)
  * @param[in] str Input string
  * @param[in] basetype Oid of the base type
  * @param[in] linear Set to true when the sequence has linear interpolation
- * @param[in] end Set to true when reading a single instant to ensure there is
- * no moreinput after the sequence
- * @param[in] make Set to false for the first pass to do not create the instant 
+ * @param[in] end Set to true when reading a single sequence to ensure there
+ * is no more input after the sequence
  */
 static TSequence *
-tsequence_parse(char **str, Oid basetype, bool linear, bool end, bool make) 
+tsequence_parse(char **str, Oid basetype, bool linear, bool end) 
 {
   p_whitespace(str);
   bool lower_inc = false, upper_inc = false;
@@ -501,15 +597,13 @@ tsequence_parse(char **str, Oid basetype, bool linear, bool end, bool make)
   else if (p_oparen(str))
     lower_inc = false;
 
-  /* First parsing */
-  char *bak = *str;
-  tinstant_parse(str, basetype, false, false);
-  int count = 1;
-  while (p_comma(str)) 
+  int count = 0, capacity = PARSER_INITIAL_CAPACITY;
+  TInstant **instants = palloc(sizeof(TInstant *) * capacity);
+  do
   {
-    count++;
-    tinstant_parse(str, basetype, false, false);
-  }
+    tinstantarr_parse_append(&instants, &count, &capacity,
+      tinstant_parse(str, basetype, false));
+  } while (p_comma(str));
   if (p_cbracket(str))
     upper_inc = true;
   else if (p_cparen(str))
@@ -518,19 +612,6 @@ tsequence_parse(char **str, Oid basetype, bool linear, bool end, bool make)
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse temporal value")));
   ensure_end_input(str, end);
-  if (! make)
-    return NULL;
-
-  /* Second parsing */
-  *str = bak; 
-  TInstant **instants = palloc(sizeof(TInstant *) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    instants[i] = tinstant_parse(str, basetype, false, true);
-  }
-  p_cbracket(str);
-  p_cparen(str);
   return tsequence_make_free(instants, count, lower_inc, upper_inc,
     linear, NORMALIZE);
 }
@@ -550,29 +631,17 @@ tsequenceset_parse(char **str, Oid basetype, bool linear)
    * to call this function in the dispatch function temporal_parse */
   p_obrace(str);
 
-  /* First parsing */
-  char *bak = *str;
-  tsequence_parse(str, basetype, linear, false, false);
-  int count = 1;
-  while (p_comma(str)) 
+  int count = 0, capacity = PARSER_INITIAL_CAPACITY;
+  TSequence **sequences = palloc(sizeof(TSequence *) * capacity);
+  do
   {
-    count++;
-    tsequence_parse(str, basetype, linear, false, false);
-  }
+    tsequencearr_parse_append(&sequences, &count, &capacity,
+      tsequence_parse(str, basetype, linear, false));
+  } while (p_comma(str));
   if (!p_cbrace(str))
     ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
       errmsg("Could not parse temporal value")));
   ensure_end_input(str, true);
-
-  /* Second parsing */
-  *str = bak;
-  TSequence **sequences = palloc(sizeof(TSequence *) * count);
-  for (int i = 0; i < count; i++) 
-  {
-    p_comma(str);
-    sequences[i] = tsequence_parse(str, basetype, linear, false, true);
-  }
-  p_cbrace(str);
   return tsequenceset_make_free(sequences, count, NORMALIZE);
 }
 
@@ -596,9 +665,9 @@ temporal_parse(char **str, Oid basetype)
     linear = false;
   }
   if (**str != '{' && **str != '[' && **str != '(')
-    result = (Temporal *)tinstant_parse(str, basetype, true, true);
+    result = (Temporal *)tinstant_parse(str, basetype, true);
   else if (**str == '[' || **str == '(')
-    result = (Temporal *)tsequence_parse(str, basetype, linear, true, true);
+    result = (Temporal *)tsequence_parse(str, basetype, linear, true);
   else if (**str == '{')
   {
     char *bak = *str;
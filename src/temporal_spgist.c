@@ -37,12 +37,8 @@ PG_FUNCTION_INFO_V1(spgist_temporal_compress);
 PGDLLEXPORT Datum
 spgist_temporal_compress(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   Period *period = palloc(sizeof(Period));
-
-  temporal_bbox(period, temp);
-
-  PG_FREE_IF_COPY(temp, 0);
+  temporal_bbox_slice(PG_GETARG_DATUM(0), period);
   PG_RETURN_PERIOD(period);
 }
 #endif
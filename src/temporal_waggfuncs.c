@@ -221,88 +221,159 @@ temporal_extend(Temporal *temp, Interval *interval, bool min, int *count)
 }
 
 /*****************************************************************************
- * Transform a temporal number type into a temporal integer type with value 1 
- * extended by a time interval. 
+ * Sliding window engine
+ *
+ * Each composing instant or segment of a temporal value contributes its value
+ * during a window segment that starts at its start time and ends at its end
+ * time extended by the interval. Since both the lower and the upper bounds of
+ * these window segments are ordered, the segments that are active at a given
+ * timestamp form a contiguous range that only moves forward in time. The
+ * engine sweeps the bounds once and maintains the minimum and the maximum of
+ * the range with a monotonic deque and its sum with blocks of suffix sums,
+ * so that the value of a row is computed in linear time and spliced into the
+ * skiplist at once instead of one extended segment at a time.
  *****************************************************************************/
 
 /**
- * Construct a sequence with a value 1 by extending the two bounds by the
- * time interval
+ * Kinds of aggregation computed by the sliding window engine
  */
-static TSequence *
-tinstant_transform_wcount1(TimestampTz lower, TimestampTz upper,
-  bool lower_inc, bool upper_inc, Interval *interval)
+typedef enum
 {
-  TInstant *instants[2];
-  TimestampTz upper1 = DatumGetTimestampTz(DirectFunctionCall2(
-    timestamptz_pl_interval, TimestampTzGetDatum(upper), 
-    PointerGetDatum(interval)));
-  instants[0] = tinstant_make(Int32GetDatum(1), lower, INT4OID);
-  instants[1] = tinstant_make(Int32GetDatum(1), upper1, INT4OID);
-  TSequence *result = tsequence_make(instants, 2, lower_inc, upper_inc,
-    STEP, NORMALIZE_NO);
-  pfree(instants[0]); pfree(instants[1]);
+  WAGG_MIN,
+  WAGG_MAX,
+  WAGG_SUM,
+  WAGG_COUNT,
+  WAGG_AVG
+} WindowAggKind;
+
+/**
+ * Composing instant or segment of a temporal value extended by the interval
+ */
+typedef struct
+{
+  TimestampTz lower;
+  TimestampTz upper;
+  bool lower_inc;
+  bool upper_inc;
+  double value;
+} WindowSegment;
+
+/**
+ * Constant piece of the result of the window aggregation of a temporal value.
+ * The second component of the value is only used for the average.
+ */
+typedef struct
+{
+  TimestampTz lower;
+  TimestampTz upper;
+  bool lower_inc;
+  bool upper_inc;
+  double2 value;
+} WindowPiece;
+
+/**
+ * Range [lo, hi) of the window segments that are currently active
+ */
+typedef struct
+{
+  const WindowSegment *segs;
+  int lo;
+  int hi;
+  int *deque;          /**< Candidates for the minimum or the maximum */
+  int first;           /**< First element of the deque */
+  int last;            /**< Element following the last one of the deque */
+  double *suffix;      /**< Sums of the segments from i to pivot - 1 */
+  int pivot;
+  double sum;          /**< Sum of the segments from pivot to hi - 1 */
+} WindowRange;
+
+/**
+ * Add the interval to the timestamp
+ *
+ * @note Intervals without months and days do not depend on the time zone
+ * and are thus added directly to the timestamp
+ */
+static TimestampTz
+window_upper(TimestampTz t, const Interval *interval)
+{
+  if (interval->month != 0 || interval->day != 0 || TIMESTAMP_NOT_FINITE(t))
+    return DatumGetTimestampTz(DirectFunctionCall2(timestamptz_pl_interval,
+      TimestampTzGetDatum(t), PointerGetDatum(interval)));
+
+  TimestampTz result = t + interval->time;
+  if (! IS_VALID_TIMESTAMP(result))
+    ereport(ERROR, (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+      errmsg("timestamp out of range")));
   return result;
 }
 
 /**
- * Transform the temporal number instant value by the time interval
+ * Extend the temporal instant value by the time interval
  *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
+ * @param[out] result Window segment
  * @param[in] inst Temporal value
  * @param[in] interval Interval
+ * @param[in] number True when the values of the segments are needed
  */
 static int
-tinstant_transform_wcount(TSequence **result, TInstant *inst, 
-  Interval *interval)
+tinstant_window_segments(WindowSegment *result, const TInstant *inst,
+  const Interval *interval, bool number)
 {
-  result[0] = tinstant_transform_wcount1(inst->t, inst->t, true, true,
-    interval);
+  result->lower = inst->t;
+  result->upper = window_upper(inst->t, interval);
+  result->lower_inc = result->upper_inc = true;
+  result->value = number ?
+    datum_double(tinstant_value(inst), inst->valuetypid) : 0.0;
   return 1;
 }
 
 /**
- * Transform the temporal number instant set value by the time interval
+ * Extend the temporal instant set value by the time interval
  *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
+ * @param[out] result Array of window segments
  * @param[in] ti Temporal value
  * @param[in] interval Interval
+ * @param[in] number True when the values of the segments are needed
  */
 static int
-tinstantset_transform_wcount(TSequence **result, TInstantSet *ti, Interval *interval)
+tinstantset_window_segments(WindowSegment *result, const TInstantSet *ti,
+  const Interval *interval, bool number)
 {
   for (int i = 0; i < ti->count; i++)
-  {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    tinstant_transform_wcount(&result[i], inst, interval);
-  }
+    tinstant_window_segments(&result[i], tinstantset_inst_n(ti, i),
+      interval, number);
   return ti->count;
 }
 
 /**
- * Transform the temporal number sequence value by the time interval
+ * Extend the segments of the temporal sequence value by the time interval.
+ * Each segment keeps the value at its start.
  *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
+ * @param[out] result Array of window segments
  * @param[in] seq Temporal value
  * @param[in] interval Interval
+ * @param[in] number True when the values of the segments are needed
  */
 static int
-tsequence_transform_wcount(TSequence **result, TSequence *seq, Interval *interval)
+tsequence_window_segments(WindowSegment *result, const TSequence *seq,
+  const Interval *interval, bool number)
 {
   if (seq->count == 1)
-    return tinstant_transform_wcount(result, tsequence_inst_n(seq, 0), interval);
+    return tinstant_window_segments(result, tsequence_inst_n(seq, 0),
+      interval, number);
 
   TInstant *inst1 = tsequence_inst_n(seq, 0);
   bool lower_inc = seq->period.lower_inc;
   for (int i = 0; i < seq->count - 1; i++)
   {
     TInstant *inst2 = tsequence_inst_n(seq, i + 1);
-    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false ;
-    result[i] = tinstant_transform_wcount1(inst1->t, inst2->t, lower_inc,
-      upper_inc, interval);
+    result[i].lower = inst1->t;
+    result[i].upper = window_upper(inst2->t, interval);
+    result[i].lower_inc = lower_inc;
+    result[i].upper_inc = (i == seq->count - 2) ?
+      seq->period.upper_inc : false;
+    result[i].value = number ?
+      datum_double(tinstant_value(inst1), inst1->valuetypid) : 0.0;
     inst1 = inst2;
     lower_inc = true;
   }
@@ -310,229 +381,368 @@ tsequence_transform_wcount(TSequence **result, TSequence *seq, Interval *interva
 }
 
 /**
- * Transform the temporal number sequence set value by the time interval
+ * Extend the segments of the temporal sequence set value by the time interval
  *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
+ * @param[out] result Array of window segments
  * @param[in] ts Temporal value
  * @param[in] interval Interval
+ * @param[in] number True when the values of the segments are needed
  */
 static int
-tsequenceset_transform_wcount(TSequence **result, TSequenceSet *ts, Interval *interval)
+tsequenceset_window_segments(WindowSegment *result, const TSequenceSet *ts,
+  const Interval *interval, bool number)
 {
   int k = 0;
   for (int i = 0; i < ts->count; i++)
-  {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    k += tsequence_transform_wcount(&result[k], seq, interval);
-  }
+    k += tsequence_window_segments(&result[k], tsequenceset_seq_n(ts, i),
+      interval, number);
   return k;
 }
 
 /**
- * Transform the temporal number by the time interval (dispatch function)
+ * Extend the temporal value by the time interval (dispatch function)
  *
  * @param[in] temp Temporal value
  * @param[in] interval Interval
+ * @param[in] number True when the values of the segments are needed
  * @param[out] count Number of elements in the output array
  */
-static TSequence **
-temporal_transform_wcount(Temporal *temp, Interval *interval, int *count)
+static WindowSegment *
+temporal_window_segments(const Temporal *temp, const Interval *interval,
+  bool number, int *count)
 {
+  WindowSegment *result;
   ensure_valid_duration(temp->duration);
-  TSequence **result;
   if (temp->duration == INSTANT)
   {
-    TInstant *inst = (TInstant *)temp;
-    result = palloc(sizeof(TSequence *));
-    *count = tinstant_transform_wcount(result, inst, interval);
+    result = palloc(sizeof(WindowSegment));
+    *count = tinstant_window_segments(result, (TInstant *) temp, interval,
+      number);
   }
   else if (temp->duration == INSTANTSET)
   {
-    TInstantSet *ti = (TInstantSet *)temp;
-    result = palloc(sizeof(TSequence *) * ti->count);
-    *count = tinstantset_transform_wcount(result, ti, interval);
+    const TInstantSet *ti = (TInstantSet *) temp;
+    result = palloc(sizeof(WindowSegment) * ti->count);
+    *count = tinstantset_window_segments(result, ti, interval, number);
   }
   else if (temp->duration == SEQUENCE)
   {
-    TSequence *seq = (TSequence *)temp;
-    result = palloc(sizeof(TSequence *) * seq->count);
-    *count = tsequence_transform_wcount(result, seq, interval);
+    const TSequence *seq = (TSequence *) temp;
+    result = palloc(sizeof(WindowSegment) * seq->count);
+    *count = tsequence_window_segments(result, seq, interval, number);
   }
   else /* temp->duration == SEQUENCESET */
   {
-    TSequenceSet *ts = (TSequenceSet *)temp;
-    result = palloc(sizeof(TSequence *) * ts->totalcount);
-    *count = tsequenceset_transform_wcount(result, ts, interval);
+    const TSequenceSet *ts = (TSequenceSet *) temp;
+    result = palloc(sizeof(WindowSegment) * ts->totalcount);
+    *count = tsequenceset_window_segments(result, ts, interval, number);
   }
   return result;
 }
 
-/*****************************************************************************/
+/**
+ * Initialize the range of active window segments
+ */
+static void
+window_range_init(WindowRange *range, const WindowSegment *segs, int count,
+  WindowAggKind kind)
+{
+  range->segs = segs;
+  range->lo = range->hi = 0;
+  range->deque = (kind == WAGG_MIN || kind == WAGG_MAX) ?
+    palloc(sizeof(int) * count) : NULL;
+  range->first = range->last = 0;
+  range->suffix = (kind == WAGG_SUM || kind == WAGG_AVG) ?
+    palloc(sizeof(double) * count) : NULL;
+  range->pivot = 0;
+  range->sum = 0.0;
+}
 
 /**
- * Transform the temporal number into a temporal double and extend it
- * by the time interval
- *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
- * @param[in] inst Temporal value
- * @param[in] interval Interval
+ * Move the range of active window segments forward to [lo, hi)
  */
-static int
-tnumberinst_transform_wavg(TSequence **result, TInstant *inst, Interval *interval)
+static void
+window_range_move(WindowRange *range, int lo, int hi, WindowAggKind kind)
 {
-  /* Should be additional attribute */
-  bool linear = true;
-  float8 value = 0.0;
-  ensure_tnumber_base_type(inst->valuetypid);
-  if (inst->valuetypid == INT4OID)
-    value = DatumGetInt32(tinstant_value(inst)); 
-  else /* inst->valuetypid == FLOAT8OID */
-    value = DatumGetFloat8(tinstant_value(inst)); 
-  double2 dvalue;
-  double2_set(&dvalue, value, 1);
-  TimestampTz upper = DatumGetTimestampTz(DirectFunctionCall2(
-    timestamptz_pl_interval, TimestampTzGetDatum(inst->t),
-    PointerGetDatum(interval)));
-  TInstant *instants[2];
-  instants[0] = tinstant_make(PointerGetDatum(&dvalue), inst->t,
-    type_oid(T_DOUBLE2));
-  instants[1] = tinstant_make(PointerGetDatum(&dvalue), upper,
-    type_oid(T_DOUBLE2));
-  result[0] = tsequence_make(instants, 2, true, true, linear, NORMALIZE_NO);
-  pfree(instants[0]); pfree(instants[1]);
-  return 1;
+  const WindowSegment *segs = range->segs;
+  for (int i = range->hi; i < hi; i++)
+  {
+    if (kind == WAGG_MIN || kind == WAGG_MAX)
+    {
+      /* Drop the candidates that can no longer be the extremum */
+      while (range->last > range->first &&
+        ((kind == WAGG_MIN &&
+          segs[range->deque[range->last - 1]].value >= segs[i].value) ||
+         (kind == WAGG_MAX &&
+          segs[range->deque[range->last - 1]].value <= segs[i].value)))
+        range->last--;
+      range->deque[range->last++] = i;
+    }
+    else if (kind == WAGG_SUM || kind == WAGG_AVG)
+      range->sum += segs[i].value;
+  }
+  range->hi = hi;
+
+  if (lo == range->lo)
+    return;
+  if (kind == WAGG_MIN || kind == WAGG_MAX)
+  {
+    while (range->last > range->first && range->deque[range->first] < lo)
+      range->first++;
+  }
+  else if ((kind == WAGG_SUM || kind == WAGG_AVG) && lo >= range->pivot)
+  {
+    /* Start a new block of suffix sums so that the sum of the range never
+     * subtracts the values of the segments that leave it */
+    double sum = 0.0;
+    for (int i = hi - 1; i >= lo; i--)
+    {
+      sum += segs[i].value;
+      range->suffix[i] = sum;
+    }
+    range->pivot = hi;
+    range->sum = 0.0;
+  }
+  range->lo = lo;
 }
 
 /**
- * Transform the temporal number into a temporal double and extend it
- * by the time interval
- *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
- * @param[in] ti Temporal value
- * @param[in] interval Interval
+ * Append to the array the piece covering the bounds with the value of the
+ * range of active window segments, merging it with the previous piece when
+ * they are adjacent and have the same value
  */
-static int
-tnumberinstset_transform_wavg(TSequence **result, TInstantSet *ti, Interval *interval)
+static void
+window_piece_add(WindowPiece *pieces, int *count, const WindowRange *range,
+  TimestampTz lower, TimestampTz upper, bool lower_inc, bool upper_inc,
+  WindowAggKind kind)
 {
-  for (int i = 0; i < ti->count; i++)
+  double2 value;
+  if (kind == WAGG_MIN || kind == WAGG_MAX)
+    double2_set(&value, range->segs[range->deque[range->first]].value, 0);
+  else if (kind == WAGG_COUNT)
+    double2_set(&value, range->hi - range->lo, 0);
+  else
   {
-    TInstant *inst = tinstantset_inst_n(ti, i);
-    tnumberinst_transform_wavg(&result[i], inst, interval);
+    double sum = (range->lo < range->pivot) ?
+      range->suffix[range->lo] + range->sum : range->sum;
+    double2_set(&value, sum, (kind == WAGG_AVG) ? range->hi - range->lo : 0);
   }
-  return ti->count;
+
+  if (*count > 0)
+  {
+    WindowPiece *prev = &pieces[*count - 1];
+    if (prev->upper == lower && prev->upper_inc != lower_inc &&
+      double2_eq(&prev->value, &value))
+    {
+      prev->upper = upper;
+      prev->upper_inc = upper_inc;
+      return;
+    }
+  }
+  WindowPiece *piece = &pieces[(*count)++];
+  piece->lower = lower;
+  piece->upper = upper;
+  piece->lower_inc = lower_inc;
+  piece->upper_inc = upper_inc;
+  piece->value = value;
+  return;
+}
+
+/**
+ * Return the timestamp of the next bound of the window segments
+ */
+static TimestampTz
+window_next_bound(const WindowSegment *segs, int count, int l, int u)
+{
+  return (l < count && segs[l].lower <= segs[u].upper) ?
+    segs[l].lower : segs[u].upper;
 }
 
 /**
-* Transform the temporal integer sequence value into a temporal double and extend
- * it by a time interval
+ * Sweep the bounds of the window segments and compute the constant pieces
+ * of the aggregation
  *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
- * @param[in] seq Temporal value
- * @param[in] interval Interval
- * @note There is no equivalent function for temporal float types 
+ * @param[out] result Array of pieces, with space for 4 * count elements
+ * @param[in] segs Window segments ordered by their bounds
+ * @param[in] count Number of window segments
+ * @param[in] kind Kind of aggregation
+ * @return Number of pieces
  */
 static int
-tintseq_transform_wavg(TSequence **result, TSequence *seq, Interval *interval)
+window_pieces(WindowPiece *result, const WindowSegment *segs, int count,
+  WindowAggKind kind)
 {
-  /* Should be additional attribute */
-  bool linear = true;
-  TInstant *instants[2];
-  if (seq->count == 1)
+  WindowRange range;
+  window_range_init(&range, segs, count, kind);
+  /* The segments before l have started and the ones before u have ended */
+  int l = 0, u = 0, k = 0;
+  while (u < count)
   {
-    TInstant *inst = tsequence_inst_n(seq, 0);
-    tnumberinst_transform_wavg(&result[0], inst, interval);
-    return 1;
+    TimestampTz t = window_next_bound(segs, count, l, u);
+    bool start = (l < count && segs[l].lower == t);
+    int hi_at = (start && segs[l].lower_inc) ? l + 1 : l;
+    int hi_after = start ? l + 1 : l;
+    int lo_at = u;
+    while (lo_at < count && segs[lo_at].upper == t && ! segs[lo_at].upper_inc)
+      lo_at++;
+    int lo_after = lo_at;
+    while (lo_after < count && segs[lo_after].upper == t)
+      lo_after++;
+
+    if (lo_at < hi_at)
+    {
+      window_range_move(&range, lo_at, hi_at, kind);
+      window_piece_add(result, &k, &range, t, t, true, true, kind);
+    }
+    l = hi_after;
+    u = lo_after;
+    if (lo_after < hi_after)
+    {
+      window_range_move(&range, lo_after, hi_after, kind);
+      window_piece_add(result, &k, &range, t,
+        window_next_bound(segs, count, l, u), false, false, kind);
+    }
   }
+  if (range.deque)
+    pfree(range.deque);
+  if (range.suffix)
+    pfree(range.suffix);
+  return k;
+}
 
-  TInstant *inst1 = tsequence_inst_n(seq, 0);
-  bool lower_inc = seq->period.lower_inc;
-  for (int i = 0; i < seq->count - 1; i++)
-  {
-    TInstant *inst2 = tsequence_inst_n(seq, i + 1);
-    bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false ;
-    double value = DatumGetInt32(tinstant_value(inst1)); 
-    double2 dvalue;
-    double2_set(&dvalue, value, 1);
-    TimestampTz upper = DatumGetTimestampTz(DirectFunctionCall2(
-      timestamptz_pl_interval, TimestampTzGetDatum(inst2->t),
-      PointerGetDatum(interval)));
-    instants[0] = tinstant_make(PointerGetDatum(&dvalue), inst1->t,
-      type_oid(T_DOUBLE2));
-    instants[1] = tinstant_make(PointerGetDatum(&dvalue), upper,
-      type_oid(T_DOUBLE2));
-    result[i] = tsequence_make(instants, 2, lower_inc, upper_inc,
-      linear, NORMALIZE_NO);
-    pfree(instants[0]); pfree(instants[1]);
-    inst1 = inst2;
-    lower_inc = true;
-  }
-  return seq->count - 1;
+/**
+ * Return the value of a piece as a datum of the type of the result
+ */
+static Datum
+window_piece_value(const WindowPiece *piece, Oid restypid)
+{
+  if (restypid == INT4OID)
+    return Int32GetDatum((int32) piece->value.a);
+  if (restypid == FLOAT8OID)
+    return Float8GetDatum(piece->value.a);
+  return PointerGetDatum(&piece->value);
 }
 
 /**
-* Transform the temporal integer sequence set value into a temporal double and extend
- * it by a time interval
+ * Construct the sequences of the result of the window aggregation from
+ * its constant pieces. With linear interpolation every piece is a sequence,
+ * with stepwise interpolation adjacent pieces are chained as long as the
+ * common bound belongs to the second one.
  *
- * @param[out] result Array on which the pointers of the newly constructed 
- * values are stored
- * @param[in] ts Temporal value
- * @param[in] interval Interval
- * @note There is no equivalent function for temporal float types 
+ * @param[out] result Array of sequences
+ * @param[in] pieces Array of pieces
+ * @param[in] count Number of pieces
+ * @param[in] restypid Oid of the base type of the result
+ * @param[in] linear True when the result has linear interpolation
+ * @return Number of sequences
  */
 static int
-tintseqset_transform_wavg(TSequence **result, TSequenceSet *ts, Interval *interval)
+window_sequences(TSequence **result, const WindowPiece *pieces, int count,
+  Oid restypid, bool linear)
 {
-  int k = 0;
-  for (int i = 0; i < ts->count; i++)
+  TInstant **instants = palloc(sizeof(TInstant *) * (count + 1));
+  int k = 0, n = 0;
+  bool lower_inc = true;
+  for (int i = 0; i <= count; i++)
   {
-    TSequence *seq = tsequenceset_seq_n(ts, i);
-    k += tintseq_transform_wavg(&result[k], seq, interval);
+    const WindowPiece *piece = (i < count) ? &pieces[i] : NULL;
+    if (n > 0 && (! piece || linear || pieces[i - 1].upper != piece->lower ||
+      ! piece->lower_inc))
+    {
+      /* Close the current sequence with the end of the previous piece */
+      const WindowPiece *prev = &pieces[i - 1];
+      if (prev->lower != prev->upper)
+        instants[n++] = tinstant_make(window_piece_value(prev, restypid),
+          prev->upper, restypid);
+      result[k++] = tsequence_make(instants, n, lower_inc, prev->upper_inc,
+        linear, NORMALIZE_NO);
+      for (int j = 0; j < n; j++)
+        pfree(instants[j]);
+      n = 0;
+    }
+    if (! piece)
+      break;
+    if (n == 0)
+      lower_inc = piece->lower_inc;
+    instants[n++] = tinstant_make(window_piece_value(piece, restypid),
+      piece->lower, restypid);
   }
+  pfree(instants);
   return k;
 }
 
 /**
- * Transform the temporal integer sequence set value into a temporal double and extend
- * it by a time interval (dispatch function)
+ * Splice the sequences resulting from the window aggregation of a temporal
+ * value into the skiplist
+ */
+static SkipList *
+tsequencearr_wagg_transfn(FunctionCallInfo fcinfo, SkipList *state,
+  TSequence **sequences, int count, Datum (*func)(Datum, Datum),
+  bool crossings)
+{
+  if (! state)
+    return skiplist_make(fcinfo, (Temporal **) sequences, count);
+
+  if (skiplist_headval(state)->duration != SEQUENCE)
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different duration")));
+  if (MOBDB_FLAGS_GET_LINEAR(skiplist_headval(state)->flags) !=
+      MOBDB_FLAGS_GET_LINEAR(sequences[0]->flags))
+    ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+      errmsg("Cannot aggregate temporal values of different interpolation")));
+  skiplist_splice(fcinfo, state, (Temporal **) sequences, count, func,
+    crossings);
+  return state;
+}
+
+/**
+ * Window aggregation of a temporal value with the sliding window engine
  *
+ * @param[in] fcinfo Catalog information about the external function
+ * @param[inout] state Skiplist containing the state
  * @param[in] temp Temporal value
  * @param[in] interval Interval
- * @param[out] count Number of elements in the output array
- * @note There is no equivalent function for temporal float types 
-*/
-static TSequence **
-tnumber_transform_wavg(Temporal *temp, Interval *interval, int *count)
+ * @param[in] kind Kind of aggregation
+ * @param[in] func Function combining the results of different values
+ * @param[in] crossings State whether turning points are added in the segments
+ */
+static SkipList *
+temporal_wagg_sweep(FunctionCallInfo fcinfo, SkipList *state,
+  const Temporal *temp, const Interval *interval, WindowAggKind kind,
+  Datum (*func)(Datum, Datum), bool crossings)
 {
-  ensure_valid_duration(temp->duration);
-  TSequence **result;
-  if (temp->duration == INSTANT)
-  {  
-    TInstant *inst = (TInstant *)temp;
-    result = palloc(sizeof(TSequence *));
-    *count = tnumberinst_transform_wavg(result, inst, interval);
-  }
-  else if (temp->duration == INSTANTSET)
-  {  
-    TInstantSet *ti = (TInstantSet *)temp;
-    result = palloc(sizeof(TSequence *) * ti->count);
-    *count = tnumberinstset_transform_wavg(result, ti, interval);
+  Oid restypid;
+  bool linear;
+  if (kind == WAGG_COUNT)
+  {
+    restypid = INT4OID;
+    linear = STEP;
   }
-  else if (temp->duration == SEQUENCE)
+  else if (kind == WAGG_AVG)
   {
-    TSequence *seq = (TSequence *)temp;
-    result = palloc(sizeof(TSequence *) * seq->count);
-    *count = tintseq_transform_wavg(result, seq, interval);
+    restypid = type_oid(T_DOUBLE2);
+    linear = true;
   }
-  else /* temp->duration == SEQUENCESET */
+  else
   {
-    TSequenceSet *ts = (TSequenceSet *)temp;
-    result = palloc(sizeof(TSequence *) * ts->totalcount);
-    *count = tintseqset_transform_wavg(result, ts, interval);
+    restypid = temp->valuetypid;
+    linear = (temp->duration == INSTANT || temp->duration == INSTANTSET) ?
+      linear_interpolation(temp->valuetypid) :
+      MOBDB_FLAGS_GET_LINEAR(temp->flags);
   }
+
+  int count;
+  WindowSegment *segs = temporal_window_segments(temp, interval,
+    kind != WAGG_COUNT, &count);
+  WindowPiece *pieces = palloc(sizeof(WindowPiece) * count * 4);
+  int npieces = window_pieces(pieces, segs, count, kind);
+  TSequence **sequences = palloc(sizeof(TSequence *) * npieces);
+  int nseqs = window_sequences(sequences, pieces, npieces, restypid, linear);
+  SkipList *result = tsequencearr_wagg_transfn(fcinfo, state, sequences,
+    nseqs, func, crossings);
+  for (int i = 0; i < nseqs; i++)
+    pfree(sequences[i]);
+  pfree(sequences); pfree(pieces); pfree(segs);
   return result;
 }
 
@@ -541,7 +751,9 @@ tnumber_transform_wavg(Temporal *temp, Interval *interval, int *count)
  *****************************************************************************/
 
 /**
- * Generic moving window transition function for min, max, and sum aggregation
+ * Moving window transition function for min and max aggregation of temporal
+ * values with linear interpolation, whose extended segments are not constant
+ * and are thus aggregated one by one
  *
  * @param[in] fcinfo Catalog information about the external function
  * @param[inout] state Skiplist containing the state
@@ -550,9 +762,6 @@ tnumber_transform_wavg(Temporal *temp, Interval *interval, int *count)
  * @param[in] func Function
  * @param[in] min True if the calling function is min, max otherwise
  * @param[in] crossings State whether turning points are added in the segments
- * @note This function is directly called by the window sum aggregation for 
- * temporal floats after verifying since the operation is not supported for 
- * sequence (set) duration
  */
 static SkipList *
 temporal_wagg_transfn1(FunctionCallInfo fcinfo, SkipList *state, 
@@ -573,16 +782,16 @@ temporal_wagg_transfn1(FunctionCallInfo fcinfo, SkipList *state,
 }
 
 /**
- * Generic moving window transition function for min, max, and sum aggregation
+ * Generic moving window transition function
  *
  * @param[in] fcinfo Catalog information about the external function
  * @param[in] func Function
- * @param[in] min True if the calling function is min, max otherwise
+ * @param[in] kind Kind of aggregation
  * @param[in] crossings State whether turning points are added in the segments
  */
-Datum
+static Datum
 temporal_wagg_transfn(FunctionCallInfo fcinfo, 
-  Datum (*func)(Datum, Datum), bool min, bool crossings)
+  Datum (*func)(Datum, Datum), WindowAggKind kind, bool crossings)
 {
   SkipList *state = PG_ARGISNULL(0) ? NULL :
     (SkipList *) PG_GETARG_POINTER(0);
@@ -594,48 +803,18 @@ temporal_wagg_transfn(FunctionCallInfo fcinfo,
   }
   Temporal *temp = PG_GETARG_TEMPORAL(1);
   Interval *interval = PG_GETARG_INTERVAL_P(2);
-  if ((temp->duration == SEQUENCE || temp->duration == SEQUENCESET) &&
-    temp->valuetypid == FLOAT8OID && func == &datum_sum_float8)
+  ensure_positive_interval(interval);
+  bool linearseq = (temp->duration == SEQUENCE ||
+    temp->duration == SEQUENCESET) && MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  if (linearseq && kind == WAGG_SUM)
     ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
       errmsg("Operation not supported for temporal float sequences")));
-      
-  SkipList *result = temporal_wagg_transfn1(fcinfo, state, temp, interval,
-    func, min, crossings);
-  
-  PG_FREE_IF_COPY(temp, 1);
-  PG_FREE_IF_COPY(interval, 2);
-  PG_RETURN_POINTER(result);
-}
 
-/**
- * Transition function for moving window count and average aggregation 
- * for temporal values
- */
-Datum
-temporal_wagg_transform_transfn(FunctionCallInfo fcinfo, 
-  Datum (*func)(Datum, Datum), 
-  TSequence ** (*transform)(Temporal *, Interval *, int *))
-{
-  SkipList *state = PG_ARGISNULL(0) ? NULL :
-    (SkipList *) PG_GETARG_POINTER(0);
-  if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
-  {
-    if (! state)
-      PG_RETURN_NULL();
-    PG_RETURN_POINTER(state);
-  }
-  Temporal *temp = PG_GETARG_TEMPORAL(1);
-  Interval *interval = PG_GETARG_INTERVAL_P(2);
-  int count;
-  TSequence **sequences = transform(temp, interval, &count);
-  SkipList *result = tsequence_tagg_transfn(fcinfo, state, sequences[0], 
-    func, false);
-  for (int i = 1; i < count; i++)
-    result = tsequence_tagg_transfn(fcinfo, result, sequences[i], 
-      func, false);
-  for (int i = 0; i < count; i++)
-    pfree(sequences[i]);
-  pfree(sequences);
+  SkipList *result = (linearseq && (kind == WAGG_MIN || kind == WAGG_MAX)) ?
+    temporal_wagg_transfn1(fcinfo, state, temp, interval, func,
+      kind == WAGG_MIN, crossings) :
+    temporal_wagg_sweep(fcinfo, state, temp, interval, kind, func, crossings);
+
   PG_FREE_IF_COPY(temp, 1);
   PG_FREE_IF_COPY(interval, 2);
   PG_RETURN_POINTER(result);
@@ -650,7 +829,7 @@ PG_FUNCTION_INFO_V1(tint_wmin_transfn);
 PGDLLEXPORT Datum
 tint_wmin_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transfn(fcinfo, &datum_min_int32, MIN, CROSSINGS);
+  return temporal_wagg_transfn(fcinfo, &datum_min_int32, WAGG_MIN, CROSSINGS);
 }
 
 PG_FUNCTION_INFO_V1(tfloat_wmin_transfn);
@@ -660,7 +839,7 @@ PG_FUNCTION_INFO_V1(tfloat_wmin_transfn);
 PGDLLEXPORT Datum
 tfloat_wmin_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transfn(fcinfo, &datum_min_float8, MIN, CROSSINGS);
+  return temporal_wagg_transfn(fcinfo, &datum_min_float8, WAGG_MIN, CROSSINGS);
 }
 
 PG_FUNCTION_INFO_V1(tint_wmax_transfn);
@@ -670,7 +849,7 @@ PG_FUNCTION_INFO_V1(tint_wmax_transfn);
 PGDLLEXPORT Datum
 tint_wmax_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transfn(fcinfo, &datum_max_int32, MAX, CROSSINGS);
+  return temporal_wagg_transfn(fcinfo, &datum_max_int32, WAGG_MAX, CROSSINGS);
 }
 
 PG_FUNCTION_INFO_V1(tfloat_wmax_transfn);
@@ -680,7 +859,7 @@ PG_FUNCTION_INFO_V1(tfloat_wmax_transfn);
 PGDLLEXPORT Datum
 tfloat_wmax_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transfn(fcinfo, &datum_max_float8, MAX, CROSSINGS);
+  return temporal_wagg_transfn(fcinfo, &datum_max_float8, WAGG_MAX, CROSSINGS);
 }
 
 PG_FUNCTION_INFO_V1(tint_wsum_transfn);
@@ -690,7 +869,8 @@ PG_FUNCTION_INFO_V1(tint_wsum_transfn);
 PGDLLEXPORT Datum
 tint_wsum_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transfn(fcinfo, &datum_sum_int32, MIN, CROSSINGS_NO);
+  return temporal_wagg_transfn(fcinfo, &datum_sum_int32, WAGG_SUM,
+    CROSSINGS_NO);
 }
 
 PG_FUNCTION_INFO_V1(tfloat_wsum_transfn);
@@ -700,7 +880,7 @@ PG_FUNCTION_INFO_V1(tfloat_wsum_transfn);
 PGDLLEXPORT Datum
 tfloat_wsum_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transfn(fcinfo, &datum_sum_float8, MIN, CROSSINGS);
+  return temporal_wagg_transfn(fcinfo, &datum_sum_float8, WAGG_SUM, CROSSINGS);
 }
 
 PG_FUNCTION_INFO_V1(temporal_wcount_transfn);
@@ -710,8 +890,8 @@ PG_FUNCTION_INFO_V1(temporal_wcount_transfn);
 PGDLLEXPORT Datum
 temporal_wcount_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transform_transfn(fcinfo, &datum_sum_int32, 
-    &temporal_transform_wcount);
+  return temporal_wagg_transfn(fcinfo, &datum_sum_int32, WAGG_COUNT,
+    CROSSINGS_NO);
 }
 
 PG_FUNCTION_INFO_V1(tnumber_wavg_transfn);
@@ -721,8 +901,8 @@ PG_FUNCTION_INFO_V1(tnumber_wavg_transfn);
 PGDLLEXPORT Datum
 tnumber_wavg_transfn(PG_FUNCTION_ARGS)
 {
-  return temporal_wagg_transform_transfn(fcinfo, &datum_sum_double2, 
-    &tnumber_transform_wavg);
+  return temporal_wagg_transfn(fcinfo, &datum_sum_double2, WAGG_AVG,
+    CROSSINGS_NO);
 }
 
 /*****************************************************************************/
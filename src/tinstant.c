@@ -15,6 +15,7 @@
 #include <assert.h>
 #include <libpq/pqformat.h>
 #include <utils/builtins.h>
+#include <utils/lsyscache.h>
 #include <utils/timestamp.h>
 
 #include "timetypes.h"
@@ -235,37 +236,130 @@ tinstant_to_string(const TInstant *inst, char *(*value_out)(Oid, Datum))
 }
 
 /**
- * Write the binary representation of the temporal value into the buffer
+ * Send or receive function of a base type whose values are not written
+ * natively. It is kept in the fn_extra of the send or receive function of
+ * the temporal type so that it is looked up once per query instead of for
+ * every instant.
+ */
+typedef struct
+{
+  Oid valuetypid;         /**< Oid of the base type */
+  Oid typioparam;         /**< Type parameter of the receive function */
+  FmgrInfo proc;          /**< Send or receive function of the base type */
+} TInstantIOCache;
+
+/**
+ * Returns the send or receive function of the base type cached in the
+ * fn_extra of the calling function, looking it up when needed
  *
- * @param[in] inst Temporal value
- * @param[in] buf Buffer
+ * @param[in] flinfo Information of the send or receive function of the
+ * temporal type
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] send True for the send function, false for the receive one
  */
-void
-tinstant_write(const TInstant *inst, StringInfo buf)
+static TInstantIOCache *
+tinstant_io_cache(FmgrInfo *flinfo, Oid valuetypid, bool send)
+{
+  TInstantIOCache *cache = (TInstantIOCache *) flinfo->fn_extra;
+  if (cache == NULL)
+  {
+    cache = MemoryContextAlloc(flinfo->fn_mcxt, sizeof(TInstantIOCache));
+    cache->valuetypid = InvalidOid;
+    flinfo->fn_extra = cache;
+  }
+  if (cache->valuetypid != valuetypid)
+  {
+    Oid func;
+    if (send)
+    {
+      bool isvarlena;
+      getTypeBinaryOutputInfo(valuetypid, &func, &isvarlena);
+    }
+    else
+      getTypeBinaryInputInfo(valuetypid, &func, &cache->typioparam);
+    fmgr_info_cxt(func, &cache->proc, flinfo->fn_mcxt);
+    cache->valuetypid = valuetypid;
+  }
+  return cache;
+}
+
+/**
+ * Write into the buffer the length of the binary representation of a value
+ */
+static void
+tinstant_write_size(StringInfo buf, int size)
 {
-  bytea *bt = call_send(TIMESTAMPTZOID, TimestampTzGetDatum(inst->t));
-  bytea *bv = call_send(inst->valuetypid, tinstant_value(inst));
-  pq_sendbytes(buf, VARDATA(bt), VARSIZE(bt) - VARHDRSZ);
 #if MOBDB_PGSQL_VERSION < 110000
-  pq_sendint(buf, VARSIZE(bv) - VARHDRSZ, 4) ;
+  pq_sendint(buf, size, 4) ;
 #else
-  pq_sendint32(buf, VARSIZE(bv) - VARHDRSZ) ;
+  pq_sendint32(buf, size) ;
 #endif
-  pq_sendbytes(buf, VARDATA(bv), VARSIZE(bv) - VARHDRSZ);
 }
 
 /**
- * Returns a new temporal value from its binary representation read from
- * the buffer
+ * Write the binary representation of the base value into the buffer,
+ * preceded by its length.
  *
- * @param[in] buf Buffer
- * @param[in] valuetypid Oid of the base type
+ * The values of the fixed-size base types and the points are written
+ * directly into the buffer. Their representation is the same as the one
+ * produced by the send function of the base type.
  */
-TInstant *
-tinstant_read(StringInfo buf, Oid valuetypid)
+static void
+tinstant_value_write(Datum value, Oid valuetypid, StringInfo buf,
+  FmgrInfo *flinfo)
 {
-  TimestampTz t = call_recv(TIMESTAMPTZOID, buf);
-  int size = pq_getmsgint(buf, 4) ;
+  if (valuetypid == BOOLOID)
+  {
+    tinstant_write_size(buf, 1);
+    pq_sendbyte(buf, DatumGetBool(value) ? 1 : 0);
+    return;
+  }
+  if (valuetypid == INT4OID)
+  {
+    tinstant_write_size(buf, 4);
+#if MOBDB_PGSQL_VERSION < 110000
+    pq_sendint(buf, DatumGetInt32(value), 4);
+#else
+    pq_sendint32(buf, DatumGetInt32(value));
+#endif
+    return;
+  }
+  if (valuetypid == FLOAT8OID)
+  {
+    tinstant_write_size(buf, 8);
+    pq_sendfloat8(buf, DatumGetFloat8(value));
+    return;
+  }
+  if (tgeo_base_type(valuetypid) && point_write(value, buf))
+    return;
+
+  TInstantIOCache *cache = tinstant_io_cache(flinfo, valuetypid, true);
+  bytea *bv = SendFunctionCall(&cache->proc, value);
+  tinstant_write_size(buf, VARSIZE(bv) - VARHDRSZ);
+  pq_sendbytes(buf, VARDATA(bv), VARSIZE(bv) - VARHDRSZ);
+  pfree(bv);
+}
+
+/**
+ * Returns the base value from its binary representation of the given size
+ * read from the buffer
+ */
+static Datum
+tinstant_value_read(StringInfo buf, int size, Oid valuetypid,
+  FmgrInfo *flinfo)
+{
+  if (valuetypid == BOOLOID && size == 1)
+    return BoolGetDatum(pq_getmsgbyte(buf) != 0);
+  if (valuetypid == INT4OID && size == 4)
+    return Int32GetDatum((int32) pq_getmsgint(buf, 4));
+  if (valuetypid == FLOAT8OID && size == 8)
+    return Float8GetDatum(pq_getmsgfloat8(buf));
+  /* Geography points are left to PostGIS, which checks their coordinates */
+  Datum result;
+  if (valuetypid == type_oid(T_GEOMETRY) && point_read(buf, size, &result))
+    return result;
+
+  TInstantIOCache *cache = tinstant_io_cache(flinfo, valuetypid, false);
   StringInfoData buf2 =
   {
     .cursor = 0,
@@ -273,9 +367,47 @@ tinstant_read(StringInfo buf, Oid valuetypid)
     .maxlen = size,
     .data = buf->data + buf->cursor
   };
-  Datum value = call_recv(valuetypid, &buf2);
+  result = ReceiveFunctionCall(&cache->proc, &buf2, cache->typioparam, -1);
   buf->cursor += size ;
-  return tinstant_make(value, t, valuetypid);
+  return result;
+}
+
+/**
+ * Write the binary representation of the temporal value into the buffer
+ *
+ * @param[in] inst Temporal value
+ * @param[in] buf Buffer
+ * @param[in] flinfo Information of the calling send function
+ */
+void
+tinstant_write(const TInstant *inst, StringInfo buf, FmgrInfo *flinfo)
+{
+  /* Same representation as the one of the send function of timestamptz */
+  pq_sendint64(buf, inst->t);
+  tinstant_value_write(tinstant_value(inst), inst->valuetypid, buf, flinfo);
+}
+
+/**
+ * Returns a new temporal value from its binary representation read from
+ * the buffer
+ *
+ * @param[in] buf Buffer
+ * @param[in] valuetypid Oid of the base type
+ * @param[in] flinfo Information of the calling receive function
+ */
+TInstant *
+tinstant_read(StringInfo buf, Oid valuetypid, FmgrInfo *flinfo)
+{
+  TimestampTz t = (TimestampTz) pq_getmsgint64(buf);
+  /* Same range check as the one of the receive function of timestamptz */
+  if (! TIMESTAMP_NOT_FINITE(t) && ! IS_VALID_TIMESTAMP(t))
+    ereport(ERROR, (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+      errmsg("timestamp out of range")));
+  int size = pq_getmsgint(buf, 4) ;
+  Datum value = tinstant_value_read(buf, size, valuetypid, flinfo);
+  TInstant *result = tinstant_make(value, t, valuetypid);
+  DATUM_FREE(value, valuetypid);
+  return result;
 }
 
 /*****************************************************************************
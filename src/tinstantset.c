@@ -36,15 +36,43 @@
  * General functions
  *****************************************************************************/
 
+/**
+ * Returns a pointer to the array of offsets of the temporal value
+ *
+ * @note The values written by previous versions, for which the flag
+ * PREFIXBOX is not set, have the offsets right after the header and an
+ * additional offset for the bounding box, which follows the instants
+ */
+static size_t *
+tinstantset_offsets_ptr(const TInstantSet *ti)
+{
+  size_t pos = double_pad(sizeof(TInstantSet));
+  if (MOBDB_FLAGS_GET_PREFIXBOX(ti->flags))
+    pos += double_pad(ti->bboxsize);
+  return (size_t *)(((char *) ti) + pos);
+}
+
+/**
+ * Returns a pointer to the data of the temporal value, that is, to the
+ * first instant
+ */
+static char *
+tinstantset_data_ptr(const TInstantSet *ti)
+{
+  size_t *offsets = tinstantset_offsets_ptr(ti);
+  if (MOBDB_FLAGS_GET_PREFIXBOX(ti->flags))
+    return (char *)(&offsets[ti->count]);
+  return (char *)(&offsets[ti->count + 1]);
+}
+
 /**
  * Returns the n-th instant of the temporal value
  */
 TInstant *
 tinstantset_inst_n(const TInstantSet *ti, int index)
 {
-  return (TInstant *) (
-    (char *)(&ti->offsets[ti->count + 1]) +   /* start of data */
-      ti->offsets[index]);          /* offset */
+  size_t *offsets = tinstantset_offsets_ptr(ti);
+  return (TInstant *)(tinstantset_data_ptr(ti) + offsets[index]);
 }
 
 /**
@@ -53,8 +81,10 @@ tinstantset_inst_n(const TInstantSet *ti, int index)
 void *
 tinstantset_bbox_ptr(const TInstantSet *ti)
 {
-  return (char *)(&ti->offsets[ti->count + 1]) +  /* start of data */
-    ti->offsets[ti->count];            /* offset */
+  if (MOBDB_FLAGS_GET_PREFIXBOX(ti->flags))
+    return ((char *) ti) + double_pad(sizeof(TInstantSet));
+  size_t *offsets = tinstantset_offsets_ptr(ti);
+  return tinstantset_data_ptr(ti) + offsets[ti->count];
 }
 
 /**
@@ -89,47 +119,46 @@ tinstantset_make1(TInstant **instants, int count)
 {
   /* Get the bounding box size */
   size_t bboxsize = temporal_bbox_size(instants[0]->valuetypid);
-  size_t memsize = double_pad(bboxsize);
+  /* Add the size of the struct, the bounding box, and the offset array */
+  size_t pdata = double_pad(sizeof(TInstantSet)) + double_pad(bboxsize) +
+    count * sizeof(size_t);
   /* Add the size of composing instants */
+  size_t memsize = 0;
   for (int i = 0; i < count; i++)
     memsize += double_pad(VARSIZE(instants[i]));
-  /* Add the size of the struct and the offset array
-   * Notice that the first offset is already declared in the struct */
-  size_t pdata = double_pad(sizeof(TInstantSet) + count * sizeof(size_t));
   /* Create the TInstantSet */
   TInstantSet *result = palloc0(pdata + memsize);
   SET_VARSIZE(result, pdata + memsize);
   result->count = count;
+  result->bboxsize = bboxsize;
   result->valuetypid = instants[0]->valuetypid;
   result->duration = INSTANTSET;
   MOBDB_FLAGS_SET_LINEAR(result->flags,
     MOBDB_FLAGS_GET_LINEAR(instants[0]->flags));
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
+  MOBDB_FLAGS_SET_PREFIXBOX(result->flags, true);
   if (tgeo_base_type(instants[0]->valuetypid))
   {
     MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(instants[0]->flags));
     MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(instants[0]->flags));
   }
-  /* Initialization of the variable-length part */
-  size_t pos = 0;
-  for (int i = 0; i < count; i++)
-  {
-    memcpy(((char *)result) + pdata + pos, instants[i],
-      VARSIZE(instants[i]));
-    result->offsets[i] = pos;
-    pos += double_pad(VARSIZE(instants[i]));
-  }
   /*
    * Precompute the bounding box
    * Only external types have precomputed bounding box, internal types such
    * as double2, double3, or double4 do not have one
    */
   if (bboxsize != 0)
+    tinstantset_make_bbox(tinstantset_bbox_ptr(result), instants, count);
+  /* Initialization of the variable-length part */
+  size_t *offsets = tinstantset_offsets_ptr(result);
+  size_t pos = 0;
+  for (int i = 0; i < count; i++)
   {
-    void *bbox = ((char *) result) + pdata + pos;
-    tinstantset_make_bbox(bbox, instants, count);
-    result->offsets[count] = pos;
+    memcpy(((char *)result) + pdata + pos, instants[i],
+      VARSIZE(instants[i]));
+    offsets[i] = pos;
+    pos += double_pad(VARSIZE(instants[i]));
   }
   return result;
 }
@@ -141,16 +170,18 @@ tinstantset_make1(TInstant **instants, int count)
  * For example, the memory structure of a temporal instant set value
  * with 2 instants is as follows
  * @code
- *  ------------------------------------------------------
- *  ( TInstantSet | offset_0 | offset_1 | offset_2 )_X | ...
- *  ------------------------------------------------------
- *  ----------------------------------------------------------
- *  ( TInstant_0 )_X | ( TInstant_1 )_X | ( bbox )_X |
- *  ----------------------------------------------------------
+ *  ------------------------------------------------------------------
+ *  ( TInstantSet )_X | ( bbox )_X | offset_0 | offset_1 | ...
+ *  ------------------------------------------------------------------
+ *  ------------------------------------------
+ *  ( TInstant_0 )_X | ( TInstant_1 )_X |
+ *  ------------------------------------------
  * @endcode
- * where the `_X` are unused bytes added for double padding, `offset_0` and
- * `offset_1` are offsets for the corresponding instants, and `offset_2`
- * is the offset for the bounding box.
+ * where the `_X` are unused bytes added for double padding, and `offset_0`
+ * and `offset_1` are offsets for the corresponding instants. The bounding
+ * box follows the fixed-size header so that it can be obtained from a
+ * prefix of a toasted value whose size does not depend on the number of
+ * instants, see function temporal_bbox_slice.
  *
  * @param[in] instants Array of instants
  * @param[in] count Number of elements in the array
@@ -483,7 +514,7 @@ tinstantset_to_string(const TInstantSet *ti, char *(*value_out)(Oid, Datum))
  * @param[in] buf Buffer
  */
 void
-tinstantset_write(const TInstantSet *ti, StringInfo buf)
+tinstantset_write(const TInstantSet *ti, StringInfo buf, FmgrInfo *flinfo)
 {
 #if MOBDB_PGSQL_VERSION < 110000
   pq_sendint(buf, (uint32) ti->count, 4);
@@ -493,7 +524,7 @@ tinstantset_write(const TInstantSet *ti, StringInfo buf)
   for (int i = 0; i < ti->count; i++)
   {
     TInstant *inst = tinstantset_inst_n(ti, i);
-    tinstant_write(inst, buf);
+    tinstant_write(inst, buf, flinfo);
   }
 }
 
@@ -505,12 +536,12 @@ tinstantset_write(const TInstantSet *ti, StringInfo buf)
  * @param[in] valuetypid Oid of the base type
  */
 TInstantSet *
-tinstantset_read(StringInfo buf, Oid valuetypid)
+tinstantset_read(StringInfo buf, Oid valuetypid, FmgrInfo *flinfo)
 {
   int count = (int) pq_getmsgint(buf, 4);
   TInstant **instants = palloc(sizeof(TInstant *) * count);
   for (int i = 0; i < count; i++)
-    instants[i] = tinstant_read(buf, valuetypid);
+    instants[i] = tinstant_read(buf, valuetypid, flinfo);
   return tinstantset_make_free(instants, count);
 }
 
@@ -1477,7 +1508,8 @@ tinstantset_eq(const TInstantSet *ti1, const TInstantSet *ti2)
 {
   assert(ti1->valuetypid == ti2->valuetypid);
   /* If number of sequences or flags are not equal */
-  if (ti1->count != ti2->count || ti1->flags != ti2->flags)
+  if (ti1->count != ti2->count || MOBDB_FLAGS_NO_PREFIXBOX(ti1->flags) !=
+      MOBDB_FLAGS_NO_PREFIXBOX(ti2->flags))
     return false;
 
   /* If bounding boxes are not equal */
@@ -307,9 +307,8 @@ tnumber_gist_compress(PG_FUNCTION_ARGS)
   if (entry->leafkey)
   {
     GISTENTRY *retval = palloc(sizeof(GISTENTRY));
-    Temporal *temp = DatumGetTemporal(entry->key);
     TBOX *box = palloc0(sizeof(TBOX));
-    temporal_bbox(box, temp);
+    temporal_bbox_slice(entry->key, box);
     gistentryinit(*retval, PointerGetDatum(box),
       entry->rel, entry->page, entry->offset, false);
     PG_RETURN_POINTER(retval);
@@ -13,6 +13,7 @@
 
 #include "tnumber_mathfuncs.h"
 
+#include <float.h>
 #include <math.h>
 #include <utils/builtins.h>
 
@@ -157,6 +158,486 @@ tnumberseq_mult_maxmin_at_timestamp(const TInstant *start1, const TInstant *end1
   return true;
 }
 
+/*****************************************************************************
+ * Specialized kernels
+ *
+ * When the temporal number and the result have the same base type and the
+ * operation with the number is injective, the result has the same instants,
+ * bounds, and interpolation as the temporal number, and since the operation
+ * is affine it stays normalized up to floating point rounding. The result
+ * is then computed by copying the temporal number and applying the
+ * operation in place to the values of its instants with a loop specialized
+ * for the base type and the operator, instead of calling the operation
+ * through the lifting framework and constructing a new instant per value.
+ *
+ * Similarly, two temporal numbers with the same base type as the result,
+ * the same duration and interpolation, and instants at the same timestamps
+ * do not need to be synchronized: the result is computed in place on a copy
+ * of the first one. Since the values of the result are not affine in those
+ * of the arguments, the result is checked to be normalized and the lifting
+ * framework is used otherwise.
+ *****************************************************************************/
+
+/**
+ * Apply the expression to the values of the instants, which are replaced
+ * by the result, and update the minimum and the maximum of the result
+ */
+#define ARITHOP_LOOP(type, getvalue, setvalue, expr) \
+  do { \
+    for (int i = 0; i < count; i++) \
+    { \
+      Datum *ptr = tinstant_value_ptr(instants[i]); \
+      type x = getvalue(*ptr); \
+      type r = (expr); \
+      *ptr = setvalue(r); \
+      if ((double) r < *xmin) \
+        *xmin = (double) r; \
+      if ((double) r > *xmax) \
+        *xmax = (double) r; \
+    } \
+  } while (0)
+
+/**
+ * Apply in place the arithmetic operation with the number to the values of
+ * the instants and update the minimum and the maximum of the result
+ *
+ * @param[in,out] instants Array of instants
+ * @param[in] count Number of elements in the array
+ * @param[in] value Number
+ * @param[in] valuetypid Oid of the base type of the number
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] invert True when the base value is the first argument
+ * of the function
+ * @param[in,out] xmin,xmax Minimum and maximum of the result
+ */
+static void
+tnumberinstarr_arithop(TInstant **instants, int count, Datum value,
+  Oid valuetypid, TArithmetic oper, bool invert, double *xmin, double *xmax)
+{
+  if (instants[0]->valuetypid == INT4OID)
+  {
+    int32 d = DatumGetInt32(value);
+    if (oper == ADD)
+      ARITHOP_LOOP(int32, DatumGetInt32, Int32GetDatum, x + d);
+    else if (oper == SUB && invert)
+      ARITHOP_LOOP(int32, DatumGetInt32, Int32GetDatum, d - x);
+    else if (oper == SUB)
+      ARITHOP_LOOP(int32, DatumGetInt32, Int32GetDatum, x - d);
+    else /* oper == MULT */
+      ARITHOP_LOOP(int32, DatumGetInt32, Int32GetDatum, x * d);
+  }
+  else /* instants[0]->valuetypid == FLOAT8OID */
+  {
+    double d = datum_double(value, valuetypid);
+    if (oper == ADD)
+      ARITHOP_LOOP(double, DatumGetFloat8, Float8GetDatum, x + d);
+    else if (oper == SUB && invert)
+      ARITHOP_LOOP(double, DatumGetFloat8, Float8GetDatum, d - x);
+    else if (oper == SUB)
+      ARITHOP_LOOP(double, DatumGetFloat8, Float8GetDatum, x - d);
+    else if (oper == MULT)
+      ARITHOP_LOOP(double, DatumGetFloat8, Float8GetDatum, x * d);
+    else /* oper == DIV */
+      ARITHOP_LOOP(double, DatumGetFloat8, Float8GetDatum, x / d);
+  }
+  return;
+}
+
+/**
+ * Returns true if the arithmetic operation of the temporal number and the
+ * number can be computed in place
+ *
+ * @param[in] temp Temporal number
+ * @param[in] value Number
+ * @param[in] valuetypid Oid of the base type of the number
+ * @param[in] restypid Oid of the base type of the result
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] invert True when the base value is the first argument
+ * of the function
+ */
+static bool
+tnumber_arithop_inplace_valid(const Temporal *temp, Datum value,
+  Oid valuetypid, Oid restypid, TArithmetic oper, bool invert)
+{
+  if (temp->valuetypid != restypid)
+    return false;
+  if (restypid == FLOAT8OID && ! FLOAT8PASSBYVAL)
+    return false;
+  /* The integer division and the division of a number by a temporal
+   * number are not injective or not affine */
+  if (oper == DIV && (restypid == INT4OID || invert))
+    return false;
+  if (oper == MULT && datum_double(value, valuetypid) == 0.0)
+    return false;
+  return true;
+}
+
+/**
+ * Apply in place the arithmetic operation with the number to the temporal
+ * sequence value and set its bounding box. Returns false if the result has
+ * redundant instants and thus must be normalized.
+ *
+ * @param[in,out] seq Temporal number
+ * @param[in] instants Buffer for the instants of the sequence
+ * @param[in] value Number
+ * @param[in] valuetypid Oid of the base type of the number
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in] invert True when the base value is the first argument
+ * of the function
+ * @param[in,out] xmin,xmax Minimum and maximum of the result
+ * @note The operations on integers are injective and preserve collinearity,
+ * so that the result is normalized. This is not the case for floats due to
+ * rounding, e.g., 0 + 1 and 1e-20 + 1 are equal.
+ */
+static bool
+tnumberseq_arithop_inplace(TSequence *seq, TInstant **instants, Datum value,
+  Oid valuetypid, TArithmetic oper, bool invert, double *xmin, double *xmax)
+{
+  for (int i = 0; i < seq->count; i++)
+    instants[i] = tsequence_inst_n(seq, i);
+  TBOX *box = tsequence_bbox_ptr(seq);
+  box->xmin = DBL_MAX;
+  box->xmax = -DBL_MAX;
+  tnumberinstarr_arithop(instants, seq->count, value, valuetypid, oper,
+    invert, &box->xmin, &box->xmax);
+  *xmin = Min(*xmin, box->xmin);
+  *xmax = Max(*xmax, box->xmax);
+  if (seq->valuetypid != FLOAT8OID)
+    return true;
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+  for (int i = 1; i < seq->count - 1; i++)
+  {
+    if (tinstant_redundant(instants[i - 1], instants[i], instants[i + 1],
+        linear))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Returns the arithmetic operation of the temporal number and the number
+ * computed in place on a copy of the temporal number, or NULL if the result
+ * must be normalized, which is then left to the lifting framework
+ *
+ * @pre The function tnumber_arithop_inplace_valid returns true
+ */
+static Temporal *
+tnumber_arithop_inplace(const Temporal *temp, Datum value, Oid valuetypid,
+  TArithmetic oper, bool invert)
+{
+  Temporal *result = temporal_copy(temp);
+  double xmin = DBL_MAX, xmax = -DBL_MAX;
+  bool normalized = true;
+  if (result->duration == INSTANT)
+  {
+    TInstant *inst = (TInstant *) result;
+    tnumberinstarr_arithop(&inst, 1, value, valuetypid, oper, invert,
+      &xmin, &xmax);
+  }
+  else if (result->duration == INSTANTSET)
+  {
+    TInstantSet *ti = (TInstantSet *) result;
+    TInstant **instants = palloc(sizeof(TInstant *) * ti->count);
+    for (int i = 0; i < ti->count; i++)
+      instants[i] = tinstantset_inst_n(ti, i);
+    TBOX *box = tinstantset_bbox_ptr(ti);
+    tnumberinstarr_arithop(instants, ti->count, value, valuetypid, oper,
+      invert, &xmin, &xmax);
+    box->xmin = xmin;
+    box->xmax = xmax;
+    pfree(instants);
+  }
+  else if (result->duration == SEQUENCE)
+  {
+    TSequence *seq = (TSequence *) result;
+    TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+    normalized = tnumberseq_arithop_inplace(seq, instants, value, valuetypid,
+      oper, invert, &xmin, &xmax);
+    pfree(instants);
+  }
+  else /* result->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts = (TSequenceSet *) result;
+    TInstant **instants = palloc(sizeof(TInstant *) * ts->totalcount);
+    for (int i = 0; i < ts->count && normalized; i++)
+    {
+      TSequence *seq = tsequenceset_seq_n(ts, i);
+      normalized = tnumberseq_arithop_inplace(seq, instants, value,
+        valuetypid, oper, invert, &xmin, &xmax);
+      /* Adjacent sequences may be joined by the normalization */
+      if (normalized && i > 0 && ts->valuetypid == FLOAT8OID)
+      {
+        TSequence *prev = tsequenceset_seq_n(ts, i - 1);
+        normalized = ! (prev->period.upper == seq->period.lower &&
+          (prev->period.upper_inc || seq->period.lower_inc));
+      }
+    }
+    TBOX *box = tsequenceset_bbox_ptr(ts);
+    box->xmin = xmin;
+    box->xmax = xmax;
+    pfree(instants);
+  }
+  if (! normalized)
+  {
+    pfree(result);
+    return NULL;
+  }
+  return result;
+}
+
+/**
+ * Apply the expression to the values of the instants of the first array
+ * and of the second array, which are replaced in the first array by the
+ * result, and update the minimum and the maximum of the result
+ */
+#define ARITHOP_LOOP2(type, getvalue, setvalue, expr) \
+  do { \
+    for (int i = 0; i < count; i++) \
+    { \
+      Datum *ptr = tinstant_value_ptr(instants1[i]); \
+      type x = getvalue(*ptr); \
+      type y = getvalue(tinstant_value(instants2[i])); \
+      type r = (expr); \
+      *ptr = setvalue(r); \
+      if ((double) r < *xmin) \
+        *xmin = (double) r; \
+      if ((double) r > *xmax) \
+        *xmax = (double) r; \
+    } \
+  } while (0)
+
+/**
+ * Apply in place the arithmetic operation to the values of the instants of
+ * the two arrays and update the minimum and the maximum of the result
+ *
+ * @param[in,out] instants1 First array of instants, which receives the result
+ * @param[in] instants2 Second array of instants
+ * @param[in] count Number of elements in the arrays
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in,out] xmin,xmax Minimum and maximum of the result
+ */
+static void
+tnumberinstarr_arithop2(TInstant **instants1, TInstant **instants2,
+  int count, TArithmetic oper, double *xmin, double *xmax)
+{
+  if (instants1[0]->valuetypid == INT4OID)
+  {
+    if (oper == ADD)
+      ARITHOP_LOOP2(int32, DatumGetInt32, Int32GetDatum, x + y);
+    else if (oper == SUB)
+      ARITHOP_LOOP2(int32, DatumGetInt32, Int32GetDatum, x - y);
+    else if (oper == MULT)
+      ARITHOP_LOOP2(int32, DatumGetInt32, Int32GetDatum, x * y);
+    else /* oper == DIV */
+      ARITHOP_LOOP2(int32, DatumGetInt32, Int32GetDatum, x / y);
+  }
+  else /* instants1[0]->valuetypid == FLOAT8OID */
+  {
+    if (oper == ADD)
+      ARITHOP_LOOP2(double, DatumGetFloat8, Float8GetDatum, x + y);
+    else if (oper == SUB)
+      ARITHOP_LOOP2(double, DatumGetFloat8, Float8GetDatum, x - y);
+    else if (oper == MULT)
+      ARITHOP_LOOP2(double, DatumGetFloat8, Float8GetDatum, x * y);
+    else /* oper == DIV */
+      ARITHOP_LOOP2(double, DatumGetFloat8, Float8GetDatum, x / y);
+  }
+  return;
+}
+
+/**
+ * Returns true if the two temporal sequences have the same bounds and
+ * instants at the same timestamps
+ */
+static bool
+tsequence_same_timestamps(const TSequence *seq1, const TSequence *seq2)
+{
+  if (seq1->count != seq2->count ||
+    seq1->period.lower_inc != seq2->period.lower_inc ||
+    seq1->period.upper_inc != seq2->period.upper_inc)
+    return false;
+  for (int i = 0; i < seq1->count; i++)
+  {
+    if (tsequence_inst_n(seq1, i)->t != tsequence_inst_n(seq2, i)->t)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Returns true if the arithmetic operation of the two temporal numbers can
+ * be computed in place, that is, if they have the same base type as the
+ * result, the same duration and interpolation, and instants at the same
+ * timestamps
+ *
+ * @note The multiplication and the division of temporal numbers with linear
+ * interpolation are not computed in place since the result may have
+ * turning points between the instants
+ */
+static bool
+tnumber_arithop_tnumber_inplace_valid(const Temporal *temp1,
+  const Temporal *temp2, Oid restypid, TArithmetic oper)
+{
+  if (temp1->valuetypid != restypid || temp2->valuetypid != restypid ||
+    temp1->duration != temp2->duration ||
+    MOBDB_FLAGS_GET_LINEAR(temp1->flags) !=
+      MOBDB_FLAGS_GET_LINEAR(temp2->flags))
+    return false;
+  if (restypid == FLOAT8OID && ! FLOAT8PASSBYVAL)
+    return false;
+  if ((oper == MULT || oper == DIV) && MOBDB_FLAGS_GET_LINEAR(temp1->flags))
+    return false;
+
+  ensure_valid_duration(temp1->duration);
+  if (temp1->duration == INSTANT)
+    return ((TInstant *) temp1)->t == ((TInstant *) temp2)->t;
+  if (temp1->duration == INSTANTSET)
+  {
+    TInstantSet *ti1 = (TInstantSet *) temp1;
+    TInstantSet *ti2 = (TInstantSet *) temp2;
+    if (ti1->count != ti2->count)
+      return false;
+    for (int i = 0; i < ti1->count; i++)
+    {
+      if (tinstantset_inst_n(ti1, i)->t != tinstantset_inst_n(ti2, i)->t)
+        return false;
+    }
+    return true;
+  }
+  if (temp1->duration == SEQUENCE)
+    return tsequence_same_timestamps((TSequence *) temp1,
+      (TSequence *) temp2);
+  /* temp1->duration == SEQUENCESET */
+  TSequenceSet *ts1 = (TSequenceSet *) temp1;
+  TSequenceSet *ts2 = (TSequenceSet *) temp2;
+  if (ts1->count != ts2->count)
+    return false;
+  for (int i = 0; i < ts1->count; i++)
+  {
+    if (! tsequence_same_timestamps(tsequenceset_seq_n(ts1, i),
+        tsequenceset_seq_n(ts2, i)))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Apply in place the arithmetic operation to the two temporal sequence
+ * values and set the bounding box of the first one. Returns false if the
+ * result has redundant instants and thus must be normalized.
+ *
+ * @param[in,out] seq1 First temporal number, which receives the result
+ * @param[in] seq2 Second temporal number
+ * @param[in] instants1,instants2 Buffers for the instants of the sequences
+ * @param[in] oper Enumeration that states the arithmetic operator
+ * @param[in,out] xmin,xmax Minimum and maximum of the result
+ */
+static bool
+tnumberseq_arithop_tnumberseq_inplace(TSequence *seq1, const TSequence *seq2,
+  TInstant **instants1, TInstant **instants2, TArithmetic oper,
+  double *xmin, double *xmax)
+{
+  for (int i = 0; i < seq1->count; i++)
+  {
+    instants1[i] = tsequence_inst_n(seq1, i);
+    instants2[i] = tsequence_inst_n(seq2, i);
+  }
+  TBOX *box = tsequence_bbox_ptr(seq1);
+  box->xmin = DBL_MAX;
+  box->xmax = -DBL_MAX;
+  tnumberinstarr_arithop2(instants1, instants2, seq1->count, oper,
+    &box->xmin, &box->xmax);
+  *xmin = Min(*xmin, box->xmin);
+  *xmax = Max(*xmax, box->xmax);
+  bool linear = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
+  for (int i = 1; i < seq1->count - 1; i++)
+  {
+    if (tinstant_redundant(instants1[i - 1], instants1[i], instants1[i + 1],
+        linear))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Returns the arithmetic operation of the two temporal numbers computed in
+ * place on a copy of the first one, or NULL if the result must be
+ * normalized, which is then left to the lifting framework
+ *
+ * @pre The function tnumber_arithop_tnumber_inplace_valid returns true
+ */
+static Temporal *
+tnumber_arithop_tnumber_inplace(const Temporal *temp1, const Temporal *temp2,
+  TArithmetic oper)
+{
+  Temporal *result = temporal_copy(temp1);
+  double xmin = DBL_MAX, xmax = -DBL_MAX;
+  bool normalized = true;
+  if (result->duration == INSTANT)
+  {
+    TInstant *inst1 = (TInstant *) result;
+    TInstant *inst2 = (TInstant *) temp2;
+    tnumberinstarr_arithop2(&inst1, &inst2, 1, oper, &xmin, &xmax);
+  }
+  else if (result->duration == INSTANTSET)
+  {
+    TInstantSet *ti1 = (TInstantSet *) result;
+    TInstantSet *ti2 = (TInstantSet *) temp2;
+    TInstant **instants1 = palloc(sizeof(TInstant *) * ti1->count);
+    TInstant **instants2 = palloc(sizeof(TInstant *) * ti1->count);
+    for (int i = 0; i < ti1->count; i++)
+    {
+      instants1[i] = tinstantset_inst_n(ti1, i);
+      instants2[i] = tinstantset_inst_n(ti2, i);
+    }
+    tnumberinstarr_arithop2(instants1, instants2, ti1->count, oper,
+      &xmin, &xmax);
+    TBOX *box = tinstantset_bbox_ptr(ti1);
+    box->xmin = xmin;
+    box->xmax = xmax;
+    pfree(instants1); pfree(instants2);
+  }
+  else if (result->duration == SEQUENCE)
+  {
+    TSequence *seq1 = (TSequence *) result;
+    TInstant **instants1 = palloc(sizeof(TInstant *) * seq1->count);
+    TInstant **instants2 = palloc(sizeof(TInstant *) * seq1->count);
+    normalized = tnumberseq_arithop_tnumberseq_inplace(seq1,
+      (TSequence *) temp2, instants1, instants2, oper, &xmin, &xmax);
+    pfree(instants1); pfree(instants2);
+  }
+  else /* result->duration == SEQUENCESET */
+  {
+    TSequenceSet *ts1 = (TSequenceSet *) result;
+    TSequenceSet *ts2 = (TSequenceSet *) temp2;
+    TInstant **instants1 = palloc(sizeof(TInstant *) * ts1->totalcount);
+    TInstant **instants2 = palloc(sizeof(TInstant *) * ts1->totalcount);
+    for (int i = 0; i < ts1->count && normalized; i++)
+    {
+      TSequence *seq1 = tsequenceset_seq_n(ts1, i);
+      normalized = tnumberseq_arithop_tnumberseq_inplace(seq1,
+        tsequenceset_seq_n(ts2, i), instants1, instants2, oper, &xmin, &xmax);
+      /* Adjacent sequences may be joined by the normalization */
+      if (normalized && i > 0)
+      {
+        TSequence *prev = tsequenceset_seq_n(ts1, i - 1);
+        normalized = ! (prev->period.upper == seq1->period.lower &&
+          (prev->period.upper_inc || seq1->period.lower_inc));
+      }
+    }
+    TBOX *box = tsequenceset_bbox_ptr(ts1);
+    box->xmin = xmin;
+    box->xmax = xmax;
+    pfree(instants1); pfree(instants2);
+  }
+  if (! normalized)
+  {
+    pfree(result);
+    return NULL;
+  }
+  return result;
+}
+
 /*****************************************************************************
  * Generic functions
  *****************************************************************************/
@@ -198,10 +679,20 @@ arithop_tnumber_base1(FunctionCallInfo fcinfo,
   }
 
   Oid temptypid = get_fn_expr_rettype(fcinfo->flinfo);
+  Oid restypid = base_oid_from_temporal(temptypid);
+  if (tnumber_arithop_inplace_valid(temp, value, valuetypid, restypid, oper,
+      invert))
+  {
+    Temporal *result = tnumber_arithop_inplace(temp, value, valuetypid, oper,
+      invert);
+    if (result != NULL)
+      return result;
+  }
+
   LiftedFunctionInfo lfinfo;
   lfinfo.func = (varfunc) func;
   lfinfo.numparam = 4;
-  lfinfo.restypid = base_oid_from_temporal(temptypid);
+  lfinfo.restypid = restypid;
   /* This parameter is not used for tnumber <op> base */
   lfinfo.reslinear = false;
   lfinfo.invert = invert;
@@ -282,17 +773,27 @@ arithop_tnumber_tnumber(FunctionCallInfo fcinfo,
   }
 
   Oid temptypid = get_fn_expr_rettype(fcinfo->flinfo);
+  Oid restypid = base_oid_from_temporal(temptypid);
+  Temporal *result = NULL;
+  if (tnumber_arithop_tnumber_inplace_valid(temp1, temp2, restypid, oper))
+    result = tnumber_arithop_tnumber_inplace(temp1, temp2, oper);
+  if (result != NULL)
+  {
+    PG_FREE_IF_COPY(temp1, 0);
+    PG_FREE_IF_COPY(temp2, 1);
+    PG_RETURN_POINTER(result);
+  }
+
   LiftedFunctionInfo lfinfo;
   lfinfo.func = (varfunc) func;
   lfinfo.numparam = 4;
-  lfinfo.restypid = base_oid_from_temporal(temptypid);
+  lfinfo.restypid = restypid;
   lfinfo.reslinear = linear1 || linear2;
   lfinfo.invert = INVERT_NO;
   lfinfo.discont = CONTINUOUS;
   lfinfo.tpfunc = (oper == MULT || oper == DIV) && linear1 && linear2 ?
     tpfunc : NULL;
-  Temporal *result = sync_tfunc_temporal_temporal(temp1, temp2, (Datum) NULL,
-    lfinfo);
+  result = sync_tfunc_temporal_temporal(temp1, temp2, (Datum) NULL, lfinfo);
   PG_FREE_IF_COPY(temp1, 0);
   PG_FREE_IF_COPY(temp2, 1);
   if (result == NULL)
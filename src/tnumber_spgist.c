@@ -736,10 +736,8 @@ PG_FUNCTION_INFO_V1(sptnumber_gist_compress);
 PGDLLEXPORT Datum
 sptnumber_gist_compress(PG_FUNCTION_ARGS)
 {
-  Temporal *temp = PG_GETARG_TEMPORAL(0);
   TBOX *box = palloc0(sizeof(TBOX));
-  temporal_bbox(box, temp);
-  PG_FREE_IF_COPY(temp, 0);
+  temporal_bbox_slice(PG_GETARG_DATUM(0), box);
   PG_RETURN_TBOX_P(box);
 }
 #endif
@@ -628,6 +628,38 @@ datum_collinear(Oid valuetypid, Datum value1, Datum value2, Datum value3,
  * Normalization functions
  *****************************************************************************/
 
+/**
+ * Returns true if the middle instant of three consecutive instants is
+ * redundant and can be removed when normalizing a sequence
+ *
+ * @param[in] inst1,inst2,inst3 Consecutive instants
+ * @param[in] linear True when the instants have linear interpolation
+ */
+bool
+tinstant_redundant(const TInstant *inst1, const TInstant *inst2,
+  const TInstant *inst3, bool linear)
+{
+  Oid valuetypid = inst1->valuetypid;
+  Datum value1 = tinstant_value(inst1);
+  Datum value2 = tinstant_value(inst2);
+  Datum value3 = tinstant_value(inst3);
+  return
+    /* step sequences and 2 consecutive instants that have the same value
+      ... 1@t1, 1@t2, 2@t3, ... -> ... 1@t1, 2@t3, ...
+    */
+    (!linear && datum_eq(value1, value2, valuetypid))
+    ||
+    /* 3 consecutive linear instants that have the same value
+      ... 1@t1, 1@t2, 1@t3, ... -> ... 1@t1, 1@t3, ...
+    */
+    (linear && datum_eq(value1, value2, valuetypid) && datum_eq(value2, value3, valuetypid))
+    ||
+    /* collinear linear instants
+      ... 1@t1, 2@t2, 3@t3, ... -> ... 1@t1, 3@t3, ...
+    */
+    (linear && datum_collinear(valuetypid, value1, value2, value3, inst1->t, inst2->t, inst3->t));
+}
+
 /**
  * Normalize the array of temporal instant values
  *
@@ -645,43 +677,22 @@ tinstantarr_normalize(TInstant **instants, bool linear, int count,
   int *newcount)
 {
   assert(count > 1);
-  Oid valuetypid = instants[0]->valuetypid;
   TInstant **result = palloc(sizeof(TInstant *) * count);
   /* Remove redundant instants */
   TInstant *inst1 = instants[0];
-  Datum value1 = tinstant_value(inst1);
   TInstant *inst2 = instants[1];
-  Datum value2 = tinstant_value(inst2);
   result[0] = inst1;
   int k = 1;
   for (int i = 2; i < count; i++)
   {
     TInstant *inst3 = instants[i];
-    Datum value3 = tinstant_value(inst3);
-    if (
-      /* step sequences and 2 consecutive instants that have the same value
-        ... 1@t1, 1@t2, 2@t3, ... -> ... 1@t1, 2@t3, ...
-      */
-      (!linear && datum_eq(value1, value2, valuetypid))
-      ||
-      /* 3 consecutive linear instants that have the same value
-        ... 1@t1, 1@t2, 1@t3, ... -> ... 1@t1, 1@t3, ...
-      */
-      (linear && datum_eq(value1, value2, valuetypid) && datum_eq(value2, value3, valuetypid))
-      ||
-      /* collinear linear instants
-        ... 1@t1, 2@t2, 3@t3, ... -> ... 1@t1, 3@t3, ...
-      */
-      (linear && datum_collinear(valuetypid, value1, value2, value3, inst1->t, inst2->t, inst3->t))
-      )
-    {
-      inst2 = inst3; value2 = value3;
-    }
+    if (tinstant_redundant(inst1, inst2, inst3, linear))
+      inst2 = inst3;
     else
     {
       result[k++] = inst2;
-      inst1 = inst2; value1 = value2;
-      inst2 = inst3; value2 = value3;
+      inst1 = inst2;
+      inst2 = inst3;
     }
   }
   result[k++] = inst2;
@@ -710,20 +721,30 @@ TSequence **
 tsequencearr_normalize(TSequence **sequences, int count, int *newcount)
 {
   TSequence **result = palloc(sizeof(TSequence *) * count);
-  /* seq1 is the sequence to which we try to join subsequent seq2 */
+  /* The sequences joined so far are kept as an array of instants so that
+   * each resulting sequence is constructed only once */
+  int totalcount = 0;
+  for (int i = 0; i < count; i++)
+    totalcount += sequences[i]->count;
+  TInstant **instants = palloc(sizeof(TInstant *) * totalcount);
+  /* seq1 is the first sequence of the run to which we try to join
+   * subsequent seq2 */
   TSequence *seq1 = sequences[0];
   Oid valuetypid = seq1->valuetypid;
   bool linear = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
+  int ninsts = 0;
+  for (int j = 0; j < seq1->count; j++)
+    instants[ninsts++] = tsequence_inst_n(seq1, j);
+  TimestampTz upper = seq1->period.upper;
+  bool upper_inc = seq1->period.upper_inc;
   bool isnew = false;
   int k = 0;
   for (int i = 1; i < count; i++)
   {
     TSequence *seq2 = sequences[i];
-    TInstant *last2 = (seq1->count == 1) ? NULL :
-      tsequence_inst_n(seq1, seq1->count - 2);
-    Datum last2value = (seq1->count == 1) ? 0 :
-      tinstant_value(last2);
-    TInstant *last1 = tsequence_inst_n(seq1, seq1->count - 1);
+    TInstant *last2 = (ninsts == 1) ? NULL : instants[ninsts - 2];
+    Datum last2value = (ninsts == 1) ? 0 : tinstant_value(last2);
+    TInstant *last1 = instants[ninsts - 1];
     Datum last1value = tinstant_value(last1);
     TInstant *first1 = tsequence_inst_n(seq2, 0);
     Datum first1value = tinstant_value(first1);
@@ -731,8 +752,9 @@ tsequencearr_normalize(TSequence **sequences, int count, int *newcount)
       tsequence_inst_n(seq2, 1);
     Datum first2value = (seq2->count == 1) ? 0 :
       tinstant_value(first2);
-    bool adjacent = seq1->period.upper == seq2->period.lower &&
-      (seq1->period.upper_inc || seq2->period.lower_inc);
+    bool adjacent = upper == seq2->period.lower &&
+      (upper_inc || seq2->period.lower_inc);
+    bool join = true, removelast, removefirst;
     /* If they are adjacent and not instantaneous */
     if (adjacent && last2 != NULL && first2 != NULL &&
       (
@@ -761,19 +783,18 @@ tsequencearr_normalize(TSequence **sequences, int count, int *newcount)
       ))
     {
       /* Remove the last and first instants of the sequences */
-      seq1 = tsequence_join(seq1, seq2, true, true);
-      isnew = true;
+      removelast = removefirst = true;
     }
     /* If step sequences and the first one has an exclusive upper bound,
        by definition the first sequence has the last segment constant
        ..., 1@t1, 1@t2) [2@t2, 3@t3, ... -> ..., 1@t1, 2@t2, 3@t3, ...
        ..., 1@t1, 1@t2) [2@t2] -> ..., 1@t1, 2@t2]
      */
-    else if (adjacent && !linear && !seq1->period.upper_inc)
+    else if (adjacent && !linear && !upper_inc)
     {
       /* Remove the last instant of the first sequence */
-      seq1 = tsequence_join(seq1, seq2, true, false);
-      isnew = true;
+      removelast = true;
+      removefirst = false;
     }
     /* If they are adjacent and have equal last/first value respectively
       Stewise
@@ -788,32 +809,82 @@ tsequencearr_normalize(TSequence **sequences, int count, int *newcount)
     else if (adjacent && datum_eq(last1value, first1value, valuetypid))
     {
       /* Remove the first instant of the second sequence */
-      seq1 = tsequence_join(seq1, seq2, false, true);
+      removelast = false;
+      removefirst = true;
+    }
+    else
+      join = removelast = removefirst = false;
+
+    if (join)
+    {
+      if (removelast)
+        ninsts--;
+      for (int j = removefirst ? 1 : 0; j < seq2->count; j++)
+        instants[ninsts++] = tsequence_inst_n(seq2, j);
       isnew = true;
     }
     else
     {
-      result[k++] = isnew ? seq1 : tsequence_copy(seq1);
+      result[k++] = isnew ? tsequence_make1(instants, ninsts,
+        seq1->period.lower_inc, upper_inc, linear, NORMALIZE_NO) :
+        tsequence_copy(seq1);
       seq1 = seq2;
+      ninsts = 0;
+      for (int j = 0; j < seq1->count; j++)
+        instants[ninsts++] = tsequence_inst_n(seq1, j);
       isnew = false;
     }
+    upper = seq2->period.upper;
+    upper_inc = seq2->period.upper_inc;
   }
-  result[k++] = isnew ? seq1 : tsequence_copy(seq1);
+  result[k++] = isnew ? tsequence_make1(instants, ninsts,
+    seq1->period.lower_inc, upper_inc, linear, NORMALIZE_NO) :
+    tsequence_copy(seq1);
+  pfree(instants);
   *newcount = k;
   return result;
 }
 
 /*****************************************************************************/
 
+/**
+ * Returns a pointer to the array of offsets of the temporal value
+ *
+ * @note The values written by previous versions, for which the flag
+ * PREFIXBOX is not set, have the offsets right after the header and
+ * additional offsets for the bounding box and the trajectory, which follow
+ * the instants
+ */
+size_t *
+tsequence_offsets_ptr(const TSequence *seq)
+{
+  size_t pos = double_pad(sizeof(TSequence));
+  if (MOBDB_FLAGS_GET_PREFIXBOX(seq->flags))
+    pos += double_pad(seq->bboxsize);
+  return (size_t *)(((char *) seq) + pos);
+}
+
+/**
+ * Returns a pointer to the data of the temporal value, that is, to the
+ * first instant
+ */
+char *
+tsequence_data_ptr(const TSequence *seq)
+{
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  if (MOBDB_FLAGS_GET_PREFIXBOX(seq->flags))
+    return (char *)(&offsets[seq->maxcount + 1]);
+  return (char *)(&offsets[seq->count + 2]);
+}
+
 /**
  * Returns the n-th instant of the temporal value
  */
 TInstant *
 tsequence_inst_n(const TSequence *seq, int index)
 {
-  return (TInstant *)(
-    (char *)(&seq->offsets[seq->count + 2]) +   /* start of data */
-      seq->offsets[index]);          /* offset */
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  return (TInstant *)(tsequence_data_ptr(seq) + offsets[index]);
 }
 
 /**
@@ -822,8 +893,10 @@ tsequence_inst_n(const TSequence *seq, int index)
 void *
 tsequence_bbox_ptr(const TSequence *seq)
 {
-  return (char *)(&seq->offsets[seq->count + 2]) +    /* start of data */
-    seq->offsets[seq->count];            /* offset */
+  if (MOBDB_FLAGS_GET_PREFIXBOX(seq->flags))
+    return ((char *) seq) + double_pad(sizeof(TSequence));
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  return tsequence_data_ptr(seq) + offsets[seq->count];
 }
 
 /**
@@ -843,16 +916,14 @@ tsequence_bbox(void *box, const TSequence *seq)
 static size_t
 tsequence_make_size(TInstant **instants, int count, size_t bboxsize, size_t trajsize)
 {
-  /* Add the bounding box size */
-  size_t result = bboxsize;
+  /* Add the size of the struct, the bounding box, and the offset array */
+  size_t result = double_pad(sizeof(TSequence)) + double_pad(bboxsize) +
+    (count + 1) * sizeof(size_t);
   /* Add the size of composing instants */
   for (int i = 0; i < count; i++)
     result += double_pad(VARSIZE(instants[i]));
   /* Add the trajectory size */
   result += trajsize;
-  /* Add the size of the struct and the offset array
-   * Notice that the first offset is already declared in the struct */
-  result += double_pad(sizeof(TSequence)) + (count + 1) * sizeof(size_t);
   return result;
 }
 
@@ -892,7 +963,7 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
     norminsts = tinstantarr_normalize(instants, linear, count, &newcount);
 
   /* Get the bounding box size */
-  size_t bboxsize = double_pad(temporal_bbox_size(instants[0]->valuetypid));
+  size_t bboxsize = temporal_bbox_size(instants[0]->valuetypid);
 
   /* Precompute the trajectory */
   size_t trajsize = 0;
@@ -915,7 +986,8 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
   size_t seqsize = tsequence_make_size(norminsts, newcount, bboxsize, trajsize);
   TSequence *result = palloc0(seqsize);
   SET_VARSIZE(result, seqsize);
-  result->count = newcount;
+  result->count = result->maxcount = newcount;
+  result->bboxsize = bboxsize;
   result->valuetypid = instants[0]->valuetypid;
   result->duration = SEQUENCE;
   period_set(&result->period, norminsts[0]->t, norminsts[newcount - 1]->t,
@@ -923,22 +995,12 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
   MOBDB_FLAGS_SET_LINEAR(result->flags, linear);
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
+  MOBDB_FLAGS_SET_PREFIXBOX(result->flags, true);
   if (isgeo)
   {
     MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(instants[0]->flags));
     MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(instants[0]->flags));
   }
-  /* Initialization of the variable-length part
-   * Notice that the first offset is already declared in the struct */
-  size_t pdata = double_pad(sizeof(TSequence)) + (newcount + 1) * sizeof(size_t);
-  size_t pos = 0;
-  for (int i = 0; i < newcount; i++)
-  {
-    memcpy(((char *)result) + pdata + pos, norminsts[i],
-      VARSIZE(norminsts[i]));
-    result->offsets[i] = pos;
-    pos += double_pad(VARSIZE(norminsts[i]));
-  }
   /*
    * Precompute the bounding box
    * Only external types have precomputed bounding box, internal types such
@@ -948,7 +1010,7 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
    */
   if (bboxsize != 0)
   {
-    void *bbox = ((char *) result) + pdata + pos;
+    void *bbox = tsequence_bbox_ptr(result);
     if (hastraj)
     {
       geo_to_stbox_internal(bbox, (GSERIALIZED *)DatumGetPointer(traj));
@@ -958,14 +1020,21 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
     }
     else
       tsequence_make_bbox(bbox, norminsts, newcount, lower_inc, upper_inc);
-    result->offsets[newcount] = pos;
-    pos += double_pad(bboxsize);
+  }
+  /* Initialization of the variable-length part */
+  size_t *offsets = tsequence_offsets_ptr(result);
+  char *data = (char *) &offsets[newcount + 1];
+  size_t pos = 0;
+  for (int i = 0; i < newcount; i++)
+  {
+    memcpy(data + pos, norminsts[i], VARSIZE(norminsts[i]));
+    offsets[i] = pos;
+    pos += double_pad(VARSIZE(norminsts[i]));
   }
   if (isgeo && hastraj)
   {
-    result->offsets[newcount + 1] = pos;
-    memcpy(((char *) result) + pdata + pos, DatumGetPointer(traj),
-      VARSIZE(DatumGetPointer(traj)));
+    offsets[newcount] = pos;
+    memcpy(data + pos, DatumGetPointer(traj), VARSIZE(DatumGetPointer(traj)));
     pfree(DatumGetPointer(traj));
   }
 
@@ -981,18 +1050,26 @@ tsequence_make1(TInstant **instants, int count, bool lower_inc, bool upper_inc,
  * For example, the memory structure of a temporal sequence value with
  * 2 instants and a precomputed trajectory is as follows:
  * @code
- * -------------------------------------------------------------------
- * ( TSequence )_X | offset_0 | offset_1 | offset_2 | offset_3 | ...
- * -------------------------------------------------------------------
- * ------------------------------------------------------------------------
- * ( TInstant_0 )_X | ( TInstant_1 )_X | ( bbox )_X | ( Traj )_X  |
- * ------------------------------------------------------------------------
+ * --------------------------------------------------------------------------
+ * ( TSequence )_X | ( bbox )_X | offset_0 | offset_1 | offset_2 | ...
+ * --------------------------------------------------------------------------
+ * ------------------------------------------------------
+ * ( TInstant_0 )_X | ( TInstant_1 )_X | ( Traj )_X  |
+ * ------------------------------------------------------
  * @endcode
  * where the `X` are unused bytes added for double padding, `offset_0` and
- * `offset_1` are offsets for the corresponding instants, `offset_2` is the
- * offset for the bounding box and `offset_3` is the offset for the
- * precomputed trajectory. Precomputed trajectories are only kept for temporal
- * points of sequence duration.
+ * `offset_1` are offsets for the corresponding instants, and `offset_2` is
+ * the offset for the precomputed trajectory. Precomputed trajectories are
+ * only kept for temporal points of sequence duration. The bounding box
+ * follows the fixed-size header so that it can be obtained from a prefix of
+ * a toasted value whose size does not depend on the number of instants, see
+ * function temporal_bbox_slice.
+ *
+ * The sequences built by appending instants in an aggregation may have
+ * spare capacity, that is, room for `maxcount` offsets, unused bytes after
+ * the last instant, and unused bytes after the trajectory, see function
+ * tsequence_append_tinstant. The values returned to the user never have
+ * spare capacity.
  *
  * @param[in] instants Array of instants
  * @param[in] count Number of elements in the array
@@ -1032,38 +1109,6 @@ tsequence_make_free(TInstant **instants, int count, bool lower_inc,
   return result;
 }
 
-/**
- * Join the two temporal sequence values
- *
- * @param[in] seq1,seq2 Temporal sequence values
- * @param[in] removelast,removefirst Remove the last and/or the
- * first instant of the first/second sequence
- * @pre The two input sequences are adjacent and have the same interpolation
- * @note The function is called when normalizing an array of sequences
- * and thus, all validity tests have been already made
- */
-TSequence *
-tsequence_join(const TSequence *seq1, const TSequence *seq2,
-  bool removelast, bool removefirst)
-{
-  ensure_same_interpolation((Temporal *) seq1, (Temporal *) seq2);
-
-  int count1 = removelast ? seq1->count - 1 : seq1->count;
-  int start2 = removefirst ? 1 : 0;
-  int count = count1 + (seq2->count - start2);
-  TInstant **instants = palloc(sizeof(TSequence *) * count);
-  int k = 0;
-  for (int i = 0; i < count1; i++)
-    instants[k++] = tsequence_inst_n(seq1, i);
-  for (int i = start2; i < seq2->count; i++)
-    instants[k++] = tsequence_inst_n(seq2, i);
-  TSequence *result = tsequence_make1(instants, count,
-    seq1->period.lower_inc, seq2->period.upper_inc,
-    MOBDB_FLAGS_GET_LINEAR(seq1->flags), NORMALIZE_NO);
-  pfree(instants);
-  return result;
-}
-
 /**
  * Construct a temporal sequence value from a base value and a period
  * (internal function)
@@ -1102,11 +1147,292 @@ tsequence_from_base(PG_FUNCTION_ARGS)
   PG_RETURN_POINTER(result);
 }
 
+/**
+ * Returns the size in bytes of the instants of the temporal value, which
+ * are stored contiguously at the beginning of the data
+ */
+static size_t
+tsequence_insts_size(const TSequence *seq)
+{
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  return offsets[seq->count - 1] +
+    double_pad(VARSIZE(tsequence_inst_n(seq, seq->count - 1)));
+}
+
+/**
+ * Returns true if the sequence has a precomputed trajectory
+ *
+ * @note The sequences with spare capacity do not keep the trajectory, which
+ * is computed by tsequence_compact. Their offset of the trajectory is zero,
+ * which is never the case otherwise since the trajectory follows at least
+ * one instant.
+ */
+static bool
+tsequence_has_traj(const TSequence *seq)
+{
+  if (! tgeo_base_type(seq->valuetypid) ||
+      ! type_has_precomputed_trajectory(seq->valuetypid))
+    return false;
+  return ! MOBDB_FLAGS_GET_PREFIXBOX(seq->flags) ||
+    tsequence_offsets_ptr(seq)[seq->maxcount] != 0;
+}
+
+/**
+ * Update the bounding box of a temporal sequence for appending an instant
+ *
+ * @param[in,out] bbox Bounding box of the sequence, which is set to the one
+ * of the result
+ * @param[in] seq Temporal value, the period of which is the one of the result
+ * @param[in] inst Temporal instant
+ * @param[in] traj Precomputed trajectory of the result, if any
+ */
+static void
+tsequence_append_bbox(void *bbox, const TSequence *seq, const TInstant *inst,
+  const GSERIALIZED *traj)
+{
+  if (traj != NULL)
+  {
+    /* As in tsequence_make1, the bounding box of temporal points is obtained
+     * from the one of the trajectory, which is kept up to date when appending
+     * an instant. For geodetic points, it takes into account the arcs between
+     * the points */
+    geo_to_stbox_internal(bbox, traj);
+    ((STBOX *)bbox)->tmin = seq->period.lower;
+    ((STBOX *)bbox)->tmax = seq->period.upper;
+    MOBDB_FLAGS_SET_T(((STBOX *)bbox)->flags, true);
+  }
+  else
+  {
+    bboxunion box;
+    memset(&box, 0, sizeof(bboxunion));
+    tinstant_make_bbox(&box, inst);
+    temporal_bbox_expand(bbox, &box, seq->valuetypid);
+    if (talpha_base_type(seq->valuetypid))
+      memcpy(bbox, &seq->period, sizeof(Period));
+  }
+  return;
+}
+
+/**
+ * Construct the temporal sequence obtained by appending an instant
+ *
+ * The instants of the sequence are copied with a single memcpy, the
+ * bounding box is expanded with the one of the appended instant, and the
+ * trajectory of temporal points is extended from the precomputed one,
+ * instead of normalizing the instants and recomputing the bounding box
+ * and the trajectory from scratch as done in tsequence_make1.
+ *
+ * @param[in] seq Temporal value
+ * @param[in] inst Temporal instant
+ * @param[in] replace True when the instant replaces the last instant of
+ * the sequence
+ * @param[in] expand True when the result has spare capacity for appending
+ * as many instants as it has. In this case the trajectory of temporal points
+ * is not kept, and the bounding box is only expanded with the one of the
+ * instant, until the sequence is compacted.
+ * @pre The validity of the arguments has been tested before and the
+ * resulting sequence is normalized. A sequence with spare capacity is only
+ * appended to with spare capacity.
+ */
+static TSequence *
+tsequence_append1(const TSequence *seq, const TInstant *inst, bool replace,
+  bool expand)
+{
+  int count = replace ? seq->count : seq->count + 1;
+  /* Number of instants of the sequence kept in the result */
+  int keep = count - 1;
+  size_t bboxsize = temporal_bbox_size(seq->valuetypid);
+
+  /* Compute the trajectory */
+  bool hastraj = ! expand && tsequence_has_traj(seq);
+  Datum traj = 0; /* keep compiler quiet */
+  size_t trajsize = 0;
+  if (hastraj)
+  {
+    traj = tpointseq_trajectory_append(seq, inst, replace);
+    trajsize = double_pad(VARSIZE(DatumGetPointer(traj)));
+  }
+
+  /* The instants kept are contiguous at the beginning of the data */
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  size_t instsize = (keep > 0) ? offsets[keep - 1] +
+    double_pad(VARSIZE(tsequence_inst_n(seq, keep - 1))) : 0;
+
+  /* Reserve the spare capacity */
+  int maxcount = count;
+  size_t instcap = instsize + double_pad(VARSIZE(inst));
+  if (expand)
+  {
+    maxcount *= 2;
+    instcap *= 2;
+  }
+
+  /* Create the temporal sequence */
+  size_t pdata = double_pad(sizeof(TSequence)) + double_pad(bboxsize) +
+    (maxcount + 1) * sizeof(size_t);
+  size_t seqsize = pdata + instcap + trajsize;
+  TSequence *result = palloc0(seqsize);
+  SET_VARSIZE(result, seqsize);
+  result->count = count;
+  result->maxcount = maxcount;
+  result->bboxsize = bboxsize;
+  result->valuetypid = seq->valuetypid;
+  result->duration = SEQUENCE;
+  result->flags = seq->flags;
+  MOBDB_FLAGS_SET_PREFIXBOX(result->flags, true);
+  period_set(&result->period, keep > 0 ? seq->period.lower : inst->t,
+    inst->t, seq->period.lower_inc, true);
+
+  /* Bounding box */
+  if (bboxsize != 0)
+  {
+    void *bbox = tsequence_bbox_ptr(result);
+    memcpy(bbox, tsequence_bbox_ptr(seq), bboxsize);
+    tsequence_append_bbox(bbox, result, inst,
+      hastraj ? (GSERIALIZED *) DatumGetPointer(traj) : NULL);
+  }
+
+  /* Instants */
+  size_t *newoffsets = tsequence_offsets_ptr(result);
+  char *newdata = ((char *) result) + pdata;
+  if (keep > 0)
+  {
+    memcpy(newdata, tsequence_data_ptr(seq), instsize);
+    memcpy(newoffsets, offsets, keep * sizeof(size_t));
+  }
+  memcpy(newdata + instsize, inst, VARSIZE(inst));
+  newoffsets[keep] = instsize;
+
+  /* Trajectory */
+  if (hastraj)
+  {
+    newoffsets[maxcount] = instcap;
+    memcpy(newdata + instcap, DatumGetPointer(traj),
+      VARSIZE(DatumGetPointer(traj)));
+    pfree(DatumGetPointer(traj));
+  }
+  return result;
+}
+
+/**
+ * Append in place an instant to a temporal sequence that has spare capacity
+ *
+ * @param[in,out] seq Temporal value
+ * @param[in] inst Temporal instant
+ * @param[in] replace True when the instant replaces the last instant of
+ * the sequence
+ * @return False when there is not enough spare capacity, in which case the
+ * sequence is not modified
+ * @pre The validity of the arguments has been tested before and the
+ * resulting sequence is normalized
+ */
+static bool
+tsequence_append_inplace(TSequence *seq, const TInstant *inst, bool replace)
+{
+  int count = replace ? seq->count : seq->count + 1;
+  /* The values written by previous versions do not have spare capacity and
+   * the sequences that keep a trajectory are compact */
+  if (! MOBDB_FLAGS_GET_PREFIXBOX(seq->flags) || count > seq->maxcount ||
+      tsequence_has_traj(seq))
+    return false;
+
+  /* The instants can use the space until the end of the sequence */
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  char *data = tsequence_data_ptr(seq);
+  size_t instcap = VARSIZE(seq) - (data - (char *) seq);
+  size_t pos = replace ? offsets[seq->count - 1] : tsequence_insts_size(seq);
+  if (pos + double_pad(VARSIZE(inst)) > instcap)
+    return false;
+
+  memcpy(data + pos, inst, VARSIZE(inst));
+  offsets[count - 1] = pos;
+  seq->count = count;
+  period_set(&seq->period, seq->period.lower, inst->t,
+    seq->period.lower_inc, true);
+  if (seq->bboxsize != 0)
+    tsequence_append_bbox(tsequence_bbox_ptr(seq), seq, inst, NULL);
+  return true;
+}
+
+/**
+ * Returns a copy of the temporal sequence without spare capacity
+ *
+ * @note The trajectory of temporal points, which is not kept by the
+ * sequences with spare capacity, is computed from the instants and the
+ * bounding box is derived from it as in tsequence_make1
+ */
+TSequence *
+tsequence_compact(const TSequence *seq)
+{
+  /* The values written by previous versions do not have spare capacity */
+  if (! MOBDB_FLAGS_GET_PREFIXBOX(seq->flags))
+    return tsequence_copy(seq);
+
+  bool hastraj = tgeo_base_type(seq->valuetypid) &&
+    type_has_precomputed_trajectory(seq->valuetypid);
+  bool maketraj = hastraj && ! tsequence_has_traj(seq);
+  Datum traj = 0; /* keep compiler quiet */
+  size_t trajsize = 0;
+  if (maketraj)
+  {
+    TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+    for (int i = 0; i < seq->count; i++)
+      instants[i] = tsequence_inst_n(seq, i);
+    traj = tpointseq_make_trajectory(instants, seq->count,
+      MOBDB_FLAGS_GET_LINEAR(seq->flags));
+    pfree(instants);
+  }
+  else if (hastraj)
+    traj = tpointseq_trajectory(seq);
+  if (hastraj)
+    trajsize = double_pad(VARSIZE(DatumGetPointer(traj)));
+
+  size_t *offsets = tsequence_offsets_ptr(seq);
+  char *data = tsequence_data_ptr(seq);
+  size_t instsize = tsequence_insts_size(seq);
+
+  size_t hdrsize = double_pad(sizeof(TSequence)) + double_pad(seq->bboxsize);
+  size_t pdata = hdrsize + (seq->count + 1) * sizeof(size_t);
+  size_t seqsize = pdata + instsize + trajsize;
+  TSequence *result = palloc0(seqsize);
+  /* Copy the header and the bounding box */
+  memcpy(result, seq, hdrsize);
+  SET_VARSIZE(result, seqsize);
+  result->maxcount = seq->count;
+  size_t *newoffsets = tsequence_offsets_ptr(result);
+  char *newdata = ((char *) result) + pdata;
+  memcpy(newoffsets, offsets, seq->count * sizeof(size_t));
+  memcpy(newdata, data, instsize);
+  if (hastraj)
+  {
+    newoffsets[seq->count] = instsize;
+    memcpy(newdata + instsize, DatumGetPointer(traj),
+      VARSIZE(DatumGetPointer(traj)));
+  }
+  if (maketraj)
+  {
+    tsequence_append_bbox(tsequence_bbox_ptr(result), result,
+      tsequence_inst_n(result, result->count - 1),
+      (GSERIALIZED *) DatumGetPointer(traj));
+    pfree(DatumGetPointer(traj));
+  }
+  return result;
+}
+
 /**
  * Append an instant to the temporal value
+ *
+ * @param[in] seq Temporal value
+ * @param[in] inst Temporal instant
+ * @param[in] expand True when the sequence is owned by the caller, e.g., in
+ * the state of an aggregation. In this case, the instant is appended in
+ * place when the sequence has spare capacity, otherwise the result is
+ * allocated with spare capacity for the next instants, so that appending
+ * n instants takes amortized constant time per instant.
+ * @note When the result is a new value, the input sequence is not freed
  */
 Temporal *
-tsequence_append_tinstant(const TSequence *seq, const TInstant *inst)
+tsequence_append_tinstant(TSequence *seq, const TInstant *inst, bool expand)
 {
   /* Ensure validity of the arguments */
   assert(seq->valuetypid == inst->valuetypid);
@@ -1126,17 +1452,32 @@ tsequence_append_tinstant(const TSequence *seq, const TInstant *inst)
     if (linear && ! seqresult)
     {
       TSequence *sequences[2];
-      sequences[0] = (TSequence *) seq;
+      /* Only the sequences owned by the caller may have spare capacity */
+      sequences[0] = expand ? tsequence_compact(seq) : seq;
       sequences[1] = tinstant_to_tsequence(inst, linear);
       TSequenceSet *result = tsequenceset_make(sequences, 2, NORMALIZE_NO);
+      if (sequences[0] != seq)
+        pfree(sequences[0]);
       pfree(sequences[1]);
       return (Temporal *) result;
     }
+    /* The last value of a step sequence changes, recompute the bounding box */
+    if (! seqresult)
+    {
+      TInstant **instants = palloc(sizeof(TInstant *) * seq->count);
+      for (int i = 0; i < seq->count - 1; i++)
+        instants[i] = tsequence_inst_n(seq, i);
+      instants[seq->count - 1] = (TInstant *) inst;
+      TSequence *result = tsequence_make1(instants, seq->count,
+        seq->period.lower_inc, true, linear, NORMALIZE_NO);
+      pfree(instants);
+      return (Temporal *) result;
+    }
   }
 
   /* The result is a sequence */
-  int count = seq->count + 1;
-  if (seq->count > 1)
+  bool replace = (inst1->t == inst->t);
+  if (! replace && seq->count > 1)
   {
     /* Normalize the result */
     inst1 = tsequence_inst_n(seq, seq->count - 2);
@@ -1162,19 +1503,12 @@ tsequence_append_tinstant(const TSequence *seq, const TInstant *inst)
       )
     {
       /* The new instant replaces the last instant of the sequence */
-      count--;
+      replace = true;
     }
   }
-
-  TInstant **instants = palloc(sizeof(TInstant *) * count);
-  int k = 0;
-  for (int i = 0; i < count - 1; i++)
-    instants[k++] = tsequence_inst_n(seq, i);
-  instants[k++] = (TInstant *) inst;
-  TSequence *result = tsequence_make1(instants, count, seq->period.lower_inc,
-    true, MOBDB_FLAGS_GET_LINEAR(seq->flags), NORMALIZE_NO);
-  pfree(instants);
-  return (Temporal *) result;
+  if (expand && tsequence_append_inplace(seq, inst, replace))
+    return (Temporal *) seq;
+  return (Temporal *) tsequence_append1(seq, inst, replace, expand);
 }
 
 /**
@@ -1600,6 +1934,322 @@ synchronize_tsequence_tsequence(const TSequence *seq1, const TSequence *seq2,
   return true;
 }
 
+/*****************************************************************************
+ * Iterate over the synchronized segments of two TSequence values. Instead of
+ * constructing the synchronized sequences, the segments covering the
+ * intersection of their time spans are produced one pair at a time. The
+ * instants added for the synchronization are written in two buffers per
+ * sequence that are reused along the iteration, one for the start and one
+ * for the end of the current segment.
+ *****************************************************************************/
+
+/**
+ * Sets the buffer to the value of the segment at the timestamp
+ *
+ * @param[in] buf Buffer, which may be NULL
+ * @param[in] inst1,inst2 Temporal values defining the segment
+ * @param[in] linear True when the segment has linear interpolation
+ * @param[in] t Timestamp
+ * @result Buffer, which is reallocated when the value does not fit in it
+ */
+static TInstant *
+tsequence_sync_buffer(TInstant *buf, const TInstant *inst1,
+  const TInstant *inst2, bool linear, TimestampTz t)
+{
+  Oid valuetypid = inst1->valuetypid;
+  Datum value = tsequence_value_at_timestamp1(inst1, inst2, linear, t);
+  if (buf != NULL && MOBDB_FLAGS_GET_BYVAL(buf->flags))
+  {
+    tinstant_set(buf, value, t);
+    return buf;
+  }
+  /* For base types passed by reference the value is copied in place if it
+   * has the same size as the one in the buffer, which is always the case
+   * for the values of a single sequence */
+  if (buf != NULL)
+  {
+    int typlen = get_typlen_fast(valuetypid);
+    void *value_to = tinstant_value_ptr(buf);
+    size_t size = typlen != -1 ? (unsigned int) typlen :
+      VARSIZE(DatumGetPointer(value));
+    size_t bufsize = typlen != -1 ? (unsigned int) typlen : VARSIZE(value_to);
+    if (size == bufsize)
+    {
+      memcpy(value_to, DatumGetPointer(value), size);
+      buf->t = t;
+      pfree(DatumGetPointer(value));
+      return buf;
+    }
+    pfree(buf);
+  }
+  TInstant *result = tinstant_make(value, t, valuetypid);
+  DATUM_FREE(value, valuetypid);
+  return result;
+}
+
+/**
+ * Returns the instant of the sequence at the timestamp, which is written
+ * in the buffer of the iterator that is not used by the start instant
+ */
+static TInstant *
+tsequence_sync_at_timestamp(TInstant **buffers, const TInstant *start,
+  const TInstant *inst1, const TInstant *inst2, bool linear, TimestampTz t)
+{
+  int n = (start != NULL && start == buffers[0]) ? 1 : 0;
+  buffers[n] = tsequence_sync_buffer(buffers[n], inst1, inst2, linear, t);
+  return buffers[n];
+}
+
+/**
+ * Initializes the iterator over the synchronized segments of the temporal
+ * values, which are positioned at the start of their intersection
+ *
+ * @param[out] iter Iterator
+ * @param[in] seq1,seq2 Temporal values
+ * @param[in] inter Intersection of the time spans of the temporal values.
+ * Only its lower bound is used, so that any period starting strictly
+ * before the end of the intersection may be given to resume the iteration
+ * at its lower bound.
+ * @pre The intersection is not instantaneous
+ */
+void
+tsequence_sync_init(TSequenceSyncIter *iter, const TSequence *seq1,
+  const TSequence *seq2, const Period *inter)
+{
+  iter->seq1 = seq1;
+  iter->seq2 = seq2;
+  iter->linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
+  iter->linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
+  iter->buffers1[0] = iter->buffers1[1] = NULL;
+  iter->buffers2[0] = iter->buffers2[1] = NULL;
+  iter->end1 = iter->end2 = NULL;
+  iter->start1 = tsequence_inst_n(seq1, 0);
+  iter->start2 = tsequence_inst_n(seq2, 0);
+  iter->i = iter->j = 1;
+  /* Synchronize the start instant */
+  if (iter->start1->t < inter->lower)
+  {
+    int n = tsequence_find_timestamp(seq1, inter->lower);
+    iter->start1 = tsequence_sync_at_timestamp(iter->buffers1, NULL,
+      tsequence_inst_n(seq1, n), tsequence_inst_n(seq1, n + 1),
+      iter->linear1, inter->lower);
+    iter->i = n + 1;
+  }
+  if (iter->start2->t < inter->lower)
+  {
+    int n = tsequence_find_timestamp(seq2, inter->lower);
+    iter->start2 = tsequence_sync_at_timestamp(iter->buffers2, NULL,
+      tsequence_inst_n(seq2, n), tsequence_inst_n(seq2, n + 1),
+      iter->linear2, inter->lower);
+    iter->j = n + 1;
+  }
+  return;
+}
+
+/**
+ * Advances the iterator to the next pair of synchronized segments
+ *
+ * After the call, the segments are defined by the instants `start1`, `end1`
+ * and `start2`, `end2` of the iterator, where `start1->t = start2->t` and
+ * `end1->t = end2->t`. The instants are owned by the iterator and are only
+ * valid until the next call to this function.
+ *
+ * @result Returns false when the end of the intersection has been reached
+ */
+bool
+tsequence_sync_next(TSequenceSyncIter *iter)
+{
+  if (iter->i >= iter->seq1->count || iter->j >= iter->seq2->count)
+    return false;
+  if (iter->end1 != NULL)
+  {
+    iter->start1 = iter->end1;
+    iter->start2 = iter->end2;
+  }
+  TInstant *end1 = tsequence_inst_n(iter->seq1, iter->i);
+  TInstant *end2 = tsequence_inst_n(iter->seq2, iter->j);
+  int cmp = timestamp_cmp_internal(end1->t, end2->t);
+  if (cmp == 0)
+  {
+    iter->i++; iter->j++;
+  }
+  else if (cmp < 0)
+  {
+    iter->i++;
+    end2 = tsequence_sync_at_timestamp(iter->buffers2, iter->start2,
+      iter->start2, end2, iter->linear2, end1->t);
+  }
+  else
+  {
+    iter->j++;
+    end1 = tsequence_sync_at_timestamp(iter->buffers1, iter->start1,
+      iter->start1, end1, iter->linear1, end2->t);
+  }
+  iter->end1 = end1;
+  iter->end2 = end2;
+  return true;
+}
+
+/**
+ * Releases the buffers of the iterator
+ */
+void
+tsequence_sync_free(TSequenceSyncIter *iter)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    if (iter->buffers1[i] != NULL)
+      pfree(iter->buffers1[i]);
+    if (iter->buffers2[i] != NULL)
+      pfree(iter->buffers2[i]);
+  }
+  return;
+}
+
+
+/*****************************************************************************
+ * Cursor over the segments of a temporal value of sequence or sequence set
+ * duration, optionally restricted to a period. Functions that consume the
+ * segments of a temporal value one at a time, such as the derivative
+ * functions for temporal points, use the cursor to be applied to the
+ * restriction of the temporal value to a period without constructing it.
+ * The instants added at the bounds of the period are written in two buffers
+ * that are reused along the iteration.
+ *****************************************************************************/
+
+/**
+ * Initializes the cursor over the segments of the temporal value
+ *
+ * @param[out] cur Cursor
+ * @param[in] temp Temporal value
+ * @param[in] p Period to which the temporal value is restricted, may be NULL
+ * @pre The temporal value has sequence or sequence set duration
+ */
+void
+tsegment_cursor_init(TSegmentCursor *cur, const Temporal *temp,
+  const Period *p)
+{
+  assert(temp->duration == SEQUENCE || temp->duration == SEQUENCESET);
+  cur->temp = temp;
+  cur->hasperiod = (p != NULL);
+  if (p != NULL)
+    cur->period = *p;
+  cur->count = (temp->duration == SEQUENCE) ? 1 :
+    ((TSequenceSet *) temp)->count;
+  cur->seqno = 0;
+  cur->seq = NULL;
+  cur->instno = 0;
+  cur->linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+  cur->start = cur->end = NULL;
+  cur->newseq = false;
+  cur->buffers[0] = cur->buffers[1] = NULL;
+  return;
+}
+
+/**
+ * Positions the cursor at the start of the next sequence that intersects
+ * the period of the cursor
+ *
+ * @result Returns false when there are no more sequences
+ */
+static bool
+tsegment_cursor_next_seq(TSegmentCursor *cur)
+{
+  while (cur->seqno < cur->count)
+  {
+    const TSequence *seq = (cur->temp->duration == SEQUENCE) ?
+      (TSequence *) cur->temp :
+      tsequenceset_seq_n((TSequenceSet *) cur->temp, cur->seqno);
+    cur->seqno++;
+    if (! cur->hasperiod)
+      cur->seqperiod = seq->period;
+    else
+    {
+      Period *inter = intersection_period_period_internal(&seq->period,
+        &cur->period);
+      if (inter == NULL)
+        continue;
+      cur->seqperiod = *inter;
+      pfree(inter);
+    }
+    cur->seq = seq;
+    /* Position the start of the first segment at the lower bound */
+    TInstant *first = tsequence_inst_n(seq, 0);
+    if (first->t == cur->seqperiod.lower)
+    {
+      cur->start = first;
+      cur->instno = 1;
+    }
+    else
+    {
+      int n = tsequence_find_timestamp(seq, cur->seqperiod.lower);
+      cur->start = tsequence_sync_at_timestamp(cur->buffers, NULL,
+        tsequence_inst_n(seq, n), tsequence_inst_n(seq, n + 1), cur->linear,
+        cur->seqperiod.lower);
+      cur->instno = n + 1;
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Advances the cursor to the next segment
+ *
+ * After the call, the segment is defined by the instants `start` and `end`
+ * of the cursor, `newseq` states whether the segment is the first one of
+ * a sequence, and `seqperiod` is the period of the (restricted) sequence
+ * to which the segment belongs. When the sequence is instantaneous, the
+ * start and the end of the segment are the same instant. The instants are
+ * owned by the cursor and are only valid until the next call to this
+ * function.
+ *
+ * @result Returns false when there are no more segments
+ */
+bool
+tsegment_cursor_next(TSegmentCursor *cur)
+{
+  if (cur->seq != NULL && cur->end->t >= cur->seqperiod.upper)
+    cur->seq = NULL;
+  if (cur->seq == NULL)
+  {
+    if (! tsegment_cursor_next_seq(cur))
+      return false;
+    cur->newseq = true;
+    /* Instantaneous sequence */
+    if (cur->seqperiod.lower == cur->seqperiod.upper)
+    {
+      cur->end = cur->start;
+      return true;
+    }
+  }
+  else
+  {
+    cur->start = cur->end;
+    cur->newseq = false;
+  }
+  TInstant *end = tsequence_inst_n(cur->seq, cur->instno);
+  if (end->t > cur->seqperiod.upper)
+    end = tsequence_sync_at_timestamp(cur->buffers, cur->start, cur->start,
+      end, cur->linear, cur->seqperiod.upper);
+  else
+    cur->instno++;
+  cur->end = end;
+  return true;
+}
+
+/**
+ * Releases the buffers of the cursor
+ */
+void
+tsegment_cursor_free(TSegmentCursor *cur)
+{
+  if (cur->buffers[0] != NULL)
+    pfree(cur->buffers[0]);
+  if (cur->buffers[1] != NULL)
+    pfree(cur->buffers[1]);
+  return;
+}
 /*****************************************************************************
  * Input/output functions
  *****************************************************************************/
@@ -1646,7 +2296,7 @@ tsequence_to_string(const TSequence *seq, bool component,
  * @param[in] buf Buffer
  */
 void
-tsequence_write(const TSequence *seq, StringInfo buf)
+tsequence_write(const TSequence *seq, StringInfo buf, FmgrInfo *flinfo)
 {
 #if MOBDB_PGSQL_VERSION < 110000
   pq_sendint(buf, (uint32) seq->count, 4);
@@ -1659,7 +2309,7 @@ tsequence_write(const TSequence *seq, StringInfo buf)
   for (int i = 0; i < seq->count; i++)
   {
     TInstant *inst = tsequence_inst_n(seq, i);
-    tinstant_write(inst, buf);
+    tinstant_write(inst, buf, flinfo);
   }
 }
 
@@ -1669,9 +2319,10 @@ tsequence_write(const TSequence *seq, StringInfo buf)
  *
  * @param[in] buf Buffer
  * @param[in] valuetypid Oid of the base type
+ * @param[in] flinfo Information of the calling receive function
  */
 TSequence *
-tsequence_read(StringInfo buf, Oid valuetypid)
+tsequence_read(StringInfo buf, Oid valuetypid, FmgrInfo *flinfo)
 {
   int count = (int) pq_getmsgint(buf, 4);
   bool lower_inc = (char) pq_getmsgbyte(buf);
@@ -1679,7 +2330,7 @@ tsequence_read(StringInfo buf, Oid valuetypid)
   bool linear = (char) pq_getmsgbyte(buf);
   TInstant **instants = palloc(sizeof(TInstant *) * count);
   for (int i = 0; i < count; i++)
-    instants[i] = tinstant_read(buf, valuetypid);
+    instants[i] = tinstant_read(buf, valuetypid, flinfo);
   return tsequence_make_free(instants, count, lower_inc,
     upper_inc, linear, NORMALIZE);
 }
@@ -4033,34 +4684,51 @@ tsequence_intersects_periodset(const TSequence *seq, const PeriodSet *ps)
  * Local aggregate functions
  *****************************************************************************/
 
+/**
+ * Returns the integral (area under the curve) of a temporal number given
+ * by the parallel arrays of its timestamps and values
+ *
+ * @param[in] times Array of timestamps
+ * @param[in] values Array of values
+ * @param[in] count Number of elements in the arrays
+ * @param[in] linear True when the interpolation is linear
+ */
+double
+tnumberarr_integral(const TimestampTz *times, const double *values, int count,
+  bool linear)
+{
+  double result = 0;
+  if (linear)
+  {
+    for (int i = 1; i < count; i++)
+      result += (values[i - 1] + values[i]) *
+        (double) (times[i] - times[i - 1]) / 2.0;
+  }
+  else
+  {
+    for (int i = 1; i < count; i++)
+      result += values[i - 1] * (double) (times[i] - times[i - 1]);
+  }
+  return result;
+}
+
 /**
  * Returns the integral (area under the curve) of the temporal number
  */
 double
 tnumberseq_integral(const TSequence *seq)
 {
-  double result = 0;
-  TInstant *inst1 = tsequence_inst_n(seq, 0);
-  for (int i = 1; i < seq->count; i++)
+  TimestampTz *times = palloc(sizeof(TimestampTz) * seq->count);
+  double *values = palloc(sizeof(double) * seq->count);
+  for (int i = 0; i < seq->count; i++)
   {
-    TInstant *inst2 = tsequence_inst_n(seq, i);
-    if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
-    {
-      /* Linear interpolation */
-      double min = Min(DatumGetFloat8(tinstant_value(inst1)),
-        DatumGetFloat8(tinstant_value(inst2)));
-      double max = Max(DatumGetFloat8(tinstant_value(inst1)),
-        DatumGetFloat8(tinstant_value(inst2)));
-      result += (max + min) * (double) (inst2->t - inst1->t) / 2.0;
-    }
-    else
-    {
-      /* Step interpolation */
-      result += datum_double(tinstant_value(inst1), inst1->valuetypid) *
-        (double) (inst2->t - inst1->t);
-    }
-    inst1 = inst2;
+    TInstant *inst = tsequence_inst_n(seq, i);
+    times[i] = inst->t;
+    values[i] = datum_double(tinstant_value(inst), inst->valuetypid);
   }
+  double result = tnumberarr_integral(times, values, seq->count,
+    MOBDB_FLAGS_GET_LINEAR(seq->flags));
+  pfree(times); pfree(values);
   return result;
 }
 
@@ -4096,7 +4764,8 @@ tsequence_eq(const TSequence *seq1, const TSequence *seq2)
 {
   assert(seq1->valuetypid == seq2->valuetypid);
   /* If number of sequences, flags, or periods are not equal */
-  if (seq1->count != seq2->count || seq1->flags != seq2->flags ||
+  if (seq1->count != seq2->count || MOBDB_FLAGS_NO_PREFIXBOX(seq1->flags) !=
+      MOBDB_FLAGS_NO_PREFIXBOX(seq2->flags) ||
       ! period_eq_internal(&seq1->period, &seq2->period))
     return false;
 
@@ -4160,9 +4829,11 @@ tsequence_cmp(const TSequence *seq1, const TSequence *seq2)
    * composing instant tests above */
 
   /* Compare flags  */
-  if (seq1->flags < seq2->flags)
+  if (MOBDB_FLAGS_NO_PREFIXBOX(seq1->flags) <
+      MOBDB_FLAGS_NO_PREFIXBOX(seq2->flags))
     return -1;
-  if (seq1->flags > seq2->flags)
+  if (MOBDB_FLAGS_NO_PREFIXBOX(seq1->flags) >
+      MOBDB_FLAGS_NO_PREFIXBOX(seq2->flags))
     return 1;
 
   /* The two values are equal */
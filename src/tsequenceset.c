@@ -35,15 +35,43 @@
  * General functions
  *****************************************************************************/
 
+/**
+ * Returns a pointer to the array of offsets of the temporal value
+ *
+ * @note The values written by previous versions, for which the flag
+ * PREFIXBOX is not set, have the offsets right after the header and an
+ * additional offset for the bounding box, which follows the sequences
+ */
+static size_t *
+tsequenceset_offsets_ptr(const TSequenceSet *ts)
+{
+  size_t pos = double_pad(sizeof(TSequenceSet));
+  if (MOBDB_FLAGS_GET_PREFIXBOX(ts->flags))
+    pos += double_pad(ts->bboxsize);
+  return (size_t *)(((char *) ts) + pos);
+}
+
+/**
+ * Returns a pointer to the data of the temporal value, that is, to the
+ * first sequence
+ */
+static char *
+tsequenceset_data_ptr(const TSequenceSet *ts)
+{
+  size_t *offsets = tsequenceset_offsets_ptr(ts);
+  if (MOBDB_FLAGS_GET_PREFIXBOX(ts->flags))
+    return (char *)(&offsets[ts->count]);
+  return (char *)(&offsets[ts->count + 1]);
+}
+
 /**
  * Returns the n-th sequence of the temporal value
  */
 TSequence *
 tsequenceset_seq_n(const TSequenceSet *ts, int index)
 {
-  return (TSequence *)(
-    (char *)(&ts->offsets[ts->count + 1]) +   /* start of data */
-      ts->offsets[index]);          /* offset */
+  size_t *offsets = tsequenceset_offsets_ptr(ts);
+  return (TSequence *)(tsequenceset_data_ptr(ts) + offsets[index]);
 }
 
 /**
@@ -52,8 +80,10 @@ tsequenceset_seq_n(const TSequenceSet *ts, int index)
 void *
 tsequenceset_bbox_ptr(const TSequenceSet *ts)
 {
-  return (char *)(&ts->offsets[ts->count + 1]) +  /* start of data */
-    ts->offsets[ts->count];            /* offset */
+  if (MOBDB_FLAGS_GET_PREFIXBOX(ts->flags))
+    return ((char *) ts) + double_pad(sizeof(TSequenceSet));
+  size_t *offsets = tsequenceset_offsets_ptr(ts);
+  return tsequenceset_data_ptr(ts) + offsets[ts->count];
 }
 
 /**
@@ -74,17 +104,18 @@ tsequenceset_bbox(void *box, const TSequenceSet *ts)
  * For example, the memory structure of a temporal sequence set value
  * with 2 sequences is as follows
  * @code
- * --------------------------------------------------------
- * ( TSequenceSet )_X | offset_0 | offset_1 | offset_2 | ...
- * --------------------------------------------------------
- * --------------------------------------------------------
- * ( TSequence_0 )_X | ( TSequence_1 )_X | ( bbox )_X |
- * --------------------------------------------------------
+ * ---------------------------------------------------------------
+ * ( TSequenceSet )_X | ( bbox )_X | offset_0 | offset_1 | ...
+ * ---------------------------------------------------------------
+ * --------------------------------------------
+ * ( TSequence_0 )_X | ( TSequence_1 )_X |
+ * --------------------------------------------
  * @endcode
- * where the `_X` are unused bytes added for double padding, `offset_0` and
- * `offset_1` are offsets for the corresponding sequences and `offset_2`
- * is the offset for the bounding box. Temporal sequence set values do not
- * have precomputed trajectory.
+ * where the `_X` are unused bytes added for double padding, and `offset_0`
+ * and `offset_1` are offsets for the corresponding sequences. The bounding
+ * box follows the fixed-size header so that it can be obtained from a
+ * prefix of a toasted value, see function temporal_bbox_slice. Temporal
+ * sequence set values do not have precomputed trajectory.
  *
  * @param[in] sequences Array of sequences
  * @param[in] count Number of elements in the array
@@ -103,9 +134,11 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
   int newcount = count;
   if (normalize && count > 1)
     newsequences = tsequencearr_normalize(sequences, count, &newcount);
-  /* Add the size of the struct and the offset array
-   * Notice that the first offset is already declared in the struct */
-  size_t pdata = double_pad(sizeof(TSequenceSet)) + newcount * sizeof(size_t);
+  /* Get the bounding box size */
+  size_t bboxsize = temporal_bbox_size(sequences[0]->valuetypid);
+  /* Add the size of the struct, the bounding box, and the offset array */
+  size_t pdata = double_pad(sizeof(TSequenceSet)) + double_pad(bboxsize) +
+    newcount * sizeof(size_t);
   size_t memsize = 0;
   int totalcount = 0;
   for (int i = 0; i < newcount; i++)
@@ -113,19 +146,18 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
     totalcount += newsequences[i]->count;
     memsize += double_pad(VARSIZE(newsequences[i]));
   }
-  /* Get the bounding box size */
-  size_t bboxsize = temporal_bbox_size(sequences[0]->valuetypid);
-  memsize += double_pad(bboxsize);
   TSequenceSet *result = palloc0(pdata + memsize);
   SET_VARSIZE(result, pdata + memsize);
   result->count = newcount;
   result->totalcount = totalcount;
+  result->bboxsize = bboxsize;
   result->valuetypid = sequences[0]->valuetypid;
   result->duration = SEQUENCESET;
   MOBDB_FLAGS_SET_LINEAR(result->flags,
     MOBDB_FLAGS_GET_LINEAR(sequences[0]->flags));
   MOBDB_FLAGS_SET_X(result->flags, true);
   MOBDB_FLAGS_SET_T(result->flags, true);
+  MOBDB_FLAGS_SET_PREFIXBOX(result->flags, true);
   if (tgeo_base_type(sequences[0]->valuetypid))
   {
     MOBDB_FLAGS_SET_Z(result->flags,
@@ -133,25 +165,23 @@ tsequenceset_make(TSequence **sequences, int count, bool normalize)
     MOBDB_FLAGS_SET_GEODETIC(result->flags,
       MOBDB_FLAGS_GET_GEODETIC(sequences[0]->flags));
   }
-  /* Initialization of the variable-length part */
-  size_t pos = 0;
-  for (int i = 0; i < newcount; i++)
-  {
-    memcpy(((char *) result) + pdata + pos, newsequences[i],
-      VARSIZE(newsequences[i]));
-    result->offsets[i] = pos;
-    pos += double_pad(VARSIZE(newsequences[i]));
-  }
   /*
    * Precompute the bounding box
    * Only external types have precomputed bounding box, internal types such
    * as double2, double3, or double4 do not have precomputed bounding box
    */
   if (bboxsize != 0)
+    tsequenceset_make_bbox(tsequenceset_bbox_ptr(result), newsequences,
+      newcount);
+  /* Initialization of the variable-length part */
+  size_t *offsets = tsequenceset_offsets_ptr(result);
+  size_t pos = 0;
+  for (int i = 0; i < newcount; i++)
   {
-    void *bbox = ((char *) result) + pdata + pos;
-    tsequenceset_make_bbox(bbox, newsequences, newcount);
-    result->offsets[newcount] = pos;
+    memcpy(((char *) result) + pdata + pos, newsequences[i],
+      VARSIZE(newsequences[i]));
+    offsets[i] = pos;
+    pos += double_pad(VARSIZE(newsequences[i]));
   }
   if (normalize && count > 1)
   {
@@ -242,8 +272,8 @@ tsequenceset_append_tinstant(const TSequenceSet *ts, const TInstant *inst)
 {
   assert(ts->valuetypid == inst->valuetypid);
   TSequence *seq = tsequenceset_seq_n(ts, ts->count - 1);
-  Temporal *temp = tsequence_append_tinstant(seq, inst);
-  TSequence **sequences = palloc(sizeof(TSequence *) * ts->count + 1);
+  Temporal *temp = tsequence_append_tinstant(seq, inst, false);
+  TSequence **sequences = palloc(sizeof(TSequence *) * (ts->count + 1));
   int k = 0;
   for (int i = 0; i < ts->count - 1; i++)
     sequences[k++] = tsequenceset_seq_n(ts, i);
@@ -637,7 +667,7 @@ tsequenceset_to_string(const TSequenceSet *ts, char *(*value_out)(Oid, Datum))
  * @param[in] buf Buffer
  */
 void
-tsequenceset_write(const TSequenceSet *ts, StringInfo buf)
+tsequenceset_write(const TSequenceSet *ts, StringInfo buf, FmgrInfo *flinfo)
 {
 #if MOBDB_PGSQL_VERSION < 110000
   pq_sendint(buf, (uint32) ts->count, 4);
@@ -647,7 +677,7 @@ tsequenceset_write(const TSequenceSet *ts, StringInfo buf)
   for (int i = 0; i < ts->count; i++)
   {
     TSequence *seq = tsequenceset_seq_n(ts, i);
-    tsequence_write(seq, buf);
+    tsequence_write(seq, buf, flinfo);
   }
 }
 
@@ -657,15 +687,16 @@ tsequenceset_write(const TSequenceSet *ts, StringInfo buf)
  *
  * @param[in] buf Buffer
  * @param[in] valuetypid Oid of the base type
+ * @param[in] flinfo Information of the calling receive function
  */
 TSequenceSet *
-tsequenceset_read(StringInfo buf, Oid valuetypid)
+tsequenceset_read(StringInfo buf, Oid valuetypid, FmgrInfo *flinfo)
 {
   int count = (int) pq_getmsgint(buf, 4);
   assert(count > 0);
   TSequence **sequences = palloc(sizeof(TSequence *) * count);
   for (int i = 0; i < count; i++)
-    sequences[i] = tsequence_read(buf, valuetypid);
+    sequences[i] = tsequence_read(buf, valuetypid, flinfo);
   return tsequenceset_make_free(sequences, count, NORMALIZE_NO);
 }
 
@@ -2058,7 +2089,8 @@ tsequenceset_eq(const TSequenceSet *ts1, const TSequenceSet *ts2)
 {
   assert(ts1->valuetypid == ts2->valuetypid);
   /* If number of sequences or flags are not equal */
-  if (ts1->count != ts2->count || ts1->flags != ts2->flags)
+  if (ts1->count != ts2->count || MOBDB_FLAGS_NO_PREFIXBOX(ts1->flags) !=
+      MOBDB_FLAGS_NO_PREFIXBOX(ts2->flags))
     return false;
 
   /* If bounding boxes are not equal */
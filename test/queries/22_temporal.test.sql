@@ -18,6 +18,9 @@ SELECT tfloat '1@2012-01-01 08:00:00';
 SELECT tfloat '2@2012-01-01 08:00:00';
 SELECT ttext 'AAA@2012-01-01 08:00:00';
 SELECT ttext 'BBB@2012-01-01 08:00:00';
+SELECT tbool 't@2012-01-01 08:00:00';
+SELECT tint ' -2147483648 @2012-01-01 08:00:00';
+SELECT tfloat '1.5e2@2012-01-01 08:00:00';
 /* Errors */
 SELECT tbool '2@2012-01-01 08:00:00';
 SELECT tint 'TRUE@2012-01-01 08:00:00';
@@ -99,6 +102,21 @@ SELECT ttexts(ttext '{[AA@2000-01-01, AA@2000-01-03], [AA@2000-01-02, AA@2000-01
 SELECT tfloats(tfloat '{[1@2000-01-01, 2@2000-01-03], [2@2000-01-02, 1@2000-01-04]');
 SELECT tfloats(tfloat '{[1@2000-01-01, 2@2000-01-03], [2@2000-01-02, 1@2000-01-04]},');
 
+-------------------------------------------------------------------------------
+-- Values written with the layout of previous versions, which keep the
+-- bounding box after the instants or the sequences
+
+BEGIN;
+CREATE FUNCTION tint_oldlayout(cstring) RETURNS tint
+  AS 'byteain' LANGUAGE internal IMMUTABLE STRICT;
+SELECT tint_oldlayout('\x02000000140000001700000002000000000000000000000000000000200000000000000040000000000000008000000001000000160000001700000000000000000000000100000000000000800000000100000016000000170000000060d71d140000000200000000000000000000000000f03f000000000000004000000000000000000060d71d140000001400000000000000');
+SELECT tint_oldlayout('\x030000001400000017000000020000000000000000000000000000000060d71d14000000010100000000000000000000000000002000000000000000400000000000000000000000000000008000000001000000160000001700000000000000000000000100000000000000800000000100000016000000170000000060d71d140000000200000000000000000000000000f03f000000000000004000000000000000000060d71d140000001400000000000000');
+SELECT tint_oldlayout('\x04000000140000001700000002000000030000000000000000000000b8000000000000004801000000000000e0020000030000001400000017000000020000000000000000000000000000000060d71d14000000010100000000000000000000000000002000000000000000400000000000000000000000000000008000000001000000160000001700000000000000000000000100000000000000800000000100000016000000170000000060d71d140000000200000000000000000000000000f03f000000000000004000000000000000000060d71d14000000140000000000000040020000030000001400000017000000010000000000000000c0ae3b2800000000c0ae3b2800000001010000000000000000000000000000200000000000000000000000000000008000000001000000160000001700000000c0ae3b2800000003000000000000000000000000000840000000000000084000c0ae3b2800000000c0ae3b280000001400000000000000000000000000f03f0000000000000840000000000000000000c0ae3b280000001400000000000000');
+SELECT tint_oldlayout('\x030000001400000017000000020000000000000000000000000000000060d71d14000000010100000000000000000000000000002000000000000000400000000000000000000000000000008000000001000000160000001700000000000000000000000100000000000000800000000100000016000000170000000060d71d140000000200000000000000000000000000f03f000000000000004000000000000000000060d71d140000001400000000000000') = tint '[1@2000-01-01, 2@2000-01-02]';
+SELECT tbox(tint_oldlayout('\x04000000140000001700000002000000030000000000000000000000b8000000000000004801000000000000e0020000030000001400000017000000020000000000000000000000000000000060d71d14000000010100000000000000000000000000002000000000000000400000000000000000000000000000008000000001000000160000001700000000000000000000000100000000000000800000000100000016000000170000000060d71d140000000200000000000000000000000000f03f000000000000004000000000000000000060d71d14000000140000000000000040020000030000001400000017000000010000000000000000c0ae3b2800000000c0ae3b2800000001010000000000000000000000000000200000000000000000000000000000008000000001000000160000001700000000c0ae3b2800000003000000000000000000000000000840000000000000084000c0ae3b2800000000c0ae3b280000001400000000000000000000000000f03f0000000000000840000000000000000000c0ae3b280000001400000000000000'));
+SELECT appendInstant(tint_oldlayout('\x030000001400000017000000020000000000000000000000000000000060d71d14000000010100000000000000000000000000002000000000000000400000000000000000000000000000008000000001000000160000001700000000000000000000000100000000000000800000000100000016000000170000000060d71d140000000200000000000000000000000000f03f000000000000004000000000000000000060d71d140000001400000000000000'), tint '3@2000-01-03');
+ROLLBACK;
+
 -------------------------------------------------------------------------------
 -- typmod
 -------------------------------------------------------------------------------
@@ -526,6 +544,9 @@ SELECT appendInstant(tfloat '{[1@2000-01-01, 1@2000-01-02]}', '1@2000-01-02');
 SELECT appendInstant(tfloat '{[1@2000-01-01, 1@2000-01-02)}', '1@2000-01-02');
 SELECT appendInstant(tfloat '{[1@2000-01-01, 1@2000-01-02)}', '2@2000-01-02');
 SELECT appendInstant(tfloat 'Interp=Stepwise;{[1@2000-01-01, 1@2000-01-02)}', '2@2000-01-02');
+SELECT appendInstant(tint '[1@2000-01-01, 5@2000-01-02)', tint '3@2000-01-02') ~= tint '[1@2000-01-01, 3@2000-01-02]';
+SELECT appendInstant(tfloat '[1@2000-01-01, 3@2000-01-02]', tfloat '5@2000-01-03') ~= tfloat '[1@2000-01-01, 5@2000-01-03]';
+SELECT appendInstant(tfloat '[1@2000-01-01, 3@2000-01-02]', tfloat '2@2000-01-03') ~= tfloat '[1@2000-01-01, 3@2000-01-03]';
 /* Errors */
 SELECT appendInstant(tfloat '{1@2000-01-01, 2@2000-01-02}', tfloat '2@2000-01-01');
 SELECT appendInstant(tfloat '[1@2000-01-01, 1@2000-01-02]', '2@2000-01-02');
@@ -2609,6 +2630,31 @@ SELECT tfloat '{1@2000-01-01, 1@2000-01-02}' = tfloat '{[1@2000-01-01], [1@2000-
 
 -------------------------------------------------------------------------------
 
+SELECT tboolFromCompressed(compress(tbool 't@2000-01-01')) = tbool 't@2000-01-01';
+SELECT tboolFromCompressed(compress(tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}')) = tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}';
+SELECT tboolFromCompressed(compress(tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]')) = tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]';
+SELECT tboolFromCompressed(compress(tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}')) = tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[t@2000-01-04, t@2000-01-05]}';
+SELECT tintFromCompressed(compress(tint '1@2000-01-01')) = tint '1@2000-01-01';
+SELECT tintFromCompressed(compress(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}')) = tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}';
+SELECT tintFromCompressed(compress(tint '[1@2000-01-01, -2147483648@2000-01-02, 2147483647@2000-01-03]')) = tint '[1@2000-01-01, -2147483648@2000-01-02, 2147483647@2000-01-03]';
+SELECT tintFromCompressed(compress(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}')) = tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}';
+SELECT tfloatFromCompressed(compress(tfloat '1.5@2000-01-01')) = tfloat '1.5@2000-01-01';
+SELECT tfloatFromCompressed(compress(tfloat '{1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03}')) = tfloat '{1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03}';
+SELECT tfloatFromCompressed(compress(tfloat '[1.5@2000-01-01 00:00:00, 1.51@2000-01-01 00:00:01, 1.52@2000-01-01 00:00:02.001, -1e300@2000-01-01 00:00:03)')) = tfloat '[1.5@2000-01-01 00:00:00, 1.51@2000-01-01 00:00:01, 1.52@2000-01-01 00:00:02.001, -1e300@2000-01-01 00:00:03)';
+SELECT tfloatFromCompressed(compress(tfloat 'Interp=Stepwise;[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]')) = tfloat 'Interp=Stepwise;[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]';
+SELECT tfloatFromCompressed(compress(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}')) = tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}';
+SELECT length(compress(tfloat '[1@2000-01-01 00:00:00, 1@2000-01-01 00:00:01, 1@2000-01-01 00:00:02, 1@2000-01-01 00:00:03]')) < length(temporal_send(tfloat '[1@2000-01-01 00:00:00, 1@2000-01-01 00:00:01, 1@2000-01-01 00:00:02, 1@2000-01-01 00:00:03]'));
+/* Errors */
+SELECT tintFromCompressed(compress(tbool 't@2000-01-01'));
+
+-------------------------------------------------------------------------------
+
+SELECT temporal_send(tint '1@2000-01-01');
+SELECT temporal_send(tfloat '[1@2000-01-01, 2@2000-01-02]');
+SELECT temporal_send(tbool '{[t@2000-01-01, f@2000-01-02]}');
+
+-------------------------------------------------------------------------------
+
 SELECT tbool_hash(tbool 't@2000-01-01');
 SELECT tbool_hash(tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}');
 SELECT tbool_hash(tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]');
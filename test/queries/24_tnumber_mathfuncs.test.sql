@@ -380,6 +380,15 @@ SELECT tfloat '{1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03}' * tfloat '{[1.5
 SELECT tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]' * tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}';
 SELECT tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}' * tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}';
 
+SELECT valueRange(tfloat '{[1@2000-01-01, 2@2000-01-02], [3@2000-01-03, 4@2000-01-04]}' * -2);
+SELECT tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]' * 0;
+SELECT tint '[1@2000-01-01, 2@2000-01-02, 3@2000-01-03]' + tint '[3@2000-01-01, 2@2000-01-02, 1@2000-01-03]';
+SELECT tfloat '[1@2000-01-01, 3@2000-01-02, 2@2000-01-03]' + tfloat '[1@2000-01-01, 1@2000-01-02, 2@2000-01-03]';
+SELECT valueRange(tfloat '{[1@2000-01-01, 2@2000-01-02], [3@2000-01-03, 4@2000-01-04]}' - tfloat '{[0.5@2000-01-01, 0.5@2000-01-02], [1@2000-01-03, 3@2000-01-04]}');
+SELECT tfloat '{[1@2000-01-01, 2@2000-01-02), [3@2000-01-02, 3@2000-01-03]}' + tfloat '{[2@2000-01-01, 1@2000-01-02), [0@2000-01-02, 0@2000-01-03]}';
+SELECT tfloat 'Interp=Stepwise;[0@2000-01-01, 1e-20@2000-01-02, 0@2000-01-03]' + 1;
+SELECT tfloat '[0@2000-01-01, 1e-20@2000-01-02, 0@2000-01-03]' + 1;
+
 -------------------------------------------------------------------------------
 -- Temporal division
 -------------------------------------------------------------------------------
@@ -535,6 +535,10 @@ SELECT ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}' #< ttext '{[AAA@
 SELECT ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]' #< ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
 SELECT ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}' #< ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
 
+SELECT tfloat '[10@2000-01-01, 20@2000-01-02, 15@2000-01-03]' #< 5;
+SELECT 50 #< tint '{10@2000-01-01, 20@2000-01-02}';
+SELECT tfloat '[1@2000-01-01, 2@2000-01-03]' #< tfloat '{[3@2000-01-02, 4@2000-01-04], [5@2000-01-05, 6@2000-01-06]}';
+
 -------------------------------------------------------------------------------
 -- Temporal gt
 -------------------------------------------------------------------------------
@@ -957,4 +961,15 @@ SELECT ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}' #>= ttext '{[AAA
 SELECT ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]' #>= ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
 SELECT ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}' #>= ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
 
+SELECT tfloat '[1@2000-01-01, 2@2000-01-03]' #< 1.5;
+SELECT 1.5 #> tfloat '[1@2000-01-01, 2@2000-01-03]';
+SELECT tfloat '[1@2000-01-01, 2@2000-01-03]' #= 1.5;
+SELECT tfloat '[2@2000-01-01, 4@2000-01-03]' #<= 2;
+SELECT tfloat '[1@2000-01-01, 3@2000-01-03]' #>= 2;
+SELECT tfloat '{[1@2000-01-01, 2@2000-01-03], [2@2000-01-04, 1@2000-01-06]}' #>= 1.5;
+SELECT tint '{[1@2000-01-01, 2@2000-01-02, 3@2000-01-03], [3@2000-01-04, 1@2000-01-05]}' #< 3;
+SELECT tint '{1@2000-01-01, 2@2000-01-02, 3@2000-01-03}' #<> 2;
+SELECT tfloat '-0@2000-01-01' #= 0.0;
+SELECT tfloat '-0@2000-01-01' #<= 0.0;
+
 -------------------------------------------------------------------------------
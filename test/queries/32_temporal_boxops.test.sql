@@ -2008,3 +2008,12 @@ SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 WHERE t1.b -|- t2.b;
 
 -------------------------------------------------------------------------------
 
+DROP TABLE IF EXISTS tbl_tfloat_long;
+CREATE TABLE tbl_tfloat_long AS SELECT tfloatseq(array_agg(tfloatinst((i % 7)::float, timestamptz '2000-01-01' + i * interval '1 second') ORDER BY i)) AS temp FROM generate_series(1, 10000) i;
+SELECT temp && tbox 'TBOX((1,2000-01-01),(2,2000-01-02))' FROM tbl_tfloat_long;
+SELECT temp @> tfloat '[1@2000-01-01 00:00:01, 2@2000-01-01 00:00:02]' FROM tbl_tfloat_long;
+SELECT period '[2000-01-01, 2000-01-02]' @> temp FROM tbl_tfloat_long;
+SELECT temp ~= tfloat '[0@2000-01-01 00:00:01, 6@2000-01-01 02:46:40]' FROM tbl_tfloat_long;
+DROP TABLE tbl_tfloat_long;
+
+-------------------------------------------------------------------------------
@@ -113,6 +113,11 @@ SELECT extent(temp) FROM (VALUES
 SELECT tcount(temp) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tint), 
 ('[3@2000-01-02, 4@2000-01-06]'::tint)) t(temp);
+SELECT tcount(temp) FROM (VALUES
+('[1@2000-01-01, 1@2000-01-02)'::tint), ('[1@2000-01-02, 1@2000-01-03]'::tint),
+('[1@2000-01-02]'::tint)) t(temp);
+SELECT tcount(temp) FROM (VALUES
+('[1@2000-01-01, 1@2000-01-02)'::tint), ('[1@2000-01-02, 1@2000-01-03]'::tint)) t(temp);
 
 SELECT tmin(temp) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tint), 
@@ -130,6 +135,20 @@ SELECT tavg(temp) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tint), 
 ('[3@2000-01-02, 4@2000-01-06]'::tint)) t(temp);
 
+SELECT tcount(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, '1@2000-01-01'::tint), (2, '2@2000-01-01'::tint), (3, '3@2000-01-02'::tint)) t(k, temp);
+SELECT tavg(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, '1@2000-01-01'::tint), (2, '2@2000-01-01'::tint), (3, '3@2000-01-02'::tint)) t(k, temp);
+SELECT tsum(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, tint '[1@2000-01-01, 1@2000-01-03]'), (2, tint '[2@2000-01-02, 2@2000-01-04]'),
+(3, tint '[3@2000-01-03, 3@2000-01-05]')) t(k, temp);
+SELECT extent(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, tint '[1@2000-01-01, 5@2000-01-03]'), (2, tint '[2@2000-01-02, 3@2000-01-04]'),
+(3, tint '[4@2000-01-03, 4@2000-01-05]')) t(k, temp);
+SELECT extent(temp) OVER (ORDER BY k ROWS BETWEEN 2 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, tbool '[t@2000-01-01, f@2000-01-03]'), (2, NULL), (3, tbool '[t@2000-01-02, t@2000-01-04)'),
+(4, tbool 't@2000-01-03'), (5, tbool '(f@2000-01-02, f@2000-01-03]'), (6, tbool 't@2000-01-05')) t(k, temp);
+
 --------------------------------------------------
 
 SELECT extent(temp) FROM (VALUES
@@ -182,6 +201,21 @@ SELECT round(tavg(temp), 6) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tfloat), 
 ('[3@2000-01-02, 4@2000-01-06]'::tfloat)) t(temp);
 
+SELECT tavg(temp) FROM (VALUES
+(tfloat '[0.7@2000-01-01, 0.1@2000-01-02]')) t(temp);
+SELECT tavg(temp) FROM (VALUES
+(tfloat '[1e16@2000-01-01, 1e16@2000-01-02]'), (tfloat '[1@2000-01-01, 1@2000-01-03]')) t(temp);
+SELECT tavg(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, tfloat '[1e16@2000-01-01, 1e16@2000-01-03]'), (2, tfloat '[1@2000-01-01, 1@2000-01-03]'),
+(3, tfloat '[2@2000-01-01, 2@2000-01-03]')) t(k, temp);
+SELECT tsum(temp) OVER (ORDER BY k ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM (VALUES
+(1, tfloat '[1@2000-01-01, 3@2000-01-03]'), (2, tfloat '[2@2000-01-02, 2@2000-01-04]'),
+(3, tfloat '[1@2000-01-03, 3@2000-01-05]')) t(k, temp);
+SELECT numInstants(tavg(temp)) FROM (VALUES
+('Interp=Stepwise;[0.1@2000-01-01, 0.1@2000-01-03]'::tfloat),
+('Interp=Stepwise;[0.2@2000-01-01, 0.2@2000-01-02)'::tfloat),
+('Interp=Stepwise;[0.2@2000-01-02, 0.2@2000-01-03]'::tfloat)) t(temp);
+
 --------------------------------------------------
 
 /* Errors */
@@ -205,3 +239,56 @@ SELECT tsum(temp) FROM (VALUES
 ('{[3@2000-01-02, 4@2000-01-06]}'::tfloat)) t(temp);
 
 --------------------------------------------------
+
+-------------------------------------------------------------------------------
+
+SELECT tintSeq(v, t ORDER BY t) FROM (VALUES
+  (1, timestamptz '2000-01-01'), (1, '2000-01-02'), (2, '2000-01-03'), (2, '2000-01-04')) t(v, t);
+SELECT tfloatSeq(v, t ORDER BY t) FROM (VALUES
+  (1, timestamptz '2000-01-01'), (2, '2000-01-02'), (3, '2000-01-03'), (3, '2000-01-03'), (1, '2000-01-05')) t(v, t);
+SELECT tfloatSeq(v, t, interval '1 day' ORDER BY t) FROM (VALUES
+  (1, timestamptz '2000-01-01'), (2, '2000-01-02'), (5, '2000-01-05'), (6, '2000-01-06')) t(v, t);
+SELECT ttextSeq(v, t ORDER BY t) FROM (VALUES
+  (text 'AAA', timestamptz '2000-01-01'), (NULL, '2000-01-02'), ('BBB', '2000-01-03')) t(v, t);
+SELECT tboolSeq(v, t ORDER BY t) FROM (VALUES
+  (true, timestamptz '2000-01-01'), (true, '2000-01-02'), (false, '2000-01-03')) t(v, t);
+/* Errors */
+SELECT tintSeq(v, t) FROM (VALUES
+  (1, timestamptz '2000-01-02'), (2, '2000-01-01')) t(v, t);
+
+SELECT appendInstant(inst ORDER BY getTimestamp(inst)) FROM (VALUES
+  (tfloat '1@2000-01-01'), ('2@2000-01-02'), ('3@2000-01-03'), ('3@2000-01-03'), ('1@2000-01-05')) t(inst);
+SELECT appendInstant(inst ORDER BY getTimestamp(inst)) FROM (VALUES
+  (tint '1@2000-01-01'), ('1@2000-01-02'), (NULL), ('2@2000-01-03')) t(inst);
+SELECT appendInstant(inst ORDER BY getTimestamp(inst)) FROM (VALUES
+  (ttext 'AAA@2000-01-01'), ('BBBBBBBBBBBB@2000-01-02'), ('C@2000-01-03')) t(inst);
+SELECT appendInstant(tfloatinst(i % 7, timestamptz '2000-01-01' + i * interval '1 hour') ORDER BY i) =
+  tfloatseq(array_agg(tfloatinst(i % 7, timestamptz '2000-01-01' + i * interval '1 hour') ORDER BY i))
+FROM generate_series(1, 1000) i;
+/* Errors */
+SELECT appendInstant(inst) FROM (VALUES
+  (tint '1@2000-01-02'), ('2@2000-01-01')) t(inst);
+SELECT appendInstant(inst ORDER BY getTimestamp(inst)) FROM (VALUES
+  (tfloat '1@2000-01-01'), ('2@2000-01-02'), ('3@2000-01-02')) t(inst);
+SELECT appendInstant(inst) FROM (VALUES
+  (tint '[1@2000-01-01, 2@2000-01-02]')) t(inst);
+
+-------------------------------------------------------------------------------
+
+SELECT tcountBucket(temp, '1 day', '2000-01-01') FROM (VALUES
+(tint '[1@2000-01-01, 2@2000-01-02 12:00]'), ('{3@2000-01-02 06:00, 4@2000-01-04}')) t(temp);
+SELECT tavgBucket(temp, '1 day', '2000-01-01') FROM (VALUES
+(tfloat '[0@2000-01-01, 4@2000-01-03]'), ('[2@2000-01-01, 2@2000-01-03)')) t(temp);
+/* Errors */
+SELECT tcountBucket(temp, i, '2000-01-01') FROM (VALUES
+(tint '1@2000-01-01', interval '1 day'), ('1@2000-01-02', '1 hour')) t(temp, i);
+
+-------------------------------------------------------------------------------
+
+SELECT merge(temp) FROM (VALUES
+(tint '[5@2000-01-05, 5@2000-01-06]'), ('[2@2000-01-02, 3@2000-01-03]'), ('[1@2000-01-01, 1@2000-01-02)')) t(temp);
+SELECT merge(temp) FROM (VALUES
+(tfloat '[2@2000-01-02, 3@2000-01-03]'), ('[1@2000-01-01, 2@2000-01-02]')) t(temp);
+/* Errors */
+SELECT merge(temp) FROM (VALUES
+(tint '[1@2000-01-01, 1@2000-01-03]'), ('[2@2000-01-02, 2@2000-01-04]')) t(temp);